@@ -581,3 +581,64 @@ err_out:
 
     return hse_err_to_errno(err);
 }
+
+int
+kvdb_trace_request(const char *kvdb_home, const char *period, unsigned long min_us)
+{
+    struct pidfile content;
+    hse_err_t      err;
+    char           url[PATH_MAX];
+    char *         buf;
+    size_t         bufsz = (2 * 1024 * 1024);
+
+    err = pidfile_deserialize(kvdb_home, &content);
+    if (err) {
+        fprintf(
+            stderr,
+            "Failed to find the UNIX socket for the KVDB (%s). Ensure the KVDB is open in a "
+            "process.\n",
+            kvdb_home);
+        return hse_err_to_errno(err);
+    }
+
+    if (content.socket.path[0] == '\0') {
+        fprintf(stderr, "HSE socket is disabled in PID %d\n", content.pid);
+        return ENOENT;
+    }
+
+    buf = calloc(1, bufsz);
+    if (!buf)
+        return ENOMEM;
+
+    if (period) {
+        snprintf(url, sizeof(url), "trace?period=%s", period);
+
+        err = curl_put(url, content.socket.path, 0, 0, buf, bufsz);
+        if (err) {
+            char ebuf[256];
+
+            hse_strerror(err, ebuf, sizeof(ebuf));
+            fprintf(stderr, "Failed to set the trace period for the KVDB (%s): %s\n",
+                    kvdb_home, ebuf);
+            goto err_out;
+        }
+    }
+
+    snprintf(url, sizeof(url), "trace?min_us=%lu", min_us);
+
+    err = curl_get(url, content.socket.path, buf, bufsz);
+    if (err) {
+        char ebuf[256];
+
+        hse_strerror(err, ebuf, sizeof(ebuf));
+        fprintf(stderr, "Failed to retrieve request traces for the KVDB (%s): %s\n",
+                kvdb_home, ebuf);
+    } else {
+        printf("%s", buf);
+    }
+
+err_out:
+    free(buf);
+
+    return hse_err_to_errno(err);
+}
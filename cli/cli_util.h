@@ -30,4 +30,7 @@ kvdb_storage_info_print(
 
 int
 kvdb_compact_request(const char *kvdb_home, const char *request_type, unsigned timeout_sec);
+
+int
+kvdb_trace_request(const char *kvdb_home, const char *period, unsigned long min_us);
 #endif
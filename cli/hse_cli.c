@@ -130,17 +130,20 @@ struct cli {
  *    hse kvdb drop
  *    hse kvdb info
  *    hse kvdb compact
+ *    hse kvdb trace
  */
 static cli_cmd_func_t cli_hse_kvdb_create;
 static cli_cmd_func_t cli_hse_kvdb_drop;
 static cli_cmd_func_t cli_hse_kvdb_info;
 static cli_cmd_func_t cli_hse_kvdb_compact;
+static cli_cmd_func_t cli_hse_kvdb_trace;
 /* static cli_cmd_func_t cli_hse_kvdb_params; */
 struct cli_cmd        cli_hse_kvdb_commands[] = {
     { "create", "Create a KVDB", cli_hse_kvdb_create, 0 },
     { "drop", "Drop a KVDB", cli_hse_kvdb_drop, 0 },
     { "info", "Display information for a KVDB", cli_hse_kvdb_info, 0 },
     { "compact", "Compact a KVDB", cli_hse_kvdb_compact, 0 },
+    { "trace", "Display sampled request traces for a KVDB", cli_hse_kvdb_trace, 0 },
     /* { "params", "Show configuration parameters for a KVDB", cli_hse_kvdb_params, 0 }, */
     { 0 },
 };
@@ -1031,6 +1034,94 @@ cli_hse_kvdb_compact(struct cli_cmd *self, struct cli *cli)
     return cli_hse_kvdb_compact_impl(cli, kvdb_home, status, cancel, timeout_secs);
 }
 
+static int
+cli_hse_kvdb_trace(struct cli_cmd *self, struct cli *cli)
+{
+    const struct cmd_spec spec = {
+        .usagev =
+            {
+                "[options] <kvdb_home>",
+                NULL,
+            },
+        .optionv =
+            {
+                OPTION_HELP,
+                { "-m, --min-us=USECS", "Only show requests that took at least USECS" },
+                { "-p, --period=N", "Trace one in every N requests per thread (0 disables)" },
+                { NULL },
+            },
+        .longoptv =
+            {
+                { "help", no_argument, 0, 'h' },
+                { "min-us", required_argument, 0, 'm' },
+                { "period", required_argument, 0, 'p' },
+                { NULL },
+            },
+        .configv =
+            {
+                { NULL },
+            },
+        .extra_help = {
+            "Tracing is process wide and disabled by default.  Use --period to",
+            "enable it in the process that has the KVDB open, then run again to",
+            "display the most recent samples with a per-stage time breakdown.",
+            NULL,
+        },
+    };
+
+    const char *kvdb_home = NULL;
+    const char *period = NULL;
+    uint64_t    min_us = 0;
+    uint32_t    n;
+    bool        help = false;
+    int         c;
+
+    if (cli_hook(cli, self, &spec))
+        return 0;
+
+    while (-1 != (c = cli_getopt(cli))) {
+        switch (c) {
+            case 'h':
+                help = true;
+                break;
+            case 'm':
+                if (parse_u64(optarg, &min_us)) {
+                    fprintf(stderr, "%s: unable to parse '%s' as an unsigned 64-bit scalar value\n",
+                            self->cmd_path, optarg);
+                    return EX_USAGE;
+                }
+                break;
+            case 'p':
+                if (parse_u32(optarg, &n)) {
+                    fprintf(stderr, "%s: unable to parse '%s' as an unsigned 32-bit scalar value\n",
+                            self->cmd_path, optarg);
+                    return EX_USAGE;
+                }
+                period = optarg;
+                break;
+            default:
+                return EX_USAGE;
+        }
+    }
+
+    kvdb_home = cli_next_arg(cli);
+
+    if (!kvdb_home || help) {
+        cmd_print_help(self, help ? stdout : stderr);
+        return help ? 0 : EX_USAGE;
+    }
+
+    if (cli_hse_init_rest(cli))
+        return -1;
+
+    if (cli->optind != cli->argc) {
+        fprintf(stderr, "Too many arguments passed on the command line\n");
+        return EINVAL;
+    }
+
+    return kvdb_trace_request(kvdb_home, period, min_us);
+}
+
 static int
 cli_hse_storage_add_impl(struct cli *cli, const char *const kvdb_home)
 {
@@ -6,6 +6,20 @@
 
 package org.micron.hse;
 
+import java.nio.ByteBuffer;
+
+/* The ByteBuffer methods require direct buffers and operate on the bytes
+ * between a buffer's position and limit, so no data is copied between the
+ * Java heap and HSE.
+ *
+ * Batch buffers hold records packed back to back, with each length a
+ * 4-byte int in native byte order (use ByteOrder.nativeOrder()):
+ *
+ *   putBatch input:   { klen, vlen, key, value } ...
+ *   getBatch keys:    { klen, key } ...
+ *   getBatch output:  { vlen, value } ...    (vlen -1: key not found)
+ *   readBatch output: { klen, vlen, key, value } ...
+ */
 public class API {
 
 	public static void loadLibrary() {
@@ -42,6 +56,68 @@ public class API {
 		return this.del(nativeHandle, key);
 	}
 
+	/* Returns the length of key's value, or -1 if key was not found.
+	 */
+	public int valueLength(byte[] key) throws HSEGenException {
+		return this.valueLength(nativeHandle, key);
+	}
+
+	public int put(ByteBuffer key, ByteBuffer value)
+		       throws HSEGenException {
+		return this.putDirect(nativeHandle,
+				      key, key.position(), key.remaining(),
+				      value, value.position(), value.remaining());
+	}
+
+	/* Returns the length of key's value, or -1 if key was not found.
+	 * The value is stored at value's position and its limit set to the
+	 * end of the value only if it fits, otherwise value is unchanged and
+	 * the caller may retry with a buffer of the returned length.  A null
+	 * value buffer only probes the length.
+	 */
+	public int get(ByteBuffer key, ByteBuffer value)
+		       throws HSEGenException {
+		int pos = (value == null) ? 0 : value.position();
+		int cap = (value == null) ? 0 : value.remaining();
+		int len;
+
+		len = this.getDirect(nativeHandle,
+				     key, key.position(), key.remaining(),
+				     value, pos, cap);
+		if (len >= 0 && len <= cap)
+			value.limit(pos + len);
+
+		return len;
+	}
+
+	/* Puts all the records in batch, returns the number put.
+	 */
+	public int putBatch(ByteBuffer batch) throws HSEGenException {
+		return this.putBatch(nativeHandle, batch,
+				     batch.position(), batch.remaining());
+	}
+
+	/* Gets values for as many keys as will fit in out.  Advances keys'
+	 * position past the keys processed and sets out's limit to the end
+	 * of the results.  Returns false if no progress could be made
+	 * because the next value is larger than out.
+	 */
+	public boolean getBatch(ByteBuffer keys, ByteBuffer out)
+				throws HSEGenException {
+		long rv;
+		int  used;
+
+		rv = this.getBatch(nativeHandle,
+				   keys, keys.position(), keys.remaining(),
+				   out, out.position(), out.remaining());
+		used = (int)(rv >>> 32);
+
+		keys.position(keys.position() + used);
+		out.limit(out.position() + (int)rv);
+
+		return used > 0 || !keys.hasRemaining();
+	}
+
 	public void close() throws HSEGenException {
 		this.close(nativeHandle);
 	}
@@ -66,6 +142,20 @@ public class API {
 		return this.read(nativeHandle);
 	}
 
+	/* Reads as many records as will fit in out and sets out's limit to
+	 * the end of them.  Throws HSEEOFException once the cursor is
+	 * exhausted.
+	 */
+	public void readBatch(ByteBuffer out)
+			      throws HSEGenException, HSEEOFException {
+		int len;
+
+		len = this.readBatch(nativeHandle, out,
+				     out.position(), out.remaining());
+
+		out.limit(out.position() + len);
+	}
+
 	private long nativeHandle;
 
 	// JNI functions
@@ -89,6 +179,27 @@ public class API {
 
 	public native int del(long handle, byte[] key) throws HSEGenException;
 
+	public native int valueLength(long handle, byte[] key)
+				      throws HSEGenException;
+
+	public native int putDirect(long handle,
+				    ByteBuffer key, int keyOff, int keyLen,
+				    ByteBuffer value, int valueOff, int valueLen)
+				    throws HSEGenException;
+
+	public native int getDirect(long handle,
+				    ByteBuffer key, int keyOff, int keyLen,
+				    ByteBuffer value, int valueOff, int valueCap)
+				    throws HSEGenException;
+
+	public native int putBatch(long handle, ByteBuffer batch, int off,
+				   int len) throws HSEGenException;
+
+	public native long getBatch(long handle,
+				    ByteBuffer keys, int keysOff, int keysLen,
+				    ByteBuffer out, int outOff, int outCap)
+				    throws HSEGenException;
+
 	public native void createCursor(long handle, String pfx, int pfxlen)
 					throws HSEGenException;
 
@@ -99,4 +210,8 @@ public class API {
 
 	public native byte[] read(long handle)
 				  throws HSEGenException, HSEEOFException;
+
+	public native int readBatch(long handle, ByteBuffer out, int off,
+				    int cap)
+				    throws HSEGenException, HSEEOFException;
 }
@@ -30,6 +30,19 @@ pthread_key_t td_cursor_key;
 
 thread_local struct hse_kvs_cursor *cursor = NULL;
 
+/* A cursor record read by readBatch() that did not fit in the caller's
+ * buffer.  It remains valid until the next read, seek or destroy of the
+ * thread's cursor, and is returned first by the next readBatch().
+ */
+static thread_local const void *pendKey, *pendVal;
+static thread_local size_t      pendKeyL, pendValL;
+static thread_local bool        pending;
+
+/* Batch records are packed back to back with lengths in native byte order
+ * (see API.java).  A length of -1 in a get result marks a key not found.
+ */
+#define BATCH_LEN_SZ ((ptrdiff_t)sizeof(int32_t))
+
 static void
 jni_config_string_to_argv(char *p_list, size_t *argc, const char **argv, const char *prefix, uint32_t max_args)
 {
@@ -94,6 +107,42 @@ throw_err(JNIEnv *env, const char *func, uint64_t err)
     throw_gen_exception(env, msg);
 }
 
+/* Return the address of [off, off + len) within a direct ByteBuffer,
+ * or throw and return NULL if buf is not direct or the range is invalid.
+ */
+static void *
+direct_addr(JNIEnv *env, jobject buf, jint off, jint len)
+{
+    char *addr;
+    jlong cap;
+
+    addr = (*env)->GetDirectBufferAddress(env, buf);
+    cap = (*env)->GetDirectBufferCapacity(env, buf);
+
+    if (!addr || off < 0 || len < 0 || (jlong)off + len > cap) {
+        throw_gen_exception(env, "Not a direct buffer or invalid range");
+        return NULL;
+    }
+
+    return addr + off;
+}
+
+static void
+put_len(char *p, int32_t len)
+{
+    memcpy(p, &len, sizeof(len));
+}
+
+static int32_t
+get_len(const char *p)
+{
+    int32_t len;
+
+    memcpy(&len, p, sizeof(len));
+
+    return len;
+}
+
 static void
 td_exit_getbuf(void *arg)
 {
@@ -290,6 +339,7 @@ Java_org_micron_hse_API_close(JNIEnv *env, jobject jobj, jlong handle)
         }
 
         cursor = NULL;
+        pending = false;
     }
 
     rc = hse_kvdb_kvs_close((void *)handle);
@@ -361,6 +411,51 @@ Java_org_micron_hse_API_put(
     return rval;
 }
 
+/* Get a value larger than g_val_buf_size, retrying if it grows between
+ * the length probe and the fetch.
+ */
+static jbyteArray
+get_large(JNIEnv *env, struct hse_kvs *kvs, const void *key, size_t keyL, size_t vlen)
+{
+    jbyteArray jRetVal = NULL;
+    uint64_t   rc;
+    bool       found;
+    size_t     alen;
+    void      *buf;
+
+    do {
+        alen = vlen;
+
+        buf = malloc(alen);
+        if (!buf) {
+            throw_gen_exception(env, "Failed to alloc value buffer");
+            return NULL;
+        }
+
+        rc = hse_kvs_get(kvs, 0, NULL, key, keyL, &found, buf, alen, &vlen);
+        if (rc || !found) {
+            if (rc)
+                throw_err(env, "hse_kvs_get", rc);
+            else
+                throw_gen_exception(env, "hse_kvs_get: key not found");
+            free(buf);
+            return NULL;
+        }
+
+        if (vlen <= alen) {
+            jRetVal = (*env)->NewByteArray(env, vlen);
+            if (jRetVal)
+                (*env)->SetByteArrayRegion(env, jRetVal, 0, vlen, buf);
+            else
+                throw_gen_exception(env, "Failed to alloc jRetVal");
+        }
+
+        free(buf);
+    } while (vlen > alen);
+
+    return jRetVal;
+}
+
 JNIEXPORT jbyteArray JNICALL
 Java_org_micron_hse_API_get(JNIEnv *env, jobject jobj, jlong handle, jbyteArray key)
 {
@@ -428,6 +523,14 @@ Java_org_micron_hse_API_get(JNIEnv *env, jobject jobj, jlong handle, jbyteArray
         goto errout;
     }
 
+    /* The value didn't fit in valBuf, so fetch it again into a buffer
+     * of the reported size.
+     */
+    if (vlen > g_val_buf_size) {
+        jRetVal = get_large(env, (void *)handle, keyA, keyL, vlen);
+        goto errout;
+    }
+
     jRetVal = (*env)->NewByteArray(env, vlen);
     if (!jRetVal) {
         throw_gen_exception(env, "Failed to alloc jRetVal");
@@ -541,6 +644,7 @@ Java_org_micron_hse_API_destroyCursor(JNIEnv *env, jobject jobj, jlong handle)
     }
 
     cursor = NULL;
+    pending = false;
 }
 
 JNIEXPORT jbyteArray JNICALL
@@ -567,6 +671,8 @@ Java_org_micron_hse_API_seek(JNIEnv *env, jobject jobj, jlong handle, jbyteArray
 
     keyL = (*env)->GetArrayLength(env, key);
 
+    pending = false;
+
     rc = hse_kvs_cursor_seek(cursor, 0, keyA, keyL, &foundKey, &foundKeyL);
 
     (*env)->ReleaseByteArrayElements(env, key, keyA, JNI_ABORT);
@@ -604,6 +710,15 @@ Java_org_micron_hse_API_read(JNIEnv *env, jobject jobj, jlong handle)
         goto errout;
     }
 
+    if (pending) {
+        keyBuf = pendKey;
+        klen = pendKeyL;
+        valBuf = pendVal;
+        vlen = pendValL;
+        pending = false;
+        goto found;
+    }
+
     rc = hse_kvs_cursor_read(cursor, 0, &keyBuf, &klen, &valBuf, &vlen, &eof);
 
     if (rc) {
@@ -616,6 +731,7 @@ Java_org_micron_hse_API_read(JNIEnv *env, jobject jobj, jlong handle)
         goto errout;
     }
 
+found:
     jRetVal = (*env)->NewByteArray(env, vlen);
     if (!jRetVal) {
         throw_gen_exception(env, "Failed to alloc jRetVal");
@@ -627,3 +743,292 @@ Java_org_micron_hse_API_read(JNIEnv *env, jobject jobj, jlong handle)
 errout:
     return jRetVal;
 }
+
+JNIEXPORT jint JNICALL
+Java_org_micron_hse_API_putDirect(
+    JNIEnv *env,
+    jobject jobj,
+    jlong   handle,
+    jobject key,
+    jint    keyOff,
+    jint    keyLen,
+    jobject value,
+    jint    valueOff,
+    jint    valueLen)
+{
+    void    *keyA, *valueA;
+    uint64_t rc;
+
+    keyA = direct_addr(env, key, keyOff, keyLen);
+    if (!keyA)
+        return -1;
+
+    valueA = valueLen > 0 ? direct_addr(env, value, valueOff, valueLen) : NULL;
+    if (!valueA && valueLen > 0)
+        return -1;
+
+    rc = hse_kvs_put((void *)handle, 0, NULL, keyA, keyLen, valueA, valueLen);
+    if (rc) {
+        throw_err(env, "hse_kvs_put", rc);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Returns the length of the value, which is copied into [valueOff,
+ * valueOff + valueCap) only if it fits, or -1 if the key was not found.
+ * A null value buffer (or zero valueCap) makes this a length probe.
+ */
+JNIEXPORT jint JNICALL
+Java_org_micron_hse_API_getDirect(
+    JNIEnv *env,
+    jobject jobj,
+    jlong   handle,
+    jobject key,
+    jint    keyOff,
+    jint    keyLen,
+    jobject value,
+    jint    valueOff,
+    jint    valueCap)
+{
+    void    *keyA, *valueA = NULL;
+    size_t   vlen;
+    bool     found;
+    uint64_t rc;
+
+    keyA = direct_addr(env, key, keyOff, keyLen);
+    if (!keyA)
+        return -1;
+
+    if (value && valueCap > 0) {
+        valueA = direct_addr(env, value, valueOff, valueCap);
+        if (!valueA)
+            return -1;
+    } else {
+        valueCap = 0;
+    }
+
+    rc = hse_kvs_get((void *)handle, 0, NULL, keyA, keyLen, &found, valueA, valueCap, &vlen);
+    if (rc) {
+        throw_err(env, "hse_kvs_get", rc);
+        return -1;
+    }
+
+    return found ? (jint)vlen : -1;
+}
+
+JNIEXPORT jint JNICALL
+Java_org_micron_hse_API_valueLength(JNIEnv *env, jobject jobj, jlong handle, jbyteArray key)
+{
+    jbyte   *keyA;
+    jsize    keyL;
+    jboolean isCopy;
+    size_t   vlen;
+    bool     found;
+    uint64_t rc;
+
+    keyA = (*env)->GetByteArrayElements(env, key, &isCopy);
+    if (!keyA) {
+        throw_gen_exception(env, "Failed to get key bytes");
+        return -1;
+    }
+
+    keyL = (*env)->GetArrayLength(env, key);
+
+    rc = hse_kvs_get((void *)handle, 0, NULL, keyA, keyL, &found, NULL, 0, &vlen);
+
+    (*env)->ReleaseByteArrayElements(env, key, keyA, JNI_ABORT);
+
+    if (rc) {
+        throw_err(env, "hse_kvs_get", rc);
+        return -1;
+    }
+
+    return found ? (jint)vlen : -1;
+}
+
+/* Put each (klen, vlen, key, value) record in [off, off + len).
+ * Returns the number of records put.
+ */
+JNIEXPORT jint JNICALL
+Java_org_micron_hse_API_putBatch(
+    JNIEnv *env,
+    jobject jobj,
+    jlong   handle,
+    jobject batch,
+    jint    off,
+    jint    len)
+{
+    const char *p, *end;
+    jint        n = 0;
+    uint64_t    rc;
+
+    p = direct_addr(env, batch, off, len);
+    if (!p)
+        return -1;
+
+    end = p + len;
+
+    while (p < end) {
+        int32_t klen, vlen;
+
+        if (end - p < 2 * BATCH_LEN_SZ)
+            goto badrec;
+
+        klen = get_len(p);
+        vlen = get_len(p + BATCH_LEN_SZ);
+        p += 2 * BATCH_LEN_SZ;
+
+        if (klen < 0 || vlen < 0 || end - p < (ptrdiff_t)klen + vlen)
+            goto badrec;
+
+        rc = hse_kvs_put((void *)handle, 0, NULL, p, klen, vlen ? p + klen : NULL, vlen);
+        if (rc) {
+            throw_err(env, "hse_kvs_put", rc);
+            return n;
+        }
+
+        p += klen + vlen;
+        ++n;
+    }
+
+    return n;
+
+badrec:
+    throw_gen_exception(env, "putBatch: malformed record");
+    return n;
+}
+
+/* Get the value of each (klen, key) record in [keysOff, keysOff + keysLen),
+ * appending a (vlen, value) record for each to [outOff, outOff + outCap).
+ * Stops at the first value that does not fit.  Returns the number of
+ * bytes of keys consumed in the upper 32 bits and the number of bytes
+ * written to out in the lower 32 bits.
+ */
+JNIEXPORT jlong JNICALL
+Java_org_micron_hse_API_getBatch(
+    JNIEnv *env,
+    jobject jobj,
+    jlong   handle,
+    jobject keys,
+    jint    keysOff,
+    jint    keysLen,
+    jobject out,
+    jint    outOff,
+    jint    outCap)
+{
+    const char *kp, *kstart, *kend;
+    char       *op, *ostart, *oend;
+    uint64_t    rc;
+
+    kstart = direct_addr(env, keys, keysOff, keysLen);
+    if (!kstart)
+        return -1;
+
+    ostart = direct_addr(env, out, outOff, outCap);
+    if (!ostart)
+        return -1;
+
+    kp = kstart;
+    kend = kstart + keysLen;
+    op = ostart;
+    oend = ostart + outCap;
+
+    while (kp < kend && oend - op >= BATCH_LEN_SZ) {
+        size_t  vlen, vcap;
+        int32_t klen;
+        bool    found;
+
+        if (kend - kp < BATCH_LEN_SZ)
+            goto badrec;
+
+        klen = get_len(kp);
+        if (klen < 0 || kend - kp - BATCH_LEN_SZ < klen)
+            goto badrec;
+
+        vcap = oend - op - BATCH_LEN_SZ;
+
+        rc = hse_kvs_get((void *)handle, 0, NULL, kp + BATCH_LEN_SZ, klen, &found,
+                         vcap ? op + BATCH_LEN_SZ : NULL, vcap, &vlen);
+        if (rc) {
+            throw_err(env, "hse_kvs_get", rc);
+            break;
+        }
+
+        if (found && vlen > vcap)
+            break;
+
+        put_len(op, found ? (int32_t)vlen : -1);
+        op += BATCH_LEN_SZ + (found ? vlen : 0);
+        kp += BATCH_LEN_SZ + klen;
+    }
+
+    return ((jlong)(kp - kstart) << 32) | (op - ostart);
+
+badrec:
+    throw_gen_exception(env, "getBatch: malformed record");
+    return ((jlong)(kp - kstart) << 32) | (op - ostart);
+}
+
+/* Append (klen, vlen, key, value) records from the thread's cursor to
+ * [off, off + cap) until it is full or the cursor reaches the end.
+ * Returns the number of bytes written, or throws HSEEOFException if
+ * the cursor was already at the end.
+ */
+JNIEXPORT jint JNICALL
+Java_org_micron_hse_API_readBatch(JNIEnv *env, jobject jobj, jlong handle, jobject out, jint off, jint cap)
+{
+    char    *op, *ostart, *oend;
+    uint64_t rc;
+    bool     eof = false;
+
+    if (cursor == NULL) {
+        throw_gen_exception(env, "No active cursor; not created?");
+        return -1;
+    }
+
+    ostart = direct_addr(env, out, off, cap);
+    if (!ostart)
+        return -1;
+
+    op = ostart;
+    oend = ostart + cap;
+
+    while (1) {
+        if (!pending) {
+            rc = hse_kvs_cursor_read(cursor, 0, &pendKey, &pendKeyL, &pendVal, &pendValL, &eof);
+            if (rc) {
+                throw_err(env, "hse_kvs_cursor_read", rc);
+                return op - ostart;
+            }
+
+            if (eof)
+                break;
+
+            pending = true;
+        }
+
+        if ((size_t)(oend - op) < 2 * BATCH_LEN_SZ + pendKeyL + pendValL) {
+            if (op == ostart)
+                throw_gen_exception(env, "readBatch: record larger than buffer");
+            break;
+        }
+
+        put_len(op, pendKeyL);
+        put_len(op + BATCH_LEN_SZ, pendValL);
+        op += 2 * BATCH_LEN_SZ;
+
+        memcpy(op, pendKey, pendKeyL);
+        op += pendKeyL;
+        memcpy(op, pendVal, pendValL);
+        op += pendValL;
+
+        pending = false;
+    }
+
+    if (eof && op == ostart)
+        throw_eof_exception(env);
+
+    return op - ostart;
+}
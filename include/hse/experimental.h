@@ -30,6 +30,12 @@ extern "C" {
 #define HSE_KVDB_COMPACT_CANCEL   (1u << 0)
 #define HSE_KVDB_COMPACT_SAMP_LWM (1u << 1)
 
+/* hse_kvs_cursor_create() flags */
+#define HSE_CURSOR_CREATE_KEYS_ONLY (1u << 1)
+
+/* hse_kvs_range_count() flags */
+#define HSE_KVS_RANGE_COUNT_EST (1u << 0)
+
 /** @addtogroup KVDB Key-Value Database (KVDB)
  * @{
  */
@@ -87,6 +93,53 @@ hse_kvdb_compact(struct hse_kvdb *kvdb, unsigned int flags);
 hse_err_t
 hse_kvdb_compact_status_get(struct hse_kvdb *kvdb, struct hse_kvdb_compact_status *status);
 
+/** @struct hse_kvdb_snapshot
+ * @brief Opaque structure, a pointer to which is a handle to a read-only
+ * snapshot of a KVDB.
+ */
+struct hse_kvdb_snapshot;
+
+/** @brief Create a read-only snapshot of a KVDB.
+ *
+ * A snapshot pins a consistent view of every KVS in the KVDB without any of
+ * the write machinery of a transaction (no key locks, no commit processing).
+ * Gets and cursors that use the snapshot observe exactly the mutations that
+ * were committed before the snapshot was created.
+ *
+ * A snapshot holds back the garbage collection of older key versions, so
+ * it should be destroyed as soon as it is no longer needed.
+ *
+ * @note This function is thread safe.
+ *
+ * @param kvdb: KVDB handle from hse_kvdb_open().
+ * @param[out] snap: Snapshot handle.
+ *
+ * @remark @p kvdb must not be NULL.
+ * @remark @p snap must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvdb_snapshot_create(struct hse_kvdb *kvdb, struct hse_kvdb_snapshot **snap);
+
+/** @brief Destroy a read-only snapshot.
+ *
+ * Cursors created from the snapshot remain valid after the snapshot is
+ * destroyed.
+ *
+ * @note This function is thread safe with respect to other snapshots.
+ *
+ * @param kvdb: KVDB handle from hse_kvdb_open().
+ * @param snap: Snapshot handle from hse_kvdb_snapshot_create().
+ *
+ * @remark @p kvdb must not be NULL.
+ * @remark @p snap must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvdb_snapshot_destroy(struct hse_kvdb *kvdb, struct hse_kvdb_snapshot *snap);
+
 /**@} KVDB */
 
 /** @addtogroup KVS Key-Value Store (KVS)
@@ -149,6 +202,398 @@ hse_kvs_prefix_probe(
     size_t                      valbuf_sz,
     size_t *                    val_len);
 
+/** @brief Count the keys within a range of keys.
+ *
+ * Counts every key @p k such that @p start <= @p k < @p end, as seen by
+ * @p txn if given.
+ *
+ * By default the count is exact. It is obtained by walking the range with
+ * a cursor created with HSE_CURSOR_CREATE_KEYS_ONLY, which resolves keys
+ * and value lengths from key metadata alone and never reads values. Such a
+ * cursor may also be created directly by hse_kvs_cursor_create(), in which
+ * case hse_kvs_cursor_read() returns a NULL value pointer with the
+ * value's length, and hse_kvs_cursor_read_copy() copies nothing into
+ * @p valbuf.
+ *
+ * With HSE_KVS_RANGE_COUNT_EST the count is instead estimated from the
+ * key counts recorded in each kblock overlapping the range, scaled by the
+ * fraction of each edge kblock's leaves that the range spans and corrected
+ * for duplicate keys across kvsets by each cN node's HyperLogLog. No key is
+ * read, so the estimate takes time proportional to the number of kblocks
+ * rather than to the number of keys. It reflects only data that has been
+ * ingested into cN and ignores @p txn.
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg HSE_KVS_RANGE_COUNT_EST - Estimate the count from kblock metadata.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param txn: Transaction context (optional).
+ * @param start: First key of the range (inclusive).
+ * @param start_len: Length of @p start.
+ * @param end: Last key of the range (exclusive).
+ * @param end_len: Length of @p end.
+ * @param[out] count: Number of keys in the range.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p start and @p end must not be NULL.
+ * @remark @p start must not sort after @p end.
+ * @remark @p count must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_range_count(
+    struct hse_kvs *     kvs,
+    unsigned int         flags,
+    struct hse_kvdb_txn *txn,
+    const void *         start,
+    size_t               start_len,
+    const void *         end,
+    size_t               end_len,
+    uint64_t *           count);
+
+/** @struct hse_kvs_value_ref
+ * @brief Opaque structure, a pointer to which is a handle to a value returned
+ * by hse_kvs_get_ref().
+ */
+struct hse_kvs_value_ref;
+
+/** @brief Retrieve a reference to the value for a given key.
+ *
+ * Equivalent to hse_kvs_get() except that, rather than copying the value
+ * into a caller-supplied buffer, it returns a pointer to the value that
+ * remains valid until hse_kvs_get_ref_release() is called on @p ref.
+ * Wherever possible the pointer refers to the value in place (in the
+ * in-memory index or in the memory-mapped media), so no copy is made.
+ * Values that must be transformed, such as compressed values, are copied
+ * into memory owned by @p ref.
+ *
+ * A reference pins the storage that holds the value, so references should
+ * be released promptly.
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg 0 - Reserved for future use.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param txn: Transaction context (optional).
+ * @param key: Key to get from @p kvs.
+ * @param key_len: Length of @p key.
+ * @param[out] found: Whether or not @p key was found.
+ * @param[out] val: Value associated with @p key, valid only if found.
+ * @param[out] val_len: Length of @p val.
+ * @param[out] ref: Reference to release with hse_kvs_get_ref_release(),
+ * set only if @p key was found.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p key must not be NULL.
+ * @remark @p found, @p val, @p val_len and @p ref must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_get_ref(
+    struct hse_kvs *            kvs,
+    unsigned int                flags,
+    struct hse_kvdb_txn *       txn,
+    const void *                key,
+    size_t                      key_len,
+    bool *                      found,
+    const void **               val,
+    size_t *                    val_len,
+    struct hse_kvs_value_ref ** ref);
+
+/** @brief Release a value reference obtained from hse_kvs_get_ref().
+ *
+ * @note This function is thread safe.
+ *
+ * @param ref: Reference from hse_kvs_get_ref() (may be NULL).
+ */
+void
+hse_kvs_get_ref_release(struct hse_kvs_value_ref *ref);
+
+/** @brief Retrieve the value for a given key as of a snapshot.
+ *
+ * Identical to hse_kvs_get() except that the lookup is performed against the
+ * view pinned by @p snap rather than the current view.
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg 0 - Reserved for future use.
+ *
+ * @param kvs: KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param snap: Snapshot handle from hse_kvdb_snapshot_create().
+ * @param key: Key to get from @p kvs.
+ * @param key_len: Length of @p key.
+ * @param[out] found: Whether or not @p key was found.
+ * @param valbuf: Buffer into which the value associated with @p key will be
+ * copied (optional).
+ * @param valbuf_sz: Size of @p valbuf.
+ * @param[out] val_len: Actual length of value if @p key was found.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p snap must not be NULL.
+ * @remark @p key must not be NULL.
+ * @remark @p found must not be NULL.
+ * @remark @p val_len must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_snapshot_get(
+    struct hse_kvs *          kvs,
+    unsigned int              flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              key,
+    size_t                    key_len,
+    bool *                    found,
+    void *                    valbuf,
+    size_t                    valbuf_sz,
+    size_t *                  val_len);
+
+/** @brief Create a cursor over the view pinned by a snapshot.
+ *
+ * Identical to hse_kvs_cursor_create() except that the cursor's view is
+ * that of @p snap. The view of such a cursor cannot be updated with
+ * hse_kvs_cursor_update_view().
+ *
+ * @note This function is thread safe.
+ *
+ * <b>Flags:</b>
+ * @arg HSE_CURSOR_CREATE_REV - Iterate in reverse lexicographical order.
+ * @arg HSE_CURSOR_CREATE_KEYS_ONLY - Iterate over keys only (see
+ * hse_kvs_range_count()).
+ *
+ * @param kvs: KVS to iterate over, handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param snap: Snapshot handle from hse_kvdb_snapshot_create().
+ * @param filter: Iteration limited to keys matching this prefix filter
+ * (optional).
+ * @param filter_len: Length of @p filter (optional).
+ * @param[out] cursor: Cursor handle.
+ *
+ * @remark @p kvs must not be NULL.
+ * @remark @p snap must not be NULL.
+ * @remark @p cursor must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_snapshot_cursor_create(
+    struct hse_kvs *          kvs,
+    unsigned int              flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              filter,
+    size_t                    filter_len,
+    struct hse_kvs_cursor **  cursor);
+
+/** @brief Maximum number of fields in a cursor filter. */
+#define HSE_KVS_CURSOR_FILTER_FIELDS_MAX 4
+
+/** @brief Bounds on a fixed-offset field of a key. */
+struct hse_kvs_cursor_filter_field {
+    size_t      kvcf_off; /**< byte offset of the field within the key. */
+    size_t      kvcf_len; /**< length of the field in bytes. */
+    const void *kvcf_min; /**< inclusive lower bound of @p kvcf_len bytes (optional). */
+    const void *kvcf_max; /**< inclusive upper bound of @p kvcf_len bytes (optional). */
+};
+
+/** @brief Key predicate evaluated beneath a cursor. */
+struct hse_kvs_cursor_filter {
+    const void *kvcf_sfx_mask;  /**< mask of @p kvcf_sfx_len bytes (optional). */
+    const void *kvcf_sfx_match; /**< required value of the masked key suffix. */
+    size_t      kvcf_sfx_len;   /**< length of the key suffix to match (zero if none). */
+    unsigned int kvcf_fieldc;   /**< number of entries in @p kvcf_fieldv. */
+    struct hse_kvs_cursor_filter_field kvcf_fieldv[HSE_KVS_CURSOR_FILTER_FIELDS_MAX];
+    bool (*kvcf_cb)(void *arg, const void *key, size_t key_len); /**< callback (optional). */
+    void *kvcf_cb_arg;          /**< argument passed to @p kvcf_cb. */
+};
+
+/** @brief Install a key filter on a cursor.
+ *
+ * Restricts the keys returned by hse_kvs_cursor_read() to those matching
+ * every part of @p filter. The filter is evaluated by each of the in-memory
+ * and on-media sources beneath the cursor as keys are produced, so keys it
+ * rejects are neither merged, nor compared against other sources, nor have
+ * their values read.
+ *
+ * A key matches if:
+ * - its last @p kvcf_sfx_len bytes, masked by @p kvcf_sfx_mask (all ones
+ *   if NULL), equal @p kvcf_sfx_match likewise masked,
+ * - for each field, the @p kvcf_len bytes at @p kvcf_off lie within
+ *   [@p kvcf_min, @p kvcf_max] in lexicographic order, and
+ * - @p kvcf_cb, if given, returns true.
+ *
+ * A key too short to contain the suffix or any field does not match.
+ * Filters consider keys only, never values, so that all versions and
+ * tombstones of a key are treated alike. The callback may be called on
+ * the same key more than once and from the thread calling
+ * hse_kvs_cursor_read() or hse_kvs_cursor_seek(); it must not call back
+ * into HSE.
+ *
+ * The filter's byte strings are copied, so they need not outlive this
+ * call. Installing or removing a filter repositions the cursor to the
+ * start of its range.
+ *
+ * @note This function is not thread safe with respect to @p cursor.
+ *
+ * @param cursor: Cursor handle from hse_kvs_cursor_create().
+ * @param flags: Flags for operation specialization (reserved, must be zero).
+ * @param filter: Key filter, or NULL to remove the current filter.
+ *
+ * @remark @p cursor must not be NULL.
+ * @remark @p kvcf_sfx_match must not be NULL if @p kvcf_sfx_len is nonzero.
+ * @remark @p kvcf_sfx_len must not exceed HSE_KVS_KEY_LEN_MAX.
+ * @remark @p kvcf_fieldc must not exceed HSE_KVS_CURSOR_FILTER_FIELDS_MAX.
+ * @remark Each field must be nonempty and lie within HSE_KVS_KEY_LEN_MAX bytes.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_cursor_filter_set(
+    struct hse_kvs_cursor *             cursor,
+    unsigned int                        flags,
+    const struct hse_kvs_cursor_filter *filter);
+
+/** @struct hse_kvs_batch
+ * @brief Opaque structure, a pointer to which is a handle to a write batch.
+ */
+struct hse_kvs_batch;
+
+/** @brief Create an empty write batch.
+ *
+ * A write batch accumulates put and delete operations, on any number of
+ * non-transactional KVSs within a KVDB, which hse_kvs_batch_commit() then
+ * applies atomically: readers observe either none or all of them, and after
+ * a crash either none or all of them are recovered.
+ *
+ * Unlike a transaction, a batch acquires no key locks and hence performs no
+ * write conflict detection. Concurrent writes to the same key are ordered
+ * as for hse_kvs_put(), last writer wins.
+ *
+ * Committing a batch inserts its operations into memory in key order, a
+ * run of keys at a time, which costs less per operation than issuing them
+ * with hse_kvs_put() and hse_kvs_delete(). Operations issued outside a
+ * batch are not staged or reordered.
+ *
+ * A batch must be destroyed before its KVDB is closed.
+ *
+ * @note This function is thread safe.
+ *
+ * @param kvdb: KVDB handle from hse_kvdb_open().
+ * @param[out] batch: Batch handle.
+ *
+ * @remark @p kvdb must not be NULL.
+ * @remark @p batch must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_batch_create(struct hse_kvdb *kvdb, struct hse_kvs_batch **batch);
+
+/** @brief Destroy a write batch, discarding any operations not yet committed.
+ *
+ * @note This function is not thread safe with respect to @p batch.
+ *
+ * @param batch: Batch handle from hse_kvs_batch_create() (may be NULL).
+ */
+void
+hse_kvs_batch_destroy(struct hse_kvs_batch *batch);
+
+/** @brief Append a put operation to a write batch.
+ *
+ * The key and value are copied into the batch, the caller's buffers may be
+ * reused once this function returns.
+ *
+ * <b>Flags:</b>
+ * @arg HSE_KVS_PUT_VCOMP_OFF - Guaranteed not to compress the value.
+ *
+ * @note This function is not thread safe with respect to @p batch.
+ *
+ * @param batch: Batch handle from hse_kvs_batch_create().
+ * @param kvs: Non-transactional KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization.
+ * @param key: Key to put into @p kvs.
+ * @param key_len: Length of @p key.
+ * @param val: Value associated with @p key (may be NULL if @p val_len is 0).
+ * @param val_len: Length of @p val.
+ *
+ * @remark @p batch must not be NULL.
+ * @remark @p kvs must belong to the batch's KVDB.
+ * @remark @p key must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_batch_put(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs *      kvs,
+    unsigned int          flags,
+    const void *          key,
+    size_t                key_len,
+    const void *          val,
+    size_t                val_len);
+
+/** @brief Append a delete operation to a write batch.
+ *
+ * @note This function is not thread safe with respect to @p batch.
+ *
+ * @param batch: Batch handle from hse_kvs_batch_create().
+ * @param kvs: Non-transactional KVS handle from hse_kvdb_kvs_open().
+ * @param flags: Flags for operation specialization (must be 0).
+ * @param key: Key to delete from @p kvs.
+ * @param key_len: Length of @p key.
+ *
+ * @remark @p batch must not be NULL.
+ * @remark @p kvs must belong to the batch's KVDB.
+ * @remark @p key must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_batch_delete(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs *      kvs,
+    unsigned int          flags,
+    const void *          key,
+    size_t                key_len);
+
+/** @brief Atomically apply all the operations in a write batch.
+ *
+ * The operations are applied in the order they were appended, as one
+ * write-ahead log record group sharing a single sequence number. On
+ * success the batch is emptied and may be reused. On failure none of
+ * the operations have been applied and the batch is left unchanged.
+ *
+ * @note This function is not thread safe with respect to @p batch.
+ *
+ * @param batch: Batch handle from hse_kvs_batch_create().
+ *
+ * @remark @p batch must not be NULL.
+ *
+ * @returns Error status.
+ */
+hse_err_t
+hse_kvs_batch_commit(struct hse_kvs_batch *batch);
+
+/** @brief Discard all the operations in a write batch.
+ *
+ * @note This function is not thread safe with respect to @p batch.
+ *
+ * @param batch: Batch handle from hse_kvs_batch_create().
+ *
+ * @remark @p batch must not be NULL.
+ */
+void
+hse_kvs_batch_reset(struct hse_kvs_batch *batch);
+
 /**@} KVS */
 
 #pragma GCC visibility pop
@@ -25,6 +25,12 @@ enum kvdb_perfc_sidx_kvdbop {
     PERFC_RA_KVDBOP_KVDB_TXN_FREE,
     PERFC_RA_KVDBOP_KVDB_TXN_GET_STATE,
 
+    PERFC_RA_KVDBOP_KVDB_SNAPSHOT_CREATE,
+    PERFC_RA_KVDBOP_KVDB_SNAPSHOT_DESTROY,
+
+    PERFC_RA_KVDBOP_KVS_BATCH_COMMIT,
+    PERFC_RA_KVDBOP_KVS_BATCH_OPS,
+
     PERFC_RA_KVDBOP_KVS_CURSOR_CREATE,
     PERFC_RA_KVDBOP_KVS_CURSOR_UPDATE,
     PERFC_RA_KVDBOP_KVS_CURSOR_SEEK,
@@ -37,6 +43,8 @@ enum kvdb_perfc_sidx_kvdbop {
     PERFC_RA_KVDBOP_KVS_PFX_DEL,
     PERFC_RA_KVDBOP_KVS_PFX_DELB,
 
+    PERFC_RA_KVDBOP_KVS_RANGE_COUNT,
+
     PERFC_RA_KVDBOP_KVS_PFXPROBE,
 
     PERFC_RA_KVDBOP_KVDB_SYNC,
@@ -60,6 +68,8 @@ enum kvdb_perfc_sidx_c0skop {
     PERFC_LT_C0SKOP_PUT,
     PERFC_RA_C0SKOP_DEL,
     PERFC_LT_C0SKOP_DEL,
+    PERFC_RA_C0SKOP_XNODE,
+    PERFC_RA_C0SKOP_BATCH,
     PERFC_EN_C0SKOP
 };
 
@@ -128,6 +138,8 @@ enum kvdb_perfc_sidx_kvdb_metrics {
     PERFC_BA_KVDBMETRICS_CURCNT,
     PERFC_RA_KVDBMETRICS_CURRETIRED,
     PERFC_RA_KVDBMETRICS_CUREVICTED,
+    PERFC_BA_KVDBMETRICS_SNAPCNT,
+    PERFC_BA_KVDBMETRICS_SNAPAGE,
     PERFC_DI_KVDBMETRICS_THROTTLE,
     PERFC_EN_KVDBMETRICS
 };
@@ -143,6 +155,18 @@ enum kvdb_perfc_sidx_api_throttle {
 
 enum kvdb_perfc_sidx_throttle_sleep { PERFC_BA_THR_SVAL, PERFC_EN_THR_MAX };
 
+enum kvdb_perfc_sidx_throttle_pred {
+    PERFC_BA_THRP_KVSETS,
+    PERFC_BA_THRP_KVSETS_HWM,
+    PERFC_BA_THRP_DEBT,
+    PERFC_BA_THRP_DRAIN,
+    PERFC_BA_THRP_TARGET,
+    PERFC_BA_THRP_RATE,
+    PERFC_BA_THRP_HORIZON,
+    PERFC_BA_THRP_SLOW,
+    PERFC_EN_THRP
+};
+
 enum kvdb_perfc_compact {
     PERFC_BA_CNCOMP_START,
     PERFC_BA_CNCOMP_FINISH,
@@ -153,7 +177,7 @@ enum kvdb_perfc_compact {
     PERFC_DI_CNCOMP_VBCNT,
     PERFC_DI_CNCOMP_VBUTIL,
     PERFC_DI_CNCOMP_VBDEAD,
-    PERFC_LT_CNCOMP_TOTAL,
+    PERFC_HG_CNCOMP_TOTAL,
     PERFC_DI_CNCOMP_VGET,
     PERFC_EN_CNCOMP
 };
@@ -176,6 +200,17 @@ enum kvdb_perfc_cncapped {
     PERFC_EN_CNCAPPED
 };
 
+enum kvdb_perfc_cnpin {
+    PERFC_BA_CNPIN_RESIDENT,
+    PERFC_BA_CNPIN_LIVE,
+    PERFC_BA_CNPIN_CHUNKS,
+    PERFC_BA_CNPIN_HUGE,
+    PERFC_BA_CNPIN_ALLOCS,
+    PERFC_BA_CNPIN_FAILS,
+    PERFC_BA_CNPIN_EVICTS,
+    PERFC_EN_CNPIN
+};
+
 enum kvdb_perfc_sidx_cursorcache {
     PERFC_RA_CC_HIT,
     PERFC_RA_CC_MISS,
@@ -193,12 +228,12 @@ enum kvdb_perfc_sidx_cursorcache {
 };
 
 enum kvdb_perfc_sidx_cursordist {
-    PERFC_LT_CD_SAVE,
-    PERFC_LT_CD_RESTORE,
-    PERFC_LT_CD_CREATE_CN,
-    PERFC_LT_CD_UPDATE_CN,
-    PERFC_LT_CD_CREATE_C0,
-    PERFC_LT_CD_UPDATE_C0,
+    PERFC_HG_CD_SAVE,
+    PERFC_HG_CD_RESTORE,
+    PERFC_HG_CD_CREATE_CN,
+    PERFC_HG_CD_UPDATE_CN,
+    PERFC_HG_CD_CREATE_C0,
+    PERFC_HG_CD_UPDATE_C0,
     PERFC_DI_CD_READPERSEEK,
     PERFC_DI_CD_TOMBSPERPROBE,
     PERFC_DI_CD_ACTIVEKVSETS_CN,
@@ -207,20 +242,20 @@ enum kvdb_perfc_sidx_cursordist {
 
 /* "PKVSL" stands for Public KVS interface Latencies" */
 enum kvdb_perfc_sidx_pkvsl {
-    PERFC_LT_PKVSL_KVS_CURSOR_CREATE,
-    PERFC_LT_PKVSL_KVS_CURSOR_UPDATE,
-    PERFC_LT_PKVSL_KVS_CURSOR_DESTROY,
-    PERFC_LT_PKVSL_KVS_CURSOR_FULL,
-    PERFC_LT_PKVSL_KVS_CURSOR_INIT,
-    PERFC_LT_PKVSL_KVS_CURSOR_SEEK,
-    PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
-    PERFC_LT_PKVSL_KVS_CURSOR_READREV,
-
-    PERFC_LT_PKVSL_KVS_PUT,
-    PERFC_LT_PKVSL_KVS_GET,
-    PERFC_LT_PKVSL_KVS_DEL,
-    PERFC_LT_PKVSL_KVS_PFX_PROBE,
-    PERFC_LT_PKVSL_KVS_PFX_DEL,
+    PERFC_HG_PKVSL_KVS_CURSOR_CREATE,
+    PERFC_HG_PKVSL_KVS_CURSOR_UPDATE,
+    PERFC_HG_PKVSL_KVS_CURSOR_DESTROY,
+    PERFC_HG_PKVSL_KVS_CURSOR_FULL,
+    PERFC_HG_PKVSL_KVS_CURSOR_INIT,
+    PERFC_HG_PKVSL_KVS_CURSOR_SEEK,
+    PERFC_HG_PKVSL_KVS_CURSOR_READFWD,
+    PERFC_HG_PKVSL_KVS_CURSOR_READREV,
+
+    PERFC_HG_PKVSL_KVS_PUT,
+    PERFC_HG_PKVSL_KVS_GET,
+    PERFC_HG_PKVSL_KVS_DEL,
+    PERFC_HG_PKVSL_KVS_PFX_PROBE,
+    PERFC_HG_PKVSL_KVS_PFX_DEL,
 
     PERFC_EN_PKVSL
 };
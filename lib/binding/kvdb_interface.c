@@ -36,10 +36,11 @@
 
 /* clang-format off */
 
-#define HSE_KVDB_COMPACT_MASK  (HSE_KVDB_COMPACT_CANCEL | HSE_KVDB_COMPACT_SAMP_LWM)
-#define HSE_KVDB_SYNC_MASK     (HSE_KVDB_SYNC_ASYNC)
-#define HSE_KVS_PUT_MASK       (HSE_KVS_PUT_PRIO | HSE_KVS_PUT_VCOMP_OFF)
-#define HSE_CURSOR_CREATE_MASK (HSE_CURSOR_CREATE_REV)
+#define HSE_KVDB_COMPACT_MASK    (HSE_KVDB_COMPACT_CANCEL | HSE_KVDB_COMPACT_SAMP_LWM)
+#define HSE_KVDB_SYNC_MASK       (HSE_KVDB_SYNC_ASYNC)
+#define HSE_KVS_PUT_MASK         (HSE_KVS_PUT_PRIO | HSE_KVS_PUT_VCOMP_OFF)
+#define HSE_CURSOR_CREATE_MASK   (HSE_CURSOR_CREATE_REV | HSE_CURSOR_CREATE_KEYS_ONLY)
+#define HSE_KVS_RANGE_COUNT_MASK (HSE_KVS_RANGE_COUNT_EST)
 
 /* clang-format on */
 
@@ -910,6 +911,107 @@ hse_kvs_get(
     return 0;
 }
 
+/* A value returned by hse_kvs_get_ref() is either pinned in place (vr_pin)
+ * or, if it could not be pinned, copied into vr_buf.
+ */
+struct hse_kvs_value_ref {
+    struct kvs_vpin vr_pin;
+    void *          vr_buf;
+};
+
+hse_err_t
+hse_kvs_get_ref(
+    struct hse_kvs *            handle,
+    const unsigned int          flags,
+    struct hse_kvdb_txn *const  txn,
+    const void *                key,
+    size_t                      key_len,
+    bool *                      found,
+    const void **               val,
+    size_t *                    val_len,
+    struct hse_kvs_value_ref ** refp)
+{
+    struct hse_kvs_value_ref *ref;
+    struct kvs_ktuple         kt;
+    struct kvs_buf            vbuf;
+    enum key_lookup_res       res;
+    merr_t                    err;
+
+    if (HSE_UNLIKELY(!handle || !key || !found || !val || !val_len || !refp || flags != 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(key_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(key_len == 0))
+        return merr(ENOENT);
+
+    *found = false;
+    *refp = NULL;
+    *val = NULL;
+    *val_len = 0;
+
+    ref = calloc(1, sizeof(*ref));
+    if (ev(!ref))
+        return merr(ENOMEM);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+
+    /* See hse_kvs_get() for why the buffer is (void *)-1.
+     */
+    kvs_buf_init(&vbuf, (void *)-1, 0);
+    vbuf.b_pin = &ref->vr_pin;
+
+    err = ikvdb_kvs_get(handle, flags, txn, &kt, &res, &vbuf);
+
+    /* Values that could not be pinned (e.g., compressed values) are looked
+     * up again, this time into a buffer large enough to hold them.  Repeat
+     * if the value grew in the meantime.
+     */
+    while (!err && res == FOUND_VAL && !ref->vr_pin.vp_data && vbuf.b_len > vbuf.b_buf_sz) {
+        uint32_t len = vbuf.b_len;
+
+        free(ref->vr_buf);
+        ref->vr_buf = malloc(len);
+        if (ev(!ref->vr_buf)) {
+            err = merr(ENOMEM);
+            break;
+        }
+
+        kvs_buf_init(&vbuf, ref->vr_buf, len);
+
+        err = ikvdb_kvs_get(handle, flags, txn, &kt, &res, &vbuf);
+    }
+
+    if (!err && res == FOUND_MULTIPLE)
+        err = merr(EPROTO);
+
+    if (ev(err) || res != FOUND_VAL) {
+        hse_kvs_get_ref_release(ref);
+        return err;
+    }
+
+    *found = true;
+    *val = ref->vr_pin.vp_data ?: ref->vr_buf;
+    *val_len = vbuf.b_len;
+    *refp = ref;
+
+    PERFC_INCADD_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_GET, PERFC_RA_KVDBOP_KVS_GETB, *val_len);
+
+    return 0;
+}
+
+void
+hse_kvs_get_ref_release(struct hse_kvs_value_ref *ref)
+{
+    if (!ref)
+        return;
+
+    kvs_vpin_release(&ref->vr_pin);
+    free(ref->vr_buf);
+    free(ref);
+}
+
 /**
  * hse_kvs_delete() - remove the supplied key and associated value from the KVS
  */
@@ -1056,6 +1158,41 @@ hse_kvs_prefix_delete(
     return err;
 }
 
+hse_err_t
+hse_kvs_range_count(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               start,
+    size_t                     start_len,
+    const void *               end,
+    size_t                     end_len,
+    uint64_t *                 count)
+{
+    merr_t            err;
+    struct kvs_ktuple skt, ekt;
+
+    if (HSE_UNLIKELY(!handle || !start || !end || !count || flags & ~HSE_KVS_RANGE_COUNT_MASK))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(start_len > HSE_KVS_KEY_LEN_MAX || end_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(start_len == 0 || end_len == 0))
+        return merr(ENOENT);
+
+    kvs_ktuple_init_nohash(&skt, start, start_len);
+    kvs_ktuple_init_nohash(&ekt, end, end_len);
+
+    err = ikvdb_kvs_range_count(handle, flags, txn, &skt, &ekt, count);
+    ev(err);
+
+    if (!err)
+        PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_RANGE_COUNT);
+
+    return err;
+}
+
 hse_err_t
 hse_kvdb_sync(struct hse_kvdb *handle, const unsigned int flags)
 {
@@ -1256,6 +1393,43 @@ hse_kvs_cursor_update_view(struct hse_kvs_cursor *cursor, const unsigned int fla
     return err;
 }
 
+hse_err_t
+hse_kvs_cursor_filter_set(
+    struct hse_kvs_cursor *             cursor,
+    const unsigned int                  flags,
+    const struct hse_kvs_cursor_filter *filter)
+{
+    merr_t err;
+    uint   i;
+
+    if (HSE_UNLIKELY(!cursor || flags != 0))
+        return merr(EINVAL);
+
+    if (filter) {
+        if (ev(filter->kvcf_sfx_len > HSE_KVS_KEY_LEN_MAX))
+            return merr(EINVAL);
+
+        if (ev(filter->kvcf_sfx_len > 0 && !filter->kvcf_sfx_match))
+            return merr(EINVAL);
+
+        if (ev(filter->kvcf_fieldc > HSE_KVS_CURSOR_FILTER_FIELDS_MAX))
+            return merr(EINVAL);
+
+        for (i = 0; i < filter->kvcf_fieldc; ++i) {
+            const struct hse_kvs_cursor_filter_field *f = filter->kvcf_fieldv + i;
+
+            if (ev(f->kvcf_len == 0 || f->kvcf_len > HSE_KVS_KEY_LEN_MAX ||
+                   f->kvcf_off > HSE_KVS_KEY_LEN_MAX - f->kvcf_len))
+                return merr(EINVAL);
+        }
+    }
+
+    err = ikvdb_kvs_cursor_filter_set(cursor, flags, filter);
+    ev(err);
+
+    return err;
+}
+
 hse_err_t
 hse_kvs_cursor_seek(
     struct hse_kvs_cursor *cursor,
@@ -1425,6 +1599,223 @@ hse_kvdb_compact_status_get(struct hse_kvdb *handle, struct hse_kvdb_compact_sta
     return 0;
 }
 
+hse_err_t
+hse_kvdb_snapshot_create(struct hse_kvdb *handle, struct hse_kvdb_snapshot **snap)
+{
+    merr_t err;
+
+    if (HSE_UNLIKELY(!handle || !snap))
+        return merr(EINVAL);
+
+    PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVDB_SNAPSHOT_CREATE);
+
+    err = ikvdb_snapshot_create((struct ikvdb *)handle, snap);
+    ev(err);
+
+    return err;
+}
+
+hse_err_t
+hse_kvdb_snapshot_destroy(struct hse_kvdb *handle, struct hse_kvdb_snapshot *snap)
+{
+    merr_t err;
+
+    if (HSE_UNLIKELY(!handle || !snap))
+        return merr(EINVAL);
+
+    PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVDB_SNAPSHOT_DESTROY);
+
+    err = ikvdb_snapshot_destroy((struct ikvdb *)handle, snap);
+    ev(err);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_snapshot_get(
+    struct hse_kvs *          handle,
+    const unsigned int        flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              key,
+    size_t                    key_len,
+    bool *                    found,
+    void *                    valbuf,
+    size_t                    valbuf_sz,
+    size_t *                  val_len)
+{
+    struct kvs_ktuple   kt;
+    struct kvs_buf      vbuf;
+    enum key_lookup_res res;
+    merr_t              err;
+
+    if (HSE_UNLIKELY(!handle || !snap || !key || !found || !val_len || flags != 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(!valbuf && valbuf_sz > 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(key_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(key_len == 0))
+        return merr(ENOENT);
+
+    /* See hse_kvs_get() for the meaning of a NULL valbuf. */
+    if (!valbuf && valbuf_sz == 0)
+        valbuf = (void *)-1;
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+    kvs_buf_init(&vbuf, valbuf, valbuf_sz);
+
+    err = ikvdb_kvs_snapshot_get(handle, flags, snap, &kt, &res, &vbuf);
+    if (ev(err))
+        return err;
+
+    *found = (res == FOUND_VAL);
+    *val_len = vbuf.b_len;
+
+    if (ev(res == FOUND_MULTIPLE))
+        return merr(EPROTO);
+
+    PERFC_INCADD_RU(
+        &kvdb_pc, PERFC_RA_KVDBOP_KVS_GET, PERFC_RA_KVDBOP_KVS_GETB, *found ? *val_len : 0);
+
+    return 0;
+}
+
+hse_err_t
+hse_kvs_snapshot_cursor_create(
+    struct hse_kvs *          handle,
+    const unsigned int        flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              prefix,
+    size_t                    pfx_len,
+    struct hse_kvs_cursor **  cursor)
+{
+    merr_t err;
+
+    if (HSE_UNLIKELY(!handle || !snap || !cursor || (pfx_len && !prefix) ||
+                     flags & ~HSE_CURSOR_CREATE_MASK))
+        return merr(EINVAL);
+
+    PERFC_INC_RU(&kvdb_pc, PERFC_RA_KVDBOP_KVS_CURSOR_CREATE);
+
+    err = ikvdb_kvs_snapshot_cursor_create(handle, flags, snap, prefix, pfx_len, cursor);
+    ev(err);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_batch_create(struct hse_kvdb *handle, struct hse_kvs_batch **batch)
+{
+    merr_t err;
+
+    if (HSE_UNLIKELY(!handle || !batch))
+        return merr(EINVAL);
+
+    err = ikvdb_kvs_batch_create((struct ikvdb *)handle, batch);
+    ev(err);
+
+    return err;
+}
+
+void
+hse_kvs_batch_destroy(struct hse_kvs_batch *batch)
+{
+    ikvdb_kvs_batch_destroy(batch);
+}
+
+hse_err_t
+hse_kvs_batch_put(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs *      handle,
+    const unsigned int    flags,
+    const void *          key,
+    size_t                key_len,
+    const void *          val,
+    size_t                val_len)
+{
+    struct kvs_ktuple kt;
+    struct kvs_vtuple vt;
+    merr_t            err;
+
+    if (HSE_UNLIKELY(!batch || !handle || !key || (val_len > 0 && !val) ||
+                     flags & ~HSE_KVS_PUT_VCOMP_OFF))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(key_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(key_len == 0))
+        return merr(ENOENT);
+
+    if (HSE_UNLIKELY(val_len > HSE_KVS_VALUE_LEN_MAX))
+        return merr(EMSGSIZE);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+    kvs_vtuple_init(&vt, (void *)val, val_len);
+
+    err = ikvdb_kvs_batch_put(batch, handle, flags, &kt, &vt);
+    ev(err);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_batch_delete(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs *      handle,
+    const unsigned int    flags,
+    const void *          key,
+    size_t                key_len)
+{
+    struct kvs_ktuple kt;
+    merr_t            err;
+
+    if (HSE_UNLIKELY(!batch || !handle || !key || flags != 0))
+        return merr(EINVAL);
+
+    if (HSE_UNLIKELY(key_len > HSE_KVS_KEY_LEN_MAX))
+        return merr(ENAMETOOLONG);
+
+    if (HSE_UNLIKELY(key_len == 0))
+        return merr(ENOENT);
+
+    kvs_ktuple_init_nohash(&kt, key, key_len);
+
+    err = ikvdb_kvs_batch_del(batch, handle, flags, &kt);
+    ev(err);
+
+    return err;
+}
+
+hse_err_t
+hse_kvs_batch_commit(struct hse_kvs_batch *batch)
+{
+    unsigned int opc;
+    merr_t       err;
+
+    if (HSE_UNLIKELY(!batch))
+        return merr(EINVAL);
+
+    err = ikvdb_kvs_batch_commit(batch, &opc);
+    ev(err);
+
+    if (!err && opc > 0)
+        PERFC_INCADD_RU(
+            &kvdb_pc, PERFC_RA_KVDBOP_KVS_BATCH_COMMIT, PERFC_RA_KVDBOP_KVS_BATCH_OPS, opc);
+
+    return err;
+}
+
+void
+hse_kvs_batch_reset(struct hse_kvs_batch *batch)
+{
+    if (batch)
+        ikvdb_kvs_batch_reset(batch);
+}
+
 size_t
 hse_strerror(hse_err_t err, char *buf, size_t buf_sz)
 {
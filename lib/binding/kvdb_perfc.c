@@ -21,6 +21,7 @@ struct perfc_name kvdb_perfc_op[] _dt_section = {
     NE(PERFC_RA_KVDBOP_KVS_PFX_DELB,    1, "kvs_pfxdel klen",         "r_kvs_pfxdel_bytes(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFXPROBE,    1, "kvs_prefix_probe rate",   "r_kvs_prefix_probe(/s)"),
     NE(PERFC_RA_KVDBOP_KVS_PFX_DEL,     1, "kvs_prefix_delete rate",  "r_kvs_prefix_delete(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_RANGE_COUNT, 1, "kvs_range_count rate",    "r_kvs_range_count(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_SYNC,       1, "kvdb_sync rate",          "r_kvdb_sync(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_ALLOC,  1, "kvdb_txn_alloc rate",     "r_kvdb_txn_alloc(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_FREE,   1, "kvdb_txn_free rate",      "r_kvdb_txn_free(/s)"),
@@ -49,6 +50,14 @@ struct perfc_name kvdb_perfc_op[] _dt_section = {
     NE(PERFC_RA_KVDBOP_KVDB_KVS_DROP,   3, "kvdb_kvs_drop rate",      "r_kvdb_kvs_drop(/s)"),
     NE(PERFC_RA_KVDBOP_KVDB_TXN_GET_STATE,
        3, "kvdb_txn_get_state rate", "r_kvdb_txn_get_state(/s)"),
+    NE(PERFC_RA_KVDBOP_KVDB_SNAPSHOT_CREATE,
+       1, "kvdb_snapshot_create rate", "r_kvdb_snapshot_create(/s)"),
+    NE(PERFC_RA_KVDBOP_KVDB_SNAPSHOT_DESTROY,
+       1, "kvdb_snapshot_destroy rate", "r_kvdb_snapshot_destroy(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_BATCH_COMMIT,
+       1, "kvs_batch_commit rate", "r_kvs_batch_commit(/s)"),
+    NE(PERFC_RA_KVDBOP_KVS_BATCH_OPS,
+       1, "kvs_batch_commit ops", "r_kvs_batch_ops(/s)"),
 };
 
 NE_CHECK(kvdb_perfc_op, PERFC_EN_KVDBOP, "kvdb_perfc_op table/enum mismatch");
@@ -77,6 +86,8 @@ struct perfc_name kvdb_metrics_perfc[] _dt_section = {
     NE(PERFC_BA_KVDBMETRICS_CURCNT,     0, "Active cursor count",         "c_cur_active"),
     NE(PERFC_RA_KVDBMETRICS_CURRETIRED, 0, "Cached cursor retired rate",  "r_cur_retired(/s)"),
     NE(PERFC_RA_KVDBMETRICS_CUREVICTED, 0, "Cached cursor eviction rate", "r_cur_evicted(/s)"),
+    NE(PERFC_BA_KVDBMETRICS_SNAPCNT,    0, "Active snapshot count",       "c_snap_active"),
+    NE(PERFC_BA_KVDBMETRICS_SNAPAGE,    0, "Oldest snapshot age (ms)",    "snap_oldest_age_ms"),
 
     NE(PERFC_BA_KVDBMETRICS_SEQNO,      3, "Current kvdb seqno",          "c_seqno"),
     NE(PERFC_BA_KVDBMETRICS_CURHORIZON, 3, "Cursor kvdb horizon",         "cur_horizon"),
@@ -119,6 +119,29 @@ c0_del(struct c0 *handle, struct kvs_ktuple *kt, uintptr_t seqnoref)
     return c0sk_del(self->c0_c0sk, self->c0_index, kt, seqnoref);
 }
 
+merr_t
+c0_putdel_batch(struct c0kvs_batch_ent **entv, uint entc, uintptr_t seqnoref)
+{
+    struct c0sk *c0sk;
+    uint         i;
+
+    if (entc == 0)
+        return 0;
+
+    c0sk = c0_h2r(entv[0]->cbe_c0)->c0_c0sk;
+
+    for (i = 0; i < entc; ++i) {
+        struct c0_impl *self = c0_h2r(entv[i]->cbe_c0);
+
+        assert(self->c0_index < HSE_KVS_COUNT_MAX);
+        assert(self->c0_c0sk == c0sk);
+
+        entv[i]->cbe_skidx = self->c0_index;
+    }
+
+    return c0sk_putdel_batch(c0sk, entv, entc, seqnoref);
+}
+
 merr_t
 c0_prefix_del(struct c0 *handle, struct kvs_ktuple *kt, uintptr_t seqnoref)
 {
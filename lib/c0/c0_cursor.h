@@ -30,6 +30,7 @@ struct c0_kvmultiset_cursor {
     const void *          c0mc_pfx;
     size_t                c0mc_pfx_len;
     size_t                c0mc_ct_pfx_len;
+    const struct kc_pred *c0mc_pred;
     /* HSE_REVISIT: split apart like c0_cursor_arrays */
     struct element_source *  c0mc_esrcv[HSE_C0_INGEST_WIDTH_MAX];
     struct c0_kvset_iterator c0mc_iterv[HSE_C0_INGEST_WIDTH_MAX];
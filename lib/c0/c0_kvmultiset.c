@@ -16,6 +16,7 @@
 #include <hse_util/xrand.h>
 #include <hse_util/keycmp.h>
 #include <hse_util/logging.h>
+#include <hse_util/numa.h>
 
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/lc.h>
@@ -114,6 +115,21 @@ c0kvms_get_hashed_c0kvset(struct c0_kvmultiset *handle, u64 hash)
     return self->c0ms_sets[idx + 1]; /* skip ptomb c0kvset at index zero */
 }
 
+void
+c0kvms_numa_bind(struct c0_kvmultiset *handle)
+{
+    struct c0_kvmultiset_impl *self = c0_kvmultiset_h2r(handle);
+    uint                       nodes = hse_numa_nodes();
+    int                        i;
+
+    /* A key must reside in exactly one c0kvset (chosen by hash) no matter
+     * which thread puts it, so rather than partition c0kvsets by node we
+     * spread them over all nodes in order to balance memory traffic.
+     */
+    for (i = 1; i < self->c0ms_num_sets; ++i)
+        c0kvs_numa_bind(self->c0ms_sets[i], (i - 1) % nodes);
+}
+
 void
 c0kvms_finalize(struct c0_kvmultiset *handle, struct workqueue_struct *wq)
 {
@@ -316,6 +332,17 @@ c0kvms_cursor_next(struct element_source *es, void **element)
             kv->bkv_es = es;
             if (es == cur->c0mc_esrcv[0])
                 kv->bkv_flags |= BKV_FLAG_PTOMB;
+
+            /* Keys rejected by the cursor's predicate never reach the
+             * c0 cursor's binheap.  Ptombs must always pass through.
+             */
+            if (cur->c0mc_pred && !(kv->bkv_flags & BKV_FLAG_PTOMB)) {
+                struct key_obj ko;
+
+                key2kobj(&ko, kv->bkv_key, key_imm_klen(&kv->bkv_key_imm));
+                if (!kc_pred_match(cur->c0mc_pred, &ko))
+                    continue;
+            }
             break;
         }
     }
@@ -546,6 +573,7 @@ c0kvms_cursor_create(
     cur->c0mc_pfx = pfx;
     cur->c0mc_pfx_len = pfx_len;
     cur->c0mc_ct_pfx_len = ct_pfx_len;
+    cur->c0mc_pred = NULL;
 
     c0kvms_cursor_discover(cur, self);
 
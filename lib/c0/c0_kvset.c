@@ -10,6 +10,7 @@
 #include <hse_util/bonsai_tree.h>
 #include <hse_util/compression_lz4.h>
 #include <hse_util/event_counter.h>
+#include <hse_util/numa.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/c0_kvset.h>
@@ -466,6 +467,7 @@ c0kvs_create(
 
     set->c0s_alloc_sz = alloc_sz;
     set->c0s_cheap = cheap;
+    set->c0s_node = -1;
     atomic_set(&set->c0s_finalized, 0);
     mutex_init(&set->c0s_mutex);
 
@@ -522,6 +524,31 @@ c0kvs_used(struct c0_kvset *handle)
     return cheap_used(self->c0s_cheap);
 }
 
+void
+c0kvs_numa_bind(struct c0_kvset *handle, uint node)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    struct cheap *cheap = self->c0s_cheap;
+
+    if (self->c0s_node == (int)node)
+        return;
+
+    /* Migrate the pages the cheap has already faulted in (the c0kvset
+     * itself, its bonsai root, and whatever a cached c0kvs retained
+     * across its last reset) so that the entire c0kvs resides on @node.
+     */
+    if (!hse_numa_membind(cheap->mem, ALIGN(cheap->size, PAGE_SIZE), node, true))
+        self->c0s_node = node;
+}
+
+int
+c0kvs_numa_node(struct c0_kvset *handle)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+
+    return self->c0s_node;
+}
+
 void
 c0kvs_reset(struct c0_kvset *handle, size_t sz)
 {
@@ -615,6 +642,50 @@ c0kvs_put(
     return c0kvs_putdel(self, &skey, &sval, &kt->kt_seqno);
 }
 
+merr_t
+c0kvs_putdel_batch(
+    struct c0_kvset         *handle,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref,
+    uint                    *donep)
+{
+    struct c0_kvset_impl *self = c0_kvset_h2r(handle);
+    merr_t                err = 0;
+    uint                  i;
+
+    c0kvs_lock(self);
+    for (i = 0; i < entc; ++i) {
+        struct c0kvs_batch_ent *ent = entv[i];
+        struct kvs_ktuple      *kt = &ent->cbe_kt;
+        struct bonsai_skey      skey;
+        struct bonsai_sval      sval;
+
+        if (ent->cbe_del) {
+            bn_skey_init(kt->kt_data, kt->kt_len, 0, ent->cbe_skidx, &skey);
+            bn_sval_init(HSE_CORE_TOMB_REG, 0, seqnoref, &sval);
+        } else {
+            bn_skey_init(kt->kt_data, kt->kt_len, kt->kt_flags, ent->cbe_skidx, &skey);
+            bn_sval_init(ent->cbe_vt.vt_data, ent->cbe_vt.vt_xlen, seqnoref, &sval);
+        }
+
+        err = bn_insert_or_replace(self->c0s_broot, &skey, &sval);
+        if (err)
+            break;
+
+        kt->kt_seqno = HSE_SQNREF_TO_ORDNL(sval.bsv_seqnoref);
+    }
+    c0kvs_unlock(self);
+
+    /* See c0kvs_putdel().
+     */
+    assert(atomic_read(&self->c0s_finalized) == 0);
+
+    *donep = i;
+
+    return err;
+}
+
 merr_t
 c0kvs_del(struct c0_kvset *handle, u16 skidx, struct kvs_ktuple *key, uintptr_t seqnoref)
 {
@@ -733,6 +804,16 @@ c0kvs_get_excl(
     vbuf->b_len = bonsai_val_vlen(val);
     copylen = vbuf->b_len;
 
+    /* Bonsai values are immutable and live as long as their kvms, so an
+     * uncompressed value can be handed out by reference.  The caller is
+     * responsible for pinning the kvms (see c0sk_get()).
+     */
+    if (vbuf->b_pin && bonsai_val_clen(val) == 0) {
+        vbuf->b_pin->vp_data = val->bv_value;
+        *res = FOUND_VAL;
+        return 0;
+    }
+
     if (copylen > vbuf->b_buf_sz)
         copylen = vbuf->b_buf_sz;
 
@@ -42,6 +42,7 @@ struct c0_kvset_impl {
     u32                   c0s_alloc_sz;
     u32                   c0s_ccache_sz;
     u32                   c0s_reset_sz;
+    int                   c0s_node;
     atomic_int            c0s_finalized;
     struct c0_kvset_impl *c0s_next;
 
@@ -273,6 +273,23 @@ c0sk_del(struct c0sk *handle, u16 skidx, struct kvs_ktuple *kt, uintptr_t seqnor
     return err;
 }
 
+merr_t
+c0sk_putdel_batch(
+    struct c0sk             *handle,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref)
+{
+    struct c0sk_impl *self = c0sk_h2r(handle);
+    merr_t            err;
+
+    err = c0sk_putdelv(self, entv, entc, seqnoref);
+
+    perfc_add(&self->c0sk_pc_op, PERFC_RA_C0SKOP_BATCH, entc);
+
+    return err;
+}
+
 merr_t
 c0sk_prefix_del(struct c0sk *handle, u16 skidx, struct kvs_ktuple *kt, uintptr_t seqnoref)
 {
@@ -281,6 +298,12 @@ c0sk_prefix_del(struct c0sk *handle, u16 skidx, struct kvs_ktuple *kt, uintptr_t
     return c0sk_putdel(self, skidx, C0SK_OP_PREFIX_DEL, kt, NULL, seqnoref);
 }
 
+static void
+c0sk_vpin_release(void *arg)
+{
+    c0kvms_putref(arg);
+}
+
 /*
  * Tombstone indicated by:
  *     return value == 0 && res == FOUND_TOMB
@@ -341,14 +364,23 @@ c0sk_get(
 
         val_seq = HSE_SQNREF_TO_ORDNL(key_seqref);
 
-        if (*res != NOT_FOUND)
+        if (*res != NOT_FOUND) {
+            if (vbuf->b_pin && vbuf->b_pin->vp_data) {
+                c0kvms_getref(c0kvms);
+                vbuf->b_pin->vp_obj = c0kvms;
+                vbuf->b_pin->vp_release = c0sk_vpin_release;
+            }
             break;
+        }
     }
     rcu_read_unlock();
 
     if (pfx_seq > val_seq) {
         *res = FOUND_PTMB;
         vbuf->b_len = 0;
+
+        if (vbuf->b_pin)
+            kvs_vpin_release(vbuf->b_pin);
     }
 
     if (start > 0) {
@@ -497,6 +529,7 @@ c0sk_open(
     }
 
     c0sk->c0sk_ingest_width = kvdb_rp->c0_ingest_width;
+    c0sk->c0sk_numa = kvdb_rp->numa_mode;
 
     if (gen > 0)
         c0kvms_gen_init(gen);
@@ -507,6 +540,9 @@ c0sk_open(
     if (err)
         goto errout;
 
+    if (c0sk->c0sk_numa)
+        c0kvms_numa_bind(c0kvms);
+
     if (!c0sk_install_c0kvms(c0sk, NULL, c0kvms)) {
         assert(0);
         c0kvms_putref(c0kvms); /* release birth reference */
@@ -1084,12 +1120,15 @@ c0sk_cursor_destroy(struct c0_cursor *cur)
 merr_t
 c0sk_cursor_seek(struct c0_cursor *cur, const void *seek, size_t seeklen, struct kc_filter *filter)
 {
+    const struct kc_pred *pred = filter ? filter->kcf_pred : NULL;
     int i;
 
     cur->c0cur_filter = filter;
 
-    for (i = 0; i < cur->c0cur_cnt; i++)
+    for (i = 0; i < cur->c0cur_cnt; i++) {
+        cur->c0cur_curv[i]->c0mc_pred = pred;
         c0kvms_cursor_seek(cur->c0cur_curv[i], seek, seeklen, cur->c0cur_ct_pfx_len);
+    }
 
     bin_heap2_prepare(cur->c0cur_bh, cur->c0cur_cnt, cur->c0cur_esrcv);
     return 0;
@@ -1143,7 +1182,7 @@ c0sk_cursor_read(struct c0_cursor *cur, struct kvs_cursor_element *elem, bool *e
                 continue;
         }
 
-        if (cur->c0cur_filter) {
+        if (cur->c0cur_filter && cur->c0cur_filter->kcf_maxkey) {
             const void *maxkey = cur->c0cur_filter->kcf_maxkey;
             size_t      maxlen = cur->c0cur_filter->kcf_maxklen;
 
@@ -1565,6 +1604,31 @@ c0sk_ingest_width_get(struct c0sk *handle)
     return self->c0sk_ingest_width;
 }
 
+void
+c0sk_usage(struct c0sk *handle, uint *kvmsc, size_t *memsz)
+{
+    struct c0sk_impl *    self;
+    struct c0_kvmultiset *kvms;
+    struct c0_usage       usage;
+
+    assert(handle);
+
+    self = c0sk_h2r(handle);
+
+    *kvmsc = 0;
+    *memsz = 0;
+
+    rcu_read_lock();
+    cds_list_for_each_entry_rcu(kvms, &self->c0sk_kvmultisets, c0ms_link)
+    {
+        c0kvms_usage(kvms, &usage);
+
+        *memsz += usage.u_memsz;
+        *kvmsc += 1;
+    }
+    rcu_read_unlock();
+}
+
 #if HSE_MOCKING
 #include "c0sk_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -14,6 +14,7 @@
 #include <hse_util/xrand.h>
 #include <hse_util/bonsai_tree.h>
 #include <hse_util/bkv_collection.h>
+#include <hse_util/keycmp.h>
 
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/c0sk.h>
@@ -1033,6 +1034,9 @@ c0sk_queue_ingest(struct c0sk_impl *self, struct c0_kvmultiset *old)
 
     err = c0kvms_create(self->c0sk_ingest_width, self->c0sk_kvdb_seq, stashp, &new);
     if (!err) {
+        if (self->c0sk_numa)
+            c0kvms_numa_bind(new);
+
         c0kvms_getref(new);
 
         /* Wait for all active non-txn put/del threads to complete or abort to
@@ -1198,6 +1202,15 @@ c0sk_putdel(
 
         kvs = c0kvms_get_hashed_c0kvset(dst, kt->kt_hash);
 
+        if (HSE_UNLIKELY(self->c0sk_numa) && op != C0SK_OP_PREFIX_DEL) {
+            uint node;
+
+            hse_getcpu(&node);
+
+            if (c0kvs_numa_node(kvs) != (int)node)
+                perfc_inc(&self->c0sk_pc_op, PERFC_RA_C0SKOP_XNODE);
+        }
+
         if (op == C0SK_OP_PUT) {
             err = c0kvs_put(kvs, skidx, kt, vt, seqnoref);
         } else if (op == C0SK_OP_DEL) {
@@ -1246,6 +1259,135 @@ c0sk_putdel(
     return err;
 }
 
+/* Order batch entries by c0kvset (as per c0kvms_get_hashed_c0kvset()),
+ * then by (skidx, key) so that each run is inserted in key order.  Ties
+ * are broken by address, which is the order in which the entries were
+ * added to the batch, such that the last update of a key wins.
+ */
+static int
+c0sk_putdelv_cmp(const void *lhs, const void *rhs)
+{
+    const struct c0kvs_batch_ent *a = *(const struct c0kvs_batch_ent **)lhs;
+    const struct c0kvs_batch_ent *b = *(const struct c0kvs_batch_ent **)rhs;
+    uint ai = a->cbe_kt.kt_hash % HSE_C0_INGEST_WIDTH_MAX;
+    uint bi = b->cbe_kt.kt_hash % HSE_C0_INGEST_WIDTH_MAX;
+    int  rc;
+
+    if (ai != bi)
+        return ai < bi ? -1 : 1;
+
+    if (a->cbe_skidx != b->cbe_skidx)
+        return a->cbe_skidx < b->cbe_skidx ? -1 : 1;
+
+    rc = keycmp(a->cbe_kt.kt_data, a->cbe_kt.kt_len, b->cbe_kt.kt_data, b->cbe_kt.kt_len);
+    if (rc)
+        return rc;
+
+    return (a > b) - (a < b);
+}
+
+merr_t
+c0sk_putdelv(
+    struct c0sk_impl        *self,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref)
+{
+    uintptr_t *priv = (uintptr_t *)seqnoref;
+    bool       is_txn = (!HSE_SQNREF_SINGLE_P(seqnoref) && !HSE_SQNREF_ORDNL_P(seqnoref));
+    uint       done = 0;
+    merr_t     err = 0;
+
+    qsort(entv, entc, sizeof(*entv), c0sk_putdelv_cmp);
+
+    while (done < entc) {
+        struct c0_kvmultiset *dst;
+        uintptr_t *           entry = NULL;
+        void                 *cookie = NULL;
+        uint                  start = done;
+        u64                   dst_gen;
+        uint                  i;
+
+        rcu_read_lock();
+        dst = c0sk_get_first_c0kvms(&self->c0sk_handle);
+        if (ev_warn(!dst)) {
+            rcu_read_unlock();
+            return merr(EINVAL);
+        }
+
+        /* As in c0sk_putdel(), only non-txn mutations take an ingest ref.
+         * Write batches are applied within a txn and so take none.
+         */
+        c0sk_ingestref_get(self, is_txn, &cookie);
+
+        if (c0kvms_should_ingest(dst) && atomic_read(&self->c0sk_replaying) == 0) {
+            err = merr(ENOMEM);
+            goto unlock;
+        }
+
+        dst_gen = c0kvms_gen_read(dst);
+        if (is_txn && c0snr_get_cgen(priv) != dst_gen) {
+            entry = c0kvms_c0snr_alloc(dst);
+            if (ev(!entry)) {
+                err = merr(ENOMEM);
+                goto unlock;
+            }
+        }
+
+        /* Apply each run of entries that hash to the same c0kvset under
+         * a single acquisition of its lock.  On error, entries [start, done)
+         * have been applied to dst and the rest will be retried.
+         */
+        while (done < entc) {
+            struct c0_kvset *kvs;
+            uint             n;
+
+            kvs = c0kvms_get_hashed_c0kvset(dst, entv[done]->cbe_kt.kt_hash);
+
+            for (n = 1; done + n < entc; ++n) {
+                if (c0kvms_get_hashed_c0kvset(dst, entv[done + n]->cbe_kt.kt_hash) != kvs)
+                    break;
+            }
+
+            err = c0kvs_putdel_batch(kvs, entv + done, n, seqnoref, &i);
+            done += i;
+            if (err)
+                break;
+        }
+
+        assert(!c0kvms_is_finalized(dst)); /* See c0kvs_putdel() */
+
+        for (i = start; i < done; ++i)
+            entv[i]->cbe_kt.kt_dgen = dst_gen;
+
+        if (entry) {
+            if (done > start) {
+                *entry = seqnoref;
+                c0snr_getref(priv, dst_gen);
+            } else {
+                *entry = 0;
+            }
+        }
+
+    unlock:
+        c0sk_ingestref_put(self, cookie);
+
+        if (merr_errno(err) == ENOMEM)
+            c0kvms_getref(dst);
+
+        rcu_read_unlock();
+
+        if (merr_errno(err) != ENOMEM)
+            break;
+
+        c0sk_queue_ingest(self, dst);
+        c0kvms_putref(dst);
+        err = 0;
+    }
+
+    return err;
+}
+
 #if HSE_MOCKING
 #include "c0sk_internal_ut_impl.i"
 #endif /* HSE_MOCKING */
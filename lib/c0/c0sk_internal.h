@@ -28,6 +28,7 @@
 
 struct rcu_head;
 struct c0_kvmultiset;
+struct c0kvs_batch_ent;
 struct csched;
 struct kvs_ktuple;
 struct kvs_vtuple;
@@ -47,6 +48,7 @@ struct c0sk {
  * @c0sk_wq_maint         workqueue for concurrent maintenance tasks
  * @c0sk_kvdb_seq:        kvdb seqno
  * @c0sk_closing:         set to %true when c0sk is closing
+ * @c0sk_numa:            set to %true if c0kvsets are bound to NUMA nodes
  * @c0sk_pc_op:           perf counter for c0sk
  * @c0sk_pc_ingest:       perf counter for c0sk ingests
  * @c0sk_kvms_mutex:      mutex protecting the list of c0_kvmultisets
@@ -83,6 +85,7 @@ struct c0sk_impl {
     atomic_ulong            *c0sk_kvdb_seq;
     bool                     c0sk_closing;
     bool                     c0sk_syncing;
+    bool                     c0sk_numa;
     atomic_int               c0sk_replaying;
     struct perfc_set         c0sk_pc_op;
     struct perfc_set         c0sk_pc_ingest;
@@ -219,6 +222,26 @@ c0sk_putdel(
     const struct kvs_vtuple *vt,
     uintptr_t                seqnoref);
 
+/**
+ * c0sk_putdelv() - apply a vector of puts and tombstones
+ * @self:     struct c0sk_impl in which to put
+ * @entv:     vector of batch entries (sorted in place)
+ * @entc:     number of entries in @entv
+ * @seqnoref: seqnoref of all entries
+ *
+ * Like c0sk_putdel(), but each run of entries destined for the same
+ * c0kvset is applied under a single acquisition of the c0kvset lock.
+ *
+ * Return: 0 on success, otherwise the first error encountered (in which
+ * case some of the entries may have been applied).
+ */
+merr_t
+c0sk_putdelv(
+    struct c0sk_impl        *self,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref);
+
 struct cn *
 c0sk_get_cn(struct c0sk_impl *c0sk, u64 skidx);
 
@@ -23,6 +23,8 @@ struct perfc_name c0sk_perfc_op[] _dt_section = {
     NE(PERFC_LT_C0SKOP_PUT, 3, "Latency of c0sk puts", "l_put(/s)", 7),
     NE(PERFC_RA_C0SKOP_DEL, 3, "Count of c0sk dels",   "c_del(/s)"),
     NE(PERFC_LT_C0SKOP_DEL, 3, "Latency of c0sk dels", "l_del(/s)", 7),
+    NE(PERFC_RA_C0SKOP_XNODE, 3, "Count of cross-node c0sk puts/dels", "c_xnode(/s)"),
+    NE(PERFC_RA_C0SKOP_BATCH, 3, "Count of c0sk batched puts/dels", "c_batch(/s)"),
 };
 
 struct perfc_name c0sk_perfc_ingest[] _dt_section = {
@@ -32,6 +32,7 @@
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/kvdb_health.h>
+#include <hse_ikvdb/hse_gparams.h>
 #include <hse_ikvdb/cn_kvdb.h>
 #include <hse_ikvdb/kvs_cparams.h>
 
@@ -61,6 +62,10 @@
 #include "bloom_reader.h"
 #include "cn_perfc.h"
 #include "kvset_internal.h"
+#include "cn_tree_internal.h"
+#include "cn_summary.h"
+#include "cn_pin.h"
+#include "cn_bcache.h"
 
 #define VMA_SIZE_MAX 30
 
@@ -79,10 +84,18 @@ cn_init(void)
     uint               sz;
     merr_t             err;
 
-    err = wbti_init();
+    err = cn_pin_init(hse_gparams.gp_cn_pin_sz);
     if (err)
         return err;
 
+    err = cn_bcache_init(hse_gparams.gp_cn_bcache_sz);
+    if (err)
+        goto pin_cleanup;
+
+    err = wbti_init();
+    if (err)
+        goto bcache_cleanup;
+
     err = ib_init();
     if (err)
         goto wbti_cleanup;
@@ -119,6 +132,12 @@ ib_cleanup:
 wbti_cleanup:
     wbti_fini();
 
+bcache_cleanup:
+    cn_bcache_fini();
+
+pin_cleanup:
+    cn_pin_fini();
+
     return err;
 }
 
@@ -132,6 +151,14 @@ cn_fini(void)
     cn_tree_fini();
     ib_fini();
     wbti_fini();
+    cn_bcache_fini();
+    cn_pin_fini();
+}
+
+void
+cn_purge(struct mpool *ds)
+{
+    cn_bcache_purge(ds);
 }
 
 u64
@@ -143,7 +170,8 @@ cn_get_ingest_dgen(struct cn *cn)
 void
 cn_inc_ingest_dgen(struct cn *cn)
 {
-    atomic_inc(&cn->cn_ingest_dgen);
+    if (cn)
+        atomic_inc(&cn->cn_ingest_dgen);
 }
 
 struct kvs_rparams *
@@ -155,7 +183,7 @@ cn_get_rp(const struct cn *cn)
 struct mclass_policy *
 cn_get_mclass_policy(const struct cn *cn)
 {
-    return cn->cn_mpolicy;
+    return cn ? cn->cn_mpolicy : NULL;
 }
 
 bool
@@ -185,7 +213,13 @@ cn_get_seqno_horizon(struct cn *cn)
 struct workqueue_struct *
 cn_get_io_wq(struct cn *cn)
 {
-    return cn->cn_io_wq;
+    return cn ? cn->cn_io_wq : NULL;
+}
+
+struct cn_qos_budget *
+cn_get_qos_budget(struct cn *cn, bool write)
+{
+    return write ? &cn->cn_qos_wr : &cn->cn_qos_rd;
 }
 
 struct workqueue_struct *
@@ -197,7 +231,7 @@ cn_get_maint_wq(struct cn *cn)
 struct csched *
 cn_get_sched(struct cn *cn)
 {
-    return cn->csched;
+    return cn ? cn->csched : NULL;
 }
 
 atomic_int *
@@ -209,6 +243,9 @@ cn_get_cancel(struct cn *cn)
 struct perfc_set *
 cn_get_perfc(struct cn *cn, enum cn_action action)
 {
+    if (!cn)
+        return NULL;
+
     switch (action) {
 
         case CN_ACTION_COMPACT_K:
@@ -247,13 +284,15 @@ cn_pc_capped_get(struct cn *cn)
 void
 cn_ref_get(struct cn *cn)
 {
-    atomic_inc_acq(&cn->cn_refcnt);
+    if (cn)
+        atomic_inc_acq(&cn->cn_refcnt);
 }
 
 void
 cn_ref_put(struct cn *cn)
 {
-    atomic_dec_rel(&cn->cn_refcnt);
+    if (cn)
+        atomic_dec_rel(&cn->cn_refcnt);
 }
 
 /* Wait for all async jobs started by cn_work_submit() to complete.
@@ -292,7 +331,7 @@ cn_get_cn_kvdb(const struct cn *handle)
 u32
 cn_get_flags(const struct cn *handle)
 {
-    return handle->cn_cflags;
+    return handle ? handle->cn_cflags : 0;
 }
 
 struct perfc_set *
@@ -371,6 +410,12 @@ cn_pfx_probe(
     return cn_tree_lookup(cn->cn_tree, &cn->cn_pc_get, kt, seq, res, qctx, kbuf, vbuf);
 }
 
+u64
+cn_range_count_est(struct cn *cn, const struct kvs_ktuple *start, const struct kvs_ktuple *end)
+{
+    return cn_tree_range_count_est(cn->cn_tree, start, end);
+}
+
 /**
  * cn_commit_blks() - commit a set of mblocks
  * @ds:           dataset
@@ -422,25 +467,18 @@ cn_mblocks_commit(
      * will be no corresponding meta record, but the replay algorithm can
      * easily anticipate this case.
      */
-    for (lx = 0; lx < num_lists; lx++) {
-
-        /*
-         * If key compaction, all the vblocks are already committed
-         * and all of them need to be kept on rollback.
-         * Else all vblocks need to be
-         * committed and none will be kept on rollback.
-         */
-        err = cndb_txn_txc(
-            cndb,
-            txid,
-            cnid,
-            context,
-            &list[lx],
-            (mutation == CN_MUT_KCOMPACT) ? list[lx].vblks.n_blks : 0);
-        if (ev(err))
-            return err;
-        tags[lx] = *context;
-    }
+    /*
+     * If key compaction, all the vblocks are already committed
+     * and all of them need to be kept on rollback.
+     * Else all vblocks need to be
+     * committed and none will be kept on rollback.
+     *
+     * The C records of all lists are journaled with a single sync.
+     */
+    err = cndb_txn_txcv(
+        cndb, txid, cnid, context, num_lists, list, mutation == CN_MUT_KCOMPACT, tags);
+    if (ev(err))
+        return err;
 
     for (lx = 0; lx < num_lists; lx++) {
         err = cn_commit_blks(ds, &list[lx].kblks, n_committed);
@@ -1000,23 +1038,49 @@ cn_tstate_destroy(struct cn_tstate *tstate)
     free_aligned(impl);
 }
 
+/**
+ * struct cn_kvsetmk_work - deferred kvset instantiation
+ * @kmw_work:  work struct for the open workqueue
+ * @kmw_cn:    cn being opened
+ * @kmw_km:    kvset metadata (block lists point into @kmw_blkv)
+ * @kmw_tag:   kvset tag
+ * @kmw_kvset: the instantiated kvset
+ * @kmw_err:   kvset_create() status
+ * @kmw_ns:    time spent in kvset_create()
+ * @kmw_blkv:  kblock ids followed by vblock ids
+ */
+struct cn_kvsetmk_work {
+    struct work_struct kmw_work;
+    struct cn *        kmw_cn;
+    struct kvset_meta  kmw_km;
+    u64                kmw_tag;
+    struct kvset *     kmw_kvset;
+    merr_t             kmw_err;
+    u64                kmw_ns;
+    struct kvs_block   kmw_blkv[];
+};
+
 struct cn_kvsetmk_ctx {
-    struct cn *ckmk_cn;
-    u64 *      ckmk_dgen;
-    uint       ckmk_node_level_max;
-    uint       ckmk_kvsets;
+    struct cn *              ckmk_cn;
+    u64 *                    ckmk_dgen;
+    uint                     ckmk_node_level_max;
+    uint                     ckmk_kvsets;
+    struct workqueue_struct *ckmk_wq;
+    struct cn_kvsetmk_work **ckmk_workv;
+    uint                     ckmk_workc;
+    uint                     ckmk_workmax;
+    u64                      ckmk_create_ns;
+    u64                      ckmk_insert_ns;
 };
 
 static merr_t
-cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
+cn_kvset_insert(struct cn_kvsetmk_ctx *ctx, struct kvset *kvset, struct kvset_meta *km)
 {
-    struct kvset *kvset;
-    struct cn *   cn = ctx->ckmk_cn;
-    merr_t        err;
+    struct cn *cn = ctx->ckmk_cn;
+    merr_t     err;
+    u64        tstart;
 
-    err = kvset_create(cn->cn_tree, tag, km, &kvset);
-    if (ev(err))
-        return err;
+    tstart = get_time_ns();
 
     err = cn_tree_insert_kvset(cn->cn_tree, kvset, km->km_node_level, km->km_node_offset);
     if (ev(err)) {
@@ -1024,6 +1088,7 @@ cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
         return err;
     }
 
+    ctx->ckmk_insert_ns += get_time_ns() - tstart;
     ctx->ckmk_kvsets++;
 
     if (km->km_dgen > *(ctx->ckmk_dgen))
@@ -1035,6 +1100,129 @@ cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
     return 0;
 }
 
+static void
+cn_kvset_mk_cb(struct work_struct *work)
+{
+    struct cn_kvsetmk_work *w = container_of(work, struct cn_kvsetmk_work, kmw_work);
+    u64                     tstart;
+
+    tstart = get_time_ns();
+    w->kmw_err = kvset_create(w->kmw_cn->cn_tree, w->kmw_tag, &w->kmw_km, &w->kmw_kvset);
+    w->kmw_ns = get_time_ns() - tstart;
+}
+
+static merr_t
+cn_kvset_mk(struct cn_kvsetmk_ctx *ctx, struct kvset_meta *km, u64 tag)
+{
+    struct cn_kvsetmk_work *w;
+    struct kvset *          kvset;
+    struct cn *             cn = ctx->ckmk_cn;
+    uint                    nk, nv;
+    merr_t                  err;
+    u64                     tstart;
+
+    if (!ctx->ckmk_wq) {
+        tstart = get_time_ns();
+
+        err = kvset_create(cn->cn_tree, tag, km, &kvset);
+        if (ev(err))
+            return err;
+
+        ctx->ckmk_create_ns += get_time_ns() - tstart;
+
+        return cn_kvset_insert(ctx, kvset, km);
+    }
+
+    /* Kvset creation is dominated by mblock property queries and page
+     * faults on kblock headers, so fan it out over the open workqueue.
+     * The caller reuses km and its block lists, hence the copy.
+     */
+    if (ctx->ckmk_workc == ctx->ckmk_workmax) {
+        uint   workmax = max_t(uint, 1024, ctx->ckmk_workmax * 2);
+        void  *workv;
+
+        workv = realloc(ctx->ckmk_workv, workmax * sizeof(*ctx->ckmk_workv));
+        if (ev(!workv))
+            return merr(ENOMEM);
+
+        ctx->ckmk_workv = workv;
+        ctx->ckmk_workmax = workmax;
+    }
+
+    nk = km->km_kblk_list.n_blks;
+    nv = km->km_vblk_list.n_blks;
+
+    w = malloc(sizeof(*w) + (nk + nv) * sizeof(w->kmw_blkv[0]));
+    if (ev(!w))
+        return merr(ENOMEM);
+
+    w->kmw_cn = cn;
+    w->kmw_km = *km;
+    w->kmw_tag = tag;
+    w->kmw_kvset = NULL;
+    w->kmw_err = 0;
+    w->kmw_ns = 0;
+
+    memcpy(w->kmw_blkv, km->km_kblk_list.blks, nk * sizeof(w->kmw_blkv[0]));
+    memcpy(w->kmw_blkv + nk, km->km_vblk_list.blks, nv * sizeof(w->kmw_blkv[0]));
+
+    w->kmw_km.km_kblk_list.blks = w->kmw_blkv;
+    w->kmw_km.km_kblk_list.n_alloc = nk;
+    w->kmw_km.km_vblk_list.blks = w->kmw_blkv + nk;
+    w->kmw_km.km_vblk_list.n_alloc = nv;
+
+    ctx->ckmk_workv[ctx->ckmk_workc++] = w;
+
+    INIT_WORK(&w->kmw_work, cn_kvset_mk_cb);
+    queue_work(ctx->ckmk_wq, &w->kmw_work);
+
+    return 0;
+}
+
+/**
+ * cn_kvset_mk_wait() - wait for deferred kvset creation and insert the results
+ * @ctx: kvset make context
+ * @err: status of cndb_cn_instantiate()
+ *
+ * Kvsets are inserted into the tree in the order cndb presented them.  On
+ * error, all kvsets that were not inserted are released.
+ */
+static merr_t
+cn_kvset_mk_wait(struct cn_kvsetmk_ctx *ctx, merr_t err)
+{
+    uint i;
+
+    if (!ctx->ckmk_wq)
+        return err;
+
+    flush_workqueue(ctx->ckmk_wq);
+
+    for (i = 0; i < ctx->ckmk_workc; i++) {
+        struct cn_kvsetmk_work *w = ctx->ckmk_workv[i];
+
+        ctx->ckmk_create_ns += w->kmw_ns;
+
+        if (!err)
+            err = w->kmw_err;
+
+        if (!err)
+            err = cn_kvset_insert(ctx, w->kmw_kvset, &w->kmw_km);
+        else if (w->kmw_kvset)
+            kvset_put_ref(w->kmw_kvset);
+
+        free(w);
+    }
+
+    free(ctx->ckmk_workv);
+    ctx->ckmk_workv = NULL;
+    ctx->ckmk_workc = ctx->ckmk_workmax = 0;
+
+    destroy_workqueue(ctx->ckmk_wq);
+    ctx->ckmk_wq = NULL;
+
+    return err;
+}
+
 /*----------------------------------------------------------------
  * SECTION: perf counter initialization
  *
@@ -1066,8 +1254,11 @@ cn_open(
     size_t      sz;
     u64         dgen = 0;
     uint64_t    mperr;
+    u64         tstart, tinst;
+    ulong       sumhits, summisses;
 
     struct cn_kvsetmk_ctx ctx = { 0 };
+    struct cn_pin_stats   pinstats;
     struct mpool_props    mpprops;
     struct merr_info      ei;
 
@@ -1126,6 +1317,9 @@ cn_open(
         goto err_exit;
     }
 
+    cn_qos_budget_init(&cn->cn_qos_rd, rp->cn_compact_rd_mbps);
+    cn_qos_budget_init(&cn->cn_qos_wr, rp->cn_compact_wr_mbps);
+
     cn->cn_replay = flags & IKVS_OFLAG_REPLAY;
 
     /* no perf counters in replay mode */
@@ -1145,6 +1339,14 @@ cn_open(
     ctx.ckmk_cn = cn;
     ctx.ckmk_dgen = &dgen;
 
+    if (rp->cn_open_threads > 1) {
+        ctx.ckmk_wq = alloc_workqueue("hse_cn_open", 0, 1, rp->cn_open_threads);
+        if (ev(!ctx.ckmk_wq)) {
+            err = merr(ENOMEM);
+            goto err_exit;
+        }
+    }
+
     ksz = kcnt = kshift = 0;
     vsz = vcnt = vshift = 0;
     kszsuf = vszsuf = "bkmgtp";
@@ -1156,10 +1358,44 @@ cn_open(
         vcnt = atomic_read(&cn_kvdb->cnd_vblk_cnt);
     }
 
+    tstart = get_time_ns();
+
+    /* A missing or unusable summary merely means that kvset_create()
+     * has to read every kblock header.
+     */
+    if (rp->cn_summary && !cn->cn_replay)
+        ev(cn_summary_load(mp, cnid, &cn->cn_tree->ct_summary));
+
     err = cndb_cn_instantiate(cndb, cnid, &ctx, (void *)cn_kvset_mk);
+
+    tinst = get_time_ns();
+
+    err = cn_kvset_mk_wait(&ctx, err);
+
+    cn_summary_stats(cn->cn_tree->ct_summary, &sumhits, &summisses);
+    cn_summary_free(cn->cn_tree->ct_summary);
+    cn->cn_tree->ct_summary = NULL;
+
     if (ev(err))
         goto err_exit;
 
+    log_info("%s/%s cnid %lu kvsets %u threads %u summary %lu/%lu: cndb %lu ms, wait %lu ms,"
+             " create %lu ms (cumulative), insert %lu ms",
+             cn->cn_kvdb_alias, cn->cn_kvsname, (ulong)cnid, ctx.ckmk_kvsets,
+             max_t(uint, rp->cn_open_threads, 1), sumhits, sumhits + summisses,
+             (tinst - tstart) / (NSEC_PER_SEC / MSEC_PER_SEC),
+             (get_time_ns() - tinst) / (NSEC_PER_SEC / MSEC_PER_SEC),
+             ctx.ckmk_create_ns / (NSEC_PER_SEC / MSEC_PER_SEC),
+             ctx.ckmk_insert_ns / (NSEC_PER_SEC / MSEC_PER_SEC));
+
+    cn_pin_stats_get(&pinstats);
+    if (pinstats.cps_cap)
+        log_info("%s/%s cnid %lu resident arena %lu/%lu MiB, chunks %lu (%lu huge),"
+                 " refused %lu, evicted %lu",
+                 cn->cn_kvdb_alias, cn->cn_kvsname, (ulong)cnid, pinstats.cps_live >> 20,
+                 pinstats.cps_cap >> 20, pinstats.cps_chunks, pinstats.cps_huge,
+                 pinstats.cps_fails, pinstats.cps_evicts);
+
     if (cn_kvdb) {
         /* [HSE_REVISIT]: This approach is not thread-safe */
         ksz = atomic_read(&cn_kvdb->cnd_kblk_size) - ksz;
@@ -1269,6 +1505,12 @@ cn_close(struct cn *cn)
      */
     cn_ref_wait(cn);
 
+    /* Save the kvset summary so that the next open needn't read
+     * every kblock header.
+     */
+    if (cn->rp->cn_summary && !cn->cn_replay && !ikvdb_read_only(cn->ikvdb))
+        cn_summary_save(cn->cn_dataset, cn->cn_cnid, cn->cn_tree);
+
     cndb_cn_close(cn->cn_cndb, cn->cn_cnid);
     cndb_putref(cn->cn_cndb);
 
@@ -1381,6 +1623,7 @@ cn_cursor_create(
     struct cn *            cn,
     u64                    seqno,
     bool                   reverse,
+    bool                   keys_only,
     const void *           prefix,
     u32                    pfx_len,
     struct cursor_summary *summary,
@@ -1419,6 +1662,7 @@ cn_cursor_create(
 
     cur->summary = summary;
     cur->reverse = reverse;
+    cur->keys_only = keys_only;
 
     err = cn_tree_cursor_create(cur, cn->cn_tree);
     if (ev(err)) {
@@ -1558,9 +1802,18 @@ cn_make(struct mpool *ds, const struct kvs_cparams *cp, struct kvdb_health *heal
     return err;
 }
 
+merr_t
+cn_drop(struct mpool *ds, u64 cnid)
+{
+    return cn_summary_drop(ds, cnid);
+}
+
 u64
 cn_mpool_dev_zone_alloc_unit_default(struct cn *cn, enum hse_mclass mclass)
 {
+    if (!cn)
+        return MPOOL_MBLOCK_SIZE_DEFAULT;
+
     return cn->cn_mpool_props.mclass[mclass].mc_mblocksz;
 }
 
@@ -0,0 +1,521 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/arch.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/hash.h>
+#include <hse_util/list.h>
+#include <hse_util/log2.h>
+#include <hse_util/logging.h>
+#include <hse_util/minmax.h>
+#include <hse_util/mutex.h>
+#include <hse_util/page.h>
+#include <hse_util/vlb.h>
+
+#include <mpool/mpool.h>
+
+#include "cn_bcache.h"
+
+/* The cache holds PAGE_SIZE pages of mblocks, split over a fixed number
+ * of independently locked shards.  The cache is shared by all KVDBs in
+ * the process but mblock ids are unique only within an mpool, so pages
+ * are keyed by (mpool, mblock id, page number).  An mpool's pages are
+ * purged before it is closed so that an mpool later opened at the same
+ * address cannot hit them.
+ *
+ * Each shard runs S3-FIFO: new pages enter a small FIFO, pages that are
+ * hit again before they reach its tail are promoted to the main FIFO, and
+ * the rest are evicted after a single pass and remembered in a ghost table.
+ * A miss on a page that is in the ghost table inserts it directly into the
+ * main FIFO.  The main FIFO is a CLOCK with a two bit frequency counter.
+ *
+ * Only vblock value reads go through the cache.  Kblock wbtree and bloom
+ * pages are still accessed through the kblock mmaps and so are cached by
+ * the kernel page cache; routing them here would require replacing the
+ * pointer-based wbtree and bloom readers with copy-out reads.
+ *
+ * CN_BCACHE_SMALL_PCT     percentage of a shard given to the small FIFO
+ * CN_BCACHE_FREQ_MAX      saturation point of the frequency counter
+ * CN_BCACHE_RUN_MAX       max pages read by a single mblock read on miss
+ */
+#define CN_BCACHE_SHARDS    (16)
+#define CN_BCACHE_SMALL_PCT (10)
+#define CN_BCACHE_FREQ_MAX  (3)
+#define CN_BCACHE_RUN_MAX   (VLB_ALLOCSZ_MAX / PAGE_SIZE)
+
+struct cn_bcache_ent {
+    struct list_head      cbe_qlink;
+    struct cn_bcache_ent *cbe_hnext;
+    const struct mpool *  cbe_ds;
+    u64                   cbe_mbid;
+    u64                   cbe_pgno;
+    u64                   cbe_hash;
+    int                   cbe_refcnt;
+    u8                    cbe_freq;
+    bool                  cbe_main;
+    char                  cbe_data[] HSE_ALIGNED(16);
+};
+
+struct cn_bcache_shard {
+    struct mutex           cbs_lock;
+    struct list_head       cbs_small;
+    struct list_head       cbs_main;
+    size_t                 cbs_smallc;
+    size_t                 cbs_mainc;
+    size_t                 cbs_cap;
+    struct cn_bcache_ent **cbs_htab;
+    u64 *                  cbs_ghost;
+    u64                    cbs_mask;
+    ulong                  cbs_hits;
+    ulong                  cbs_misses;
+    ulong                  cbs_reads;
+    ulong                  cbs_evicts;
+} HSE_L1D_ALIGNED;
+
+static struct {
+    size_t                 cb_cap;
+    struct cn_bcache_shard cb_shardv[CN_BCACHE_SHARDS];
+} cn_bcache;
+
+static HSE_ALWAYS_INLINE u64
+cn_bcache_hash(const struct mpool *ds, u64 mbid, u64 pgno)
+{
+    u64 key[] = { (uintptr_t)ds, mbid, pgno };
+
+    return hse_hash64(key, sizeof(key));
+}
+
+static HSE_ALWAYS_INLINE struct cn_bcache_shard *
+cn_bcache_shard(u64 hash)
+{
+    return cn_bcache.cb_shardv + (hash % CN_BCACHE_SHARDS);
+}
+
+static HSE_ALWAYS_INLINE u64
+cn_bcache_slot(struct cn_bcache_shard *s, u64 hash)
+{
+    return (hash / CN_BCACHE_SHARDS) & s->cbs_mask;
+}
+
+static struct cn_bcache_ent *
+cn_bcache_find(
+    struct cn_bcache_shard *s,
+    u64                     hash,
+    const struct mpool *    ds,
+    u64                     mbid,
+    u64                     pgno)
+{
+    struct cn_bcache_ent *e;
+
+    for (e = s->cbs_htab[cn_bcache_slot(s, hash)]; e; e = e->cbe_hnext) {
+        if (e->cbe_mbid == mbid && e->cbe_pgno == pgno && e->cbe_ds == ds)
+            break;
+    }
+
+    return e;
+}
+
+static void
+cn_bcache_unhash(struct cn_bcache_shard *s, struct cn_bcache_ent *e)
+{
+    struct cn_bcache_ent **pp = s->cbs_htab + cn_bcache_slot(s, e->cbe_hash);
+
+    while (*pp != e)
+        pp = &(*pp)->cbe_hnext;
+
+    *pp = e->cbe_hnext;
+}
+
+/* Ghost entries are fingerprints in a direct mapped table, so a ghost
+ * hit is occasionally wrong.  That only costs an early promotion.
+ */
+static HSE_ALWAYS_INLINE void
+cn_bcache_ghost_add(struct cn_bcache_shard *s, u64 hash)
+{
+    s->cbs_ghost[cn_bcache_slot(s, hash)] = hash | 1;
+}
+
+static HSE_ALWAYS_INLINE bool
+cn_bcache_ghost_test(struct cn_bcache_shard *s, u64 hash)
+{
+    return s->cbs_ghost[cn_bcache_slot(s, hash)] == (hash | 1);
+}
+
+/* Caller must hold cbs_lock.  Returns an unhashed entry for the caller
+ * to free, or NULL if every entry is pinned.
+ */
+static struct cn_bcache_ent *
+cn_bcache_evict(struct cn_bcache_shard *s)
+{
+    struct cn_bcache_ent *e;
+    size_t                tries;
+
+    tries = 2 * (s->cbs_smallc + s->cbs_mainc) * (CN_BCACHE_FREQ_MAX + 1);
+
+    while (tries-- > 0) {
+        if (s->cbs_smallc * 100 > s->cbs_cap * CN_BCACHE_SMALL_PCT || !s->cbs_mainc) {
+            e = list_last_entry_or_null(&s->cbs_small, struct cn_bcache_ent, cbe_qlink);
+            if (!e)
+                return NULL;
+
+            list_del(&e->cbe_qlink);
+            s->cbs_smallc--;
+
+            if (e->cbe_freq > 0 || e->cbe_refcnt > 0) {
+                e->cbe_freq = 0;
+                e->cbe_main = true;
+                list_add(&e->cbe_qlink, &s->cbs_main);
+                s->cbs_mainc++;
+                continue;
+            }
+
+            cn_bcache_ghost_add(s, e->cbe_hash);
+        } else {
+            e = list_last_entry(&s->cbs_main, struct cn_bcache_ent, cbe_qlink);
+
+            list_del(&e->cbe_qlink);
+
+            if (e->cbe_freq > 0 || e->cbe_refcnt > 0) {
+                if (e->cbe_freq > 0)
+                    e->cbe_freq--;
+                list_add(&e->cbe_qlink, &s->cbs_main);
+                continue;
+            }
+
+            s->cbs_mainc--;
+        }
+
+        cn_bcache_unhash(s, e);
+        s->cbs_evicts++;
+
+        return e;
+    }
+
+    return NULL;
+}
+
+static struct cn_bcache_ent *
+cn_bcache_get(const struct mpool *ds, u64 mbid, u64 pgno)
+{
+    struct cn_bcache_shard *s;
+    struct cn_bcache_ent *  e;
+    u64                     hash;
+
+    hash = cn_bcache_hash(ds, mbid, pgno);
+    s = cn_bcache_shard(hash);
+
+    mutex_lock(&s->cbs_lock);
+    e = cn_bcache_find(s, hash, ds, mbid, pgno);
+    if (e) {
+        if (e->cbe_freq < CN_BCACHE_FREQ_MAX)
+            e->cbe_freq++;
+        e->cbe_refcnt++;
+        s->cbs_hits++;
+    } else {
+        s->cbs_misses++;
+    }
+    mutex_unlock(&s->cbs_lock);
+
+    return e;
+}
+
+static void
+cn_bcache_put(struct cn_bcache_ent *e)
+{
+    struct cn_bcache_shard *s = cn_bcache_shard(e->cbe_hash);
+
+    mutex_lock(&s->cbs_lock);
+    assert(e->cbe_refcnt > 0);
+    e->cbe_refcnt--;
+    mutex_unlock(&s->cbs_lock);
+}
+
+static void
+cn_bcache_insert(const struct mpool *ds, u64 mbid, u64 pgno, const void *data)
+{
+    struct cn_bcache_shard *s;
+    struct cn_bcache_ent *  e, *victim = NULL;
+    u64                     hash, slot;
+
+    e = malloc(sizeof(*e) + PAGE_SIZE);
+    if (ev(!e))
+        return;
+
+    hash = cn_bcache_hash(ds, mbid, pgno);
+    s = cn_bcache_shard(hash);
+
+    e->cbe_ds = ds;
+    e->cbe_mbid = mbid;
+    e->cbe_pgno = pgno;
+    e->cbe_hash = hash;
+    e->cbe_refcnt = 0;
+    e->cbe_freq = 0;
+    memcpy(e->cbe_data, data, PAGE_SIZE);
+
+    mutex_lock(&s->cbs_lock);
+    if (cn_bcache_find(s, hash, ds, mbid, pgno)) {
+        mutex_unlock(&s->cbs_lock);
+        free(e);
+        return;
+    }
+
+    if (s->cbs_smallc + s->cbs_mainc >= s->cbs_cap)
+        victim = cn_bcache_evict(s);
+
+    e->cbe_main = cn_bcache_ghost_test(s, hash);
+    if (e->cbe_main) {
+        list_add(&e->cbe_qlink, &s->cbs_main);
+        s->cbs_mainc++;
+    } else {
+        list_add(&e->cbe_qlink, &s->cbs_small);
+        s->cbs_smallc++;
+    }
+
+    slot = cn_bcache_slot(s, hash);
+    e->cbe_hnext = s->cbs_htab[slot];
+    s->cbs_htab[slot] = e;
+    mutex_unlock(&s->cbs_lock);
+
+    free(victim);
+}
+
+static HSE_ALWAYS_INLINE void
+cn_bcache_copy(u64 pgno, const char *page, size_t off, size_t len, char *dst)
+{
+    size_t pgoff = pgno * PAGE_SIZE;
+    size_t start = max_t(size_t, off, pgoff);
+    size_t end = min_t(size_t, off + len, pgoff + PAGE_SIZE);
+
+    memcpy(dst + (start - off), page + (start - pgoff), end - start);
+}
+
+static merr_t
+cn_bcache_fill(struct mpool *ds, u64 mbid, u64 pgno, u64 pgc, size_t off, size_t len, char *dst)
+{
+    struct cn_bcache_shard *s;
+    struct iovec            iov;
+    merr_t                  err;
+    u64                     i;
+
+    iov.iov_len = pgc * PAGE_SIZE;
+    iov.iov_base = vlb_alloc(iov.iov_len);
+    if (ev(!iov.iov_base))
+        return merr(ENOMEM);
+
+    err = mpool_mblock_read(ds, mbid, &iov, 1, pgno * PAGE_SIZE);
+    if (!ev(err)) {
+        for (i = 0; i < pgc; i++) {
+            const char *page = iov.iov_base + i * PAGE_SIZE;
+
+            cn_bcache_copy(pgno + i, page, off, len, dst);
+            cn_bcache_insert(ds, mbid, pgno + i, page);
+        }
+
+        s = cn_bcache_shard(cn_bcache_hash(ds, mbid, pgno));
+        mutex_lock(&s->cbs_lock);
+        s->cbs_reads++;
+        mutex_unlock(&s->cbs_lock);
+    }
+
+    vlb_free(iov.iov_base, iov.iov_len);
+
+    return err;
+}
+
+bool
+cn_bcache_enabled(void)
+{
+    return cn_bcache.cb_cap > 0;
+}
+
+merr_t
+cn_bcache_read(struct mpool *ds, u64 mbid, size_t off, size_t len, void *dst)
+{
+    u64    pgno, pglast, run;
+    merr_t err;
+
+    if (!cn_bcache.cb_cap)
+        return merr(ENOTSUP);
+
+    if (!len)
+        return 0;
+
+    pgno = off / PAGE_SIZE;
+    pglast = (off + len - 1) / PAGE_SIZE;
+
+    while (pgno <= pglast) {
+        struct cn_bcache_ent *e;
+
+        e = cn_bcache_get(ds, mbid, pgno);
+        if (e) {
+            cn_bcache_copy(pgno, e->cbe_data, off, len, dst);
+            cn_bcache_put(e);
+            pgno++;
+            continue;
+        }
+
+        /* Read the remainder of the range with one I/O.  Pages in the
+         * run that happen to be cached already are simply re-read.
+         */
+        run = min_t(u64, pglast - pgno + 1, CN_BCACHE_RUN_MAX);
+
+        err = cn_bcache_fill(ds, mbid, pgno, run, off, len, dst);
+        if (err)
+            return err;
+
+        pgno += run;
+    }
+
+    return 0;
+}
+
+void
+cn_bcache_purge(const struct mpool *ds)
+{
+    int i;
+
+    if (!cn_bcache.cb_cap)
+        return;
+
+    for (i = 0; i < CN_BCACHE_SHARDS; i++) {
+        struct cn_bcache_shard *s = cn_bcache.cb_shardv + i;
+        struct cn_bcache_ent *  e, *next;
+        struct list_head        purged;
+
+        INIT_LIST_HEAD(&purged);
+
+        mutex_lock(&s->cbs_lock);
+        list_for_each_entry_safe(e, next, &s->cbs_small, cbe_qlink) {
+            if (e->cbe_ds != ds)
+                continue;
+
+            assert(e->cbe_refcnt == 0);
+            cn_bcache_unhash(s, e);
+            list_del(&e->cbe_qlink);
+            list_add(&e->cbe_qlink, &purged);
+            s->cbs_smallc--;
+        }
+
+        list_for_each_entry_safe(e, next, &s->cbs_main, cbe_qlink) {
+            if (e->cbe_ds != ds)
+                continue;
+
+            assert(e->cbe_refcnt == 0);
+            cn_bcache_unhash(s, e);
+            list_del(&e->cbe_qlink);
+            list_add(&e->cbe_qlink, &purged);
+            s->cbs_mainc--;
+        }
+        mutex_unlock(&s->cbs_lock);
+
+        list_for_each_entry_safe(e, next, &purged, cbe_qlink)
+            free(e);
+    }
+}
+
+void
+cn_bcache_stats_get(struct cn_bcache_stats *stats)
+{
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    stats->cbs_cap = cn_bcache.cb_cap;
+
+    if (!cn_bcache.cb_cap)
+        return;
+
+    for (i = 0; i < CN_BCACHE_SHARDS; i++) {
+        struct cn_bcache_shard *s = cn_bcache.cb_shardv + i;
+
+        mutex_lock(&s->cbs_lock);
+        stats->cbs_bytes += (s->cbs_smallc + s->cbs_mainc) * PAGE_SIZE;
+        stats->cbs_hits += s->cbs_hits;
+        stats->cbs_misses += s->cbs_misses;
+        stats->cbs_reads += s->cbs_reads;
+        stats->cbs_evicts += s->cbs_evicts;
+        mutex_unlock(&s->cbs_lock);
+    }
+}
+
+static void
+cn_bcache_shards_destroy(int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        struct cn_bcache_shard *s = cn_bcache.cb_shardv + i;
+        struct cn_bcache_ent *  e, *next;
+
+        list_for_each_entry_safe(e, next, &s->cbs_small, cbe_qlink)
+            free(e);
+        list_for_each_entry_safe(e, next, &s->cbs_main, cbe_qlink)
+            free(e);
+
+        free(s->cbs_htab);
+        free(s->cbs_ghost);
+        mutex_destroy(&s->cbs_lock);
+    }
+
+    memset(&cn_bcache, 0, sizeof(cn_bcache));
+}
+
+merr_t
+cn_bcache_init(size_t cap)
+{
+    size_t pages, nslots;
+    int    i;
+
+    memset(&cn_bcache, 0, sizeof(cn_bcache));
+
+    pages = cap / PAGE_SIZE / CN_BCACHE_SHARDS;
+    if (!pages)
+        return 0;
+
+    /* The hash table and the ghost table share one size, at least as
+     * large as the number of pages a shard may hold.
+     */
+    nslots = roundup_pow_of_two(pages);
+
+    for (i = 0; i < CN_BCACHE_SHARDS; i++) {
+        struct cn_bcache_shard *s = cn_bcache.cb_shardv + i;
+
+        mutex_init(&s->cbs_lock);
+        INIT_LIST_HEAD(&s->cbs_small);
+        INIT_LIST_HEAD(&s->cbs_main);
+        s->cbs_cap = pages;
+        s->cbs_mask = nslots - 1;
+
+        s->cbs_htab = calloc(nslots, sizeof(*s->cbs_htab));
+        s->cbs_ghost = calloc(nslots, sizeof(*s->cbs_ghost));
+        if (ev(!s->cbs_htab || !s->cbs_ghost)) {
+            cn_bcache_shards_destroy(i + 1);
+            return merr(ENOMEM);
+        }
+    }
+
+    cn_bcache.cb_cap = pages * PAGE_SIZE * CN_BCACHE_SHARDS;
+
+    return 0;
+}
+
+void
+cn_bcache_fini(void)
+{
+    struct cn_bcache_stats stats;
+
+    if (!cn_bcache.cb_cap)
+        return;
+
+    cn_bcache_stats_get(&stats);
+
+    log_info("block cache: cap %lu MiB, hits %lu, misses %lu, reads %lu, evicts %lu",
+             stats.cbs_cap >> 20, stats.cbs_hits, stats.cbs_misses,
+             stats.cbs_reads, stats.cbs_evicts);
+
+    cn_bcache_shards_destroy(CN_BCACHE_SHARDS);
+}
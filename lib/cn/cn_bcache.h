@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_BCACHE_H
+#define HSE_KVS_CN_BCACHE_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+struct mpool;
+
+/**
+ * struct cn_bcache_stats - block cache statistics
+ * @cbs_cap:     capacity in bytes (0 if the cache is disabled)
+ * @cbs_bytes:   bytes of cached pages
+ * @cbs_hits:    page lookups that found the page cached
+ * @cbs_misses:  page lookups that had to read the page from media
+ * @cbs_reads:   number of mblock reads issued to fill misses
+ * @cbs_evicts:  pages evicted
+ */
+struct cn_bcache_stats {
+    ulong cbs_cap;
+    ulong cbs_bytes;
+    ulong cbs_hits;
+    ulong cbs_misses;
+    ulong cbs_reads;
+    ulong cbs_evicts;
+};
+
+/**
+ * cn_bcache_enabled() - check whether the block cache is enabled
+ */
+bool
+cn_bcache_enabled(void);
+
+/**
+ * cn_bcache_read() - read a byte range of an mblock through the block cache
+ * @ds:   mpool, part of the cache key along with @mbid
+ * @mbid: mblock id
+ * @off:  byte offset into the mblock
+ * @len:  number of bytes to read
+ * @dst:  output buffer, need not be aligned
+ *
+ * Pages not found in the cache are read with mpool_mblock_read() (which
+ * uses direct I/O if the media class supports it) and inserted into the
+ * cache.  Cached pages are pinned only for the duration of the copy to
+ * @dst, so eviction never waits on a reader.
+ */
+merr_t
+cn_bcache_read(struct mpool *ds, u64 mbid, size_t off, size_t len, void *dst);
+
+/**
+ * cn_bcache_purge() - drop all cached pages of an mpool
+ * @ds: mpool
+ *
+ * Must be called before @ds is closed, when no reads of its mblocks
+ * are in progress.
+ */
+void
+cn_bcache_purge(const struct mpool *ds);
+
+/**
+ * cn_bcache_stats_get() - retrieve block cache statistics
+ * @stats: (output) statistics
+ */
+void
+cn_bcache_stats_get(struct cn_bcache_stats *stats);
+
+/**
+ * cn_bcache_init() - initialize the block cache
+ * @cap: capacity in bytes, 0 to disable the cache
+ */
+merr_t
+cn_bcache_init(size_t cap);
+
+/**
+ * cn_bcache_fini() - tear down the block cache
+ */
+void
+cn_bcache_fini(void);
+
+#endif
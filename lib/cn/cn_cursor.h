@@ -38,6 +38,7 @@ struct cursor_summary;
  * @dgen:       max dgen in this scan
  * @seqno:      view sequence number for this cursor
  * @reverse:    reverse iterator: 1=yes 0=no
+ * @keys_only:  resolve keys and value lengths only, never read vblocks
  * @eof:        cursor is at eof: 1=yes 0=no
  * @pt_set:     if the ptomb in pt_kobj, if there is one, is relevant.
  * @stats:      metrics for this scan; exists lifetime of cursor
@@ -67,6 +68,7 @@ struct cn_cursor {
 
     /* bitflags */
     u32 reverse : 1;
+    u32 keys_only : 1;
     u32 eof : 1;
     u32 pt_set : 1;
 
@@ -83,6 +85,7 @@ cn_cursor_create(
     struct cn *            cn,
     u64                    seqno,
     bool                   reverse,
+    bool                   keys_only,
     const void *           prefix,
     u32                    len,
     struct cursor_summary *summary,
@@ -24,6 +24,8 @@ struct csched;
 #include <hse/limits.h>
 #include <mpool/mpool.h>
 
+#include "cn_qos.h"
+
 struct cn {
     struct cn_tree *  cn_tree;
     struct perfc_set  cn_pc_get;
@@ -31,7 +33,6 @@ struct cn {
     struct cn_tstate *cn_tstate;
     struct mpool *    cn_dataset;
     struct cndb *     cn_cndb;
-    struct tbkt *     cn_tbkt_maint;
     u64               cn_cnid;
 
     atomic_ulong cn_ingest_dgen;
@@ -60,6 +61,10 @@ struct cn {
     atomic_int               cn_maint_cancel;
     bool                     cn_maint_running;
 
+    /* compaction bandwidth budgets */
+    struct cn_qos_budget cn_qos_rd;
+    struct cn_qos_budget cn_qos_wr;
+
     struct kvs_rparams *  rp;
     struct kvs_cparams *  cp;
     struct ikvdb *        ikvdb;
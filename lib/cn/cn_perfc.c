@@ -42,7 +42,7 @@ struct perfc_name cn_perfc_get[] _dt_section = {
 };
 
 struct perfc_name cn_perfc_compact[] _dt_section = {
-    NE(PERFC_LT_CNCOMP_TOTAL,    2, "cN comp latency",               "l_comp"),
+    NE(PERFC_HG_CNCOMP_TOTAL,    2, "cN comp latency",               "l_comp"),
 
     NE(PERFC_BA_CNCOMP_START,    3, "cN comp starts",                "started"),
     NE(PERFC_BA_CNCOMP_FINISH,   3, "cN comp finishes",              "finished"),
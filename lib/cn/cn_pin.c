@@ -0,0 +1,481 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/list.h>
+#include <hse_util/logging.h>
+#include <hse_util/mman.h>
+#include <hse_util/mutex.h>
+#include <hse_util/page.h>
+#include <hse_util/perfc.h>
+
+#include <hse_ikvdb/hse_gparams.h>
+#include <hse/kvdb_perfc.h>
+
+#include <urcu-bp.h>
+
+#include "cn_pin.h"
+
+/* The arena is built from 2MB aligned chunks so that each chunk can be
+ * backed by hugetlb pages if any are available, or by transparent huge
+ * pages otherwise.  Allocations larger than a chunk get a chunk of their
+ * own, rounded up to a multiple of the chunk size.
+ */
+#define CN_PIN_CHUNK_SZ (2ul << 20)
+
+/* clang-format off */
+
+static struct perfc_name cn_pin_perfc[] _dt_section = {
+    NE(PERFC_BA_CNPIN_RESIDENT, 2, "resident bytes",          "pin_resident"),
+    NE(PERFC_BA_CNPIN_LIVE,     2, "allocated bytes",         "pin_live"),
+    NE(PERFC_BA_CNPIN_CHUNKS,   2, "mapped chunks",           "pin_chunks"),
+    NE(PERFC_BA_CNPIN_HUGE,     2, "hugetlb backed chunks",   "pin_huge"),
+    NE(PERFC_BA_CNPIN_ALLOCS,   2, "allocations",             "pin_allocs"),
+    NE(PERFC_BA_CNPIN_FAILS,    2, "refused allocations",     "pin_fails"),
+    NE(PERFC_BA_CNPIN_EVICTS,   2, "evicted allocations",     "pin_evicts"),
+};
+
+NE_CHECK(cn_pin_perfc, PERFC_EN_CNPIN, "cn_pin_perfc table/enum mismatch");
+
+/* clang-format on */
+
+/**
+ * struct cn_pin_chunk - a contiguous piece of the resident arena
+ * @cpc_link:    chunk list linkage
+ * @cpc_pins:    list of allocations from this chunk
+ * @cpc_base:    base address of the chunk
+ * @cpc_size:    size of the chunk
+ * @cpc_used:    bump allocator offset
+ * @cpc_live:    bytes allocated from this chunk and not yet freed
+ * @cpc_pending: number of allocations not yet published
+ * @cpc_huge:    chunk is backed by hugetlb pages
+ *
+ * Space is handed out from the current chunk with a bump allocator and is
+ * reclaimed only when every allocation in a chunk has been freed, at which
+ * point the chunk is unmapped (or rewound, if it is the current chunk).
+ * Allocations are owned by kvsets, which come and go together, so chunks
+ * tend to drain as compaction retires the kvsets that filled them.
+ *
+ * When the arena is full the chunk list is swept as a CLOCK: a chunk
+ * with an allocation that has been referenced since the last sweep has
+ * the reference bits cleared and moves to the tail, and the first chunk
+ * found with none is evicted as a whole.  Chunks with allocations that
+ * have not yet been published, and the current chunk, are never evicted.
+ */
+struct cn_pin_chunk {
+    struct list_head cpc_link;
+    struct list_head cpc_pins;
+    char *           cpc_base;
+    size_t           cpc_size;
+    size_t           cpc_used;
+    size_t           cpc_live;
+    uint             cpc_pending;
+    bool             cpc_huge;
+};
+
+static struct {
+    struct mutex         cp_lock;
+    struct list_head     cp_chunks;
+    struct cn_pin_chunk *cp_cur;
+    size_t               cp_cap;
+    size_t               cp_resident;
+    size_t               cp_live;
+    ulong                cp_chunkc;
+    ulong                cp_hugec;
+    ulong                cp_allocs;
+    ulong                cp_fails;
+    ulong                cp_evicts;
+    struct perfc_set     cp_pc;
+} cn_pin;
+
+/* Caller must hold cp_lock.
+ */
+static void
+cn_pin_perfc_update(void)
+{
+    struct perfc_set *pc = &cn_pin.cp_pc;
+
+    perfc_set(pc, PERFC_BA_CNPIN_RESIDENT, cn_pin.cp_resident);
+    perfc_set(pc, PERFC_BA_CNPIN_LIVE, cn_pin.cp_live);
+    perfc_set(pc, PERFC_BA_CNPIN_CHUNKS, cn_pin.cp_chunkc);
+    perfc_set(pc, PERFC_BA_CNPIN_HUGE, cn_pin.cp_hugec);
+    perfc_set(pc, PERFC_BA_CNPIN_ALLOCS, cn_pin.cp_allocs);
+    perfc_set(pc, PERFC_BA_CNPIN_FAILS, cn_pin.cp_fails);
+    perfc_set(pc, PERFC_BA_CNPIN_EVICTS, cn_pin.cp_evicts);
+}
+
+static struct cn_pin_chunk *
+cn_pin_chunk_create(size_t size)
+{
+    int                  prot = PROT_READ | PROT_WRITE;
+    int                  flags = MAP_ANON | MAP_PRIVATE | MAP_POPULATE;
+    struct cn_pin_chunk *chunk;
+    char *               base, *mem;
+    size_t               head, tail;
+
+    chunk = malloc(sizeof(*chunk));
+    if (ev(!chunk))
+        return NULL;
+
+    INIT_LIST_HEAD(&chunk->cpc_link);
+    INIT_LIST_HEAD(&chunk->cpc_pins);
+    chunk->cpc_size = size;
+    chunk->cpc_used = 0;
+    chunk->cpc_live = 0;
+    chunk->cpc_pending = 0;
+    chunk->cpc_huge = true;
+
+    /* Try for hugetlb pages first.  MAP_POPULATE ensures that we find
+     * out now rather than via SIGBUS if the pool runs dry.
+     */
+    mem = mmap(NULL, size, prot, flags | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED)
+        goto done;
+
+    chunk->cpc_huge = false;
+
+    /* Otherwise carve a 2MB aligned region out of a larger mapping so
+     * that it is eligible for transparent huge pages.
+     */
+    base = mmap(NULL, size + CN_PIN_CHUNK_SZ, prot, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (ev(base == MAP_FAILED)) {
+        free(chunk);
+        return NULL;
+    }
+
+    mem = PTR_ALIGN(base, CN_PIN_CHUNK_SZ);
+    head = mem - base;
+    tail = CN_PIN_CHUNK_SZ - head;
+
+    if (head)
+        munmap(base, head);
+    if (tail)
+        munmap(mem + size, tail);
+
+    ev(madvise(mem, size, MADV_HUGEPAGE));
+    ev(madvise(mem, size, MADV_WILLNEED));
+
+done:
+    /* Keep the arena out of swap if the memlock limit allows it.
+     */
+    ev(mlock(mem, size));
+
+    chunk->cpc_base = mem;
+
+    return chunk;
+}
+
+static void
+cn_pin_chunk_destroy(struct cn_pin_chunk *chunk)
+{
+    if (!chunk)
+        return;
+
+    munlock(chunk->cpc_base, chunk->cpc_size);
+    munmap(chunk->cpc_base, chunk->cpc_size);
+    free(chunk);
+}
+
+/* Caller must hold cp_lock.  Returns the chunk if it should be destroyed.
+ */
+static struct cn_pin_chunk *
+cn_pin_chunk_retire(struct cn_pin_chunk *chunk)
+{
+    if (chunk->cpc_live > 0)
+        return NULL;
+
+    if (chunk == cn_pin.cp_cur) {
+        chunk->cpc_used = 0;
+        return NULL;
+    }
+
+    list_del(&chunk->cpc_link);
+    cn_pin.cp_resident -= chunk->cpc_size;
+    cn_pin.cp_chunkc--;
+    if (chunk->cpc_huge)
+        cn_pin.cp_hugec--;
+
+    return chunk;
+}
+
+/* Caller must hold cp_lock.  Remove the chunk from the arena and
+ * unpublish all of its allocations.  The chunk must not be unmapped
+ * until the readers that may still be using it have left their RCU
+ * read-side critical sections.
+ */
+static void
+cn_pin_chunk_evict(struct cn_pin_chunk *chunk)
+{
+    struct cn_pin *pin, *next;
+
+    list_for_each_entry_safe(pin, next, &chunk->cpc_pins, cpn_link) {
+        rcu_assign_pointer(*pin->cpn_ptrp, NULL);
+        list_del_init(&pin->cpn_link);
+        pin->cpn_chunk = NULL;
+        cn_pin.cp_evicts++;
+    }
+
+    list_del(&chunk->cpc_link);
+    cn_pin.cp_live -= chunk->cpc_live;
+    cn_pin.cp_resident -= chunk->cpc_size;
+    cn_pin.cp_chunkc--;
+    if (chunk->cpc_huge)
+        cn_pin.cp_hugec--;
+}
+
+/* Caller must hold cp_lock.  Sweep the chunk list as a CLOCK and return
+ * the first evictable chunk that hasn't been referenced since the last
+ * sweep, or NULL if every chunk is either busy or in use.
+ */
+static struct cn_pin_chunk *
+cn_pin_chunk_victim(void)
+{
+    struct cn_pin_chunk *chunk;
+    ulong                n;
+
+    for (n = cn_pin.cp_chunkc * 2; n > 0; --n) {
+        struct cn_pin *pin;
+        bool           ref = false;
+
+        chunk = list_first_entry(&cn_pin.cp_chunks, typeof(*chunk), cpc_link);
+        list_del(&chunk->cpc_link);
+        list_add_tail(&chunk->cpc_link, &cn_pin.cp_chunks);
+
+        if (chunk == cn_pin.cp_cur || chunk->cpc_pending > 0)
+            continue;
+
+        list_for_each_entry(pin, &chunk->cpc_pins, cpn_link) {
+            ref |= pin->cpn_ref;
+            pin->cpn_ref = false;
+        }
+
+        if (!ref)
+            return chunk;
+    }
+
+    return NULL;
+}
+
+void *
+cn_pin_alloc(size_t len, void **ptrp, struct cn_pin **pinp)
+{
+    struct cn_pin_chunk *chunk, *old = NULL;
+    struct list_head     victims;
+    struct cn_pin *      pin;
+    size_t               chunksz;
+
+    *pinp = NULL;
+
+    if (!cn_pin.cp_cap || !len)
+        return NULL;
+
+    pin = malloc(sizeof(*pin));
+    if (ev(!pin))
+        return NULL;
+
+    INIT_LIST_HEAD(&victims);
+    len = ALIGN(len, PAGE_SIZE);
+
+    mutex_lock(&cn_pin.cp_lock);
+    chunk = cn_pin.cp_cur;
+
+    if (chunk && chunk->cpc_used + len <= chunk->cpc_size)
+        goto alloc;
+
+    /* Evict cold chunks until the new chunk fits, then reserve the space
+     * for it before dropping the lock so that concurrent callers cannot
+     * overrun the cap.
+     */
+    chunksz = ALIGN(len, CN_PIN_CHUNK_SZ);
+
+    while (chunksz <= cn_pin.cp_cap && cn_pin.cp_resident + chunksz > cn_pin.cp_cap) {
+        struct cn_pin_chunk *victim = cn_pin_chunk_victim();
+
+        if (!victim)
+            break;
+
+        cn_pin_chunk_evict(victim);
+        list_add_tail(&victim->cpc_link, &victims);
+    }
+
+    if (cn_pin.cp_resident + chunksz > cn_pin.cp_cap) {
+        cn_pin.cp_fails++;
+        cn_pin_perfc_update();
+        mutex_unlock(&cn_pin.cp_lock);
+        chunk = NULL;
+        goto out;
+    }
+
+    cn_pin.cp_resident += chunksz;
+    mutex_unlock(&cn_pin.cp_lock);
+
+    chunk = cn_pin_chunk_create(chunksz);
+
+    mutex_lock(&cn_pin.cp_lock);
+    if (!chunk) {
+        cn_pin.cp_resident -= chunksz;
+        cn_pin.cp_fails++;
+        cn_pin_perfc_update();
+        mutex_unlock(&cn_pin.cp_lock);
+        goto out;
+    }
+
+    list_add_tail(&chunk->cpc_link, &cn_pin.cp_chunks);
+    cn_pin.cp_chunkc++;
+    if (chunk->cpc_huge)
+        cn_pin.cp_hugec++;
+
+    /* Allocate subsequent requests from whichever chunk has more room.
+     */
+    if (!cn_pin.cp_cur || chunksz - len > cn_pin.cp_cur->cpc_size - cn_pin.cp_cur->cpc_used) {
+        struct cn_pin_chunk *prev = cn_pin.cp_cur;
+
+        cn_pin.cp_cur = chunk;
+        if (prev)
+            old = cn_pin_chunk_retire(prev);
+    }
+
+alloc:
+    list_add_tail(&pin->cpn_link, &chunk->cpc_pins);
+    pin->cpn_chunk = chunk;
+    pin->cpn_ptrp = ptrp;
+    pin->cpn_mem = chunk->cpc_base + chunk->cpc_used;
+    pin->cpn_len = len;
+    pin->cpn_pending = true;
+    pin->cpn_ref = true;
+
+    chunk->cpc_used += len;
+    chunk->cpc_live += len;
+    chunk->cpc_pending++;
+    cn_pin.cp_live += len;
+    cn_pin.cp_allocs++;
+    cn_pin_perfc_update();
+    mutex_unlock(&cn_pin.cp_lock);
+
+    cn_pin_chunk_destroy(old);
+
+out:
+    /* Wait for readers of the evicted chunks to drain before unmapping.
+     */
+    if (!list_empty(&victims)) {
+        struct cn_pin_chunk *next;
+
+        synchronize_rcu();
+
+        list_for_each_entry_safe(old, next, &victims, cpc_link)
+            cn_pin_chunk_destroy(old);
+    }
+
+    if (!chunk) {
+        free(pin);
+        return NULL;
+    }
+
+    *pinp = pin;
+
+    return pin->cpn_mem;
+}
+
+void
+cn_pin_publish(struct cn_pin *pin)
+{
+    mutex_lock(&cn_pin.cp_lock);
+    assert(pin->cpn_pending && pin->cpn_chunk);
+    rcu_assign_pointer(*pin->cpn_ptrp, pin->cpn_mem);
+    pin->cpn_pending = false;
+    pin->cpn_chunk->cpc_pending--;
+    mutex_unlock(&cn_pin.cp_lock);
+}
+
+void
+cn_pin_free(struct cn_pin *pin)
+{
+    struct cn_pin_chunk *chunk;
+
+    if (!pin)
+        return;
+
+    mutex_lock(&cn_pin.cp_lock);
+    chunk = pin->cpn_chunk;
+    if (chunk) {
+        assert(chunk->cpc_live >= pin->cpn_len);
+        list_del(&pin->cpn_link);
+        if (pin->cpn_pending)
+            chunk->cpc_pending--;
+        chunk->cpc_live -= pin->cpn_len;
+        cn_pin.cp_live -= pin->cpn_len;
+        chunk = cn_pin_chunk_retire(chunk);
+        cn_pin_perfc_update();
+    }
+    mutex_unlock(&cn_pin.cp_lock);
+
+    cn_pin_chunk_destroy(chunk);
+    free(pin);
+}
+
+void
+cn_pin_stats_get(struct cn_pin_stats *stats)
+{
+    mutex_lock(&cn_pin.cp_lock);
+    stats->cps_cap = cn_pin.cp_cap;
+    stats->cps_resident = cn_pin.cp_resident;
+    stats->cps_live = cn_pin.cp_live;
+    stats->cps_chunks = cn_pin.cp_chunkc;
+    stats->cps_huge = cn_pin.cp_hugec;
+    stats->cps_allocs = cn_pin.cp_allocs;
+    stats->cps_fails = cn_pin.cp_fails;
+    stats->cps_evicts = cn_pin.cp_evicts;
+    mutex_unlock(&cn_pin.cp_lock);
+}
+
+merr_t
+cn_pin_init(size_t cap)
+{
+    mutex_init(&cn_pin.cp_lock);
+    INIT_LIST_HEAD(&cn_pin.cp_chunks);
+
+    cn_pin.cp_cur = NULL;
+    cn_pin.cp_cap = ALIGN(cap, CN_PIN_CHUNK_SZ);
+    cn_pin.cp_resident = 0;
+    cn_pin.cp_live = 0;
+    cn_pin.cp_chunkc = 0;
+    cn_pin.cp_hugec = 0;
+    cn_pin.cp_allocs = 0;
+    cn_pin.cp_fails = 0;
+    cn_pin.cp_evicts = 0;
+
+    if (cn_pin.cp_cap)
+        perfc_alloc(cn_pin_perfc, "global", "cnpin", hse_gparams.gp_perfc_level, &cn_pin.cp_pc);
+
+    return 0;
+}
+
+void
+cn_pin_fini(void)
+{
+    struct cn_pin_chunk *chunk, *next;
+
+    if (cn_pin.cp_cap)
+        log_info("resident arena: cap %lu MiB, allocs %lu, fails %lu, evicts %lu, huge chunks %lu/%lu",
+                 cn_pin.cp_cap >> 20, cn_pin.cp_allocs, cn_pin.cp_fails, cn_pin.cp_evicts,
+                 cn_pin.cp_hugec, cn_pin.cp_chunkc);
+
+    perfc_free(&cn_pin.cp_pc);
+
+    assert(cn_pin.cp_live == 0);
+
+    list_for_each_entry_safe(chunk, next, &cn_pin.cp_chunks, cpc_link) {
+        list_del(&chunk->cpc_link);
+        cn_pin_chunk_destroy(chunk);
+    }
+
+    cn_pin.cp_cur = NULL;
+    cn_pin.cp_cap = 0;
+    cn_pin.cp_resident = 0;
+
+    mutex_destroy(&cn_pin.cp_lock);
+}
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_PIN_H
+#define HSE_KVS_CN_PIN_H
+
+#include <hse_util/compiler.h>
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/list.h>
+
+struct cn_pin_chunk;
+
+/**
+ * struct cn_pin - an allocation from the resident arena
+ * @cpn_link:    chunk's allocation list linkage
+ * @cpn_chunk:   chunk the allocation lives in, NULL once evicted
+ * @cpn_ptrp:    reader visible pointer to the allocation
+ * @cpn_mem:     the allocation
+ * @cpn_len:     length of the allocation
+ * @cpn_pending: allocated but not yet published
+ * @cpn_ref:     referenced since the eviction clock last passed
+ */
+struct cn_pin {
+    struct list_head     cpn_link;
+    struct cn_pin_chunk *cpn_chunk;
+    void **              cpn_ptrp;
+    void *               cpn_mem;
+    size_t               cpn_len;
+    bool                 cpn_pending;
+    bool                 cpn_ref;
+};
+
+/**
+ * struct cn_pin_stats - resident arena statistics
+ * @cps_cap:      arena capacity in bytes (0 if the arena is disabled)
+ * @cps_resident: bytes of chunks currently mapped
+ * @cps_live:     bytes currently allocated to callers
+ * @cps_chunks:   number of chunks currently mapped
+ * @cps_huge:     number of those chunks backed by hugetlb pages
+ * @cps_allocs:   number of successful allocations
+ * @cps_fails:    number of allocations refused for lack of space
+ * @cps_evicts:   number of allocations evicted to make room
+ */
+struct cn_pin_stats {
+    ulong cps_cap;
+    ulong cps_resident;
+    ulong cps_live;
+    ulong cps_chunks;
+    ulong cps_huge;
+    ulong cps_allocs;
+    ulong cps_fails;
+    ulong cps_evicts;
+};
+
+/**
+ * cn_pin_alloc() - allocate page aligned memory from the resident arena
+ * @len:  number of bytes, rounded up to a multiple of PAGE_SIZE
+ * @ptrp: reader visible pointer to the allocation
+ * @pinp: (output) allocation handle
+ *
+ * The arena is carved from hugepage-backed chunks and never paged out by
+ * the kernel, which makes it suitable for small, hot structures such as
+ * bloom filters and wbtree internal nodes that are otherwise reached
+ * through mcache maps of the kblocks.
+ *
+ * The caller fills the memory and then calls cn_pin_publish() to store
+ * its address in *@ptrp.  If the arena is full, chunks whose allocations
+ * have not been referenced recently are evicted to make room: *@ptrp is
+ * reset to NULL and the memory is unmapped after an RCU grace period, so
+ * readers must load *@ptrp with rcu_dereference() under rcu_read_lock()
+ * and fall back to the mcache map if it is NULL.
+ *
+ * Return: the memory, or NULL if the arena is disabled or full, in which
+ * case the caller should fall back to the mcache map.
+ */
+void *
+cn_pin_alloc(size_t len, void **ptrp, struct cn_pin **pinp);
+
+/**
+ * cn_pin_publish() - make a filled allocation visible to readers
+ * @pin: allocation handle returned by cn_pin_alloc()
+ */
+void
+cn_pin_publish(struct cn_pin *pin);
+
+/**
+ * cn_pin_touch() - mark an allocation as recently referenced
+ * @pin: allocation handle (may be NULL)
+ */
+static HSE_ALWAYS_INLINE void
+cn_pin_touch(struct cn_pin *pin)
+{
+    if (pin && !pin->cpn_ref)
+        pin->cpn_ref = true;
+}
+
+/**
+ * cn_pin_free() - return memory obtained from cn_pin_alloc()
+ * @pin: allocation handle returned by cn_pin_alloc() (may be NULL)
+ *
+ * The handle must be freed even if the allocation has been evicted.
+ * There must be no readers of the allocation.
+ */
+void
+cn_pin_free(struct cn_pin *pin);
+
+/**
+ * cn_pin_stats_get() - retrieve resident arena statistics
+ * @stats: (output) statistics
+ */
+void
+cn_pin_stats_get(struct cn_pin_stats *stats);
+
+/**
+ * cn_pin_init() - initialize the resident arena
+ * @cap: arena capacity in bytes, 0 to disable the arena
+ */
+merr_t
+cn_pin_init(size_t cap);
+
+/**
+ * cn_pin_fini() - tear down the resident arena
+ *
+ * All memory obtained from cn_pin_alloc() must have been freed.
+ */
+void
+cn_pin_fini(void);
+
+#endif
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_QOS_H
+#define HSE_KVS_CN_QOS_H
+
+#include <hse_util/atomic.h>
+#include <hse_util/inttypes.h>
+#include <hse_util/token_bucket.h>
+
+/**
+ * struct cn_qos_budget - per-KVS compaction bandwidth budget
+ * @cqb_tb:       token bucket (one token per byte)
+ * @cqb_mbps:     budget currently in effect (MiB/s), 0 means unlimited
+ * @cqb_bytes:    total bytes charged against the budget
+ * @cqb_delay_ns: total time compaction threads were delayed by the budget
+ *
+ * Each cn has one budget for compaction reads (mblock reads issued by the
+ * kvset iterators) and one for compaction writes (kblock and vblock
+ * builder writes).  Ingest never charges either budget.
+ */
+struct cn_qos_budget {
+    struct tbkt  cqb_tb;
+    uint         cqb_mbps;
+    atomic_ulong cqb_bytes;
+    atomic_ulong cqb_delay_ns;
+};
+
+static inline void
+cn_qos_budget_init(struct cn_qos_budget *self, uint mbps)
+{
+    u64 rate = (u64)mbps << 20;
+
+    /* A rate of zero disables the token bucket.
+     */
+    tbkt_init(&self->cqb_tb, rate / 2, rate);
+    self->cqb_mbps = mbps;
+    atomic_set(&self->cqb_bytes, 0);
+    atomic_set(&self->cqb_delay_ns, 0);
+}
+
+static inline void
+cn_qos_budget_update(struct cn_qos_budget *self, uint mbps)
+{
+    u64 rate = (u64)mbps << 20;
+
+    if (mbps == self->cqb_mbps)
+        return;
+
+    tbkt_adjust(&self->cqb_tb, rate / 2, rate);
+    self->cqb_mbps = mbps;
+}
+
+/**
+ * cn_qos_budget_charge() - charge an I/O against a budget
+ * @self:  budget (may be NULL)
+ * @bytes: size of the I/O
+ *
+ * Sleeps as long as necessary to keep the caller within the budget.
+ */
+static inline void
+cn_qos_budget_charge(struct cn_qos_budget *self, u64 bytes)
+{
+    u64 delay, now;
+
+    if (!self)
+        return;
+
+    atomic_add(&self->cqb_bytes, bytes);
+
+    delay = tbkt_request(&self->cqb_tb, bytes, &now);
+    if (delay > 0) {
+        tbkt_delay(delay);
+        atomic_add(&self->cqb_delay_ns, delay);
+    }
+}
+
+#endif
@@ -0,0 +1,389 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <stdlib.h>
+#include <libgen.h>
+#include <fcntl.h>
+#include <bsd/string.h>
+
+#include <crc32c.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/atomic.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/logging.h>
+
+#include <mpool/mpool.h>
+
+#include "cn_summary.h"
+#include "cn_tree.h"
+#include "cn_tree_iter.h"
+#include "kvset.h"
+#include "omf.h"
+
+/* Upper bound on the size of a summary we are willing to load.
+ */
+#define CN_SUMMARY_LEN_MAX (1ul << 30)
+
+struct cn_summary_ent {
+    u64                               cse_dgen;
+    u64                               cse_blkid;
+    const struct cn_summary_kblk_omf *cse_rec;
+};
+
+/**
+ * struct cn_summary - in-memory kvset summary
+ * @cs_buf:    summary records as read from media
+ * @cs_len:    length of @cs_buf
+ * @cs_entc:   number of entries in @cs_entv
+ * @cs_hits:   number of successful lookups
+ * @cs_misses: number of failed lookups
+ * @cs_entv:   records sorted by (dgen, blkid)
+ */
+struct cn_summary {
+    char                 *cs_buf;
+    size_t                cs_len;
+    uint                  cs_entc;
+    atomic_ulong          cs_hits;
+    atomic_ulong          cs_misses;
+    struct cn_summary_ent cs_entv[];
+};
+
+static void
+cn_summary_name(u64 cnid, char *buf, size_t bufsz)
+{
+    snprintf(buf, bufsz, "%s-%lx", CN_SUMMARY_FILE_PFX, (ulong)cnid);
+}
+
+static int
+cn_summary_ent_cmp(const void *lhs, const void *rhs)
+{
+    const struct cn_summary_ent *l = lhs, *r = rhs;
+
+    if (l->cse_dgen != r->cse_dgen)
+        return l->cse_dgen < r->cse_dgen ? -1 : 1;
+
+    if (l->cse_blkid != r->cse_blkid)
+        return l->cse_blkid < r->cse_blkid ? -1 : 1;
+
+    return 0;
+}
+
+struct cn_summary_find {
+    const char *csf_name;
+    bool        csf_found;
+};
+
+static void
+cn_summary_find_cb(void *arg, const char *path)
+{
+    struct cn_summary_find *f = arg;
+    char                    buf[PATH_MAX];
+
+    strlcpy(buf, path, sizeof(buf));
+
+    if (!strcmp(basename(buf), f->csf_name))
+        f->csf_found = true;
+}
+
+merr_t
+cn_summary_load(struct mpool *mp, u64 cnid, struct cn_summary **out)
+{
+    struct cn_summary_hdr_omf hdr;
+    struct cn_summary_find    find;
+    struct mpool_file_cb      cb;
+    struct mpool_file        *mpf;
+    struct cn_summary        *sum;
+    char                      name[32];
+    char                     *buf, *cur, *end;
+    size_t                    len, rdlen;
+    uint                      kblkc, i;
+    merr_t                    err;
+
+    *out = NULL;
+
+    cn_summary_name(cnid, name, sizeof(name));
+
+    /* mpool_file_open() creates files that don't exist, so look before
+     * we leap.
+     */
+    find.csf_name = name;
+    find.csf_found = false;
+    cb.cbarg = &find;
+    cb.cbfunc = cn_summary_find_cb;
+
+    err = mpool_mclass_ftw(mp, HSE_MCLASS_CAPACITY, CN_SUMMARY_FILE_PFX, &cb);
+    if (err || !find.csf_found)
+        return err;
+
+    err = mpool_file_open(mp, HSE_MCLASS_CAPACITY, name, O_RDONLY, 0, true, &mpf);
+    if (ev(err))
+        return err;
+
+    sum = NULL;
+    buf = NULL;
+
+    err = mpool_file_read(mpf, 0, (char *)&hdr, sizeof(hdr), &rdlen);
+    if (ev(err))
+        goto errout;
+
+    len = omf_csh_len(&hdr);
+    kblkc = omf_csh_kblkc(&hdr);
+
+    if (rdlen != sizeof(hdr) || omf_csh_magic(&hdr) != CN_SUMMARY_MAGIC ||
+        omf_csh_version(&hdr) != CN_SUMMARY_VERSION || omf_csh_cnid(&hdr) != cnid ||
+        len > CN_SUMMARY_LEN_MAX || len < (size_t)kblkc * sizeof(struct cn_summary_kblk_omf) ||
+        mpool_file_size(mpf) < sizeof(hdr) + len)
+        goto errout;
+
+    buf = malloc(len + 1);
+    sum = malloc(sizeof(*sum) + kblkc * sizeof(sum->cs_entv[0]));
+    if (ev(!buf || !sum)) {
+        err = merr(ENOMEM);
+        goto errout;
+    }
+
+    err = mpool_file_read(mpf, sizeof(hdr), buf, len, &rdlen);
+    if (ev(err))
+        goto errout;
+
+    if (ev(rdlen != len || crc32c(0, (u8 *)buf, len) != omf_csh_crc(&hdr)))
+        goto errout;
+
+    cur = buf;
+    end = buf + len;
+
+    for (i = 0; i < kblkc; i++) {
+        const struct cn_summary_kblk_omf *rec = (void *)cur;
+        size_t                            reclen = sizeof(*rec);
+
+        if (ev(cur + reclen > end))
+            goto errout;
+
+        reclen += omf_csk_klen_max(rec) + omf_csk_klen_min(rec);
+        if (ev(cur + reclen > end))
+            goto errout;
+
+        sum->cs_entv[i].cse_dgen = omf_csk_dgen(rec);
+        sum->cs_entv[i].cse_blkid = omf_csk_blkid(rec);
+        sum->cs_entv[i].cse_rec = rec;
+
+        cur += reclen;
+    }
+
+    qsort(sum->cs_entv, kblkc, sizeof(sum->cs_entv[0]), cn_summary_ent_cmp);
+
+    sum->cs_buf = buf;
+    sum->cs_len = len;
+    sum->cs_entc = kblkc;
+    atomic_set(&sum->cs_hits, 0);
+    atomic_set(&sum->cs_misses, 0);
+
+    *out = sum;
+    sum = NULL;
+    buf = NULL;
+
+errout:
+    if (!*out)
+        log_info("cnid %lu: ignoring %s summary: %s",
+                 (ulong)cnid, err ? "unreadable" : "invalid", name);
+
+    mpool_file_close(mpf);
+    free(sum);
+    free(buf);
+
+    return err;
+}
+
+void
+cn_summary_free(struct cn_summary *sum)
+{
+    if (!sum)
+        return;
+
+    free(sum->cs_buf);
+    free(sum);
+}
+
+const struct cn_summary_kblk_omf *
+cn_summary_lookup(struct cn_summary *sum, u64 dgen, u64 blkid)
+{
+    struct cn_summary_ent key, *ent;
+
+    if (!sum)
+        return NULL;
+
+    key.cse_dgen = dgen;
+    key.cse_blkid = blkid;
+
+    ent = bsearch(&key, sum->cs_entv, sum->cs_entc, sizeof(key), cn_summary_ent_cmp);
+    if (!ent) {
+        atomic_inc(&sum->cs_misses);
+        return NULL;
+    }
+
+    atomic_inc(&sum->cs_hits);
+
+    return ent->cse_rec;
+}
+
+bool
+cn_summary_contains(struct cn_summary *sum, const void *ptr)
+{
+    if (!sum)
+        return false;
+
+    return (const char *)ptr >= sum->cs_buf && (const char *)ptr < sum->cs_buf + sum->cs_len;
+}
+
+void
+cn_summary_stats(struct cn_summary *sum, ulong *hits, ulong *misses)
+{
+    *hits = sum ? atomic_read(&sum->cs_hits) : 0;
+    *misses = sum ? atomic_read(&sum->cs_misses) : 0;
+}
+
+/* The summary is saved both from cn_close() and in the background from
+ * the compaction commit path, so the tree may be changing while it is
+ * walked.  A single walk takes a ref on every kvset, and the records are
+ * then sized and packed from that stable set outside the tree lock.
+ */
+struct cn_summary_walk {
+    struct kvset **csw_kvsetv;
+    uint           csw_kvsetc;
+    uint           csw_kvsetmax;
+    bool           csw_nomem;
+};
+
+static int
+cn_summary_ref_cb(
+    void *               rock,
+    struct cn_tree *     tree,
+    struct cn_tree_node *node,
+    struct cn_node_loc * loc,
+    struct kvset *       kvset)
+{
+    struct cn_summary_walk *w = rock;
+
+    if (!kvset)
+        return 0;
+
+    if (w->csw_kvsetc == w->csw_kvsetmax) {
+        uint  max = w->csw_kvsetmax ? w->csw_kvsetmax * 2 : 256;
+        void *ptr;
+
+        ptr = realloc(w->csw_kvsetv, max * sizeof(*w->csw_kvsetv));
+        if (ev(!ptr)) {
+            w->csw_nomem = true;
+            return 1;
+        }
+
+        w->csw_kvsetv = ptr;
+        w->csw_kvsetmax = max;
+    }
+
+    kvset_get_ref(kvset);
+    w->csw_kvsetv[w->csw_kvsetc++] = kvset;
+
+    return 0;
+}
+
+merr_t
+cn_summary_save(struct mpool *mp, u64 cnid, struct cn_tree *tree)
+{
+    struct cn_summary_hdr_omf hdr;
+    struct cn_summary_walk    w = { 0 };
+    struct mpool_file        *mpf;
+    char                      name[32];
+    char                     *buf = NULL;
+    size_t                    len, off;
+    uint                      kblkc, i;
+    merr_t                    err;
+
+    cn_summary_name(cnid, name, sizeof(name));
+
+    cn_tree_preorder_walk(tree, KVSET_ORDER_NEWEST_FIRST, cn_summary_ref_cb, &w);
+    if (w.csw_nomem) {
+        err = merr(ENOMEM);
+        goto out;
+    }
+
+    len = kblkc = 0;
+
+    for (i = 0; i < w.csw_kvsetc; ++i) {
+        struct kvset_stats stats;
+
+        kvset_stats(w.csw_kvsetv[i], &stats);
+
+        len += kvset_summary_len(w.csw_kvsetv[i]);
+        kblkc += stats.kst_kblks;
+    }
+
+    buf = malloc(len + 1);
+    if (ev(!buf)) {
+        err = merr(ENOMEM);
+        goto out;
+    }
+
+    for (i = off = 0; i < w.csw_kvsetc; ++i)
+        off += kvset_summary_pack(w.csw_kvsetv[i], buf + off);
+    assert(off == len);
+
+    err = mpool_file_open(mp, HSE_MCLASS_CAPACITY, name, O_RDWR, sizeof(hdr) + len, true, &mpf);
+    if (ev(err))
+        goto out;
+
+    /* Invalidate the existing summary before overwriting its records
+     * so that a crash part way through leaves nothing to trust.
+     */
+    memset(&hdr, 0, sizeof(hdr));
+
+    err = mpool_file_write(mpf, 0, (char *)&hdr, sizeof(hdr), NULL);
+    if (!err)
+        err = mpool_file_sync(mpf);
+    if (!err)
+        err = mpool_file_write(mpf, sizeof(hdr), buf, len, NULL);
+    if (!err)
+        err = mpool_file_sync(mpf);
+
+    if (!err) {
+        omf_set_csh_magic(&hdr, CN_SUMMARY_MAGIC);
+        omf_set_csh_version(&hdr, CN_SUMMARY_VERSION);
+        omf_set_csh_cnid(&hdr, cnid);
+        omf_set_csh_len(&hdr, len);
+        omf_set_csh_kblkc(&hdr, kblkc);
+        omf_set_csh_crc(&hdr, crc32c(0, (u8 *)buf, len));
+
+        err = mpool_file_write(mpf, 0, (char *)&hdr, sizeof(hdr), NULL);
+    }
+
+    mpool_file_close(mpf);
+
+out:
+    if (err)
+        log_errx("cnid %lu: unable to save summary %s: @@e", err, (ulong)cnid, name);
+
+    for (i = 0; i < w.csw_kvsetc; ++i)
+        kvset_put_ref(w.csw_kvsetv[i]);
+
+    free(w.csw_kvsetv);
+    free(buf);
+
+    return err;
+}
+
+merr_t
+cn_summary_drop(struct mpool *mp, u64 cnid)
+{
+    char   name[32];
+    merr_t err;
+
+    cn_summary_name(cnid, name, sizeof(name));
+
+    err = mpool_file_destroy(mp, HSE_MCLASS_CAPACITY, name);
+
+    return merr_errno(err) == ENOENT ? 0 : err;
+}
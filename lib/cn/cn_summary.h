@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_KVS_CN_SUMMARY_H
+#define HSE_KVS_CN_SUMMARY_H
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+struct mpool;
+struct cn_tree;
+struct cn_summary;
+struct cn_summary_kblk_omf;
+
+/**
+ * cn_summary_load() - load the kvset summary of a cn
+ * @mp:   mpool
+ * @cnid: cn id
+ * @out:  (output) summary, NULL if there is no valid summary
+ *
+ * A missing, stale or corrupt summary is not an error, it merely means
+ * that every kvset will be instantiated from its kblock headers.
+ */
+merr_t
+cn_summary_load(struct mpool *mp, u64 cnid, struct cn_summary **out);
+
+/**
+ * cn_summary_free() - free a summary obtained from cn_summary_load()
+ * @sum: summary (may be NULL)
+ */
+void
+cn_summary_free(struct cn_summary *sum);
+
+/**
+ * cn_summary_lookup() - find the summary record of a kblock
+ * @sum:   summary (may be NULL)
+ * @dgen:  dgen of the kvset the kblock belongs to
+ * @blkid: kblock id
+ *
+ * Return: the kblock record, or NULL if the kblock is not in the summary.
+ * The record remains valid until the summary is freed.
+ */
+const struct cn_summary_kblk_omf *
+cn_summary_lookup(struct cn_summary *sum, u64 dgen, u64 blkid);
+
+/**
+ * cn_summary_contains() - check whether a pointer refers into a summary
+ * @sum: summary (may be NULL)
+ * @ptr: pointer to check
+ */
+bool
+cn_summary_contains(struct cn_summary *sum, const void *ptr);
+
+/**
+ * cn_summary_stats() - get summary lookup hit and miss counts
+ * @sum:    summary (may be NULL)
+ * @hits:   (output) number of lookups that found a record
+ * @misses: (output) number of lookups that did not
+ */
+void
+cn_summary_stats(struct cn_summary *sum, ulong *hits, ulong *misses);
+
+/**
+ * cn_summary_save() - write the summary of every kvset in a tree
+ * @mp:   mpool
+ * @cnid: cn id
+ * @tree: cn tree
+ *
+ * The tree may be modified concurrently, but calls for the same cn must
+ * be serialized by the caller.
+ */
+merr_t
+cn_summary_save(struct mpool *mp, u64 cnid, struct cn_tree *tree);
+
+/**
+ * cn_summary_drop() - remove the summary of a cn
+ * @mp:   mpool
+ * @cnid: cn id
+ */
+merr_t
+cn_summary_drop(struct mpool *mp, u64 cnid);
+
+#endif
@@ -11,6 +11,8 @@
 #define MTF_MOCK_IMPL_cn_tree_iter
 #define MTF_MOCK_IMPL_ct_view
 
+#include <bsd/string.h>
+
 #include <hse_util/alloc.h>
 #include <hse_util/event_counter.h>
 #include <hse_util/page.h>
@@ -45,6 +47,7 @@
 #include <hse_ikvdb/sched_sts.h>
 #include <hse_ikvdb/csched.h>
 #include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/reqtrace.h>
 
 #include <cn/cn_cursor.h>
 
@@ -68,6 +71,7 @@
 #include "kblock_builder.h"
 #include "vblock_builder.h"
 #include "route.h"
+#include "cn_summary.h"
 
 static struct kmem_cache *cn_node_cache HSE_READ_MOSTLY;
 
@@ -339,6 +343,9 @@ cn_tree_create(
 
     tree->ct_route_map = route_map_create(cp, kvsname);
 
+    if (kvsname)
+        strlcpy(tree->ct_kvsname, kvsname, sizeof(tree->ct_kvsname));
+
     if (tstate) {
         struct cn_khashmap *khm = &tree->ct_khmbuf;
 
@@ -1096,6 +1103,16 @@ cn_tree_route_create(struct cn_tree *tree, const void *key, uint keylen, uint64_
     return (child % tree->ct_fanout);
 }
 
+/* Attribute the time spent searching a node to its level.
+ */
+static HSE_ALWAYS_INLINE void
+cn_tree_lookup_trace(uint depth, u64 rt_start)
+{
+    const uint maxlvl = REQTRACE_STAGE_CN_L5 - REQTRACE_STAGE_CN_L0;
+
+    reqtrace_stage_end(REQTRACE_STAGE_CN_L0 + min_t(uint, depth, maxlvl), rt_start);
+}
+
 /**
  * cn_tree_lookup() - search cn tree for a key
  * @tree: cn tree
@@ -1159,6 +1176,7 @@ cn_tree_lookup(
     enum kvdb_perfc_sidx_cnget pc_cidx;
     u64                      pc_start;
     u64                      spill_hash = 0;
+    u64                      rt_start;
     bool                     pfx_hashing, first;
     void *                   wbti;
 
@@ -1196,6 +1214,8 @@ cn_tree_lookup(
         bool yield = false;
         u32 child;
 
+        rt_start = reqtrace_stage_start();
+
         /* Search kvsets from newest to oldest (head to tail).
          * If an error occurs or a key is found, return immediately.
          */
@@ -1211,6 +1231,7 @@ cn_tree_lookup(
                     err = kvset_lookup(kvset, kt, &kdisc, seq, res, vbuf);
                     if (err || *res != NOT_FOUND) {
                         rmlock_runlock(lock);
+                        cn_tree_lookup_trace(pc_depth, rt_start);
 
                         if (pc_cidx < PERFC_LT_CNGET_GET_L5 + 1)
                             perfc_lat_record(pc, pc_cidx, pc_start);
@@ -1222,6 +1243,7 @@ cn_tree_lookup(
                     err = kvset_pfx_lookup(kvset, kt, &kdisc, seq, res, wbti, kbuf, vbuf, qctx);
                     if (err || qctx->seen > 1 || *res == FOUND_PTMB) {
                         rmlock_runlock(lock);
+                        cn_tree_lookup_trace(pc_depth, rt_start);
 
                         ev(err);
                         goto done;
@@ -1230,6 +1252,8 @@ cn_tree_lookup(
             }
         }
 
+        cn_tree_lookup_trace(pc_depth, rt_start);
+
         if (pc_depth > 0 && yield)
             rmlock_yield(&tree->ct_lock, &lock);
 
@@ -1616,6 +1640,7 @@ cn_tree_prepare_compaction(struct cn_compaction_work *w)
             goto err_exit;
         }
         kvset_iter_set_stats(*iter, &w->cw_stats);
+        kvset_iter_set_qos(*iter, w->cw_qos_rd);
     }
 
     /* k-compaction keeps all the vblocks from the source kvsets
@@ -2312,7 +2337,7 @@ cn_tree_cursor_read(struct cn_cursor *cur, struct kvs_cursor_element *elem, bool
         return 0;
     }
 
-    if (HSE_UNLIKELY(cur->filter))
+    if (HSE_UNLIKELY(cur->filter && cur->filter->kcf_maxkey))
         key2kobj(&filter_ko, cur->filter->kcf_maxkey, cur->filter->kcf_maxklen);
 
     do {
@@ -2338,7 +2363,7 @@ cn_tree_cursor_read(struct cn_cursor *cur, struct kvs_cursor_element *elem, bool
 
         assert(rc <= 0);
 
-        if (HSE_UNLIKELY(cur->filter && key_obj_cmp(&item.kobj, &filter_ko) > 0)) {
+        if (HSE_UNLIKELY(filter_ko.ko_sfx && key_obj_cmp(&item.kobj, &filter_ko) > 0)) {
             *eof = (cur->eof = 1);
             return 0;
         }
@@ -2357,10 +2382,19 @@ cn_tree_cursor_read(struct cn_cursor *cur, struct kvs_cursor_element *elem, bool
         if (!found)
             continue; /* Key doesn't have a value in the cursor's view. */
 
-        cur->merr = kvset_iter_next_val(kv_iter, &item.vctx, vtype, vbidx,
-                                        vboff, &vdata, &vlen, &complen);
-        if (ev(cur->merr))
-            return cur->merr;
+        /* A keys-only cursor takes the value length from the kmd and
+         * leaves the vblock untouched.  Tombstones still need their
+         * sentinel vdata so that the kvs layer can recognize them.
+         */
+        if (cur->keys_only && (vtype == vtype_val || vtype == vtype_cval)) {
+            vdata = NULL;
+            complen = 0;
+        } else {
+            cur->merr = kvset_iter_next_val(kv_iter, &item.vctx, vtype, vbidx,
+                                            vboff, &vdata, &vlen, &complen);
+            if (ev(cur->merr))
+                return cur->merr;
+        }
 
         if (cur->pt_set) {
             if (key_obj_cmp_prefix(&cur->pt_kobj, &item.kobj) == 0) {
@@ -2458,7 +2492,9 @@ cn_tree_cursor_seek(
     for (i = cur->iterc - 1; i >= 0; --i) {
         bool eof = false;
 
-        if (cur->filter) {
+        cur->iterv[i]->kvi_pred = filter ? filter->kcf_pred : NULL;
+
+        if (filter && filter->kcf_maxkey) {
             struct kvset *ks = kvset_from_iter(cur->iterv[i]);
             const void *  minkey, *smaxkey;
             u16           minklen, smaxklen;
@@ -2722,18 +2758,22 @@ cn_comp_update_spill(struct cn_compaction_work *work, struct spill_child *childv
 }
 
 /**
- * cn_comp_commit_spill() - commit spill operation to cndb log
+ * cn_comp_spill_children() - pair spill output kvsets with child nodes
  * See section comment for more info.
+ *
+ * Allocates, but does not link into the tree, each child node that
+ * receives a kvset and doesn't yet exist.
  */
 static merr_t
-cn_comp_commit_spill(struct cn_compaction_work *work, struct kvset **kvsets)
+cn_comp_spill_children(
+    struct cn_compaction_work *work,
+    struct kvset             **kvsets,
+    struct spill_child       **childv_out)
 {
-    struct cn_tree *         tree = work->cw_tree;
-    struct cn_tree_node *    node = work->cw_node;
-    merr_t                   err = 0;
-    struct kvset_list_entry *le;
-    u32                      cx, kx;
-    struct spill_child *     childv;
+    struct cn_tree *     tree = work->cw_tree;
+    struct cn_tree_node *node = work->cw_node;
+    struct spill_child * childv;
+    u32                  cx;
 
     /* Precondition: n_outputs == tree fanout */
     assert(work->cw_outc == tree->ct_fanout);
@@ -2758,12 +2798,35 @@ cn_comp_commit_spill(struct cn_compaction_work *work, struct kvset **kvsets)
                 node->tn_loc.node_level + 1,
                 node_nth_child_offset(tree->ct_fanout, &node->tn_loc, cx));
             if (ev(!childv[cx].node)) {
-                err = merr(ENOMEM);
-                goto done;
+                while (cx-- > 0)
+                    cn_node_free(childv[cx].node);
+                free(childv);
+                return merr(ENOMEM);
             }
         }
     }
 
+    *childv_out = childv;
+
+    return 0;
+}
+
+/**
+ * cn_comp_commit_spill() - commit spill operation to cndb log
+ * See section comment for more info.
+ */
+static merr_t
+cn_comp_commit_spill(struct cn_compaction_work *work, struct kvset **kvsets)
+{
+    struct kvset_list_entry *le;
+    struct spill_child *     childv;
+    merr_t                   err;
+    u32                      cx, kx;
+
+    err = cn_comp_spill_children(work, kvsets, &childv);
+    if (ev(err))
+        return err;
+
     /* Update CNDB with "D" records.  No need to lock kvset as long as
      * we only access the marked kvsets.
      */
@@ -2780,7 +2843,7 @@ cn_comp_commit_spill(struct cn_compaction_work *work, struct kvset **kvsets)
     /* There must not be any failure conditions after successful ACK_C
      * because the operation has been committed.
      */
-    err = cndb_txn_ack_c(tree->cndb, work->cw_work_txid);
+    err = cndb_txn_ack_c(work->cw_tree->cndb, work->cw_work_txid);
     if (ev(err))
         goto done;
 
@@ -2789,7 +2852,7 @@ cn_comp_commit_spill(struct cn_compaction_work *work, struct kvset **kvsets)
 
 done:
     if (err) {
-        while (cx-- > 0)
+        for (cx = 0; cx < work->cw_outc; cx++)
             cn_node_free(childv[cx].node);
     }
     free(childv);
@@ -2797,6 +2860,41 @@ done:
     return err;
 }
 
+/* Number of kvsets committed by compactions after which the summary is
+ * saved in the background, so that a kvdb that isn't closed cleanly still
+ * finds most of its kblocks in the summary at the next open.
+ */
+#define CN_SUMMARY_SAVE_KVSETS (256)
+
+static void
+cn_tree_summary_save_cb(struct cn_work *work)
+{
+    struct cn_tree *tree = container_of(work, typeof(*tree), ct_summary_work);
+
+    cn_summary_save(tree->ds, tree->cnid, tree);
+
+    atomic_set(&tree->ct_summary_busy, 0);
+}
+
+static void
+cn_tree_summary_update(struct cn_tree *tree, uint kvsetc)
+{
+    if (!tree->cn || !tree->rp->cn_summary)
+        return;
+
+    atomic_add(&tree->ct_summary_dirty, kvsetc);
+
+    if (atomic_read(&tree->ct_summary_dirty) < CN_SUMMARY_SAVE_KVSETS)
+        return;
+
+    if (!atomic_cas(&tree->ct_summary_busy, 0, 1))
+        return;
+
+    atomic_set(&tree->ct_summary_dirty, 0);
+
+    cn_work_submit(tree->cn, cn_tree_summary_save_cb, &tree->ct_summary_work);
+}
+
 /**
  * cn_comp_commit() - commit compaction operation to cndb log
  * See section comment for more info.
@@ -2804,12 +2902,15 @@ done:
 static void
 cn_comp_commit(struct cn_compaction_work *w)
 {
-    struct kvset ** kvsets = 0;
-    struct mbset ***vecs = 0;
-    uint *          cnts = 0;
-    uint            i, alloc_len;
-    bool            spill, use_mbsets;
-    uint            scatter;
+    struct kvset **     kvsets = 0;
+    struct mbset ***    vecs = 0;
+    uint *              cnts = 0;
+    struct kvset_meta * kmbuf;
+    struct kvset_meta **kmv;
+    u64 *               tagv;
+    uint                i, kmc, alloc_len;
+    bool                spill, use_mbsets;
+    uint                scatter;
 
     if (ev(w->cw_err))
         goto done;
@@ -2821,6 +2922,7 @@ cn_comp_commit(struct cn_compaction_work *w)
     use_mbsets = w->cw_action == CN_ACTION_COMPACT_K;
 
     alloc_len = sizeof(*kvsets) * w->cw_outc;
+    alloc_len += (sizeof(*kmbuf) + sizeof(*kmv) + sizeof(*tagv)) * w->cw_outc;
     if (use_mbsets) {
         /* For k-compaction, create new kvset with references to
          * mbsets from input kvsets instead of creating new mbsets.
@@ -2836,11 +2938,15 @@ cn_comp_commit(struct cn_compaction_work *w)
         goto done;
     }
 
+    kmbuf = (void *)(kvsets + w->cw_outc);
+    kmv = (void *)(kmbuf + w->cw_outc);
+    tagv = (void *)(kmv + w->cw_outc);
+
     scatter = 0;
     if (use_mbsets) {
         struct kvset_list_entry *le;
 
-        vecs = (void *)(kvsets + w->cw_outc);
+        vecs = (void *)(tagv + w->cw_outc);
         cnts = (void *)(vecs + w->cw_kvset_cnt);
 
         /* The kvset represented by vecs[i] must be newer than
@@ -2857,6 +2963,8 @@ cn_comp_commit(struct cn_compaction_work *w)
         }
     }
 
+    kmc = 0;
+
     for (i = 0; i < w->cw_outc; i++) {
 
         struct kvset_meta km = {};
@@ -2898,16 +3006,29 @@ cn_comp_commit(struct cn_compaction_work *w)
             km.km_node_level = w->cw_node->tn_loc.node_level;
             km.km_node_offset = w->cw_node->tn_loc.node_offset;
         }
-        w->cw_err =
-            cndb_txn_meta(w->cw_tree->cndb, w->cw_work_txid, w->cw_tree->cnid, w->cw_tagv[i], &km);
-        if (ev(w->cw_err))
-            goto done;
+
+        kmbuf[i] = km;
+        kmv[kmc] = &kmbuf[i];
+        tagv[kmc] = w->cw_tagv[i];
+        kmc++;
+    }
+
+    /* Journal the metadata of all output kvsets with a single sync.
+     */
+    w->cw_err =
+        cndb_txn_metav(w->cw_tree->cndb, w->cw_work_txid, w->cw_tree->cnid, kmc, tagv, kmv);
+    if (ev(w->cw_err))
+        goto done;
+
+    for (i = 0; i < w->cw_outc; i++) {
+        if (w->cw_outv[i].kblks.n_blks == 0)
+            continue;
 
         if (use_mbsets) {
             w->cw_err = kvset_create2(
-                w->cw_tree, w->cw_tagv[i], &km, w->cw_kvset_cnt, cnts, vecs, &kvsets[i]);
+                w->cw_tree, w->cw_tagv[i], &kmbuf[i], w->cw_kvset_cnt, cnts, vecs, &kvsets[i]);
         } else {
-            w->cw_err = kvset_create(w->cw_tree, w->cw_tagv[i], &km, &kvsets[i]);
+            w->cw_err = kvset_create(w->cw_tree, w->cw_tagv[i], &kmbuf[i], &kvsets[i]);
         }
         if (ev(w->cw_err))
             goto done;
@@ -2917,6 +3038,9 @@ cn_comp_commit(struct cn_compaction_work *w)
         w->cw_err = cn_comp_commit_spill(w, kvsets);
     else
         w->cw_err = cn_comp_commit_kvcompact(w, kvsets[0]);
+
+    if (!w->cw_err)
+        cn_tree_summary_update(w->cw_tree, w->cw_outc);
 done:
     if (w->cw_err && kvsets) {
         for (i = 0; i < w->cw_outc; i++) {
@@ -3034,6 +3158,7 @@ static void
 cn_comp_compact(struct cn_compaction_work *w)
 {
     struct kvdb_health *hp;
+    struct timespec     cpu0, cpu1;
 
     bool   kcompact = w->cw_action == CN_ACTION_COMPACT_K;
     bool   skip_commit = false;
@@ -3043,6 +3168,8 @@ cn_comp_compact(struct cn_compaction_work *w)
     if (ev(w->cw_err))
         return;
 
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu0);
+
     w->cw_horizon = cn_get_seqno_horizon(w->cw_tree->cn);
     w->cw_cancel_request = cn_get_cancel(w->cw_tree->cn);
 
@@ -3096,6 +3223,10 @@ cn_comp_compact(struct cn_compaction_work *w)
 
     w->cw_t3_build = get_time_ns();
 
+    for (i = 0; i < w->cw_outc; i++)
+        if (w->cw_outv[i].kblks.n_blks > 0)
+            w->cw_outk++;
+
     /* if k-compaction and no kblocks, then force keepv to false. */
     if (kcompact && w->cw_outv[0].kblks.n_blks == 0) {
         skip_commit = true;
@@ -3148,6 +3279,9 @@ cn_comp_compact(struct cn_compaction_work *w)
     w->cw_t4_commit = get_time_ns();
 
 err_exit:
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu1);
+    w->cw_cpu_ns = (cpu1.tv_sec - cpu0.tv_sec) * NSEC_PER_SEC + cpu1.tv_nsec - cpu0.tv_nsec;
+
     w->cw_err = err;
     if (w->cw_canceled && !w->cw_err)
         w->cw_err = merr(ESHUTDOWN);
@@ -3165,6 +3299,24 @@ cn_comp_finish(struct cn_compaction_work *w)
     cn_comp_release(w);
 }
 
+void
+cn_comp_apply(struct cn_compaction_work *w, struct kvset **kvsets)
+{
+    struct spill_child *childv;
+
+    if (w->cw_action == CN_ACTION_SPILL) {
+        w->cw_err = cn_comp_spill_children(w, kvsets, &childv);
+        if (!w->cw_err) {
+            cn_comp_update_spill(w, childv);
+            free(childv);
+        }
+    } else {
+        cn_comp_update_kvcompact(w, kvsets[0]);
+    }
+
+    cn_comp_release(w);
+}
+
 /**
  * cn_comp() - perform a cn tree compaction operation
  *
@@ -3212,7 +3364,7 @@ cn_comp(struct cn_compaction_work *w)
         w = NULL;
     }
 
-    perfc_lat_record(pc, PERFC_LT_CNCOMP_TOTAL, tstart);
+    perfc_lat_record(pc, PERFC_HG_CNCOMP_TOTAL, tstart);
     cn_ref_put(cn);
 }
 
@@ -3273,6 +3425,48 @@ cn_tree_ingest_update(struct cn_tree *tree, struct kvset *kvset, void *ptomb, ui
         cn_get_sched(tree->cn), tree, post.r_alen - pre.r_alen, post.r_wlen - pre.r_wlen);
 }
 
+u64
+cn_tree_range_count_est(
+    struct cn_tree *         tree,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end)
+{
+    struct cn_tree_node *    tn;
+    struct kvset_list_entry *le;
+    struct tree_iter         iter;
+    void *                   lock;
+    u64                      count = 0;
+    uint                     n = 0;
+
+    rmlock_rlock(&tree->ct_lock, &lock);
+
+    tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+
+    while (NULL != (tn = tree_iter_next(tree, &iter))) {
+        const struct cn_node_stats *ns = &tn->tn_ns;
+        const uint                  pct_scale = 1024;
+        u64                         keys = 0;
+
+        list_for_each_entry (le, &tn->tn_kvset_list, le_link)
+            keys += kvset_range_keys_est(le->le_kvset, start, end);
+
+        /* A key may appear in several of a node's kvsets, so discount
+         * the duplicates by the node's ratio of unique keys (estimated
+         * from its hlog) to total keys.
+         */
+        if (keys && ns->ns_keys_uniq && cn_ns_keys(ns))
+            keys = keys * (pct_scale * ns->ns_keys_uniq / cn_ns_keys(ns)) / pct_scale;
+
+        count += keys;
+
+        if ((++n % 128) == 0)
+            rmlock_yield(&tree->ct_lock, &lock);
+    }
+    rmlock_runlock(lock);
+
+    return count;
+}
+
 void
 cn_tree_perfc_shape_report(
     struct cn_tree *  tree,
@@ -3356,7 +3550,12 @@ cn_tree_node_mclass(struct cn_tree_node *tn, enum hse_mclass_policy_dtype dtype)
 
     INVARIANT(tn);
 
+    /* Trees without a cn (e.g., cn_sim's) live on the capacity media class.
+     */
     policy = cn_get_mclass_policy(tn->tn_tree->cn);
+    if (!policy)
+        return HSE_MCLASS_CAPACITY;
+
     age = cn_node_isleaf(tn) ? HSE_MPOLICY_AGE_LEAF :
         (cn_node_isroot(tn) ? HSE_MPOLICY_AGE_ROOT : HSE_MPOLICY_AGE_INTERNAL);
 
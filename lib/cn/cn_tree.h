@@ -61,6 +61,22 @@ cn_tree_lookup(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+/**
+ * cn_tree_range_count_est() - estimate the number of keys in [start, end)
+ * @tree:  tree to examine
+ * @start: first key of the range (inclusive)
+ * @end:   last key of the range (exclusive)
+ *
+ * Sums kvset_range_keys_est() over each node's kvsets, discounted by the
+ * node's hlog estimate of unique keys.  Keys duplicated across nodes are
+ * counted once per node.
+ */
+u64
+cn_tree_range_count_est(
+    struct cn_tree *         tree,
+    const struct kvs_ktuple *start,
+    const struct kvs_ktuple *end);
+
 /**
  * cn_tree_initial_dgen() - return most current dgen in tree
  * @tree: tree to query
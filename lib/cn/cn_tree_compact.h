@@ -21,6 +21,7 @@
 
 struct cn_tree;
 struct cn_tree_node;
+struct cn_qos_budget;
 struct kv_iterator;
 struct kvset_list_entry;
 struct kvset_mblocks;
@@ -153,6 +154,8 @@ struct cn_work_est {
  * @cw_dgen_lo:      the dgen of the oldest kvset to be compacted
  * @cw_active_count: for tracking the number of active "root" or "other" threads
  * @cw_horizon:      sequence number horizon to use while compacting
+ * @cw_qos_rd:       compaction read budget (optional)
+ * @cw_qos_wr:       compaction write budget (optional)
  * @cw_outc:         number of output kvsets
  * @cw_outv:         outputs (mblock ids used to make output kvsets)
  * @cw_inputv:       number of input kvsets
@@ -171,6 +174,8 @@ struct cn_work_est {
  * @cw_t2_prep:      debug stats
  * @cw_t3_build:     debug stats
  * @cw_t4_commit:    debug stats
+ * @cw_cpu_ns:       cpu time consumed by the compaction thread
+ * @cw_outk:         number of non-empty output kvsets
  * @cw_t5_update:    debug stats
  */
 struct cn_compaction_work {
@@ -189,6 +194,8 @@ struct cn_compaction_work {
     struct mpool *           cw_ds;
     struct kvs_rparams *     cw_rp;
     struct kvs_cparams *     cw_cp;
+    struct cn_qos_budget *   cw_qos_rd;
+    struct cn_qos_budget *   cw_qos_wr;
 
     /* initialized in constructor (cn_tree_find_compaction_candidate) */
     struct cn_tree *         cw_tree;
@@ -246,6 +253,8 @@ struct cn_compaction_work {
     u64  cw_t2_prep;
     u64  cw_t3_build;
     u64  cw_t4_commit;
+    u64  cw_cpu_ns;
+    uint cw_outk;
     char cw_threadname[16];
 };
 
@@ -262,6 +271,20 @@ cn_tree_ingest_update(
 void
 cn_tree_capped_compact(struct cn_tree *tree);
 
+/**
+ * cn_comp_apply() - apply the output of a compaction run outside of cn_comp()
+ * @w:      work from sp3_work(), with @w->cw_outc set
+ * @kvsets: output kvsets, one per child for a spill, else at most one
+ *
+ * Updates the tree as cn_comp_commit() would, less the cndb transaction,
+ * and then releases the work.  This lets an offline driver of the
+ * scheduler (e.g., cn_sim) use the real tree update and samp accounting.
+ * Concurrent root spills must be applied in the order they were created.
+ */
+/* PRIVATE */
+void
+cn_comp_apply(struct cn_compaction_work *w, struct kvset **kvsets);
+
 /* MTF_MOCK */
 bool
 cn_node_comp_token_get(struct cn_tree_node *tn);
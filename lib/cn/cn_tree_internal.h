@@ -91,6 +91,7 @@ struct cn_khashmap {
  * @cndb:  handle for cndb (the metadata journal/log)
  * @cnid:  cndb's identifier for this cn tree
  * @ct_dgen_init:
+ * @ct_kvsname:     name of the kvs (empty if unknown)
  * @ct_r_nodec:
  * @ct_l_nodec:
  * @ct_l_samp:
@@ -101,6 +102,9 @@ struct cn_khashmap {
  * @ct_last_ptseq:
  * @ct_last_ptlen:  length of @ct_last_ptomb
  * @ct_last_ptomb:  if cn is a capped, this holds the last (largest) ptomb in cn
+ * @ct_summary_dirty: kvsets committed since the summary was last saved
+ * @ct_summary_busy:  a background save of the summary is in progress
+ * @ct_summary_work:  work item for the background save of the summary
  * @ct_kle_cache:   kvset list entry cache
  * @ct_lock:        read-mostly lock to protect kvset list
  *
@@ -121,6 +125,7 @@ struct cn_tree {
 
     struct route_map  *ct_route_map;
     struct cn_tstate  *ct_tstate;
+    struct cn_summary *ct_summary;
     struct cn_khashmap ct_khmbuf;
 
     struct cndb *       cndb;
@@ -128,6 +133,7 @@ struct cn_tree {
     struct kvs_cparams *ct_cp;
     u64                 cnid;
     u64                 ct_dgen_init;
+    char                ct_kvsname[HSE_KVS_NAME_LEN_MAX];
 
     uint                 ct_i_nodec;
     uint                 ct_l_nodec;
@@ -148,6 +154,10 @@ struct cn_tree {
     u32 ct_last_ptlen;
     u8  ct_last_ptomb[HSE_KVS_PFX_LEN_MAX];
 
+    atomic_uint    ct_summary_dirty;
+    atomic_int     ct_summary_busy;
+    struct cn_work ct_summary_work;
+
     struct cn_kle_cache ct_kle_cache HSE_L1D_ALIGNED;
 
     struct rmlock ct_lock;
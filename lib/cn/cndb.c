@@ -2706,37 +2706,36 @@ errout:
     return err;
 }
 
-/* PRIVATE */
 /**
- * cndb_accept() - appends one record in the cndb mdc
+ * cndb_accept_reserve() - make room in the cndb for @nrec records
  *
- * Only function beside cndb_rollover() to write in the cndb mdc.
+ * Rolls the cndb over if the working set or the mdc are above their
+ * high water marks.
  *
  * @cndb:
- * @data: the record in omf format
+ * @sz:   total size of the records in omf format
+ * @nrec: number of records
  */
 static merr_t
-cndb_accept(struct cndb *cndb, void *data, size_t sz)
+cndb_accept_reserve(struct cndb *cndb, size_t sz, int nrec)
 {
-    merr_t          err;
-    size_t          usage = 0;
-    u32             mtlen;
-    union cndb_mtu *mtu = NULL;
-    int             count;
-    static int      odometer;
+    merr_t     err;
+    size_t     usage = 0;
+    int        count;
+    static int odometer;
 
     assert(cndb->cndb_kvdb_health);
 
     if (cndb->cndb_read_only) {
         err = merr(EROFS);
         CNDB_LOG_ERR(err, cndb, "");
-        goto errout;
+        return err;
     }
 
     err = mpool_mdc_usage(cndb->cndb_mdc, NULL, &usage);
     if (err) {
         CNDB_LOG_ERR(err, cndb, " statistics unavailable");
-        goto errout;
+        return err;
     }
 
     count = cndb->cndb_workc + cndb->cndb_keepc;
@@ -2750,22 +2749,22 @@ cndb_accept(struct cndb *cndb, void *data, size_t sz)
             odometer++);
     assert(count <= cndb->cndb_entries);
 
-    if (count >= cndb->cndb_entries_high_water || usage >= cndb->cndb_high_water) {
+    if (count + nrec > cndb->cndb_entries_high_water || usage >= cndb->cndb_high_water) {
         err = cndb_rollover(cndb);
         if (err) {
             cndb->cndb_read_only = true;
             CNDB_LOG_ERR(err, cndb, " rollover failed");
-            goto errout;
+            return err;
         }
 
         err = mpool_mdc_usage(cndb->cndb_mdc, NULL, &usage);
         if (err) {
             CNDB_LOG_ERR(err, cndb, " statistics unavailable");
-            goto errout;
+            return err;
         }
 
         count = cndb->cndb_workc + cndb->cndb_keepc;
-        if (count >= cndb->cndb_entries_high_water) {
+        if (count + nrec > cndb->cndb_entries_high_water) {
             err = cndb_grow(cndb, usage + sz);
             if (err)
                 CNDB_LOG_WARN(
@@ -2778,59 +2777,195 @@ cndb_accept(struct cndb *cndb, void *data, size_t sz)
             err = 0; /* suppress because working set has room */
         }
 
-        if ((usage + sz) >= cndb->cndb_captgt || count >= cndb->cndb_entries) {
+        if ((usage + sz) >= cndb->cndb_captgt || count + nrec > cndb->cndb_entries) {
             cndb->cndb_read_only = true;
             err = merr(ENOSPC);
             CNDB_LOG_ERR(err, cndb, " MDC full");
             kvdb_health_event(cndb->cndb_kvdb_health, KVDB_HEALTH_FLAG_CNDBFAIL, err);
-            goto errout;
+            return err;
         }
 
-        goto accept_record;
+        return 0;
     }
 
     /* Don't shrink unless about 1/3 is empty */
     if (cndb->cndb_entries > ((count * 3) / 2))
         cndb_shrink(cndb);
 
-accept_record:
+    return 0;
+}
 
-    if (omf_cnhdr_type(data) != CNDB_TYPE_INFO && omf_cnhdr_type(data) != CNDB_TYPE_INFOD) {
-        err = omf2len(data, CNDB_VERSION, &mtlen);
-        if (err || !mtlen) {
-            err = merr(EPROTO);
-            CNDB_LOG_ERR(err, cndb, " invalid record");
-            goto errout;
-        }
+/**
+ * cndb_accept_mtx() - convert a record to its in-memory form
+ *
+ * @cndb:
+ * @data: the record in omf format
+ * @mtup: (output) the in-memory record, NULL for records that are not
+ *        kept in the working set
+ */
+static merr_t
+cndb_accept_mtx(struct cndb *cndb, void *data, union cndb_mtu **mtup)
+{
+    union cndb_mtu *mtu;
+    merr_t          err;
+    u32             mtlen;
+
+    *mtup = NULL;
+
+    if (omf_cnhdr_type(data) == CNDB_TYPE_INFO || omf_cnhdr_type(data) == CNDB_TYPE_INFOD)
+        return 0;
+
+    err = omf2len(data, CNDB_VERSION, &mtlen);
+    if (err || !mtlen) {
+        err = merr(EPROTO);
+        CNDB_LOG_ERR(err, cndb, " invalid record");
+        return err;
+    }
+
+    mtu = calloc(1, mtlen);
+    if (!mtu) {
+        err = merr(ENOMEM);
+        CNDB_LOG_ERR(err, cndb, "");
+        return err;
+    }
+
+    err = omf2mtx(mtu, &mtlen, data, CNDB_VERSION);
+    if (err) {
+        CNDB_LOG_ERR(err, cndb, " invalid OMF");
+        free(mtu);
+        return err;
+    }
+
+    *mtup = mtu;
+
+    return 0;
+}
+
+static void
+cndb_accept_insert(struct cndb *cndb, union cndb_mtu *mtu)
+{
+    if (!mtu)
+        return;
+
+    cndb->cndb_workv[cndb->cndb_workc++] = mtu;
+    cndb->cndb_compacted = false;
+    assert(cndb->cndb_workc + cndb->cndb_keepc <= cndb->cndb_entries);
+}
+
+/* PRIVATE */
+/**
+ * cndb_accept() - appends one record in the cndb mdc
+ *
+ * Only function beside cndb_rollover() and cndb_acceptv() to write in the
+ * cndb mdc.
+ *
+ * @cndb:
+ * @data: the record in omf format
+ */
+static merr_t
+cndb_accept(struct cndb *cndb, void *data, size_t sz)
+{
+    union cndb_mtu *mtu;
+    merr_t          err;
+
+    err = cndb_accept_reserve(cndb, sz, 1);
+    if (err)
+        return err;
+
+    err = cndb_accept_mtx(cndb, data, &mtu);
+    if (err)
+        return err;
+
+    cndb_accept_insert(cndb, mtu);
+
+    err = mpool_mdc_append(cndb->cndb_mdc, data, sz, true);
+    if (err) {
+        struct cndb_hdr_omf *hdr = data;
+
+        kvdb_health_error(cndb->cndb_kvdb_health, err);
+        CNDB_LOGTX_ERR(err, cndb, mtxid(mtu), " append failed (type %d)", hdr->cnhdr_type);
+    }
+
+    return err;
+}
+
+/**
+ * cndb_acceptv() - appends a batch of records in the cndb mdc
+ *
+ * The records are appended with a single mdc write and a single sync.
+ * Either all records are added to the working set or none are.
+ *
+ * @cndb:
+ * @iov:  the records in omf format, one per element
+ * @iovc: number of records
+ */
+static merr_t
+cndb_acceptv(struct cndb *cndb, struct iovec *iov, int iovc)
+{
+    union cndb_mtu **mtuv;
+    size_t           sz, szmax;
+    merr_t           err;
+    int              i;
+
+    if (ev(iovc < 1))
+        return merr(EINVAL);
+
+    sz = szmax = 0;
+    for (i = 0; i < iovc; i++) {
+        sz += iov[i].iov_len;
+        szmax = max_t(size_t, szmax, iov[i].iov_len);
+    }
+
+    /* cndb_rollover() reuses cndb_cbuf for every record it rewrites,
+     * so it must be able to hold the largest record in the batch.
+     */
+    if (szmax > cndb->cndb_cbufsz) {
+        void *buf = malloc(szmax);
 
-        mtu = calloc(1, mtlen);
-        if (!mtu) {
+        if (!buf) {
             err = merr(ENOMEM);
             CNDB_LOG_ERR(err, cndb, "");
-            goto errout;
+            return err;
         }
 
-        err = omf2mtx(mtu, &mtlen, data, CNDB_VERSION);
+        free(cndb->cndb_cbuf);
+        cndb->cndb_cbuf = buf;
+        cndb->cndb_cbufsz = szmax;
+    }
+
+    mtuv = calloc(iovc, sizeof(*mtuv));
+    if (!mtuv) {
+        err = merr(ENOMEM);
+        CNDB_LOG_ERR(err, cndb, "");
+        return err;
+    }
+
+    err = cndb_accept_reserve(cndb, sz, iovc);
+    if (err)
+        goto errout;
+
+    for (i = 0; i < iovc; i++) {
+        err = cndb_accept_mtx(cndb, iov[i].iov_base, &mtuv[i]);
         if (err) {
-            CNDB_LOG_ERR(err, cndb, " invalid OMF");
-            free(mtu);
+            while (i-- > 0)
+                free(mtuv[i]);
             goto errout;
         }
-        cndb->cndb_workv[cndb->cndb_workc++] = mtu;
-        cndb->cndb_compacted = false;
-        count = cndb->cndb_workc + cndb->cndb_keepc;
-        assert(count <= cndb->cndb_entries);
     }
 
-    err = mpool_mdc_append(cndb->cndb_mdc, data, sz, true);
-    if (err) {
-        struct cndb_hdr_omf *hdr = data;
+    for (i = 0; i < iovc; i++)
+        cndb_accept_insert(cndb, mtuv[i]);
 
+    err = mpool_mdc_appendv(cndb->cndb_mdc, iov, iovc, true);
+    if (err) {
         kvdb_health_error(cndb->cndb_kvdb_health, err);
-        CNDB_LOGTX_ERR(err, cndb, mtxid(mtu), " append failed (type %d)", hdr->cnhdr_type);
+        CNDB_LOGTX_ERR(err, cndb, mtuv[0] ? mtxid(mtuv[0]) : 0,
+                       " appendv failed (%d records)", iovc);
     }
 
 errout:
+    free(mtuv);
+
     return err;
 }
 
@@ -2846,6 +2981,19 @@ cndb_journal(struct cndb *cndb, void *data, size_t sz)
     return ev(err);
 }
 
+/* PRIVATE */
+merr_t
+cndb_journalv(struct cndb *cndb, struct iovec *iov, int iovc)
+{
+    merr_t err;
+
+    mutex_lock(&cndb->cndb_lock);
+    err = cndb_acceptv(cndb, iov, iovc);
+    mutex_unlock(&cndb->cndb_lock);
+
+    return ev(err);
+}
+
 /* PRIVATE */
 merr_t
 cndb_journal_adopt(struct cndb *cndb, void **data, size_t sz)
@@ -3078,6 +3226,52 @@ cndb_txn_start(struct cndb *cndb, u64 *txid, int nc, int nd, u64 seqno, u64 inge
     return err;
 }
 
+static size_t
+cndb_txc_len(struct kvset_mblocks *mblocks)
+{
+    int cnt = 0;
+
+    if (mblocks)
+        cnt = mblocks->kblks.n_blks + mblocks->vblks.n_blks;
+
+    return sizeof(struct cndb_txc_omf) + cnt * sizeof(u64);
+}
+
+static void
+cndb_txc_pack(
+    struct cndb_txc_omf * txc,
+    size_t                sz,
+    u64                   txid,
+    u64                   cnid,
+    u64                   tag,
+    struct kvset_mblocks *mblocks,
+    u32                   keepvbc)
+{
+    struct cndb_oid_omf *pblks;
+    int                  i;
+
+    memset(txc, 0, sz);
+
+    pblks = (void *)&txc[1];
+
+    cndb_set_hdr(&txc->hdr, CNDB_TYPE_TXC, sz);
+    omf_set_txc_cnid(txc, cnid);
+    omf_set_txc_id(txc, txid);
+    omf_set_txc_tag(txc, tag);
+
+    omf_set_txc_keepvbc(txc, keepvbc);
+    if (mblocks) {
+        omf_set_txc_kcnt(txc, mblocks->kblks.n_blks);
+        omf_set_txc_vcnt(txc, mblocks->vblks.n_blks);
+
+        for (i = 0; i < mblocks->kblks.n_blks; i++)
+            omf_set_cndb_oid(pblks++, mblocks->kblks.blks[i].bk_blkid);
+
+        for (i = 0; i < mblocks->vblks.n_blks; i++)
+            omf_set_cndb_oid(pblks++, mblocks->vblks.blks[i].bk_blkid);
+    }
+}
+
 merr_t
 cndb_txn_txc(
     struct cndb *         cndb,
@@ -3090,21 +3284,14 @@ cndb_txn_txc(
     struct cndb_txc_omf  txcbuf[1024 / sizeof(struct cndb_txc_omf)];
     struct cndb_txc_omf *txc = txcbuf;
     merr_t               err;
-    int                  i, cnt;
     size_t               sz;
-    struct cndb_oid_omf *pblks;
 
     /* [HSE_REVISIT] consider optimizing empty C / Cmeta records away
      * and relaxing the requirement that when the tx record specifies
      * a count of C records, that many records must exist even if some
      * are empty.
      */
-    if (mblocks == NULL)
-        cnt = 0;
-    else
-        cnt = mblocks->kblks.n_blks + mblocks->vblks.n_blks;
-
-    sz = sizeof(*txc) + cnt * sizeof(u64);
+    sz = cndb_txc_len(mblocks);
     ev(sz > cndb->cndb_cbufsz);
 
     if (ev(sz > sizeof(txcbuf) || sz > cndb->cndb_cbufsz)) {
@@ -3115,29 +3302,10 @@ cndb_txn_txc(
         }
     }
 
-    memset(txc, 0, sz);
-
-    pblks = (void *)&txc[1];
-
-    cndb_set_hdr(&txc->hdr, CNDB_TYPE_TXC, sz);
-    omf_set_txc_cnid(txc, cnid);
-    omf_set_txc_id(txc, txid);
-
     /* tags for a given txid start at txid and monotonically increase */
     *tag = *tag ? *tag + 1 : txid;
-    omf_set_txc_tag(txc, *tag);
 
-    omf_set_txc_keepvbc(txc, keepvbc);
-    if (mblocks) {
-        omf_set_txc_kcnt(txc, mblocks->kblks.n_blks);
-        omf_set_txc_vcnt(txc, mblocks->vblks.n_blks);
-
-        for (i = 0; i < mblocks->kblks.n_blks; i++)
-            omf_set_cndb_oid(pblks++, mblocks->kblks.blks[i].bk_blkid);
-
-        for (i = 0; i < mblocks->vblks.n_blks; i++)
-            omf_set_cndb_oid(pblks++, mblocks->vblks.blks[i].bk_blkid);
-    }
+    cndb_txc_pack(txc, sz, txid, cnid, *tag, mblocks, keepvbc);
 
     err = cndb_journal_adopt(cndb, (void **)&txc, sz);
     ev(err);
@@ -3149,6 +3317,73 @@ out:
     return err;
 }
 
+merr_t
+cndb_txn_txcv(
+    struct cndb *         cndb,
+    u64                   txid,
+    u64                   cnid,
+    u64 *                 tag,
+    int                   n,
+    struct kvset_mblocks *mblocksv,
+    bool                  keepvbs,
+    u64 *                 tagv)
+{
+    struct iovec *iov;
+    size_t        sz, off;
+    char         *buf;
+    merr_t        err;
+    u64           t;
+    int           i;
+
+    if (n == 1) {
+        err = cndb_txn_txc(
+            cndb, txid, cnid, tag, mblocksv, keepvbs ? mblocksv->vblks.n_blks : 0);
+        if (!err)
+            tagv[0] = *tag;
+
+        return err;
+    }
+
+    if (n < 1)
+        return n ? merr(EINVAL) : 0;
+
+    sz = 0;
+    for (i = 0; i < n; i++)
+        sz += cndb_txc_len(&mblocksv[i]);
+
+    iov = malloc(n * sizeof(*iov) + sz);
+    if (ev(!iov))
+        return merr(ENOMEM);
+
+    buf = (char *)(iov + n);
+    off = 0;
+    t = *tag;
+
+    for (i = 0; i < n; i++) {
+        struct kvset_mblocks *mb = &mblocksv[i];
+
+        /* tags for a given txid start at txid and monotonically increase */
+        t = t ? t + 1 : txid;
+        tagv[i] = t;
+
+        iov[i].iov_base = buf + off;
+        iov[i].iov_len = cndb_txc_len(mb);
+
+        cndb_txc_pack(
+            iov[i].iov_base, iov[i].iov_len, txid, cnid, t, mb, keepvbs ? mb->vblks.n_blks : 0);
+
+        off += iov[i].iov_len;
+    }
+
+    err = cndb_journalv(cndb, iov, n);
+    if (!ev(err))
+        *tag = t;
+
+    free(iov);
+
+    return err;
+}
+
 merr_t
 cndb_txn_txd(struct cndb *cndb, u64 txid, u64 cnid, u64 tag, int n_oids, u64 *oidv)
 {
@@ -3197,30 +3432,72 @@ out:
     return err;
 }
 
+static void
+cndb_txm_pack(struct cndb_txm_omf *txm, u64 txid, u64 cnid, u64 tag, struct kvset_meta *km)
+{
+    assert(tag != 0);
+
+    memset(txm, 0, sizeof(*txm));
+
+    cndb_set_hdr(&txm->hdr, CNDB_TYPE_TXM, sizeof(*txm));
+    omf_set_txm_cnid(txm, cnid);
+    omf_set_txm_id(txm, txid);
+    omf_set_txm_tag(txm, tag);
+    omf_set_txm_level(txm, km->km_node_level);
+    omf_set_txm_offset(txm, km->km_node_offset);
+    omf_set_txm_dgen(txm, km->km_dgen);
+    omf_set_txm_vused(txm, km->km_vused);
+    omf_set_txm_compc(txm, km->km_compc);
+    omf_set_txm_scatter(txm, km->km_scatter);
+}
+
 merr_t
 cndb_txn_meta(struct cndb *cndb, u64 txid, u64 cnid, u64 tag, struct kvset_meta *km)
 {
-    struct cndb_txm_omf txm = {};
+    struct cndb_txm_omf txm;
     merr_t              err;
 
-    assert(tag != 0);
-
-    cndb_set_hdr(&txm.hdr, CNDB_TYPE_TXM, sizeof(txm));
-    omf_set_txm_cnid(&txm, cnid);
-    omf_set_txm_id(&txm, txid);
-    omf_set_txm_tag(&txm, tag);
-    omf_set_txm_level(&txm, km->km_node_level);
-    omf_set_txm_offset(&txm, km->km_node_offset);
-    omf_set_txm_dgen(&txm, km->km_dgen);
-    omf_set_txm_vused(&txm, km->km_vused);
-    omf_set_txm_compc(&txm, km->km_compc);
-    omf_set_txm_scatter(&txm, km->km_scatter);
+    cndb_txm_pack(&txm, txid, cnid, tag, km);
 
     err = cndb_journal(cndb, &txm, sizeof(txm));
 
     return ev(err);
 }
 
+merr_t
+cndb_txn_metav(struct cndb *cndb, u64 txid, u64 cnid, int n, u64 *tagv, struct kvset_meta **kmv)
+{
+    struct cndb_txm_omf *txmv;
+    struct iovec        *iov;
+    merr_t               err;
+    int                  i;
+
+    if (n == 1)
+        return cndb_txn_meta(cndb, txid, cnid, tagv[0], kmv[0]);
+
+    if (n < 1)
+        return n ? merr(EINVAL) : 0;
+
+    iov = malloc(n * (sizeof(*iov) + sizeof(*txmv)));
+    if (ev(!iov))
+        return merr(ENOMEM);
+
+    txmv = (void *)(iov + n);
+
+    for (i = 0; i < n; i++) {
+        cndb_txm_pack(&txmv[i], txid, cnid, tagv[i], kmv[i]);
+
+        iov[i].iov_base = &txmv[i];
+        iov[i].iov_len = sizeof(txmv[i]);
+    }
+
+    err = cndb_journalv(cndb, iov, n);
+
+    free(iov);
+
+    return ev(err);
+}
+
 /* PRIVATE */
 merr_t
 cndb_txn_ack(struct cndb *cndb, u64 txid, u64 tag, u64 cnid)
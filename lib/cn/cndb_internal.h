@@ -498,6 +498,16 @@ cndb_cnv_get(struct cndb *cndb, u64 cnid, struct cndb_cn **cn_out);
 merr_t
 cndb_cnv_del(struct cndb *cndb, int idx);
 
+/**
+ * cndb_journalv() - journal a batch of records with a single mdc sync
+ * @cndb: cndb handle
+ * @iov:  records in omf format, one per element
+ * @iovc: number of records
+ */
+/* PRIVATE */
+merr_t
+cndb_journalv(struct cndb *cndb, struct iovec *iov, int iovc);
+
 void
 cndb_set_hdr(struct cndb_hdr_omf *hdr, int type, int len);
 
@@ -57,6 +57,12 @@ csched_throttle_sensor(struct csched *handle, struct throttle_sensor *sensor)
     sp3_throttle_sensor(handle, sensor);
 }
 
+void
+csched_throttle_debt(struct csched *handle, struct throttle_debt *debt)
+{
+    sp3_throttle_debt(handle, debt);
+}
+
 void
 csched_compact_request(struct csched *handle, int flags)
 {
@@ -69,6 +75,18 @@ csched_compact_status_get(struct csched *handle, struct hse_kvdb_compact_status
     sp3_compact_status_get(handle, status);
 }
 
+void
+csched_qinfo_get(struct csched *handle, uint *jobsv, uint *threadsv)
+{
+    sp3_qinfo_get(handle, jobsv, threadsv);
+}
+
+void
+csched_history_get(struct csched *handle, struct csched_history *hist)
+{
+    sp3_history_get(handle, hist);
+}
+
 #if HSE_MOCKING
 #include "csched_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -13,6 +13,7 @@
 #include <hse_util/alloc.h>
 #include <hse_util/slab.h>
 #include <hse_util/rest_api.h>
+#include <hse_util/numa.h>
 
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/ikvdb.h>
@@ -27,6 +28,7 @@
 
 #include "cn_tree_compact.h"
 #include "cn_tree_internal.h"
+#include "cn_qos.h"
 #include "kvset.h"
 
 struct mpool;
@@ -179,6 +181,12 @@ struct sp3_qinfo {
     uint qjobs_max;
 };
 
+struct periodic_check {
+    u64 interval;
+    u64 next;
+    u64 prev;
+};
+
 /**
  * struct sp3 - kvdb scheduler policy
  * @ds:           to access mpool qos
@@ -196,6 +204,17 @@ struct sp3_qinfo {
  * @samp_reduce:  if true, compact while samp > LWM
  * @mon_wq:       monitor thread workqueue
  * @mon_work:     monitor thread work struct
+ * @chk_qos:      monitor loop schedule for sp3_qos_check()
+ * @chk_sched:    monitor loop schedule for idle calls to sp3_schedule()
+ * @chk_refresh:  monitor loop schedule for sp3_refresh_settings()
+ * @chk_shape:    monitor loop schedule for sp3_tree_shape_check()
+ * @now:          time of the current monitor loop pass
+ * @submit:       job submission hook of an offline scheduler, else NULL
+ * @hist_lock:    protects the compaction history and @mon_tlist membership
+ * @hist_jobs:    number of jobs recorded in the compaction history
+ * @hist_ingest:  bytes ingested into all trees
+ * @hist_rulev:   per-rule compaction stats, indexed by enum cn_comp_rule
+ * @hist_jobv:    ring of the most recently finished jobs
  * @name:         name for logging and data tree
  */
 struct sp3 {
@@ -205,6 +224,7 @@ struct sp3 {
     struct sts              *sts;
     struct sp3_thresholds    thresh;
     struct throttle_sensor  *throttle_sensor_root;
+    struct throttle_debt    *throttle_debt;
     struct kvdb_health      *health;
     atomic_int               running;
     struct sp3_qinfo         qinfo[SP3_QNUM_MAX];
@@ -222,9 +242,19 @@ struct sp3 {
     uint             jobs_finished;
     uint             jobs_max;
     uint             rr_job_type;
+    uint             prio_mask;
     u64              job_id;
+    u64              last_activity;
+    bool             bad_health;
+
+    struct periodic_check chk_qos;
+    struct periodic_check chk_sched;
+    struct periodic_check chk_refresh;
+    struct periodic_check chk_shape;
+    u64                   now;
 
     struct cn_compaction_work *wp;
+    sp3_submit_fn             *submit;
 
     struct {
         /* mirror selected kvdb_rparams */
@@ -253,6 +283,7 @@ struct sp3 {
     /* Throttle sensors */
     u64         rspill_dt_prev;
     atomic_long rspill_dt;
+    u64         rspill_bps_prev;
 
 
     u64 qos_log_ttl;
@@ -283,6 +314,13 @@ struct sp3 {
     bool ucomp_active;
     bool ucomp_canceled;
 
+    /* Updated by monitor, read by REST threads */
+    struct mutex             hist_lock HSE_L1D_ALIGNED;
+    u64                      hist_jobs;
+    u64                      hist_ingest;
+    struct csched_rule_stats hist_rulev[CSCHED_HIST_RULES];
+    struct csched_job_rec    hist_jobv[CSCHED_HIST_JOBS];
+
     /* The following fields are rarely touched.
      */
     struct workqueue_struct *mon_wq;
@@ -975,7 +1013,7 @@ sp3_ucomp_check(struct sp3 *sp)
     if (sp->ucomp_active) {
 
         bool completed = sp->idle || sp->samp_curr < sp->samp_lwm;
-        u64  now = get_time_ns();
+        u64  now = sp->now;
         bool report = now > sp->ucomp_prev_report_ns + 5 * NSEC_PER_SEC;
 
         if (completed) {
@@ -1139,7 +1177,7 @@ sp3_dirty_node_locked(struct sp3 *sp, struct cn_tree_node *tn)
         if (nkvsets >= 2 && jobs < 1) {
             if (sp->thresh.llen_idlec > 0 && sp->thresh.llen_idlem > 0) {
                 uint64_t ttl = sp->thresh.llen_idlem * 60;
-                uint64_t weight = UINT32_MAX - (jclock_ns >> 32) - ttl;
+                uint64_t weight = UINT32_MAX - (sp->now >> 32) - ttl;
 
                 weight = (weight << 32) | nkvsets;
 
@@ -1206,7 +1244,7 @@ sp3_dirty_node_locked(struct sp3 *sp, struct cn_tree_node *tn)
             scatter = sp3_node_scatter_score_compute(spn);
 
             if (scatter >= SP3_LSCAT_THRESH_MIN) {
-                uint64_t weight = UINT32_MAX - (jclock_ns >> 32) - spn->spn_ttl;
+                uint64_t weight = UINT32_MAX - (sp->now >> 32) - spn->spn_ttl;
 
                 /* Inserts within the same 4-second window are sorted
                  * first by the scatter score then by number of kvsets.
@@ -1272,6 +1310,66 @@ sp3_dirty_node(struct sp3 *sp, struct cn_tree_node *tn)
     rmlock_runlock(lock);
 }
 
+/* Append a finished job to the compaction history and charge its
+ * I/O to its rule and kvs.
+ */
+static void
+sp3_hist_record(struct sp3 *sp, struct cn_compaction_work *w)
+{
+    const struct cn_merge_stats *ms = &w->cw_stats;
+    struct sp3_tree             *spt = tree2spt(w->cw_tree);
+    struct csched_rule_stats    *rs;
+    struct csched_job_rec       *rec;
+    u64                          tend;
+
+    static_assert(CN_CR_END <= CSCHED_HIST_RULES, "hist_rulev too small");
+
+    tend = w->cw_t4_commit ?: w->cw_t3_build ?: w->cw_t2_prep ?: w->cw_t1_qtime;
+
+    mutex_lock(&sp->hist_lock);
+    rec = sp->hist_jobv + (sp->hist_jobs++ % CSCHED_HIST_JOBS);
+
+    memset(rec, 0, sizeof(*rec));
+    rec->cjr_seq = sp->hist_jobs;
+    rec->cjr_id = w->cw_job.sj_id;
+    rec->cjr_cnid = w->cw_tree->cnid;
+    strlcpy(rec->cjr_kvsname, w->cw_tree->ct_kvsname, sizeof(rec->cjr_kvsname));
+    rec->cjr_action = cn_action2str(w->cw_action);
+    rec->cjr_rule = cn_comp_rule2str(w->cw_comp_rule);
+    rec->cjr_level = w->cw_node->tn_loc.node_level;
+    rec->cjr_offset = w->cw_node->tn_loc.node_offset;
+    rec->cjr_kvsets_in = w->cw_kvset_cnt;
+    rec->cjr_kvsets_out = w->cw_outk;
+    rec->cjr_vblks_reused = w->cw_keep_vblks ? w->cw_vbmap.vbm_blkc : 0;
+    rec->cjr_errno = merr_errno(w->cw_err);
+    rec->cjr_keys_in = ms->ms_keys_in;
+    rec->cjr_keys_out = ms->ms_keys_out;
+    rec->cjr_rbytes = ms->ms_kblk_read.op_size + ms->ms_vblk_read1.op_size +
+        ms->ms_vblk_read2.op_size;
+    rec->cjr_wbytes = ms->ms_kblk_write.op_size + ms->ms_vblk_write.op_size;
+    rec->cjr_cpu_ns = w->cw_cpu_ns;
+    rec->cjr_wait_ns = ms->ms_kblk_read_wait.op_time + ms->ms_vblk_read1_wait.op_time +
+        ms->ms_vblk_read2_wait.op_time;
+
+    if (w->cw_t1_qtime > w->cw_t0_enqueue && w->cw_t0_enqueue)
+        rec->cjr_queue_ns = w->cw_t1_qtime - w->cw_t0_enqueue;
+    if (tend > w->cw_t1_qtime && w->cw_t1_qtime)
+        rec->cjr_wall_ns = tend - w->cw_t1_qtime;
+
+    rs = sp->hist_rulev + w->cw_comp_rule;
+    rs->crs_rule = rec->cjr_rule;
+    rs->crs_jobs++;
+    rs->crs_rbytes += rec->cjr_rbytes;
+    rs->crs_wbytes += rec->cjr_wbytes;
+    rs->crs_cpu_ns += rec->cjr_cpu_ns;
+    rs->crs_wall_ns += rec->cjr_wall_ns;
+
+    spt->spt_hist_jobs++;
+    spt->spt_hist_rbytes += rec->cjr_rbytes;
+    spt->spt_hist_wbytes += rec->cjr_wbytes;
+    mutex_unlock(&sp->hist_lock);
+}
+
 static void
 sp3_process_workitem(struct sp3 *sp, struct cn_compaction_work *w)
 {
@@ -1342,6 +1440,8 @@ sp3_process_workitem(struct sp3 *sp, struct cn_compaction_work *w)
     if (w->cw_debug & CW_DEBUG_PROGRESS)
         sp3_log_progress(w, &w->cw_stats, true);
 
+    sp3_hist_record(sp, w);
+
     if (!tn->tn_parent) {
         u64 dt;
 
@@ -1350,6 +1450,17 @@ sp3_process_workitem(struct sp3 *sp, struct cn_compaction_work *w)
         dt = w->cw_t3_build - w->cw_t2_prep;
         sp->rspill_dt_prev = (dt + sp->rspill_dt_prev) / 2;
         atomic_set(&sp->rspill_dt, sp->rspill_dt_prev);
+
+        /* Maintain an average of the root spill's throughput - used by the
+         * predictive throttle to estimate how fast root debt is repaid.
+         */
+        if (sp->throttle_debt && dt > 0) {
+            u64 bytes = w->cw_stats.ms_key_bytes_out + w->cw_stats.ms_val_bytes_out;
+            u64 bps = bytes * NSEC_PER_SEC / dt;
+
+            sp->rspill_bps_prev = sp->rspill_bps_prev ? (bps + sp->rspill_bps_prev) / 2 : bps;
+            throttle_debt_drain_set(sp->throttle_debt, sp->rspill_bps_prev);
+        }
     }
 
     if (debug_samp_work(sp)) {
@@ -1357,7 +1468,8 @@ sp3_process_workitem(struct sp3 *sp, struct cn_compaction_work *w)
         sp3_log_samp_overall(sp);
     }
 
-    sts_job_done(&w->cw_job);
+    if (!sp->submit)
+        sts_job_done(&w->cw_job);
     free(w);
 }
 
@@ -1393,6 +1505,11 @@ sp3_process_ingest(struct sp3 *sp)
             atomic_sub(&spt->spt_ingest_wlen, wlen);
             sp->samp.r_wlen += wlen;
 
+            mutex_lock(&sp->hist_lock);
+            spt->spt_hist_ingest += wlen;
+            sp->hist_ingest += wlen;
+            mutex_unlock(&sp->hist_lock);
+
             sp3_dirty_node(sp, tree->ct_root);
             ingested = true;
         }
@@ -1472,8 +1589,10 @@ sp3_process_new_trees(struct sp3 *sp)
         sp->lvl_max = max(sp->lvl_max, tree->ct_lvl_max);
 
         /* Move to the monitor's list. */
+        mutex_lock(&sp->hist_lock);
         list_del(&spt->spt_tlink);
         list_add(&spt->spt_tlink, &sp->mon_tlist);
+        mutex_unlock(&sp->hist_lock);
 
         sp->activity++;
     }
@@ -1498,7 +1617,10 @@ sp3_prune_trees(struct sp3 *sp)
                 log_info("sp3 release tree cnid %lu", (ulong)tree->cnid);
 
             sp3_unlink_all_nodes(sp, tree);
+
+            mutex_lock(&sp->hist_lock);
             list_del_init(&spt->spt_tlink);
+            mutex_unlock(&sp->hist_lock);
 
             sp3_log_samp_one_tree(tree);
             sp3_log_samp_overall(sp);
@@ -1791,6 +1913,11 @@ sp3_submit(struct sp3 *sp, struct cn_compaction_work *w, uint qnum)
     w->cw_debug = csched_rp_dbg_comp(sp->rp);
     w->cw_qnum = qnum;
 
+    if (w->cw_tree->cn) {
+        w->cw_qos_rd = cn_get_qos_budget(w->cw_tree->cn, false);
+        w->cw_qos_wr = cn_get_qos_budget(w->cw_tree->cn, true);
+    }
+
     sp->samp_wip.i_alen += w->cw_est.cwe_samp.i_alen;
     sp->samp_wip.l_alen += w->cw_est.cwe_samp.l_alen;
     sp->samp_wip.l_good += w->cw_est.cwe_samp.l_good;
@@ -1804,7 +1931,11 @@ sp3_submit(struct sp3 *sp, struct cn_compaction_work *w, uint qnum)
     sp->activity++;
 
     sts_job_init(&w->cw_job, cn_comp_slice_cb, sp->job_id);
-    sts_job_submit(sp->sts, &w->cw_job);
+
+    if (sp->submit)
+        sp->submit(w);
+    else
+        sts_job_submit(sp->sts, &w->cw_job);
 
     if (debug_sched(sp)) {
         log_info("%-2lu %u,%-4u j%u q%u n%u t%-2u %s:%-6s  kvsets %u,%-2u  clen %5lu"
@@ -2102,70 +2233,172 @@ sp3_tree_shape_check(struct sp3 *sp)
 static_assert(offsetof(struct sp3_node, spn_rbe) == 0,
               "spn_rbe must be first field in struct sp3_node");
 
+/* Compaction priority classes, see kvs rparam cn_compact_prio.
+ */
+#define SP3_PRIO_MAX    (2)
+
 static bool
 sp3_check_rb_tree(struct sp3 *sp, uint tx, u64 threshold, enum sp3_work_type wtype, uint qnum)
 {
     struct rb_root *root;
     struct rb_node *rbn;
     uint            debug;
+    int             prio;
+    bool            filter;
 
     assert(tx < RBT_MAX);
 
     debug = csched_rp_dbg_comp(sp->rp);
 
     root = sp->rbt + tx;
-    rbn = rb_first(root);
 
-    while (rbn) {
-        struct sp3_rbe * rbe;
-        struct sp3_node *spn;
-        bool             have_work;
+    /* Make one pass over the rb tree per priority class present, highest
+     * class first.  Nodes of other classes are skipped (not removed) so
+     * that they remain candidates for their own pass.  If there is only
+     * one class then a single unfiltered pass suffices.
+     */
+    filter = (sp->prio_mask & (sp->prio_mask - 1)) != 0;
 
-        rbe = rb_entry(rbn, struct sp3_rbe, rbe_node);
-        spn = (void *)(rbe - tx);
+    for (prio = SP3_PRIO_MAX; prio >= 0; prio--) {
+        if (filter && !(sp->prio_mask & (1u << prio)))
+            continue;
 
-        if (rbe->rbe_weight < threshold)
-            return false;
+        rbn = rb_first(root);
 
-        if (sp3_work(spn, &sp->thresh, wtype, debug, &sp->wp))
-            return false;
+        while (rbn) {
+            struct kvs_rparams *rp;
+            struct cn_tree *    tree;
+            struct sp3_rbe *    rbe;
+            struct sp3_node *   spn;
+            bool                have_work;
 
-        have_work = sp->wp && sp->wp->cw_action != CN_ACTION_NONE;
-        if (have_work) {
-            sp3_submit(sp, sp->wp, qnum);
-            sp->wp = NULL;
-            return true;
-        }
+            rbe = rb_entry(rbn, struct sp3_rbe, rbe_node);
+            spn = (void *)(rbe - tx);
+
+            if (rbe->rbe_weight < threshold)
+                break;
 
-        rbn = rb_next(rbn);
+            tree = spn2tn(spn)->tn_tree;
+            rp = cn_tree_get_rp(tree);
 
-        /* Work functions that do not produce any work need not
-         * be invoked again until the node changes shape.
-         */
-        sp3_node_remove(sp, spn, tx);
+            if (filter && rp->cn_compact_prio != prio) {
+                rbn = rb_next(rbn);
+                continue;
+            }
+
+            /* Leave the node in place if its kvs is at its job limit.
+             */
+            if (rp->cn_compact_jobs_max &&
+                tree->ct_sched.sp3t.spt_job_cnt >= rp->cn_compact_jobs_max) {
+                rbn = rb_next(rbn);
+                continue;
+            }
+
+            if (sp3_work(spn, &sp->thresh, wtype, debug, &sp->wp))
+                return false;
+
+            have_work = sp->wp && sp->wp->cw_action != CN_ACTION_NONE;
+            if (have_work) {
+                sp3_submit(sp, sp->wp, qnum);
+                sp->wp = NULL;
+                return true;
+            }
+
+            rbn = rb_next(rbn);
+
+            /* Work functions that do not produce any work need not
+             * be invoked again until the node changes shape.
+             */
+            sp3_node_remove(sp, spn, tx);
+        }
+
+        if (!filter)
+            break;
     }
 
     return false;
 }
 
+/**
+ * sp3_qos_budgets() - refresh per-kvs compaction budgets and priorities
+ * @sp:  scheduler
+ * @log: emit a per-kvs qos record
+ */
+static void
+sp3_qos_budgets(struct sp3 *sp, bool log)
+{
+    struct cn_tree *tree;
+    uint prio_mask = 0;
+
+    list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        struct kvs_rparams *  rp = cn_tree_get_rp(tree);
+        struct cn_qos_budget *rd, *wr;
+        uint prio;
+
+        prio = min_t(uint, rp->cn_compact_prio, SP3_PRIO_MAX);
+        prio_mask |= 1u << prio;
+
+        if (!tree->cn)
+            continue;
+
+        rd = cn_get_qos_budget(tree->cn, false);
+        wr = cn_get_qos_budget(tree->cn, true);
+
+        cn_qos_budget_update(rd, rp->cn_compact_rd_mbps);
+        cn_qos_budget_update(wr, rp->cn_compact_wr_mbps);
+
+        if (log) {
+            slog_info(
+                HSE_SLOG_START("cn_qos_budget"),
+                HSE_SLOG_FIELD("cnid", "%lu", (ulong)tree->cnid),
+                HSE_SLOG_FIELD("prio", "%u", prio),
+                HSE_SLOG_FIELD("jobs", "%u", tree->ct_sched.sp3t.spt_job_cnt),
+                HSE_SLOG_FIELD("jobs_max", "%u", rp->cn_compact_jobs_max),
+                HSE_SLOG_FIELD("rd_mbps", "%u", rd->cqb_mbps),
+                HSE_SLOG_FIELD("rd_bytes", "%lu", atomic_read(&rd->cqb_bytes)),
+                HSE_SLOG_FIELD("rd_delay_ns", "%lu", atomic_read(&rd->cqb_delay_ns)),
+                HSE_SLOG_FIELD("wr_mbps", "%u", wr->cqb_mbps),
+                HSE_SLOG_FIELD("wr_bytes", "%lu", atomic_read(&wr->cqb_bytes)),
+                HSE_SLOG_FIELD("wr_delay_ns", "%lu", atomic_read(&wr->cqb_delay_ns)),
+                HSE_SLOG_END);
+        }
+    }
+
+    sp->prio_mask = prio_mask;
+}
+
 static void
 sp3_qos_check(struct sp3 *sp)
 {
     struct cn_tree *tree;
-    uint rootmin, rootmax;
-    u64 sval;
+    uint rootmin, rootmax, kvsets_max;
+    u64 sval, debt;
+    bool log;
+
+    log = debug_qos(sp) && sp->now > sp->qos_log_ttl;
+    if (log)
+        sp->qos_log_ttl = sp->now + NSEC_PER_SEC;
+
+    sp3_qos_budgets(sp, log);
 
     if (!sp->throttle_sensor_root)
         return;
 
     rootmin = sp->thresh.rspill_kvsets_max;
     rootmax = rootmin;
+    kvsets_max = 0;
     sval = 0;
+    debt = 0;
 
     list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
         struct kvs_rparams *rp = cn_tree_get_rp(tree);
         uint nk = cn_ns_kvsets(&tree->ct_root->tn_ns);
 
+        if (!rp->cn_maint_disable) {
+            kvsets_max = max_t(uint, kvsets_max, nk);
+            debt += cn_ns_clen(&tree->ct_root->tn_ns);
+        }
+
         /* The root node length counts toward the throttle sensor value
          * only if cn maintenance mode is enabled.  Diminish the weight
          * of long, tiny root nodes on the throttle.
@@ -2211,9 +2444,14 @@ sp3_qos_check(struct sp3 *sp)
 
     throttle_sensor_set(sp->throttle_sensor_root, (uint)sval);
 
-    if (debug_qos(sp) && jclock_ns > sp->qos_log_ttl) {
-        sp->qos_log_ttl = jclock_ns + NSEC_PER_SEC;
+    /* The root sensor reaches THROTTLE_SENSOR_SCALE at roughly ten kvsets
+     * beyond rspill_kvsets_max, so that's where the predictive throttle
+     * considers the root to be full.
+     */
+    if (sp->throttle_debt)
+        throttle_debt_set(sp->throttle_debt, kvsets_max, rootmin + 10, debt);
 
+    if (log) {
         slog_info(
             HSE_SLOG_START("cn_qos_sensors"),
             HSE_SLOG_FIELD("root_sensor", "%lu", sval),
@@ -2326,7 +2564,7 @@ sp3_schedule(struct sp3 *sp)
              *   - Idle node query-shape rule
              */
             if (sp->thresh.llen_idlec > 0) {
-                thresh = (UINT32_MAX - (jclock_ns >> 32)) << 32;
+                thresh = (UINT32_MAX - (sp->now >> 32)) << 32;
 
                 job = sp3_check_rb_tree(sp, RBT_LI_IDLE, thresh, wtype_node_idle, qnum);
             }
@@ -2387,7 +2625,7 @@ sp3_schedule(struct sp3 *sp)
              *   - Leaf node scatter rule
              */
             if (sp->thresh.lscatter_pct < 100) {
-                thresh = (UINT32_MAX - (jclock_ns >> 32)) << 32;
+                thresh = (UINT32_MAX - (sp->now >> 32)) << 32;
 
                 job = sp3_check_rb_tree(sp, RBT_L_SCAT, thresh, wtype_leaf_scatter, qnum);
             }
@@ -2442,36 +2680,85 @@ sp3_update_samp(struct sp3 *sp)
     }
 }
 
-struct periodic_check {
-    u64 interval;
-    u64 next;
-    u64 prev;
-};
+/* One pass of the monitor loop, at time @now.  All of the rules that
+ * depend on time (idle and scatter node ttls, ucomp progress, etc) use
+ * sp->now rather than reading a clock, so that an offline scheduler
+ * runs entirely in its driver's time.
+ */
+static void
+sp3_monitor_pass(struct sp3 *sp, u64 now)
+{
+    merr_t err;
+
+    sp->now = now;
+
+    /* The following "process and prune" functions will increment
+     * sp->activity to trigger a call (below) to sp3_schedule().
+     */
+    sp3_process_worklist(sp);
+    sp3_process_ingest(sp);
+    sp3_process_new_trees(sp);
+    sp3_prune_trees(sp);
+
+    sp3_update_samp(sp);
+
+    err = kvdb_health_check(sp->health, KVDB_HEALTH_FLAG_ALL);
+    if (ev(err)) {
+        if (!sp->bad_health)
+            log_errx("KVDB %s is in bad health; @@e", err, sp->name);
+
+        sp->bad_health = true;
+    }
+
+    if (now > sp->chk_sched.next || sp->activity) {
+        if (sp->activity) {
+            sp->last_activity = now + NSEC_PER_SEC * 5;
+            sp->activity = 0;
+        }
+
+        if (!sp->bad_health)
+            sp3_schedule(sp);
+
+        sp->chk_sched.next = now + sp->chk_sched.interval;
+    }
+
+    if (now > sp->chk_refresh.next) {
+        sp3_refresh_settings(sp);
+        sp->chk_refresh.next = now + sp->chk_refresh.interval;
+    }
+
+    if (now > sp->chk_qos.next) {
+        sp3_qos_check(sp);
+        sp->chk_qos.next = now + sp->chk_qos.interval;
+    }
+
+    if (now > sp->chk_shape.next) {
+        sp3_tree_shape_check(sp);
+        if (debug_rbtree(sp)) {
+            for (uint tx = 0; tx < RBT_MAX; tx++)
+                sp3_rb_dump(sp, tx, 25);
+        }
+        sp->chk_shape.next = now + sp->chk_shape.interval;
+    }
+
+    sp->idle = now > sp->last_activity && sp->jobs_started == sp->jobs_finished;
+}
 
 static void
 sp3_monitor(struct work_struct *work)
 {
     struct sp3 *sp = container_of(work, struct sp3, mon_work);
 
-    struct periodic_check chk_qos     = { .interval = NSEC_PER_SEC / 3 };
-    struct periodic_check chk_sched   = { .interval = NSEC_PER_SEC * 3 };
-    struct periodic_check chk_refresh = { .interval = NSEC_PER_SEC * 10 };
-    struct periodic_check chk_shape   = { .interval = NSEC_PER_SEC * 15 };
-
-    bool bad_health = false;
-    u64 last_activity = 0;
-
     sp3_refresh_settings(sp);
 
     while (atomic_read(&sp->running)) {
         uint64_t now = get_time_ns();
-        merr_t err;
 
         mutex_lock(&sp->mon_lock);
         end_stats_work();
 
-        if (!sp->mon_signaled && now < chk_qos.next) {
-            int timeout_ms = max_t(int, 10, (chk_qos.next - now) / USEC_PER_SEC);
+        if (!sp->mon_signaled && now < sp->chk_qos.next) {
+            int timeout_ms = max_t(int, 10, (sp->chk_qos.next - now) / USEC_PER_SEC);
 
             cv_timedwait(&sp->mon_cv, &sp->mon_lock, timeout_ms, "spmonslp");
 
@@ -2482,56 +2769,7 @@ sp3_monitor(struct work_struct *work)
         sp->mon_signaled = false;
         mutex_unlock(&sp->mon_lock);
 
-        /* The following "process and prune" functions will increment
-         * sp->activity to trigger a call (below) to sp3_schedule().
-         */
-        sp3_process_worklist(sp);
-        sp3_process_ingest(sp);
-        sp3_process_new_trees(sp);
-        sp3_prune_trees(sp);
-
-        sp3_update_samp(sp);
-
-        err = kvdb_health_check(sp->health, KVDB_HEALTH_FLAG_ALL);
-        if (ev(err)) {
-            if (!bad_health)
-                log_errx("KVDB %s is in bad health; @@e", err, sp->name);
-
-            bad_health = true;
-        }
-
-        if (now > chk_sched.next || sp->activity) {
-            if (sp->activity) {
-                last_activity = now + NSEC_PER_SEC * 5;
-                sp->activity = 0;
-            }
-
-            if (!bad_health)
-                sp3_schedule(sp);
-
-            chk_sched.next = now + chk_sched.interval;
-        }
-
-        if (now > chk_refresh.next) {
-            sp3_refresh_settings(sp);
-            chk_refresh.next = now + chk_refresh.interval;
-        }
-
-        if (now > chk_qos.next) {
-            sp3_qos_check(sp);
-            chk_qos.next = now + chk_qos.interval;
-        }
-
-        if (now > chk_shape.next) {
-            sp3_tree_shape_check(sp);
-            if (debug_rbtree(sp)) {
-                for (uint tx = 0; tx < RBT_MAX; tx++)
-                    sp3_rb_dump(sp, tx, 25);
-            }
-            chk_shape.next = now + chk_shape.interval;
-        }
-
-        sp->idle = now > last_activity && sp->jobs_started == sp->jobs_finished;
+        sp3_monitor_pass(sp, now);
     }
 }
 
@@ -2552,6 +2790,17 @@ sp3_throttle_sensor(struct csched *handle, struct throttle_sensor *sensor)
     sp->throttle_sensor_root = sensor;
 }
 
+void
+sp3_throttle_debt(struct csched *handle, struct throttle_debt *debt)
+{
+    struct sp3 *sp = (struct sp3 *)handle;
+
+    if (!sp)
+        return;
+
+    sp->throttle_debt = debt;
+}
+
 void
 sp3_compact_request(struct csched *handle, int flags)
 {
@@ -2584,6 +2833,69 @@ sp3_compact_status_get(struct csched *handle, struct hse_kvdb_compact_status *st
     status->kvcs_samp_hwm = sp->samp_hwm * 100 / SCALE;
 }
 
+/**
+ * sp3_qinfo_get() - External API: get compaction queue depths
+ */
+void
+sp3_qinfo_get(struct csched *handle, uint *jobsv, uint *threadsv)
+{
+    struct sp3 *sp = (struct sp3 *)handle;
+
+    for (size_t i = 0; i < SP3_QNUM_MAX; i++) {
+        jobsv[i] = sp ? sp->qinfo[i].qjobs : 0;
+        threadsv[i] = sp ? sp->qinfo[i].qjobs_max : 0;
+    }
+}
+
+/**
+ * sp3_history_get() - External API: get the compaction job history
+ */
+void
+sp3_history_get(struct csched *handle, struct csched_history *hist)
+{
+    struct sp3     *sp = (struct sp3 *)handle;
+    struct cn_tree *tree;
+    u64             seq;
+    uint            i;
+
+    memset(hist, 0, offsetof(struct csched_history, ch_jobv));
+    hist->ch_rulec = 0;
+    hist->ch_kvsc = 0;
+
+    if (!sp)
+        return;
+
+    mutex_lock(&sp->hist_lock);
+    hist->ch_jobs = sp->hist_jobs;
+    hist->ch_ingest_bytes = sp->hist_ingest;
+
+    seq = sp->hist_jobs > CSCHED_HIST_JOBS ? sp->hist_jobs - CSCHED_HIST_JOBS : 0;
+    while (seq < sp->hist_jobs)
+        hist->ch_jobv[hist->ch_jobc++] = sp->hist_jobv[seq++ % CSCHED_HIST_JOBS];
+
+    for (i = 0; i < CSCHED_HIST_RULES; i++) {
+        if (sp->hist_rulev[i].crs_jobs > 0)
+            hist->ch_rulev[hist->ch_rulec++] = sp->hist_rulev[i];
+    }
+
+    list_for_each_entry (tree, &sp->mon_tlist, ct_sched.sp3t.spt_tlink) {
+        struct sp3_tree         *spt = tree2spt(tree);
+        struct csched_kvs_stats *ks;
+
+        if (hist->ch_kvsc >= NELEM(hist->ch_kvsv))
+            break;
+
+        ks = hist->ch_kvsv + hist->ch_kvsc++;
+        ks->cks_cnid = tree->cnid;
+        strlcpy(ks->cks_kvsname, tree->ct_kvsname, sizeof(ks->cks_kvsname));
+        ks->cks_ingest_bytes = spt->spt_hist_ingest;
+        ks->cks_jobs = spt->spt_hist_jobs;
+        ks->cks_rbytes = spt->spt_hist_rbytes;
+        ks->cks_wbytes = spt->spt_hist_wbytes;
+    }
+    mutex_unlock(&sp->hist_lock);
+}
+
 /**
  * sp3_notify_ingest() - External API: notify ingest job has completed
  */
@@ -2694,6 +3006,7 @@ sp3_destroy(struct csched *handle)
 
     sts_destroy(sp->sts);
 
+    mutex_destroy(&sp->hist_lock);
     mutex_destroy(&sp->work_list_lock);
     mutex_destroy(&sp->new_tlist_lock);
     mutex_destroy(&sp->mon_lock);
@@ -2704,15 +3017,41 @@ sp3_destroy(struct csched *handle)
     free(sp);
 }
 
-/**
- * sp3_create() - External API: constructor
+/* Compaction jobs are dominated by kblock and vblock i/o, so in NUMA mode
+ * we run them on the node to which the capacity media is attached (if it
+ * can be determined) to keep their buffers local to the device.
  */
-merr_t
-sp3_create(
+static void
+sp3_numa_bind(struct sp3 *sp)
+{
+    struct mpool_mclass_props props;
+    merr_t err;
+    int node;
+
+    err = mpool_mclass_props_get(sp->ds, HSE_MCLASS_CAPACITY, &props);
+    if (err)
+        return;
+
+    node = hse_numa_path_node(props.mc_path);
+    if (node < 0)
+        return;
+
+    err = sts_numa_bind(sp->sts, node);
+    if (err) {
+        log_warnx("%s: unable to bind compaction threads to node %d: @@e", err, sp->name, node);
+        return;
+    }
+
+    log_info("%s: compaction threads bound to node %d", sp->name, node);
+}
+
+static merr_t
+sp3_create_impl(
     struct mpool *       ds,
     struct kvdb_rparams *rp,
     const char *         kvdb_alias,
     struct kvdb_health * health,
+    sp3_submit_fn       *submit,
     struct csched      **handle)
 {
     const char *restname = "csched";
@@ -2739,9 +3078,11 @@ sp3_create(
 
     sp->rp = rp;
     sp->health = health;
+    sp->submit = submit;
 
     mutex_init(&sp->new_tlist_lock);
     mutex_init(&sp->work_list_lock);
+    mutex_init(&sp->hist_lock);
 
     mutex_init(&sp->mon_lock);
     cv_init(&sp->mon_cv);
@@ -2759,10 +3100,18 @@ sp3_create(
     atomic_set(&sp->sp_ingest_count, 0);
     atomic_set(&sp->sp_prune_count, 0);
 
+    sp->chk_qos.interval = NSEC_PER_SEC / 3;
+    sp->chk_sched.interval = NSEC_PER_SEC * 3;
+    sp->chk_refresh.interval = NSEC_PER_SEC * 10;
+    sp->chk_shape.interval = NSEC_PER_SEC * 15;
+
     err = sts_create(sp->name, SP3_QNUM_MAX, sp3_job_print, &sp->sts);
     if (ev(err))
         goto err_exit;
 
+    if (rp->numa_mode && ds)
+        sp3_numa_bind(sp);
+
     sp->mon_wq = alloc_workqueue("hse_sp3_monitor", 0, 1, 1);
     if (ev(!sp->mon_wq)) {
         err = merr(ENOMEM);
@@ -2773,8 +3122,12 @@ sp3_create(
 
     perfc_alloc(csched_sp3_perfc, group, "sp3", rp->perfc_level, &sp->sched_pc);
 
-    INIT_WORK(&sp->mon_work, sp3_monitor);
-    queue_work(sp->mon_wq, &sp->mon_work);
+    if (submit) {
+        sp3_refresh_settings(sp);
+    } else {
+        INIT_WORK(&sp->mon_work, sp3_monitor);
+        queue_work(sp->mon_wq, &sp->mon_work);
+    }
 
     slog_info(
         HSE_SLOG_START("cn_threads"),
@@ -2792,6 +3145,7 @@ sp3_create(
 err_exit:
     sts_destroy(sp->sts);
 
+    mutex_destroy(&sp->hist_lock);
     mutex_destroy(&sp->work_list_lock);
     mutex_destroy(&sp->new_tlist_lock);
     mutex_destroy(&sp->mon_lock);
@@ -2802,6 +3156,41 @@ err_exit:
     return err;
 }
 
+/**
+ * sp3_create() - External API: constructor
+ */
+merr_t
+sp3_create(
+    struct mpool *       ds,
+    struct kvdb_rparams *rp,
+    const char *         kvdb_alias,
+    struct kvdb_health * health,
+    struct csched      **handle)
+{
+    return sp3_create_impl(ds, rp, kvdb_alias, health, NULL, handle);
+}
+
+merr_t
+sp3_create_offline(
+    struct kvdb_rparams *rp,
+    const char *         kvdb_alias,
+    struct kvdb_health * health,
+    sp3_submit_fn       *submit,
+    struct csched      **handle)
+{
+    INVARIANT(submit);
+
+    return sp3_create_impl(NULL, rp, kvdb_alias, health, submit, handle);
+}
+
+void
+sp3_step(struct csched *handle, u64 now)
+{
+    struct sp3 *sp = (struct sp3 *)handle;
+
+    sp3_monitor_pass(sp, now);
+}
+
 #if HSE_MOCKING
 #include "csched_sp3_ut_impl.i"
 #endif /* HSE_MOCKING */
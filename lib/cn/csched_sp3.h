@@ -23,7 +23,20 @@ struct kvdb_health;
 struct csched;
 struct cn_tree;
 struct throttle_sensor;
+struct throttle_debt;
 struct hse_kvdb_compact_status;
+struct csched_history;
+struct cn_compaction_work;
+
+/**
+ * sp3_submit_fn - job submission hook of an offline scheduler
+ * @w: compaction work ready to run
+ *
+ * Called in place of sts_job_submit().  The driver runs the job on its
+ * own terms and hands @w back with cn_comp_apply().
+ */
+typedef void
+sp3_submit_fn(struct cn_compaction_work *w);
 
 struct sp3_rbe {
     struct rb_node rbe_node;
@@ -45,6 +58,12 @@ struct sp3_tree {
     atomic_int       spt_enabled;
     atomic_ulong     spt_ingest_alen;
     atomic_ulong     spt_ingest_wlen;
+
+    /* Compaction history, protected by sp3 hist_lock */
+    u64              spt_hist_ingest;
+    u64              spt_hist_jobs;
+    u64              spt_hist_rbytes;
+    u64              spt_hist_wbytes;
 };
 
 /* MTF_MOCK */
@@ -56,18 +75,57 @@ sp3_create(
     struct kvdb_health * health,
     struct csched      **handle);
 
+/**
+ * sp3_create_offline() - create an sp3 scheduler without a monitor thread
+ * @submit: called with each job the scheduler starts
+ *
+ * The caller drives the scheduler by calling sp3_step() with its own
+ * notion of time, which is also the only time the scheduling rules see,
+ * and runs the jobs passed to @submit.  Used by tools that replay a
+ * workload against the real scheduling policy (e.g., cn_sim).
+ */
+/* PRIVATE */
+merr_t
+sp3_create_offline(
+    struct kvdb_rparams *rp,
+    const char *         kvdb_alias,
+    struct kvdb_health * health,
+    sp3_submit_fn       *submit,
+    struct csched      **handle);
+
+/**
+ * sp3_step() - run one pass of the sp3 monitor loop
+ * @handle: scheduler created by sp3_create_offline()
+ * @now:    current time (ns) as seen by the caller
+ *
+ * Processes completed jobs, ingests and new trees, then schedules
+ * work exactly as one iteration of the monitor thread would.
+ */
+/* PRIVATE */
+void
+sp3_step(struct csched *handle, u64 now);
+
 void
 sp3_destroy(struct csched *handle);
 
 void
 sp3_throttle_sensor(struct csched *handle, struct throttle_sensor *sensor);
 
+void
+sp3_throttle_debt(struct csched *handle, struct throttle_debt *debt);
+
 void
 sp3_compact_request(struct csched *handle, int flags);
 
 void
 sp3_compact_status_get(struct csched *handle, struct hse_kvdb_compact_status *status);
 
+void
+sp3_qinfo_get(struct csched *handle, uint *jobsv, uint *threadsv);
+
+void
+sp3_history_get(struct csched *handle, struct csched_history *hist);
+
 void
 sp3_notify_ingest(struct csched *handle, struct cn_tree *tree, size_t alen, size_t wlen);
 
@@ -34,6 +34,7 @@
 #include "cn_mblocks.h"
 #include "cn_metrics.h"
 #include "cn_perfc.h"
+#include "cn_qos.h"
 
 #include <mpool/mpool.h>
 
@@ -182,6 +183,7 @@ struct kblock_builder {
     struct perfc_set *         pc;
     struct hlog *              hlog;
     struct cn_merge_stats *    mstats;
+    struct cn_qos_budget *     qos;
     struct blk_list            finished_kblks;
     struct curr_kblock         curr;
     struct wbb *               ptree;
@@ -362,6 +364,8 @@ mblk_blow_chunks(
 
         written += wlen;
 
+        cn_qos_budget_charge(self->qos, wlen);
+
         perfc_inc(self->pc, PERFC_RA_CNCOMP_WREQS);
         perfc_add(self->pc, PERFC_RA_CNCOMP_WBYTES, wlen);
     }
@@ -1274,6 +1278,12 @@ kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats)
     bld->mstats = stats;
 }
 
+void
+kbb_set_qos(struct kblock_builder *bld, struct cn_qos_budget *qos)
+{
+    bld->qos = qos;
+}
+
 #if HSE_MOCKING
 #include "kblock_builder_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -17,6 +17,7 @@ struct kblock_builder;
 struct blk_list;
 struct kvs_rparams;
 struct cn_merge_stats;
+struct cn_qos_budget;
 
 enum hse_mclass;
 enum hse_mclass_policy_age;
@@ -141,6 +142,9 @@ kbb_get_agegroup(struct kblock_builder *bld);
 void
 kbb_set_merge_stats(struct kblock_builder *bld, struct cn_merge_stats *stats);
 
+void
+kbb_set_qos(struct kblock_builder *bld, struct cn_qos_budget *qos);
+
 #if HSE_MOCKING
 #include "kblock_builder_ut.h"
 #endif /* HSE_MOCKING */
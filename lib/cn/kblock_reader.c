@@ -66,7 +66,8 @@ kbr_read_wbt_region_desc_mem(void *wbt_hdr, struct wbt_desc *desc)
     desc->wbd_version = wbt_hdr_version(wbt_hdr);
 
     switch (desc->wbd_version) {
-        case WBT_TREE_VERSION:
+        case WBT_TREE_VERSION6:
+        case WBT_TREE_VERSION7:
             desc->wbd_root = omf_wbt_root(wbt_hdr);
             desc->wbd_leaf = omf_wbt_leaf(wbt_hdr);
             desc->wbd_leaf_cnt = omf_wbt_leaf_cnt(wbt_hdr);
@@ -371,7 +372,7 @@ kbr_madvise_wbt_int_nodes(struct kvs_mblk_desc *kblkdesc, struct wbt_desc *desc,
 {
     merr_t err;
     u32    pg = desc->wbd_first_page + desc->wbd_leaf_cnt;
-    u32    pg_cnt = (desc->wbd_n_pages - desc->wbd_leaf_cnt - desc->wbd_kmd_pgc);
+    u32    pg_cnt = wbt_ine_pgc(desc);
 
     err = kbr_madvise_region(kblkdesc, pg, pg_cnt, advice);
 
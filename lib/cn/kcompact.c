@@ -381,6 +381,7 @@ cn_kcompact(struct cn_compaction_work *w)
     }
 
     kvset_builder_set_merge_stats(w->cw_child[0], &w->cw_stats);
+    kvset_builder_set_qos(w->cw_child[0], w->cw_qos_wr);
 
     err = kcompact(w);
     if (ev(err))
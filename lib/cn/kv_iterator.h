@@ -20,6 +20,7 @@
  */
 
 struct kv_iterator;
+struct kc_pred;
 
 #define kvset_cursor_es_h2r(handle) container_of(handle, struct kv_iterator, kvi_es)
 
@@ -49,6 +50,7 @@ struct kv_iterator {
     void *                  kvi_context;
     struct kvs_rparams *    kvi_rparams;
     bool                    kvi_eof;
+    const struct kc_pred *  kvi_pred;
     struct element_source   kvi_es;
     struct cn_kv_item       kvi_kv;
 };
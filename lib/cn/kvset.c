@@ -25,6 +25,7 @@
 #include <hse/kvdb_perfc.h>
 
 #include <hse_ikvdb/tuple.h>
+#include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/cn_kvdb.h>
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/kvs_rparams.h>
@@ -39,6 +40,8 @@
 
 #include <mpool/mpool.h>
 
+#include <urcu-bp.h>
+
 #include <hse_util/hlog.h>
 
 #include "kvset.h"
@@ -56,6 +59,12 @@
 #include "mbset.h"
 #include "cn_tree.h"
 #include "cn_tree_internal.h"
+#include "cn_qos.h"
+#include "cn_summary.h"
+#include "cn_pin.h"
+#include "cn_bcache.h"
+
+#include <hse_ikvdb/reqtrace.h>
 
 /*
  * kvset deferred deletes
@@ -212,25 +221,12 @@ kvset_put_ref(struct kvset *ks)
 }
 
 static merr_t
-kvset_kblk_init(
-    struct kvs_rparams *     rp,
-    struct mpool *           ds,
-    struct mblock_props     *props,
-    struct mpool_mcache_map *kmap,
-    u32                      idx,
-    struct kvset_kblk *      p,
-    u8 **                    hlog)
+kvset_kblk_init_hdr(struct kvset_kblk *p, u8 **hlog)
 {
     struct kvs_mblk_desc * kbd = &p->kb_kblk_desc;
     struct kblock_hdr_omf *hdr;
     merr_t                 err;
 
-    p->kb_cn_bloom_lookup = rp->cn_bloom_lookup;
-
-    err = kbr_get_kblock_desc(ds, kmap, props, idx, p->kb_kblk.bk_blkid, kbd);
-    if (ev(err))
-        return err;
-
     err = kbr_read_wbt_region_desc(kbd, &p->kb_wbt_desc);
     if (ev(err))
         return err;
@@ -239,10 +235,6 @@ kvset_kblk_init(
     if (ev(err))
         return err;
 
-    err = kbr_read_blm_pages(kbd, p->kb_cn_bloom_lookup, &p->kb_blm_desc, &p->kb_blm_pages);
-    if (ev(err))
-        return err;
-
     err = kbr_read_pt_region_desc(kbd, &p->kb_pt_desc);
     if (ev(err))
         return err;
@@ -265,14 +257,188 @@ kvset_kblk_init(
         *hlog = 0;
     }
 
-    /* Cache min/max key ptrs and lengths, and initialize the
-     * min/max key discriminators for use in kblk_plausible().
+    /* Cache min/max key ptrs and lengths.
      */
-    p->kb_koff_max = (const char *)hdr + omf_kbh_max_koff(hdr);
+    p->kb_hoff_max = omf_kbh_max_koff(hdr);
     p->kb_klen_max = omf_kbh_max_klen(hdr);
+    p->kb_koff_max = (const char *)hdr + p->kb_hoff_max;
 
-    p->kb_koff_min = (const char *)hdr + omf_kbh_min_koff(hdr);
+    p->kb_hoff_min = omf_kbh_min_koff(hdr);
     p->kb_klen_min = omf_kbh_min_klen(hdr);
+    p->kb_koff_min = (const char *)hdr + p->kb_hoff_min;
+
+    return 0;
+}
+
+static void
+kvset_summary2wbt(const struct cn_summary_wbt_omf *omf, struct wbt_desc *desc)
+{
+    desc->wbd_first_page = omf_csw_first_page(omf);
+    desc->wbd_n_pages = omf_csw_n_pages(omf);
+    desc->wbd_root = omf_csw_root(omf);
+    desc->wbd_leaf = omf_csw_leaf(omf);
+    desc->wbd_leaf_cnt = omf_csw_leaf_cnt(omf);
+    desc->wbd_kmd_pgc = omf_csw_kmd_pgc(omf);
+    desc->wbd_version = omf_csw_version(omf);
+}
+
+static void
+kvset_wbt2summary(const struct wbt_desc *desc, struct cn_summary_wbt_omf *omf)
+{
+    omf_set_csw_first_page(omf, desc->wbd_first_page);
+    omf_set_csw_n_pages(omf, desc->wbd_n_pages);
+    omf_set_csw_root(omf, desc->wbd_root);
+    omf_set_csw_leaf(omf, desc->wbd_leaf);
+    omf_set_csw_leaf_cnt(omf, desc->wbd_leaf_cnt);
+    omf_set_csw_kmd_pgc(omf, desc->wbd_kmd_pgc);
+    omf_set_csw_version(omf, desc->wbd_version);
+}
+
+/* Initialize a kblk from its kvset summary record rather than from its
+ * header, such that the header page isn't faulted in.  The min/max keys
+ * are left pointing into the summary (unless they fit in kb_ksmall), the
+ * caller must copy or rebase them before the summary is freed.
+ */
+static merr_t
+kvset_kblk_init_summary(const struct cn_summary_kblk_omf *sum, struct kvset_kblk *p, u8 **hlog)
+{
+    const struct cn_summary_blm_omf *blm = &sum->csk_blm;
+    u32                              hlog_pg;
+
+    p->kb_klen_max = omf_csk_klen_max(sum);
+    p->kb_klen_min = omf_csk_klen_min(sum);
+    p->kb_hoff_max = omf_csk_hoff_max(sum);
+    p->kb_hoff_min = omf_csk_hoff_min(sum);
+
+    if (ev(p->kb_hoff_max + p->kb_klen_max > PAGE_SIZE ||
+           p->kb_hoff_min + p->kb_klen_min > PAGE_SIZE))
+        return merr(EINVAL);
+
+    kvset_summary2wbt(&sum->csk_wbt, &p->kb_wbt_desc);
+    kvset_summary2wbt(&sum->csk_pt, &p->kb_pt_desc);
+
+    p->kb_blm_desc.bd_modulus = omf_csb_modulus(blm);
+    p->kb_blm_desc.bd_bktshift = omf_csb_bktshift(blm);
+    p->kb_blm_desc.bd_bktmask = omf_csb_bktmask(blm);
+    p->kb_blm_desc.bd_n_hashes = omf_csb_n_hashes(blm);
+    p->kb_blm_desc.bd_rotl = omf_csb_rotl(blm);
+    p->kb_blm_desc.bd_first_page = omf_csb_first_page(blm);
+    p->kb_blm_desc.bd_n_pages = omf_csb_n_pages(blm);
+    p->kb_blm_desc.bd_bktsz = omf_csb_bktsz(blm);
+
+    p->kb_metrics.num_keys = omf_csk_keys(sum);
+    p->kb_metrics.num_tombstones = omf_csk_tombs(sum);
+    p->kb_metrics.tot_key_bytes = omf_csk_key_bytes(sum);
+    p->kb_metrics.tot_val_bytes = omf_csk_val_bytes(sum);
+    p->kb_metrics.tot_wbt_pages = omf_csk_wbt_pgc(sum);
+    p->kb_metrics.tot_blm_pages = omf_csk_blm_pgc(sum);
+
+    p->kb_seqno_min = omf_csk_seqno_min(sum);
+    p->kb_seqno_max = omf_csk_seqno_max(sum);
+
+    hlog_pg = omf_csk_hlog_pg(sum);
+    *hlog = hlog_pg ? p->kb_kblk_desc.map_base + PAGE_SIZE * hlog_pg : NULL;
+
+    p->kb_koff_max = sum + 1;
+    p->kb_koff_min = p->kb_koff_max + p->kb_klen_max;
+
+    return 0;
+}
+
+static struct cn_pin *
+kvset_kblk_pin_pages(struct kvs_mblk_desc *kbd, u32 pg, u32 pgc, void **ptrp)
+{
+    struct cn_pin *pin;
+    struct iovec   iov;
+    merr_t         err;
+
+    iov.iov_base = cn_pin_alloc(pgc * PAGE_SIZE, ptrp, &pin);
+    if (!iov.iov_base)
+        return NULL;
+
+    iov.iov_len = pgc * PAGE_SIZE;
+
+    err = mpool_mblock_read(kbd->ds, kbd->mb_id, &iov, 1, pg * PAGE_SIZE);
+    if (ev(err)) {
+        cn_pin_free(pin);
+        return NULL;
+    }
+
+    cn_pin_publish(pin);
+
+    return pin;
+}
+
+/* Copy the bloom filter and the wbtree internal nodes of a kblock into the
+ * resident arena, if there is room.  Whatever doesn't fit, or is later
+ * evicted, is served from the mcache map.
+ */
+static void
+kvset_kblk_pin(struct kvset_kblk *p)
+{
+    struct kvs_mblk_desc *kbd = &p->kb_kblk_desc;
+    struct bloom_desc *   blm = &p->kb_blm_desc;
+    struct wbt_desc *     wbd = &p->kb_wbt_desc;
+
+    if (blm->bd_n_pages && p->kb_cn_bloom_lookup != BLOOM_LOOKUP_NONE)
+        p->kb_blm_pin = kvset_kblk_pin_pages(
+            kbd, blm->bd_first_page, blm->bd_n_pages, (void **)&p->kb_blm_pages);
+
+    if (wbd->wbd_n_pages && wbt_ine_pgc(wbd) > 0)
+        p->kb_wbt_pin = kvset_kblk_pin_pages(
+            kbd, wbd->wbd_first_page + wbd->wbd_leaf_cnt, wbt_ine_pgc(wbd), &wbd->wbd_ine_pin);
+}
+
+static void
+kvset_kblk_unpin(struct kvset_kblk *p)
+{
+    if (p->kb_blm_pin) {
+        cn_pin_free(p->kb_blm_pin);
+        p->kb_blm_pin = NULL;
+        p->kb_blm_pages = NULL;
+    }
+
+    if (p->kb_wbt_pin) {
+        cn_pin_free(p->kb_wbt_pin);
+        p->kb_wbt_pin = NULL;
+        p->kb_wbt_desc.wbd_ine_pin = NULL;
+    }
+}
+
+static merr_t
+kvset_kblk_init(
+    struct kvs_rparams *              rp,
+    struct mpool *                    ds,
+    struct mblock_props              *props,
+    struct mpool_mcache_map *         kmap,
+    u32                               idx,
+    const struct cn_summary_kblk_omf *sum,
+    struct kvset_kblk *               p,
+    u8 **                             hlog)
+{
+    struct kvs_mblk_desc *kbd = &p->kb_kblk_desc;
+    merr_t                err;
+
+    p->kb_cn_bloom_lookup = rp->cn_bloom_lookup;
+
+    err = kbr_get_kblock_desc(ds, kmap, props, idx, p->kb_kblk.bk_blkid, kbd);
+    if (ev(err))
+        return err;
+
+    /* Fall back to the header if the summary record is unusable.
+     */
+    if (!sum || kvset_kblk_init_summary(sum, p, hlog)) {
+        err = kvset_kblk_init_hdr(p, hlog);
+        if (ev(err))
+            return err;
+    }
+
+    kvset_kblk_pin(p);
+
+    if (!p->kb_blm_pin)
+        err = kbr_read_blm_pages(kbd, p->kb_cn_bloom_lookup, &p->kb_blm_desc, &p->kb_blm_pages);
+    if (ev(err))
+        return err;
 
     /* If the combined key lengths are short we can cache them nearby
      * in p->kb_ksmall.  Otherwise the caller may try to pack them into
@@ -283,13 +449,16 @@ kvset_kblk_init(
         p->kb_koff_min = memcpy(p->kb_ksmall + p->kb_klen_max, p->kb_koff_min, p->kb_klen_min);
     }
 
+    /* Initialize the min/max key discriminators for use in kblk_plausible().
+     */
     key_disc_init(p->kb_koff_max, p->kb_klen_max, &p->kb_kdisc_max);
     key_disc_init(p->kb_koff_min, p->kb_klen_min, &p->kb_kdisc_min);
 
     /* Preload the wbtree nodes.
      */
     if (rp->cn_mcache_wbt > 0) {
-        kbr_madvise_wbt_int_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
+        if (!p->kb_wbt_pin)
+            kbr_madvise_wbt_int_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
 
         if (rp->cn_mcache_wbt > 1)
             kbr_madvise_wbt_leaf_nodes(kbd, &p->kb_wbt_desc, MADV_WILLNEED);
@@ -297,7 +466,7 @@ kvset_kblk_init(
 
     /* Preload the bloom filter.
      */
-    if (rp->cn_bloom_preload && p->kb_cn_bloom_lookup == BLOOM_LOOKUP_MCACHE)
+    if (rp->cn_bloom_preload && p->kb_cn_bloom_lookup == BLOOM_LOOKUP_MCACHE && !p->kb_blm_pin)
         kbr_madvise_bloom(kbd, &p->kb_blm_desc, MADV_WILLNEED);
 
     return 0;
@@ -546,6 +715,8 @@ kvset_create2(
         struct kvset_kblk * kblk = ks->ks_kblks + i;
         struct mblock_props props;
 
+        const struct cn_summary_kblk_omf *sum;
+
         u64 mbid = km->km_kblk_list.blks[i].bk_blkid;
         u8 *hlog;
 
@@ -555,8 +726,10 @@ kvset_create2(
 
         kblk->kb_kblk.bk_blkid = mbid;
 
+        sum = cn_summary_lookup(tree->ct_summary, km->km_dgen, mbid);
+
         err = kvset_kblk_init(rp, ds, &props, ks->ks_kmapv[i / mblock_max], i % mblock_max,
-                              kblk, &hlog);
+                              sum, kblk, &hlog);
         if (ev(err))
             goto err_exit;
 
@@ -624,6 +797,20 @@ kvset_create2(
         }
     }
 
+    /* Keys that were neither cached nor packed and still refer to the
+     * kvset summary must be rebased onto the kblock header, as the summary
+     * is released once the cn is open.
+     */
+    for (i = 0; tree->ct_summary && i < n_kblks; ++i) {
+        struct kvset_kblk *kb = ks->ks_kblks + i;
+
+        if (cn_summary_contains(tree->ct_summary, kb->kb_koff_max))
+            kb->kb_koff_max = kb->kb_kblk_desc.map_base + kb->kb_hoff_max;
+
+        if (cn_summary_contains(tree->ct_summary, kb->kb_koff_min))
+            kb->kb_koff_min = kb->kb_kblk_desc.map_base + kb->kb_hoff_min;
+    }
+
     ks->ks_minkey = ks->ks_kblks[0].kb_koff_min;
     ks->ks_minklen = ks->ks_kblks[0].kb_klen_min;
     {
@@ -996,7 +1183,9 @@ _kvset_destroy(struct kvset *ks)
     for (i = 0; i < ks->ks_st.kst_kblks; i++) {
         struct kvset_kblk *kblk = ks->ks_kblks + i;
 
-        kbr_free_blm_pages(&kblk->kb_kblk_desc, kblk->kb_cn_bloom_lookup, kblk->kb_blm_pages);
+        if (!kblk->kb_blm_pin)
+            kbr_free_blm_pages(&kblk->kb_kblk_desc, kblk->kb_cn_bloom_lookup, kblk->kb_blm_pages);
+        kvset_kblk_unpin(kblk);
     }
 
     cleanup_kblocks(ks);
@@ -1179,6 +1368,70 @@ kvset_kblk_start(struct kvset *ks, const void *key, int len, bool reverse)
     }
 }
 
+u64
+kvset_range_keys_est(struct kvset *ks, const struct kvs_ktuple *start,
+                     const struct kvs_ktuple *end)
+{
+    u64 keys = 0;
+    u32 i;
+
+    for (i = 0; i < ks->ks_st.kst_kblks; ++i) {
+        struct kvset_kblk *kb = ks->ks_kblks + i;
+        struct wbt_desc *wbd = &kb->kb_wbt_desc;
+        u64 live = kb->kb_metrics.num_keys;
+        uint first, last;
+
+        /* Kblocks are sorted and disjoint, so the first kblock past the
+         * end of the range ends the search.
+         */
+        if (keycmp(kb->kb_koff_min, kb->kb_klen_min, end->kt_data, end->kt_len) >= 0)
+            break;
+
+        if (keycmp(kb->kb_koff_max, kb->kb_klen_max, start->kt_data, start->kt_len) < 0)
+            continue;
+
+        live -= min_t(u64, kb->kb_metrics.num_tombstones, live);
+        if (!live || !wbd->wbd_leaf_cnt)
+            continue;
+
+        first = 0;
+        last = wbd->wbd_leaf_cnt - 1;
+
+        if (keycmp(kb->kb_koff_min, kb->kb_klen_min, start->kt_data, start->kt_len) < 0)
+            first = wbtr_leaf_index(&kb->kb_kblk_desc, wbd, start->kt_data, start->kt_len);
+
+        if (keycmp(kb->kb_koff_max, kb->kb_klen_max, end->kt_data, end->kt_len) >= 0)
+            last = wbtr_leaf_index(&kb->kb_kblk_desc, wbd, end->kt_data, end->kt_len);
+
+        if (last < first)
+            continue;
+
+        keys += live * (last - first + 1) / wbd->wbd_leaf_cnt;
+    }
+
+    return keys;
+}
+
+/* Probe the in-memory copy of a kblock's bloom filter, if there is one.
+ * A resident copy may be evicted at any time, hence the RCU read lock.
+ * Returns false if there is no in-memory copy.
+ */
+static bool
+kvset_kblk_bloom_lookup(struct kvset_kblk *kblk, struct kvs_ktuple *kt, bool *hit)
+{
+    const u8 *blm;
+
+    rcu_read_lock();
+    blm = rcu_dereference(kblk->kb_blm_pages);
+    if (blm) {
+        cn_pin_touch(kblk->kb_blm_pin);
+        *hit = bloom_reader_buffer_lookup(&kblk->kb_blm_desc, blm, kt);
+    }
+    rcu_read_unlock();
+
+    return blm;
+}
+
 static merr_t
 kblk_get_value_ref(
     struct kvset *         ks,
@@ -1190,20 +1443,34 @@ kblk_get_value_ref(
     struct kvs_vtuple_ref *vref)
 {
     struct kvset_kblk *kblk = ks->ks_kblks + kblk_idx;
-    bool               hit;
-    merr_t             err;
+    bool               hit = true;
+    merr_t             err = 0;
+    u64                rt_start;
 
-    if (kblk->kb_blm_pages) {
-        hit = bloom_reader_buffer_lookup(&kblk->kb_blm_desc, kblk->kb_blm_pages, kt);
-        if (!hit)
-            return 0;
+    rt_start = reqtrace_stage_start();
+
+    if (kblk->kb_cn_bloom_lookup == BLOOM_LOOKUP_NONE) {
+        hit = true;
+    } else if (kvset_kblk_bloom_lookup(kblk, kt, &hit)) {
+        /* answered from the in-memory copy of the bloom */
     } else if (kblk->kb_blm_desc.bd_n_pages) {
         err = bloom_reader_mcache_lookup(&kblk->kb_blm_desc, &kblk->kb_kblk_desc, kt, &hit);
-        if (!ev(err) && !hit)
-            return 0;
+        if (ev(err))
+            hit = true;
     }
 
-    return wbtr_read_vref(&kblk->kb_kblk_desc, &kblk->kb_wbt_desc, kt, lcp, seq, result, vref);
+    reqtrace_stage_end(REQTRACE_STAGE_BLOOM, rt_start);
+
+    if (!hit)
+        return 0;
+
+    cn_pin_touch(kblk->kb_wbt_pin);
+
+    rt_start = reqtrace_stage_start();
+    err = wbtr_read_vref(&kblk->kb_kblk_desc, &kblk->kb_wbt_desc, kt, lcp, seq, result, vref);
+    reqtrace_stage_end(REQTRACE_STAGE_WBT, rt_start);
+
+    return err;
 }
 
 static merr_t
@@ -1367,10 +1634,20 @@ kvset_lookup_val_direct(
     bool         freeme;
     size_t       off;
     merr_t       err;
-    u64          mbid;
+    u64          mbid, rt_start;
 
     mbid = lvx2mbid(ks, vbidx);
 
+    if (cn_bcache_enabled()) {
+        rt_start = reqtrace_stage_start();
+        err = cn_bcache_read(ks->ks_ds, mbid, vbd->vbd_off + vboff, copylen, vbuf);
+        reqtrace_stage_end(REQTRACE_STAGE_VBLOCK, rt_start);
+        if (err)
+            log_errx("off %lx, copylen %u: @@e", err, (ulong)vbd->vbd_off + vboff, copylen);
+
+        return err;
+    }
+
     off = vbd->vbd_off + (vboff & PAGE_MASK);
 
     iov.iov_len = ALIGN(vboff + copylen, PAGE_SIZE) - (vboff & PAGE_MASK);
@@ -1399,7 +1676,9 @@ kvset_lookup_val_direct(
         }
     }
 
+    rt_start = reqtrace_stage_start();
     err = mpool_mblock_read(ks->ks_ds, mbid, &iov, 1, off);
+    reqtrace_stage_end(REQTRACE_STAGE_VBLOCK, rt_start);
     if (err) {
         log_errx("off %lx, len %lx, copylen %u, vbufsz %u: @@e",
                  err, off, iov.iov_len, copylen, vbufsz);
@@ -1433,7 +1712,7 @@ kvset_lookup_val_direct_decompress(
     size_t       off;
     merr_t       err;
     void        *src;
-    u64          mbid;
+    u64          mbid, rt_start;
 
     mbid = lvx2mbid(ks, vbidx);
 
@@ -1451,14 +1730,28 @@ kvset_lookup_val_direct_decompress(
         freeme = true;
     }
 
-    err = mpool_mblock_read(ks->ks_ds, mbid, &iov, 1, off);
+    rt_start = reqtrace_stage_start();
+
+    /* The block cache copies out exactly the bytes requested, so the
+     * compressed value lands at the start of the buffer.
+     */
+    if (cn_bcache_enabled()) {
+        src = iov.iov_base;
+        err = cn_bcache_read(ks->ks_ds, mbid, vbd->vbd_off + vboff, omlen, src);
+    } else {
+        src = iov.iov_base + (vboff & ~PAGE_MASK);
+        err = mpool_mblock_read(ks->ks_ds, mbid, &iov, 1, off);
+    }
+
+    reqtrace_stage_end(REQTRACE_STAGE_VBLOCK, rt_start);
+
     if (err) {
         log_errx("off %lx, len %lx, copylen %u, omlen %u: @@e",
                  err, off, iov.iov_len, copylen, omlen);
     } else {
-        src = iov.iov_base + (vboff & ~PAGE_MASK);
-
+        rt_start = reqtrace_stage_start();
         err = compress_lz4_ops.cop_decompress(src, omlen, vbuf, copylen, outlenp);
+        reqtrace_stage_end(REQTRACE_STAGE_DECOMPRESS, rt_start);
     }
 
     if (freeme)
@@ -1467,6 +1760,22 @@ kvset_lookup_val_direct_decompress(
     return ev(err);
 }
 
+static void
+kvset_vpin_release(void *arg)
+{
+    kvset_put_ref(arg);
+}
+
+static void
+kvset_vpin(struct kvset *ks, struct kvs_vpin *pin, const void *data)
+{
+    kvset_get_ref(ks);
+
+    pin->vp_data = data;
+    pin->vp_obj = ks;
+    pin->vp_release = kvset_vpin_release;
+}
+
 static
 merr_t
 kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *vbuf)
@@ -1475,6 +1784,7 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     merr_t              err;
     void               *src, *dst;
     uint                omlen, copylen;
+    u64                 rt_start;
     bool direct;
 
     assert(vref->vr_type == vtype_ival
@@ -1487,6 +1797,12 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
         return 0;
     }
 
+    if (vbuf->b_pin && vref->vr_type == vtype_ival) {
+        kvset_vpin(ks, vbuf->b_pin, vref->vi.vr_data);
+        vbuf->b_len = vref->vi.vr_len;
+        return 0;
+    }
+
     if (vref->vr_type == vtype_ival)
         return kvset_get_immediate_value(vref, vbuf);
 
@@ -1497,11 +1813,23 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
     omlen = vref->vb.vr_complen ? vref->vb.vr_complen : vref->vb.vr_len;
     src = vbr_value(vbd, vref->vb.vr_off, omlen);
 
+    /* Uncompressed values can be returned by reference into the vblock's
+     * mcache map, which remains valid for as long as the kvset does.
+     */
+    if (vbuf->b_pin && !vref->vb.vr_complen) {
+        kvset_vpin(ks, vbuf->b_pin, src);
+        vbuf->b_len = vref->vb.vr_len;
+        return 0;
+    }
+
     /* output buffer and how much to copy out */
     dst = vbuf->b_buf;
     copylen = min(vref->vb.vr_len, vbuf->b_buf_sz);
 
-    direct = (copylen >= ks->ks_vmax ||
+    /* With the block cache enabled all value reads go through it rather
+     * than the mcache map, regardless of value size.
+     */
+    direct = (cn_bcache_enabled() || copylen >= ks->ks_vmax ||
               (copylen >= ks->ks_vmin && ks->ks_node_level >= ks->ks_vminlvl)) &&
              (vbd->vbd_mblkdesc.mclass != HSE_MCLASS_PMEM);
 
@@ -1518,7 +1846,9 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
                 ks, vbd, vref->vb.vr_index, vref->vb.vr_off, dst, copylen, omlen, &outlen);
 
         if (!direct || err) {
+            rt_start = reqtrace_stage_start();
             err = compress_lz4_ops.cop_decompress(src, omlen, dst, copylen, &outlen);
+            reqtrace_stage_end(REQTRACE_STAGE_DECOMPRESS, rt_start);
             if (ev(err))
                 return err;
         }
@@ -1539,7 +1869,12 @@ kvset_lookup_val(struct kvset *ks, struct kvs_vtuple_ref *vref, struct kvs_buf *
             err = 0; /* fall through to memcpy */
         }
 
+        /* Copying from the mcache map is where vblock page faults
+         * are taken.
+         */
+        rt_start = reqtrace_stage_start();
         memcpy(dst, src, copylen);
+        reqtrace_stage_end(REQTRACE_STAGE_VBLOCK, rt_start);
     }
 
   done:
@@ -1611,20 +1946,15 @@ next_kblk:
      * subsequent kblock.  It is thus safe to stop looking at
      * this kvset once there's a bloom miss.
      */
-    if (kblk->kb_blm_desc.bd_n_pages) {
-        const u64 lookup = kblk->kb_cn_bloom_lookup;
-        bool      hit = true;
-
-        if (HSE_LIKELY(lookup == BLOOM_LOOKUP_MCACHE)) {
-            hit = bloom_reader_buffer_lookup(&kblk->kb_blm_desc, kblk->kb_blm_pages, kt);
-        } else if (lookup == BLOOM_LOOKUP_BUFFER) {
-            hit = bloom_reader_buffer_lookup(&kblk->kb_blm_desc, kblk->kb_blm_pages, kt);
-        }
+    if (kblk->kb_cn_bloom_lookup != BLOOM_LOOKUP_NONE) {
+        bool hit;
 
-        if (!hit)
+        if (kvset_kblk_bloom_lookup(kblk, kt, &hit) && !hit)
             goto done;
     }
 
+    cn_pin_touch(kblk->kb_wbt_pin);
+
     wbti_reset(wbti, &kblk->kb_kblk_desc, &kblk->kb_wbt_desc, kt, 0, 0);
 
 get_more:
@@ -1804,6 +2134,78 @@ kvset_get_hlog(struct kvset *ks)
     return ks->ks_hlog;
 }
 
+size_t
+kvset_summary_len(const struct kvset *ks)
+{
+    size_t len = 0;
+    uint   i;
+
+    for (i = 0; i < ks->ks_st.kst_kblks; i++) {
+        const struct kvset_kblk *kb = ks->ks_kblks + i;
+
+        len += sizeof(struct cn_summary_kblk_omf) + kb->kb_klen_max + kb->kb_klen_min;
+    }
+
+    return len;
+}
+
+size_t
+kvset_summary_pack(const struct kvset *ks, void *buf)
+{
+    struct cn_summary_kblk_omf *sum;
+    uint                        i, last = ks->ks_st.kst_kblks - 1;
+    u8 *                        cur = buf;
+
+    for (i = 0; i <= last; i++) {
+        const struct kvset_kblk *kb = ks->ks_kblks + i;
+        struct cn_summary_blm_omf *blm;
+
+        sum = (void *)cur;
+        blm = &sum->csk_blm;
+
+        omf_set_csk_dgen(sum, ks->ks_dgen);
+        omf_set_csk_blkid(sum, kb->kb_kblk.bk_blkid);
+        omf_set_csk_seqno_min(sum, kb->kb_seqno_min);
+        omf_set_csk_seqno_max(sum, kb->kb_seqno_max);
+        omf_set_csk_key_bytes(sum, kb->kb_metrics.tot_key_bytes);
+        omf_set_csk_val_bytes(sum, kb->kb_metrics.tot_val_bytes);
+        omf_set_csk_keys(sum, kb->kb_metrics.num_keys);
+        omf_set_csk_tombs(sum, kb->kb_metrics.num_tombstones);
+        omf_set_csk_wbt_pgc(sum, kb->kb_metrics.tot_wbt_pages);
+        omf_set_csk_blm_pgc(sum, kb->kb_metrics.tot_blm_pages);
+        omf_set_csk_hoff_max(sum, kb->kb_hoff_max);
+        omf_set_csk_hoff_min(sum, kb->kb_hoff_min);
+        omf_set_csk_klen_max(sum, kb->kb_klen_max);
+        omf_set_csk_klen_min(sum, kb->kb_klen_min);
+
+        /* Only the last kblock's hlog is retained by the kvset.
+         */
+        omf_set_csk_hlog_pg(sum, 0);
+        if (i == last && ks->ks_hlog)
+            omf_set_csk_hlog_pg(sum, (ks->ks_hlog - (u8 *)kb->kb_kblk_desc.map_base) / PAGE_SIZE);
+
+        kvset_wbt2summary(&kb->kb_wbt_desc, &sum->csk_wbt);
+        kvset_wbt2summary(&kb->kb_pt_desc, &sum->csk_pt);
+
+        omf_set_csb_modulus(blm, kb->kb_blm_desc.bd_modulus);
+        omf_set_csb_bktshift(blm, kb->kb_blm_desc.bd_bktshift);
+        omf_set_csb_bktmask(blm, kb->kb_blm_desc.bd_bktmask);
+        omf_set_csb_n_hashes(blm, kb->kb_blm_desc.bd_n_hashes);
+        omf_set_csb_rotl(blm, kb->kb_blm_desc.bd_rotl);
+        omf_set_csb_first_page(blm, kb->kb_blm_desc.bd_first_page);
+        omf_set_csb_n_pages(blm, kb->kb_blm_desc.bd_n_pages);
+        omf_set_csb_bktsz(blm, kb->kb_blm_desc.bd_bktsz);
+
+        cur += sizeof(*sum);
+        memcpy(cur, kb->kb_koff_max, kb->kb_klen_max);
+        cur += kb->kb_klen_max;
+        memcpy(cur, kb->kb_koff_min, kb->kb_klen_min);
+        cur += kb->kb_klen_min;
+    }
+
+    return cur - (u8 *)buf;
+}
+
 u64
 kvset_ctime(const struct kvset *kvset)
 {
@@ -2104,6 +2506,7 @@ struct kvset_iterator {
     struct wbti *            pti;
     struct perfc_set *       pc;
     struct cn_merge_stats *  stats;
+    struct cn_qos_budget *   qos;
     uint                     curr_kblk;
     enum last_src            last;
     u32                      vra_flags;
@@ -2686,7 +3089,7 @@ err_exit1:
     return err;
 }
 
-static bool
+bool
 kvset_cursor_next(struct element_source *es, void **element)
 {
     struct kv_iterator *kvi = kvset_cursor_es_h2r(es);
@@ -2694,9 +3097,14 @@ kvset_cursor_next(struct element_source *es, void **element)
 
     *element = 0;
 
-    kvset_iter_next_key(kvi, &kv->kobj, &kv->vctx);
-    if (kvi->kvi_eof)
-        return false;
+    /* Skip keys rejected by the cursor's predicate here, so that they
+     * never enter the cn cursor's binheap and their values are never read.
+     */
+    do {
+        kvset_iter_next_key(kvi, &kv->kobj, &kv->vctx);
+        if (kvi->kvi_eof)
+            return false;
+    } while (kvi->kvi_pred && !kv->vctx.is_ptomb && !kc_pred_match(kvi->kvi_pred, &kv->kobj));
 
     kv->src = es;
     *element = &kvi->kvi_kv;
@@ -2712,6 +3120,14 @@ kvset_iter_set_stats(struct kv_iterator *handle, struct cn_merge_stats *stats)
     iter->stats = stats;
 }
 
+void
+kvset_iter_set_qos(struct kv_iterator *handle, struct cn_qos_budget *qos)
+{
+    struct kvset_iterator *iter = handle_to_kvset_iter(handle);
+
+    iter->qos = qos;
+}
+
 merr_t
 kvset_iter_set_start(struct kv_iterator *handle, int start, int pt_start)
 {
@@ -3171,6 +3587,7 @@ kvset_iter_next_key_read(
         }
         if (ms)
             count_ops(&ms->ms_kblk_read, kr->iores.kr_ops, kr->iores.kr_bytes, 0);
+        cn_qos_budget_charge(iter->qos, kr->iores.kr_bytes);
 
         /* new work buffer */
         wbt_reader->wb_node = kr->iores.kr_nodev;
@@ -3429,6 +3846,7 @@ kvset_iter_get_valptr_read(
 
         if (ms)
             count_ops(&ms->ms_vblk_read1, 1, active->len, 0);
+        cn_qos_budget_charge(iter->qos, active->len);
 
         /* Check if previous read satisfied our need. If not, then
          * read ahead guessed wrong and we need to start a new one
@@ -3456,6 +3874,7 @@ kvset_iter_get_valptr_read(
 
     if (ms)
         count_ops(&ms->ms_vblk_read2, 1, active->len, 0);
+    cn_qos_budget_charge(iter->qos, active->len);
 
 have_data:
 
@@ -31,6 +31,7 @@ struct mbset;
 struct cn_kvdb;
 struct cn_tree;
 struct cn_merge_stats;
+struct cn_qos_budget;
 struct kvset_stats;
 
 #include "blk_list.h"
@@ -271,6 +272,20 @@ kvset_pt_start(struct kvset *kvset);
 int
 kvset_kblk_start(struct kvset *kvset, const void *key, int len, bool reverse);
 
+/**
+ * kvset_range_keys_est() - estimate the number of live keys in a range
+ * @kvset: kvset to examine
+ * @start: first key of the range (inclusive)
+ * @end:   last key of the range (exclusive)
+ *
+ * Kblocks wholly within the range contribute their key count less their
+ * tombstone count.  Kblocks straddling an edge of the range contribute in
+ * proportion to the number of their wbtree leaves that the range spans.
+ */
+u64
+kvset_range_keys_est(struct kvset *kvset, const struct kvs_ktuple *start,
+                     const struct kvs_ktuple *end);
+
 /**
  * kvset_lookup() - Search a kvset for a key and return its value
  * @kvset:  kvset to search
@@ -350,6 +365,23 @@ kvset_set_scatter_pct(struct kvset *self, uint spct);
 u8 *
 kvset_get_hlog(struct kvset *km);
 
+/**
+ * kvset_summary_len() - get the size of a kvset's summary records
+ * @ks: kvset
+ */
+size_t
+kvset_summary_len(const struct kvset *ks);
+
+/**
+ * kvset_summary_pack() - serialize a kvset's kblock summary records
+ * @ks:  kvset
+ * @buf: output buffer of at least kvset_summary_len() bytes
+ *
+ * Return: number of bytes written to @buf
+ */
+size_t
+kvset_summary_pack(const struct kvset *ks, void *buf);
+
 /* MTF_MOCK */
 uint
 kvset_get_compc(struct kvset *km);
@@ -412,6 +444,15 @@ kvset_iter_release(struct kv_iterator *handle);
 void
 kvset_iter_set_stats(struct kv_iterator *handle, struct cn_merge_stats *stats);
 
+/**
+ * kvset_iter_set_qos() - charge iterator mblock reads against a budget
+ * @handle: kvset iterator
+ * @qos:    compaction read budget (may be NULL)
+ */
+/* MTF_MOCK */
+void
+kvset_iter_set_qos(struct kv_iterator *handle, struct cn_qos_budget *qos);
+
 /* MTF_MOCK */
 merr_t
 kvset_iter_set_start(struct kv_iterator *kv_iter, int start, int pt_start);
@@ -426,6 +467,17 @@ kvset_iter_set_start(struct kv_iterator *kv_iter, int start, int pt_start);
 merr_t
 kvset_iter_seek(struct kv_iterator *handle, const void *key, int len, bool *eof);
 
+/**
+ * kvset_cursor_next() - element source callback for kvset cursor iterators
+ * @es:      the iterator's element source
+ * @element: (output) next key that passes the iterator's predicate
+ *
+ * Installed by kvset_iter_set_start() and kvset_iter_seek().
+ */
+/* PRIVATE */
+bool
+kvset_cursor_next(struct element_source *es, void **element);
+
 /* MTF_MOCK */
 void
 kvset_iter_mark_eof(struct kv_iterator *handle);
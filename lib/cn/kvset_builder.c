@@ -418,6 +418,13 @@ kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats
     vbb_set_merge_stats(self->vbb, stats);
 }
 
+void
+kvset_builder_set_qos(struct kvset_builder *self, struct cn_qos_budget *qos)
+{
+    kbb_set_qos(self->kbb, qos);
+    vbb_set_qos(self->vbb, qos);
+}
+
 #if HSE_MOCKING
 #include "kvset_builder_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -762,7 +762,8 @@ _kblock_check(struct kb_info *kb_info, struct vb_meta *vb_meta)
 
     wbt_ver = omf_wbt_version(wbt_hdr);
     switch (wbt_ver) {
-        case WBT_TREE_VERSION:
+        case WBT_TREE_VERSION6:
+        case WBT_TREE_VERSION7:
             kb_info->wbt_ops.wops_lfe = wbt_lfe;
             kb_info->wbt_ops.wops_node_pfx = wbt_node_pfx;
             kb_info->wbt_ops.wops_lfe_key = wbt_lfe_key;
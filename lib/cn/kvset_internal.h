@@ -42,11 +42,16 @@ struct kvset_kblk {
     const void *    kb_koff_min;   /* ptr to smallest key in kblk */
     u16             kb_klen_max;   /* length of largest key */
     u16             kb_klen_min;   /* length of smallest key */
+    u16             kb_hoff_max;   /* hdr offset of largest key */
+    u16             kb_hoff_min;   /* hdr offset of smallest key */
 
     u16               kb_cn_bloom_lookup;
     struct bloom_desc kb_blm_desc;  /* Bloom descriptor */
     u8 *              kb_blm_pages; /* Bloom pages */
 
+    struct cn_pin *kb_blm_pin; /* resident arena copy of bloom */
+    struct cn_pin *kb_wbt_pin; /* resident arena copy of wbt nodes */
+
     u64 kb_seqno_min; /* min seqno */
     u64 kb_seqno_max; /* max seqno */
 
@@ -267,4 +267,106 @@ OMF_SETGET(struct cn_tstate_omf, ts_version, 32)
 OMF_SETGET(struct cn_tstate_omf, ts_khm_gen, 32)
 OMF_SETGET_CHBUF(struct cn_tstate_omf, ts_khm_mapv);
 
+/* cn kvset summary
+ *
+ * The summary is a cache of the metadata kvset_create() derives from each
+ * kblock header.  It lives in a per-cn file in the capacity media class
+ * and consists of a header followed by one variable length record per
+ * kblock.  Each record is followed by the kblock's max key and then its
+ * min key.
+ */
+#define CN_SUMMARY_MAGIC (u32)('c' << 24 | 's' << 16 | 'u' << 8 | 'm')
+
+struct cn_summary_hdr_omf {
+    uint32_t csh_magic;
+    uint32_t csh_version;
+    uint64_t csh_cnid;
+    uint64_t csh_len;
+    uint32_t csh_kblkc;
+    uint32_t csh_crc;
+} HSE_PACKED;
+
+OMF_SETGET(struct cn_summary_hdr_omf, csh_magic, 32)
+OMF_SETGET(struct cn_summary_hdr_omf, csh_version, 32)
+OMF_SETGET(struct cn_summary_hdr_omf, csh_cnid, 64)
+OMF_SETGET(struct cn_summary_hdr_omf, csh_len, 64)
+OMF_SETGET(struct cn_summary_hdr_omf, csh_kblkc, 32)
+OMF_SETGET(struct cn_summary_hdr_omf, csh_crc, 32)
+
+struct cn_summary_wbt_omf {
+    uint32_t csw_first_page;
+    uint32_t csw_n_pages;
+    uint16_t csw_root;
+    uint16_t csw_leaf;
+    uint16_t csw_leaf_cnt;
+    uint16_t csw_kmd_pgc;
+    uint16_t csw_version;
+} HSE_PACKED;
+
+OMF_SETGET(struct cn_summary_wbt_omf, csw_first_page, 32)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_n_pages, 32)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_root, 16)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_leaf, 16)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_leaf_cnt, 16)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_kmd_pgc, 16)
+OMF_SETGET(struct cn_summary_wbt_omf, csw_version, 16)
+
+struct cn_summary_blm_omf {
+    uint32_t csb_modulus;
+    uint32_t csb_bktshift;
+    uint32_t csb_bktmask;
+    uint32_t csb_n_hashes;
+    uint32_t csb_rotl;
+    uint32_t csb_first_page;
+    uint32_t csb_n_pages;
+    uint32_t csb_bktsz;
+} HSE_PACKED;
+
+OMF_SETGET(struct cn_summary_blm_omf, csb_modulus, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_bktshift, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_bktmask, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_n_hashes, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_rotl, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_first_page, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_n_pages, 32)
+OMF_SETGET(struct cn_summary_blm_omf, csb_bktsz, 32)
+
+struct cn_summary_kblk_omf {
+    uint64_t csk_dgen;
+    uint64_t csk_blkid;
+    uint64_t csk_seqno_min;
+    uint64_t csk_seqno_max;
+    uint64_t csk_key_bytes;
+    uint64_t csk_val_bytes;
+    uint32_t csk_keys;
+    uint32_t csk_tombs;
+    uint32_t csk_wbt_pgc;
+    uint32_t csk_blm_pgc;
+    uint32_t csk_hlog_pg;
+    uint16_t csk_hoff_max;
+    uint16_t csk_hoff_min;
+    uint16_t csk_klen_max;
+    uint16_t csk_klen_min;
+
+    struct cn_summary_wbt_omf csk_wbt;
+    struct cn_summary_wbt_omf csk_pt;
+    struct cn_summary_blm_omf csk_blm;
+} HSE_PACKED;
+
+OMF_SETGET(struct cn_summary_kblk_omf, csk_dgen, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_blkid, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_seqno_min, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_seqno_max, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_key_bytes, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_val_bytes, 64)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_keys, 32)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_tombs, 32)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_wbt_pgc, 32)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_blm_pgc, 32)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_hlog_pg, 32)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_hoff_max, 16)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_hoff_min, 16)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_klen_max, 16)
+OMF_SETGET(struct cn_summary_kblk_omf, csk_klen_min, 16)
+
 #endif
@@ -622,6 +622,7 @@ cn_spill(struct cn_compaction_work *w)
             goto done;
 
         kvset_builder_set_merge_stats(w->cw_child[i], &w->cw_stats);
+        kvset_builder_set_qos(w->cw_child[i], w->cw_qos_wr);
 
         pnode = w->cw_node;
         if (pnode && w->cw_action == CN_ACTION_SPILL) {
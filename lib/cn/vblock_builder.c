@@ -29,6 +29,7 @@
 #include "cn_mblocks.h"
 #include "cn_metrics.h"
 #include "cn_perfc.h"
+#include "cn_qos.h"
 
 #include <mpool/mpool.h>
 
@@ -128,6 +129,8 @@ _vblock_write(struct vblock_builder *bld)
     perfc_inc(bld->pc, PERFC_RA_CNCOMP_WREQS);
     perfc_add(bld->pc, PERFC_RA_CNCOMP_WBYTES, bld->wbuf_len);
 
+    cn_qos_budget_charge(bld->qos, iov.iov_len);
+
     return 0;
 }
 
@@ -343,6 +346,12 @@ vbb_set_merge_stats(struct vblock_builder *bld, struct cn_merge_stats *stats)
     bld->mstats = stats;
 }
 
+void
+vbb_set_qos(struct vblock_builder *bld, struct cn_qos_budget *qos)
+{
+    bld->qos = qos;
+}
+
 #if HSE_MOCKING
 #include "vblock_builder_ut_impl.i"
 #endif /* HSE_MOCKING */
@@ -16,6 +16,7 @@ struct vblock_builder;
 struct blk_list;
 struct kvs_rparams;
 struct cn_merge_stats;
+struct cn_qos_budget;
 
 enum hse_mclass;
 enum hse_mclass_policy_age;
@@ -123,6 +124,9 @@ vbb_get_agegroup(struct vblock_builder *bld);
 void
 vbb_set_merge_stats(struct vblock_builder *bld, struct cn_merge_stats *stats);
 
+void
+vbb_set_qos(struct vblock_builder *bld, struct cn_qos_budget *qos);
+
 #if HSE_MOCKING
 #include "vblock_builder_ut.h"
 #endif /* HSE_MOCKING */
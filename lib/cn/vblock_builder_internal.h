@@ -78,6 +78,7 @@ struct vblock_builder {
     struct cn *                cn;
     struct perfc_set *         pc;
     struct cn_merge_stats *    mstats;
+    struct cn_qos_budget *     qos;
     struct blk_list            vblk_list;
     enum hse_mclass_policy_age agegroup;
     uint64_t                   vsize;
@@ -10,6 +10,7 @@
 #include <hse_util/vlb.h>
 #include <hse_util/event_counter.h>
 #include <hse_util/key_util.h>
+#include <hse_util/log2.h>
 
 #include <hse_ikvdb/limits.h>
 #include <hse_ikvdb/omf_kmd.h>
@@ -25,6 +26,18 @@
 #define KMD_CHUNK_LEN (KMD_CHUNK_PAGES * PAGE_SIZE)
 #define KMD_CHUNKS (KBLOCK_MAX_SIZE / KMD_CHUNK_LEN)
 
+/* A leaf node's first key is always a kmd restart key.  Thereafter, a new
+ * restart key is chosen after KMD_RESTART_KEYS keys, or once a key's kmd
+ * would start more than KMD_RESTART_DIST bytes past the base entry (which
+ * keeps most vboff back references within KMD_VBOFF_BREF_MAX).
+ */
+#define KMD_RESTART_KEYS 16
+#define KMD_RESTART_DIST 96
+
+/* The high bit of the first byte of an absolute vboff must be clear.
+ */
+_Static_assert(VBLOCK_MAX_SIZE <= (1ul << 31), "vboff delta flag conflicts with vboff");
+
 /**
  * struct wbb - a wb tree builder (wb --> "wants to be a b-tree")
  * @nodev: vector of nodes (nodev[0] == first leaf node)
@@ -41,6 +54,13 @@
  * @wbt_first_kobj: first key (aka, min key in wb tree)
  * @wbt_last_kobj: last key (aka, max key in wb tree)
  * @sum_right_keys: total length of right-most keys in all leaf nodes
+ * @kmd_base_off:   kmd region offset of the current restart key's base entry
+ * @kmd_base_keys:  number of keys added since the current restart key
+ * @kmd_base_seq:   seqno of the base entry
+ * @kmd_base_vboff: vblock offset of the base entry (if @kmd_base_vref)
+ * @kmd_base_vref:  base entry is a vtype_val or vtype_cval
+ * @kmd_buf:        buffer for a key's delta encoded kmd
+ * @kmd_bufsz:      size of @kmd_buf
  *
  * Notes:
  *   @max_pages tracks the max number of pages that can be used by the wbtree.
@@ -78,6 +98,14 @@ struct wbb {
 
     uint entries;
 
+    uint  kmd_base_off;
+    uint  kmd_base_keys;
+    u64   kmd_base_seq;
+    uint  kmd_base_vboff;
+    bool  kmd_base_vref;
+    void *kmd_buf;
+    uint  kmd_bufsz;
+
     uint         kmd_iov_index;
     struct iovec kmd_iov[KMD_CHUNKS + 1];
 };
@@ -229,6 +257,115 @@ wbb_kmd_append(struct wbb *wbb, const void *data, uint dlen, bool copy)
     return 0;
 }
 
+/**
+ * wbb_kmd_restart() - make a key's first kmd entry the new base entry
+ * @wbb:     wbtree builder
+ * @key_kmd: the key's kmd entries (i.e., without the count)
+ * @pos:     kmd region offset of @key_kmd
+ */
+static void
+wbb_kmd_restart(struct wbb *wbb, const void *key_kmd, uint pos)
+{
+    enum kmd_vtype vtype;
+    size_t         off = 0;
+    uint           vbidx, vlen;
+
+    kmd_type_seq(key_kmd, &off, &vtype, &wbb->kmd_base_seq);
+
+    wbb->kmd_base_off = pos;
+    wbb->kmd_base_keys = 0;
+    wbb->kmd_base_vref = (vtype == vtype_val || vtype == vtype_cval);
+    if (wbb->kmd_base_vref)
+        kmd_val(key_kmd, &off, &vbidx, &wbb->kmd_base_vboff, &vlen);
+}
+
+/**
+ * wbb_kmd_delta() - delta encode a key's kmd entries against the base entry
+ * @wbb:     wbtree builder
+ * @key_kmd: the key's kmd entries (i.e., without the count)
+ * @nvals:   number of entries in @key_kmd
+ * @pos:     kmd region offset at which the result will be stored
+ * @dst:     output buffer, at least as large as @key_kmd
+ *
+ * Each seqno and vboff is delta encoded only if that is shorter than its
+ * absolute encoding, so the result is never larger than @key_kmd.
+ *
+ * Return: length of the encoded entries in @dst
+ */
+static uint
+wbb_kmd_delta(struct wbb *wbb, const void *key_kmd, uint nvals, uint pos, void *dst)
+{
+    size_t soff = 0, doff = 0;
+
+    while (nvals-- > 0) {
+        enum kmd_vtype vtype;
+        const void *   vdata;
+        uint           vbidx, vboff, vlen, complen;
+        uint           bref;
+        u64            seq, zz;
+
+        kmd_type_seq(key_kmd, &soff, &vtype, &seq);
+
+        bref = pos + doff - wbb->kmd_base_off;
+        zz = kmd_zigzag(seq - wbb->kmd_base_seq);
+
+        if (bref <= HG16_32K_MAX && zz <= HG32_1024M_MAX &&
+            hg16_32k_len(bref) + hg32_1024m_len(zz) < hg64_len(seq)) {
+            kmd_add_seq_delta(dst, &doff, vtype, seq, bref, wbb->kmd_base_seq);
+        } else {
+            ((u8 *)dst)[doff++] = vtype;
+            encode_hg64(dst, &doff, seq);
+        }
+
+        switch (vtype) {
+            case vtype_val:
+            case vtype_cval:
+                complen = 0;
+                if (vtype == vtype_cval)
+                    kmd_cval(key_kmd, &soff, &vbidx, &vboff, &vlen, &complen);
+                else
+                    kmd_val(key_kmd, &soff, &vbidx, &vboff, &vlen);
+
+                encode_hg16_32k(dst, &doff, vbidx);
+
+                bref = pos + doff - wbb->kmd_base_off;
+
+                if (wbb->kmd_base_vref && bref <= KMD_VBOFF_BREF_MAX &&
+                    vboff >= wbb->kmd_base_vboff &&
+                    vboff - wbb->kmd_base_vboff <= HG32_1024M_MAX &&
+                    1 + hg32_1024m_len(vboff - wbb->kmd_base_vboff) < sizeof(u32)) {
+                    kmd_add_vboff_delta(dst, &doff, vboff, bref, wbb->kmd_base_vboff);
+                } else {
+                    __be32 val32 = cpu_to_be32(vboff);
+
+                    memcpy(dst + doff, &val32, sizeof(val32));
+                    doff += sizeof(val32);
+                }
+
+                encode_hg32_1024m(dst, &doff, vlen);
+                if (vtype == vtype_cval)
+                    encode_hg32_1024m(dst, &doff, complen);
+                break;
+
+            case vtype_ival:
+                kmd_ival(key_kmd, &soff, &vdata, &vlen);
+                ((u8 *)dst)[doff++] = vlen;
+                memcpy(dst + doff, vdata, vlen);
+                doff += vlen;
+                break;
+
+            case vtype_zval:
+            case vtype_tomb:
+            case vtype_ptomb:
+                break;
+        }
+    }
+
+    assert(doff <= soff);
+
+    return doff;
+}
+
 uint
 wbb_entries(struct wbb *wbb)
 {
@@ -321,6 +458,7 @@ wbb_add_entry(
     char   encoded_cnt[4]; /* large enough to hold kmd encoded count */
     size_t new_pfx_len;
     uint   klen = key_obj_len(kobj);
+    bool   new_node, restart;
 
     struct key_stage_entry_leaf *kst_leaf;
 
@@ -350,6 +488,39 @@ wbb_add_entry(
     encoded_cnt_len = 0;
     kmd_set_count(encoded_cnt, &encoded_cnt_len, nvals);
 
+    /* Determine whether this key will start a new node, which must begin
+     * with a kmd restart key.
+     */
+    space = sizeof(struct wbt_node_hdr_omf) + new_pfx_len +
+            ((wbb->cnode_nkeys + 1) * sizeof(struct wbt_lfe_omf)) + wbb->cnode_sumlen + klen +
+            (sizeof(u32) * wbb->cnode_key_extra_cnt) - ((wbb->cnode_nkeys + 1) * new_pfx_len);
+
+    new_node = space > PAGE_SIZE;
+
+    restart = new_node || wbb->cnode_nkeys == 0 || wbb->kmd_base_keys >= KMD_RESTART_KEYS ||
+              entry_kmd_off - wbb->kmd_base_off > KMD_RESTART_DIST;
+
+    if (!restart) {
+        if (wbb->kmd_bufsz < key_kmd_len) {
+            void *mem;
+            uint  sz;
+
+            sz = roundup_pow_of_two(max_t(uint, key_kmd_len, 256));
+
+            mem = malloc(sz);
+            if (ev(!mem))
+                return merr(ENOMEM);
+
+            free(wbb->kmd_buf);
+            wbb->kmd_buf = mem;
+            wbb->kmd_bufsz = sz;
+        }
+
+        key_kmd_len = wbb_kmd_delta(wbb, key_kmd, nvals, entry_kmd_off + encoded_cnt_len,
+                                    wbb->kmd_buf);
+        key_kmd = wbb->kmd_buf;
+    }
+
     /* Calculate size of wbtree after adding key metadata.
      * Save max_pgc and used_pgc for use deeper in the call stack.
      */
@@ -367,11 +538,7 @@ wbb_add_entry(
     wbb->cnode_sumlen += klen;
 
     /* Create a new node if space exceeds PAGE_SIZE */
-    space = sizeof(struct wbt_node_hdr_omf) + new_pfx_len +
-            ((wbb->cnode_nkeys + 1) * sizeof(struct wbt_lfe_omf)) + wbb->cnode_sumlen +
-            (sizeof(u32) * wbb->cnode_key_extra_cnt) - ((wbb->cnode_nkeys + 1) * new_pfx_len);
-
-    if (space > PAGE_SIZE) {
+    if (new_node) {
 
         /* close out current node */
         wbt_leaf_publish(wbb);
@@ -406,6 +573,10 @@ wbb_add_entry(
         return merr(ev(EBUG));
     }
 
+    if (restart)
+        wbb_kmd_restart(wbb, key_kmd, entry_kmd_off + encoded_cnt_len);
+    wbb->kmd_base_keys++;
+
     /* Commit the new entry
      * - move key cursor back, move entry cursor forward
      * - save key offset in LFE
@@ -566,7 +737,8 @@ wbb_init(struct wbb *wbb, void *nodev, uint max_pgc, uint *wbt_pgc)
 {
     void  *kst_base, *kst_end, *iov_base[KMD_CHUNKS + 1];
     struct intern_builder *ibldr;
-    uint   kst_pgc;
+    void  *kmd_buf;
+    uint   kst_pgc, kmd_bufsz;
     uint   i;
     merr_t err;
 
@@ -575,6 +747,8 @@ wbb_init(struct wbb *wbb, void *nodev, uint max_pgc, uint *wbt_pgc)
     kst_base = wbb->cnode_key_stage_base;
     kst_end = wbb->cnode_key_stage_end;
     kst_pgc = wbb->cnode_key_stage_pgc;
+    kmd_buf = wbb->kmd_buf;
+    kmd_bufsz = wbb->kmd_bufsz;
     for (i = 0; wbb->kmd_iov[i].iov_base; i++)
         iov_base[i] = wbb->kmd_iov[i].iov_base;
     iov_base[i] = NULL;
@@ -586,6 +760,8 @@ wbb_init(struct wbb *wbb, void *nodev, uint max_pgc, uint *wbt_pgc)
     wbb->cnode_key_stage_base = kst_base;
     wbb->cnode_key_stage_end = kst_end;
     wbb->cnode_key_stage_pgc = kst_pgc;
+    wbb->kmd_buf = kmd_buf;
+    wbb->kmd_bufsz = kmd_bufsz;
     for (i = 0; iov_base[i]; i++)
         wbb->kmd_iov[i].iov_base = iov_base[i];
 
@@ -709,6 +885,7 @@ wbb_destroy(struct wbb *wbb)
             vlb_free(wbb->kmd_iov[i].iov_base, KMD_CHUNK_LEN);
         free_aligned(wbb->nodev);
         free(wbb->cnode_key_stage_base);
+        free(wbb->kmd_buf);
         free(wbb);
     }
 }
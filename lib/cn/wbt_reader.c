@@ -14,6 +14,8 @@
 
 #include <hse/limits.h>
 
+#include <urcu-bp.h>
+
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/omf_kmd.h>
 
@@ -99,6 +101,22 @@ wbti_get_page(struct wbti *self, u32 node_idx)
     self->node_idx = node_idx;
 }
 
+/* Internal nodes are served from the resident copy if there is one,
+ * leaves always come from the mcache map.
+ */
+static HSE_ALWAYS_INLINE void *
+wbtr_node(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    void *                      ine_pin,
+    uint                        node_num)
+{
+    if (ine_pin && node_num >= wbd->wbd_leaf_cnt)
+        return ine_pin + (node_num - wbd->wbd_leaf_cnt) * PAGE_SIZE;
+
+    return kbd->map_base + (wbd->wbd_first_page + node_num) * PAGE_SIZE;
+}
+
 static int
 wbtr_seek_page(
     const struct kvs_mblk_desc *kbd,
@@ -110,21 +128,22 @@ wbtr_seek_page(
     struct wbt_node_hdr_omf *node;
     int                      j, cmp, node_num;
     uint                     cmplen;
-    size_t                   pg;
+    void *                   ine_pin;
 
-    /* pull struct derefs out of the loop */
-    uint  first_page = wbd->wbd_first_page;
-    void *map_base = kbd->map_base;
+    /* The resident copy of the internal nodes may be evicted at any
+     * time, but not while we're in an RCU read-side critical section.
+     */
+    rcu_read_lock();
+    ine_pin = rcu_dereference(wbd->wbd_ine_pin);
 
     /* search from root */
     node_num = wbd->wbd_root;
 
-    /* prefetch root node header */
-    __builtin_prefetch(map_base + (first_page + wbd->wbd_root) * PAGE_SIZE);
-
     assert(0 <= node_num && node_num < wbd->wbd_n_pages);
-    pg = first_page + node_num;
-    node = map_base + pg * PAGE_SIZE;
+    node = wbtr_node(kbd, wbd, ine_pin, node_num);
+
+    /* prefetch root node header */
+    __builtin_prefetch(node);
 
     while (omf_wbn_magic(node) == WBT_INE_NODE_MAGIC) {
         struct wbt_ine_omf *ine;
@@ -185,14 +204,24 @@ wbtr_seek_page(
         node_num = omf_ine_left_child(ine);
 
         assert(0 <= node_num && node_num < wbd->wbd_n_pages);
-        pg = first_page + node_num;
-        node = map_base + pg * PAGE_SIZE;
+        node = wbtr_node(kbd, wbd, ine_pin, node_num);
         __builtin_prefetch(node);
     }
+    rcu_read_unlock();
 
     return node_num;
 }
 
+uint
+wbtr_leaf_index(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    const void *                key,
+    uint                        klen)
+{
+    return wbtr_seek_page(kbd, wbd, key, klen, 0) - wbd->wbd_leaf;
+}
+
 /*
  * Actions after prefix compare:
  *
@@ -38,6 +38,7 @@ struct wbti {
  * @wbd_leaf: first leaf node (@wbd_leaf < @wbd_n_pages)
  * @wbd_leaf_cnt: number of leaf nodes
  * @wbd_kmd_pgc: size of key-metadata region in pages
+ * @wbd_ine_pin: resident copy of the internal nodes, or NULL (RCU protected)
  *
  * When a KBLOCK is opened for reading, the @wbt_hdr_omf struct is read from
  * media and the relevant information is stored in a @wbt_desc struct.
@@ -56,8 +57,18 @@ struct wbt_desc {
     u16 wbd_leaf_cnt;
     u16 wbd_kmd_pgc;
     u16 wbd_version;
+
+    void *wbd_ine_pin;
 };
 
+/* Internal nodes follow the leaves and precede the key metadata.
+ */
+static inline uint
+wbt_ine_pgc(const struct wbt_desc *wbd)
+{
+    return wbd->wbd_n_pages - wbd->wbd_leaf_cnt - wbd->wbd_kmd_pgc;
+}
+
 /**
  * wbtr_read_vref() - Read the metadata data for the value associated with key
  * @kbd:    kblock region descriptor
@@ -79,6 +90,23 @@ wbtr_read_vref(
     enum key_lookup_res *       lookup_res,
     struct kvs_vtuple_ref *     vref);
 
+/**
+ * wbtr_leaf_index() - Find the leaf node in which a key would reside
+ * @kbd:  kblock region descriptor
+ * @wbd:  wbtree descriptor
+ * @key:  key to search for
+ * @klen: length of %key
+ *
+ * Return: the leaf's position among the wbtree's leaves, which lies
+ * in [0, @wbd->wbd_leaf_cnt).
+ */
+uint
+wbtr_leaf_index(
+    const struct kvs_mblk_desc *kbd,
+    const struct wbt_desc *     wbd,
+    const void *                key,
+    uint                        klen);
+
 merr_t
 wbti_alloc(struct wbti **wbti_out);
 
@@ -249,6 +249,48 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "cn_pin_sz",
+        .ps_description = "size of resident bloom/wbtree arena (bytes)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U64,
+        .ps_offset = offsetof(struct hse_gparams, gp_cn_pin_sz),
+        .ps_size = PARAM_SZ(struct hse_gparams, gp_cn_pin_sz),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = HSE_CN_PIN_SZ_DFLT,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = HSE_CN_PIN_SZ_MAX,
+            },
+        },
+    },
+    {
+        .ps_name = "cn_bcache_sz",
+        .ps_description = "size of vblock page cache (bytes)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U64,
+        .ps_offset = offsetof(struct hse_gparams, gp_cn_bcache_sz),
+        .ps_size = PARAM_SZ(struct hse_gparams, gp_cn_bcache_sz),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = HSE_CN_BCACHE_SZ_DFLT,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = HSE_CN_BCACHE_SZ_MAX,
+            },
+        },
+    },
     {
         .ps_name = "c0kvs_ccache_sz_max",
         .ps_description = "max size of c0kvs cheap cache (bytes)",
@@ -354,6 +396,27 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "reqtrace_period",
+        .ps_description = "trace one in every N requests per thread (0 to disable)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct hse_gparams, gp_reqtrace_period),
+        .ps_size = PARAM_SZ(struct hse_gparams, gp_reqtrace_period),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = HSE_REQTRACE_PERIOD_DFLT,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 0,
+                .ps_max = HSE_REQTRACE_PERIOD_MAX,
+            },
+        },
+    },
     {
         .ps_name = "perfc.level",
         .ps_description = "set kvs perf counter enagagement level (min:0 default:2 max:9)",
@@ -22,6 +22,7 @@
 
 struct c0;
 struct c0_cursor;
+struct c0kvs_batch_ent;
 struct cn;
 
 struct query_ctx;
@@ -134,6 +135,22 @@ c0_get(
     enum key_lookup_res *    res,
     struct kvs_buf *         vbuf);
 
+/**
+ * c0_putdel_batch() - apply a vector of puts and deletes
+ * @entv:      Vector of entries, each of which names its c0 (reordered
+ *             by this call)
+ * @entc:      Number of entries in @entv
+ * @seqnoref:  seqnoref for all entries
+ *
+ * All the c0s named by @entv must belong to the same kvdb.  Updates to
+ * the same key are applied in the order in which they appear in @entv.
+ *
+ * Return: [HSE_REVISIT]
+ */
+/* MTF_MOCK */
+merr_t
+c0_putdel_batch(struct c0kvs_batch_ent **entv, uint entc, uintptr_t seqnoref);
+
 /**
  * c0_del() - delete any value associated with the given key
  * @self:      Instance of struct c0 from which to delete
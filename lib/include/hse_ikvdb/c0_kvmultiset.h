@@ -146,6 +146,16 @@ c0kvms_size(struct c0_kvmultiset *handle);
 struct c0_kvset *
 c0kvms_get_hashed_c0kvset(struct c0_kvmultiset *mset, u64 hash);
 
+/**
+ * c0kvms_numa_bind() - distribute a kvms' c0kvsets across NUMA nodes
+ * @mset:  Struct c0_kvmultiset to bind
+ *
+ * Binds each hashed c0kvset's memory to a NUMA node such that the
+ * c0kvsets are spread evenly over all nodes.
+ */
+void
+c0kvms_numa_bind(struct c0_kvmultiset *mset);
+
 /**
  * c0kvms_finalize() - freeze the elements of the c0_kvmultiset
  * @mset:  struct c0_kvmultiset to freeze
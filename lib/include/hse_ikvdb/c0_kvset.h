@@ -16,9 +16,27 @@
 struct c0_kvset {
 };
 
+struct c0;
 struct c0kvs_ingest_ctx;
 struct c0_kvset_iterator;
 
+/**
+ * struct c0kvs_batch_ent - one put or delete of a batched c0 update
+ * @cbe_c0:    c0 of the kvs to which the entry applies
+ * @cbe_kt:    key (kt_hash must be set), kt_seqno and kt_dgen are set
+ *             when the entry is applied
+ * @cbe_vt:    value (ignored for deletes)
+ * @cbe_skidx: kvs index (set by c0_putdel_batch())
+ * @cbe_del:   true if the entry is a delete
+ */
+struct c0kvs_batch_ent {
+    struct c0        *cbe_c0;
+    struct kvs_ktuple cbe_kt;
+    struct kvs_vtuple cbe_vt;
+    u16               cbe_skidx;
+    bool              cbe_del;
+};
+
 struct c0_usage {
     size_t u_alloc;
     ulong  u_keys;
@@ -104,6 +122,27 @@ c0kvs_avail(struct c0_kvset *set);
 size_t
 c0kvs_used(struct c0_kvset *set);
 
+/**
+ * c0kvs_numa_bind() - place a c0kvs' memory on a NUMA node
+ * @set:        c0kvs handle
+ * @node:       NUMA node ID
+ *
+ * Binds the c0kvs cheap to @node: pages already resident (e.g., retained
+ * by a cached c0kvs) are migrated to @node, and memory that the cheap
+ * faults in hereafter is allocated from @node whenever it has free pages.
+ */
+void
+c0kvs_numa_bind(struct c0_kvset *set, uint node);
+
+/**
+ * c0kvs_numa_node() - get the NUMA node to which a c0kvs is bound
+ * @set:        c0kvs handle
+ *
+ * Return: NUMA node ID, or -1 if not bound
+ */
+int
+c0kvs_numa_node(struct c0_kvset *set);
+
 /**
  * c0kvs_reset() - return a cursor allocated c0_kvset to an as-new state
  * @set:        struct c0_kvset to reset
@@ -148,6 +187,29 @@ c0kvs_put(
     const struct kvs_vtuple *value,
     uintptr_t                seqnoref);
 
+/**
+ * c0kvs_putdel_batch() - apply a run of puts and deletes to a c0_kvset
+ * @set:      Struct c0_kvset to update
+ * @entv:     Vector of entries, ideally sorted by (skidx, key)
+ * @entc:     Number of entries in @entv
+ * @seqnoref: Seqnoref to use for all entries
+ * @donep:    (output) number of entries applied
+ *
+ * Equivalent to calling c0kvs_put() or c0kvs_del() for each entry, but
+ * the c0kvs lock is acquired only once.  Entries for the same key are
+ * applied in order, so the last one wins.
+ *
+ * Return: 0 on success, otherwise the error from the first entry that
+ * could not be applied.
+ */
+merr_t
+c0kvs_putdel_batch(
+    struct c0_kvset         *set,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref,
+    uint                    *donep);
+
 /**
  * c0kvs_del() - delete the key/value pair matching the given key
  * @set:   Struct c0_kvset to delete the key/value from
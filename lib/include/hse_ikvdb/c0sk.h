@@ -19,6 +19,7 @@
 #include <hse_ikvdb/kvdb_health.h>
 
 struct c0_kvmultiset;
+struct c0kvs_batch_ent;
 struct c0sk;
 struct c0_cursor;
 struct cn;
@@ -161,6 +162,29 @@ c0sk_put(
     const struct kvs_vtuple *value,
     uintptr_t                seqnoref);
 
+/**
+ * c0sk_putdel_batch() - apply a vector of puts and deletes
+ * @self:      Instance of struct c0sk into which to insert
+ * @entv:      Vector of entries (reordered by this call)
+ * @entc:      Number of entries in @entv
+ * @seqnoref:  seqnoref for all entries
+ *
+ * Entries that hash to the same c0kvset are applied together under a
+ * single acquisition of its lock.  Updates to the same key are applied
+ * in the order in which they appear in @entv.
+ *
+ * This is used only to commit an hse_kvs_batch.  Individual puts and
+ * deletes are not staged and still go through c0sk_put()/c0sk_del().
+ *
+ * Return: [HSE_REVISIT]
+ */
+merr_t
+c0sk_putdel_batch(
+    struct c0sk             *self,
+    struct c0kvs_batch_ent **entv,
+    uint                     entc,
+    uintptr_t                seqnoref);
+
 /**
  * c0sk_get() - retrieve the value associated with the given key
  * @self:      Instance of struct c0sk from which to retrieve
@@ -336,6 +360,15 @@ c0sk_gen_set(struct c0sk *handle, uint64_t gen);
 uint32_t
 c0sk_ingest_width_get(struct c0sk *handle);
 
+/**
+ * c0sk_usage() - retrieve c0 memory usage
+ * @handle: c0sk handle
+ * @kvmsc:  (output) number of kvmultisets (active plus those awaiting ingest)
+ * @memsz:  (output) memory consumed by all kvmultisets (bytes)
+ */
+void
+c0sk_usage(struct c0sk *handle, uint *kvmsc, size_t *memsz);
+
 void
 c0sk_replaying_enable(struct c0sk *handle);
 
@@ -29,6 +29,7 @@ struct kvset_mblocks;
 struct kvdb_kvs;
 struct sts;
 struct mclass_policy;
+struct cn_qos_budget;
 enum cn_action;
 enum hse_mclass;
 
@@ -36,6 +37,15 @@ enum hse_mclass;
 merr_t
 cn_make(struct mpool *ds, const struct kvs_cparams *cp, struct kvdb_health *health);
 
+/**
+ * cn_drop() - remove the files of a dropped kvs that cndb doesn't track
+ * @ds:   mpool
+ * @cnid: cnid of the dropped kvs
+ */
+/* MTF_MOCK */
+merr_t
+cn_drop(struct mpool *ds, u64 cnid);
+
 /* MTF_MOCK */
 merr_t
 cn_open(
@@ -79,6 +89,17 @@ cn_init(void);
 void
 cn_fini(void);
 
+/**
+ * cn_purge() - drop the block cache pages of an mpool
+ * @ds: mpool, all of whose cn's are closed
+ *
+ * The block cache is shared by all open KVDBs, so this must be called
+ * before @ds is closed.
+ */
+/* MTF_MOCK */
+void
+cn_purge(struct mpool *ds);
+
 /* MTF_MOCK */
 u64
 cn_get_ingest_dgen(struct cn *cn);
@@ -128,6 +149,18 @@ cn_pfx_probe(
     struct kvs_buf *     kbuf,
     struct kvs_buf *     vbuf);
 
+/**
+ * cn_range_count_est() - estimate the number of keys in [start, end)
+ * @cn:    cn to examine
+ * @start: first key of the range (inclusive)
+ * @end:   last key of the range (exclusive)
+ *
+ * The estimate is computed from kblock metrics and node hlogs without
+ * reading any keys or values.
+ */
+u64
+cn_range_count_est(struct cn *cn, const struct kvs_ktuple *start, const struct kvs_ktuple *end);
+
 /**
  * cn_ingestv() - A vectored version of cn_ingest
  * @cn:
@@ -180,6 +213,10 @@ cn_get_io_wq(struct cn *cn);
 struct workqueue_struct *
 cn_get_maint_wq(struct cn *cn);
 
+/* MTF_MOCK */
+struct cn_qos_budget *
+cn_get_qos_budget(struct cn *cn, bool write);
+
 /* MTF_MOCK */
 struct csched *
 cn_get_sched(struct cn *cn);
@@ -334,6 +334,33 @@ cndb_txn_txc(
     struct kvset_mblocks *mblocks,
     u32                   keepvbc);
 
+/**
+ * cndb_txn_txcv() - Add several kvsets to a transaction
+ * @cndb:     a cndb handle obtained from cndb_open()
+ * @txid:     an identifier obtained from cndb_txn_start()
+ * @cnid:     a cN identifier minted by ikvdb_kvs_create()
+ * @tag:      (input/output) as for cndb_txn_txc()
+ * @n:        number of kvsets
+ * @mblocksv: vector of @n lists of involved blkids
+ * @keepvbs:  keep (do not delete) all vblocks of each kvset when the CN
+ *      mutation is rolled back during cndb replay
+ * @tagv:     (output) vector of @n tags, one per kvset
+ *
+ * Equivalent to @n calls to cndb_txn_txc(), except that all TXC records
+ * are appended to the cndb mdc with a single sync.
+ */
+/* MTF_MOCK */
+merr_t
+cndb_txn_txcv(
+    struct cndb *         cndb,
+    u64                   txid,
+    u64                   cnid,
+    u64 *                 tag,
+    int                   n,
+    struct kvset_mblocks *mblocksv,
+    bool                  keepvbs,
+    u64 *                 tagv);
+
 /**
  * cndb_txn_txd() - Add a kvset deletion to a transaction
  * @cndb:     a cndb handle obtained from cndb_open()
@@ -359,6 +386,28 @@ cndb_txn_txd(struct cndb *cndb, u64 txid, u64 cnid, u64 tag, int n_oids, u64 *oi
 merr_t
 cndb_txn_meta(struct cndb *cndb, u64 txid, u64 cnid, u64 tag, struct kvset_meta *meta);
 
+/**
+ * cndb_txn_metav() - Add metadata for several kvsets to a transaction
+ * @cndb:     a cndb handle obtained from cndb_open()
+ * @txid:     an identifier obtained from cndb_txn_start()
+ * @cnid:     a cN identifier minted by ikvdb_kvs_create()
+ * @n:        number of kvsets
+ * @tagv:     vector of @n tags minted by cndb_txn_txc() or cndb_txn_txcv()
+ * @metav:    vector of @n pointers to metadata describing each kvset
+ *
+ * Equivalent to @n calls to cndb_txn_meta(), except that all TXM records
+ * are appended to the cndb mdc with a single sync.
+ */
+/* MTF_MOCK */
+merr_t
+cndb_txn_metav(
+    struct cndb *       cndb,
+    u64                 txid,
+    u64                 cnid,
+    int                 n,
+    u64 *               tagv,
+    struct kvset_meta **metav);
+
 /**
  * cndb_txn_ack_c() - Acknowledge complete description of transaction
  * @cndb:     a cndb handle obtained from cndb_open()
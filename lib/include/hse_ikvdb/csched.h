@@ -8,6 +8,8 @@
 
 #include <hse_util/inttypes.h>
 
+#include <hse/limits.h>
+
 #include <hse_ikvdb/csched_rp.h>
 
 /* MTF_MOCK_DECL(csched) */
@@ -16,6 +18,7 @@ struct csched;
 struct kvdb_rparams;
 struct cn_tree;
 struct throttle_sensor;
+struct throttle_debt;
 struct cn_samp_stats;
 struct mpool;
 struct hse_kvdb_compact_status;
@@ -44,8 +47,120 @@ enum sp3_qnum {
      (1ul << (8 * SP3_QNUM_LSIZE)) |            \
      (2ul << (8 * SP3_QNUM_SHARED)))
 
+/* Number of finished jobs retained in the compaction history, and the
+ * maximum number of distinct compaction rules it summarizes.
+ */
+#define CSCHED_HIST_JOBS   (512)
+#define CSCHED_HIST_RULES  (32)
+
 /* clang-format on */
 
+/**
+ * struct csched_job_rec - compaction history record for one finished job
+ * @cjr_seq:          sequence number (1 for the first job since open)
+ * @cjr_id:           job id (as shown by the short term scheduler)
+ * @cjr_cnid:         cnid of the kvs
+ * @cjr_kvsname:      name of the kvs
+ * @cjr_action:       compaction action (e.g., "kcomp", "spill")
+ * @cjr_rule:         rule that selected the job
+ * @cjr_level:        node level
+ * @cjr_offset:       node offset
+ * @cjr_kvsets_in:    number of input kvsets
+ * @cjr_kvsets_out:   number of non-empty output kvsets
+ * @cjr_vblks_reused: number of vblocks moved, not rewritten, into the output
+ * @cjr_keys_in:      number of keys read
+ * @cjr_keys_out:     number of keys written
+ * @cjr_rbytes:       bytes read from kblocks and vblocks
+ * @cjr_wbytes:       bytes written to kblocks and vblocks
+ * @cjr_cpu_ns:       cpu time of the compaction thread
+ * @cjr_wait_ns:      time spent waiting for mblock reads to complete
+ * @cjr_queue_ns:     time from submission until a thread picked up the job
+ * @cjr_wall_ns:      time from pickup until the job's output was committed
+ * @cjr_errno:        zero on success, otherwise the job's error
+ */
+struct csched_job_rec {
+    u64         cjr_seq;
+    u64         cjr_id;
+    u64         cjr_cnid;
+    char        cjr_kvsname[HSE_KVS_NAME_LEN_MAX];
+    const char *cjr_action;
+    const char *cjr_rule;
+    u32         cjr_level;
+    u32         cjr_offset;
+    u32         cjr_kvsets_in;
+    u32         cjr_kvsets_out;
+    u32         cjr_vblks_reused;
+    int         cjr_errno;
+    u64         cjr_keys_in;
+    u64         cjr_keys_out;
+    u64         cjr_rbytes;
+    u64         cjr_wbytes;
+    u64         cjr_cpu_ns;
+    u64         cjr_wait_ns;
+    u64         cjr_queue_ns;
+    u64         cjr_wall_ns;
+};
+
+/**
+ * struct csched_rule_stats - cumulative compaction stats for one rule
+ * @crs_rule:   rule name
+ * @crs_jobs:   number of finished jobs
+ * @crs_rbytes: bytes read
+ * @crs_wbytes: bytes written
+ * @crs_cpu_ns: cpu time
+ * @crs_wall_ns: wall time
+ */
+struct csched_rule_stats {
+    const char *crs_rule;
+    u64         crs_jobs;
+    u64         crs_rbytes;
+    u64         crs_wbytes;
+    u64         crs_cpu_ns;
+    u64         crs_wall_ns;
+};
+
+/**
+ * struct csched_kvs_stats - cumulative ingest and compaction stats for one kvs
+ * @cks_cnid:         cnid of the kvs
+ * @cks_kvsname:      name of the kvs
+ * @cks_ingest_bytes: bytes written by ingest into the root node
+ * @cks_jobs:         number of finished compaction jobs
+ * @cks_rbytes:       bytes read by compaction
+ * @cks_wbytes:       bytes written by compaction
+ *
+ * Write amplification of the kvs is (ingest + compaction writes) / ingest.
+ */
+struct csched_kvs_stats {
+    u64  cks_cnid;
+    char cks_kvsname[HSE_KVS_NAME_LEN_MAX];
+    u64  cks_ingest_bytes;
+    u64  cks_jobs;
+    u64  cks_rbytes;
+    u64  cks_wbytes;
+};
+
+/**
+ * struct csched_history - snapshot of the compaction history
+ * @ch_jobs:         number of jobs finished since open
+ * @ch_ingest_bytes: bytes ingested into all kvs since open
+ * @ch_jobc:         number of entries in @ch_jobv
+ * @ch_jobv:         most recently finished jobs, oldest first
+ * @ch_rulec:        number of entries in @ch_rulev
+ * @ch_rulev:        per-rule stats for rules that have run at least once
+ * @ch_kvsc:         number of entries in @ch_kvsv
+ * @ch_kvsv:         per-kvs stats for all open kvs
+ */
+struct csched_history {
+    u64                      ch_jobs;
+    u64                      ch_ingest_bytes;
+    uint                     ch_jobc;
+    struct csched_job_rec    ch_jobv[CSCHED_HIST_JOBS];
+    uint                     ch_rulec;
+    struct csched_rule_stats ch_rulev[CSCHED_HIST_RULES];
+    uint                     ch_kvsc;
+    struct csched_kvs_stats  ch_kvsv[HSE_KVS_COUNT_MAX];
+};
+
 /**
  * csched_create() - create a scheduler for kvdb compaction work
  * @ds:      dataset handle to access mpool qos
@@ -83,6 +198,10 @@ csched_tree_remove(struct csched *csched, struct cn_tree *tree, bool cancel);
 void
 csched_throttle_sensor(struct csched *csched, struct throttle_sensor *input);
 
+/* MTF_MOCK */
+void
+csched_throttle_debt(struct csched *csched, struct throttle_debt *debt);
+
 /* MTF_MOCK */
 void
 csched_compact_request(struct csched *handle, int flags);
@@ -91,6 +210,28 @@ csched_compact_request(struct csched *handle, int flags);
 void
 csched_compact_status_get(struct csched *handle, struct hse_kvdb_compact_status *status);
 
+/**
+ * csched_qinfo_get() - retrieve compaction queue depths
+ * @handle:   scheduler handle
+ * @jobsv:    (output) number of active jobs in each of the SP3_QNUM_MAX queues
+ * @threadsv: (output) number of threads allotted to each queue
+ *
+ * The values are sampled without synchronization with the scheduler
+ * and are intended only for monitoring.
+ */
+/* MTF_MOCK */
+void
+csched_qinfo_get(struct csched *handle, uint *jobsv, uint *threadsv);
+
+/**
+ * csched_history_get() - retrieve the compaction job history
+ * @handle: scheduler handle
+ * @hist:   (output) history snapshot (large, callers should allocate it)
+ */
+/* MTF_MOCK */
+void
+csched_history_get(struct csched *handle, struct csched_history *hist);
+
 #if HSE_MOCKING
 #include "csched_ut.h"
 #endif /* HSE_MOCKING */
@@ -6,6 +6,8 @@
 #ifndef HSE_KVS_CURSOR_H
 #define HSE_KVS_CURSOR_H
 
+#include <hse/limits.h>
+
 #include <hse_util/inttypes.h>
 #include <hse_ikvdb/tuple.h>
 
@@ -64,6 +66,126 @@ cursor_summary_add_dgen(struct cursor_summary *sum, u64 dgen)
         sum->dgen[sum->n_dgen++ & 3] = dgen;
 }
 
+/* Cursor key predicates
+ *
+ * A kc_pred is a private copy of a user's hse_kvs_cursor_filter, installed
+ * in the cursor's kc_filter and evaluated by each of c0, lc and cn before
+ * their entries are presented to the kvs cursor merge.  Predicates examine
+ * only the key, so every version of a key (including tombstones) is either
+ * kept or discarded consistently across all sources.  Prefix tombstones are
+ * never filtered.
+ */
+#define KC_PRED_FIELDS_MAX (4)
+
+/**
+ * struct kc_pred_field - fixed-offset key field bounds
+ * @kpf_min: inclusive lower bound (NULL if unbounded)
+ * @kpf_max: inclusive upper bound (NULL if unbounded)
+ * @kpf_off: byte offset of field within the key
+ * @kpf_len: length of field in bytes
+ */
+struct kc_pred_field {
+    const void *kpf_min;
+    const void *kpf_max;
+    uint        kpf_off;
+    uint        kpf_len;
+};
+
+/**
+ * struct kc_pred - cursor key predicate
+ * @kp_sfx_mask:  mask applied to the last @kp_sfx_len key bytes (NULL for all ones)
+ * @kp_sfx_match: masked value the last @kp_sfx_len key bytes must equal
+ * @kp_sfx_len:   length of suffix match (zero if none)
+ * @kp_fieldc:    number of valid entries in @kp_fieldv[]
+ * @kp_fieldv:    fixed-offset field bounds
+ * @kp_cb:        optional user callback, called last
+ * @kp_cb_arg:    argument to @kp_cb
+ * @kp_buf:       storage for all of the above byte strings
+ */
+struct kc_pred {
+    const u8            *kp_sfx_mask;
+    const u8            *kp_sfx_match;
+    uint                 kp_sfx_len;
+    uint                 kp_fieldc;
+    struct kc_pred_field kp_fieldv[KC_PRED_FIELDS_MAX];
+    bool               (*kp_cb)(void *arg, const void *key, size_t klen);
+    void                *kp_cb_arg;
+    u8                   kp_buf[];
+};
+
+/* Return a pointer to the contiguous bytes [off, off + len) of the given key,
+ * copying them into buf only if they straddle the prefix and suffix.
+ */
+static HSE_ALWAYS_INLINE const u8 *
+kc_pred_bytes(const struct key_obj *kobj, uint off, uint len, u8 *buf)
+{
+    uint pfxlen = kobj->ko_pfx_len;
+
+    if (off >= pfxlen)
+        return (const u8 *)kobj->ko_sfx + (off - pfxlen);
+
+    if (off + len <= pfxlen)
+        return (const u8 *)kobj->ko_pfx + off;
+
+    memcpy(buf, (const u8 *)kobj->ko_pfx + off, pfxlen - off);
+    memcpy(buf + (pfxlen - off), kobj->ko_sfx, len - (pfxlen - off));
+
+    return buf;
+}
+
+/**
+ * kc_pred_match() - test a key against a cursor predicate
+ * @pred: predicate
+ * @kobj: key
+ *
+ * Return: true if the key should be presented to the cursor
+ */
+static inline bool
+kc_pred_match(const struct kc_pred *pred, const struct key_obj *kobj)
+{
+    u8         buf[HSE_KVS_KEY_LEN_MAX];
+    uint       klen = key_obj_len(kobj);
+    const u8  *p;
+    uint       i;
+
+    if (pred->kp_sfx_len > 0) {
+        if (klen < pred->kp_sfx_len)
+            return false;
+
+        p = kc_pred_bytes(kobj, klen - pred->kp_sfx_len, pred->kp_sfx_len, buf);
+
+        for (i = 0; i < pred->kp_sfx_len; ++i) {
+            u8 mask = pred->kp_sfx_mask ? pred->kp_sfx_mask[i] : 0xff;
+
+            if ((p[i] ^ pred->kp_sfx_match[i]) & mask)
+                return false;
+        }
+    }
+
+    for (i = 0; i < pred->kp_fieldc; ++i) {
+        const struct kc_pred_field *f = pred->kp_fieldv + i;
+
+        if (klen < f->kpf_off + f->kpf_len)
+            return false;
+
+        p = kc_pred_bytes(kobj, f->kpf_off, f->kpf_len, buf);
+
+        if (f->kpf_min && memcmp(p, f->kpf_min, f->kpf_len) < 0)
+            return false;
+
+        if (f->kpf_max && memcmp(p, f->kpf_max, f->kpf_len) > 0)
+            return false;
+    }
+
+    if (pred->kp_cb) {
+        key_obj_copy(buf, sizeof(buf), &klen, kobj);
+
+        return pred->kp_cb(pred->kp_cb_arg, buf, klen);
+    }
+
+    return true;
+}
+
 /* KVS cursor binheap */
 
 enum kvs_bh_source {
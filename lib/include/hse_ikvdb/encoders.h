@@ -49,6 +49,12 @@ decode_hg16_32k(const void *base, size_t *off)
     return *p;
 }
 
+static HSE_ALWAYS_INLINE uint
+hg16_32k_len(u64 val)
+{
+    return val < 0x80 ? 1 : 2;
+}
+
 /* HG24_4M encoding:
  *   127      0xxxxxxx
  *   16K-1    10xxxxxx xxxxxxxx
@@ -157,6 +163,12 @@ decode_hg32_1024m(const void *base, size_t *off)
     return be16_to_cpu(val16) & (U16_MAX >> 2);
 }
 
+static HSE_ALWAYS_INLINE uint
+hg32_1024m_len(u64 val)
+{
+    return val <= (U8_MAX >> 1) ? 1 : (val <= (U16_MAX >> 2) ? 2 : 4);
+}
+
 /* HG64 encoding:
  *
  *  Max Value      Encoding
@@ -254,6 +266,17 @@ decode_hg64(const void *base, size_t *off)
     return val;
 }
 
+static HSE_ALWAYS_INLINE uint
+hg64_len(u64 val)
+{
+    if (val <= HG64_MAX_2B)
+        return 2;
+    if (val <= HG64_MAX_4B)
+        return 4;
+
+    return val <= HG64_MAX_6B ? 6 : 8;
+}
+
 /*
  * Google Protobuf Varint
  * - Doesn't perform as well as the homegrown encodings
@@ -10,6 +10,8 @@
 
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/diag_kvdb.h>
+#include <hse_ikvdb/csched.h>
+#include <hse_ikvdb/throttle.h>
 
 #include <hse_util/inttypes.h>
 #include <hse_util/hse_err.h>
@@ -35,6 +37,9 @@ struct kvs_rparams;
 struct kvs_cparams;
 struct hse_kvdb_opspec;
 struct hse_kvs_cursor;
+struct hse_kvs_cursor_filter;
+struct hse_kvdb_snapshot;
+struct hse_kvs_batch;
 struct mpool;
 struct c0sk;
 struct cndb;
@@ -454,6 +459,23 @@ ikvdb_kvs_prefix_delete(
     struct hse_kvdb_txn *txn,
     struct kvs_ktuple *  kt);
 
+/**
+ * ikvdb_kvs_range_count() - count the keys in [start, end)
+ * @count: (output) number of keys in the range
+ *
+ * The count is exact unless %flags includes HSE_KVS_RANGE_COUNT_EST, in
+ * which case it is estimated from cn kblock metadata.
+ */
+/* MTF_MOCK */
+merr_t
+ikvdb_kvs_range_count(
+    struct hse_kvs *     kvs,
+    unsigned int         flags,
+    struct hse_kvdb_txn *txn,
+    struct kvs_ktuple *  start,
+    struct kvs_ktuple *  end,
+    u64 *                count);
+
 merr_t
 ikvdb_kvs_param_get(
     struct hse_kvs *kvs,
@@ -521,6 +543,109 @@ ikvdb_txn_abort(struct ikvdb *kvdb, struct hse_kvdb_txn *txn);
 enum kvdb_ctxn_state
 ikvdb_txn_state(struct ikvdb *kvdb, struct hse_kvdb_txn *txn);
 
+/**
+ * ikvdb_snapshot_create() - pin a read-only view of the kvdb
+ * @kvdb:  KVDB handle
+ * @snap:  (output) snapshot handle
+ *
+ * The view is registered in the cursor viewset, hence it holds back the
+ * kvdb horizon but not the txn horizon (key lock expiry, lc garbage
+ * collection, wal reclaim).
+ */
+merr_t
+ikvdb_snapshot_create(struct ikvdb *kvdb, struct hse_kvdb_snapshot **snap);
+
+/**
+ * ikvdb_snapshot_destroy() - release a view pinned by ikvdb_snapshot_create()
+ * @kvdb:  KVDB handle
+ * @snap:  snapshot handle
+ */
+merr_t
+ikvdb_snapshot_destroy(struct ikvdb *kvdb, struct hse_kvdb_snapshot *snap);
+
+/**
+ * ikvdb_kvs_snapshot_get() - search for the given key within the KVS as of
+ * the view pinned by @snap.
+ */
+merr_t
+ikvdb_kvs_snapshot_get(
+    struct hse_kvs *          kvs,
+    unsigned int              flags,
+    struct hse_kvdb_snapshot *snap,
+    struct kvs_ktuple *       kt,
+    enum key_lookup_res *     res,
+    struct kvs_buf *          vbuf);
+
+/**
+ * ikvdb_kvs_snapshot_cursor_create() - create a cursor whose view is the
+ * view pinned by @snap. Such a cursor cannot have its view updated.
+ */
+merr_t
+ikvdb_kvs_snapshot_cursor_create(
+    struct hse_kvs *          kvs,
+    unsigned int              flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              prefix,
+    size_t                    pfx_len,
+    struct hse_kvs_cursor **  cursor);
+
+/**
+ * ikvdb_kvs_batch_create() - create an empty write batch
+ * @kvdb:  KVDB handle
+ * @batch: (output) batch handle
+ */
+merr_t
+ikvdb_kvs_batch_create(struct ikvdb *kvdb, struct hse_kvs_batch **batch);
+
+/**
+ * ikvdb_kvs_batch_destroy() - destroy a write batch, discarding its ops
+ * @batch: batch handle (may be nil)
+ */
+void
+ikvdb_kvs_batch_destroy(struct hse_kvs_batch *batch);
+
+/**
+ * ikvdb_kvs_batch_reset() - discard all the ops in a write batch
+ * @batch: batch handle
+ */
+void
+ikvdb_kvs_batch_reset(struct hse_kvs_batch *batch);
+
+/**
+ * ikvdb_kvs_batch_put() - append a put to a write batch
+ *
+ * The key and value are copied into the batch.  The kvs must belong to
+ * the batch's kvdb and must not be transactional.
+ */
+merr_t
+ikvdb_kvs_batch_put(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs       *kvs,
+    unsigned int          flags,
+    struct kvs_ktuple    *kt,
+    struct kvs_vtuple    *vt);
+
+/**
+ * ikvdb_kvs_batch_del() - append a delete to a write batch
+ */
+merr_t
+ikvdb_kvs_batch_del(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs       *kvs,
+    unsigned int          flags,
+    struct kvs_ktuple    *kt);
+
+/**
+ * ikvdb_kvs_batch_commit() - atomically apply all the ops in a write batch
+ * @batch: batch handle
+ * @opc:   (output) number of ops applied
+ *
+ * The batch is applied as a single keylock-free txn, and is reset on
+ * success.  On failure none of its ops are applied and it is left intact.
+ */
+merr_t
+ikvdb_kvs_batch_commit(struct hse_kvs_batch *batch, unsigned int *opc);
+
 /**
  * ikvdb_kvs_create_cursor() - return a cursor that may be used to iterate
  * over the elements of a KVS in sorted order. Forward/reverse direction is
@@ -543,6 +668,16 @@ ikvdb_kvs_cursor_update_view(
     struct hse_kvs_cursor *cursor,
     unsigned int           flags);
 
+/**
+ * ikvdb_kvs_cursor_filter_set() - install (or remove if %filter is NULL)
+ * a key predicate evaluated within the c0, lc and cn cursors
+ */
+merr_t
+ikvdb_kvs_cursor_filter_set(
+    struct hse_kvs_cursor *             cursor,
+    unsigned int                        flags,
+    const struct hse_kvs_cursor_filter *filter);
+
 /**
  * ikvdb_kvs_cursor_seek() - move the cursor to the closet match to @key.
  * The next ikvdb_kvs_cursor_read() will resume at this point.
@@ -600,6 +735,55 @@ struct hse_kvdb_compact_status;
 void
 ikvdb_compact_status_get(struct ikvdb *handle, struct hse_kvdb_compact_status *status);
 
+/**
+ * struct ikvdb_metrics - point-in-time kvdb state for monitoring
+ * @ikm_sensorv:      throttle sensor values, indexed by THROTTLE_SENSOR_*
+ * @ikm_thr_delay:    raw throttle delay
+ * @ikm_samp_curr:    current space amp (percent)
+ * @ikm_samp_lwm:     space amp low water mark (percent)
+ * @ikm_samp_hwm:     space amp high water mark (percent)
+ * @ikm_qjobsv:       active compaction jobs per csched queue
+ * @ikm_qthreadsv:    threads allotted to each csched queue
+ * @ikm_c0_kvms:      number of c0 kvmultisets (active and awaiting ingest)
+ * @ikm_c0_memsz:     memory consumed by c0 (bytes)
+ * @ikm_wal_bufsz:    total WAL buffer capacity (bytes)
+ * @ikm_wal_buflen:   bytes held in WAL buffers
+ */
+struct ikvdb_metrics {
+    uint   ikm_sensorv[THROTTLE_SENSOR_CNT];
+    uint   ikm_thr_delay;
+    uint   ikm_samp_curr;
+    uint   ikm_samp_lwm;
+    uint   ikm_samp_hwm;
+    uint   ikm_qjobsv[SP3_QNUM_MAX];
+    uint   ikm_qthreadsv[SP3_QNUM_MAX];
+    uint   ikm_c0_kvms;
+    size_t ikm_c0_memsz;
+    u64    ikm_wal_bufsz;
+    u64    ikm_wal_buflen;
+};
+
+/**
+ * ikvdb_metrics_get() - sample kvdb state for monitoring
+ * @handle:  kvdb handle
+ * @metrics: (output) metrics
+ *
+ * Sampling takes no locks that are held in the data path, and is cheap
+ * enough to be called at a high rate by a metrics scraper.
+ */
+void
+ikvdb_metrics_get(struct ikvdb *handle, struct ikvdb_metrics *metrics);
+
+/**
+ * ikvdb_compact_history_get() - retrieve the compaction job history
+ * @handle: kvdb handle
+ * @hist:   (output) history snapshot
+ *
+ * The history is empty for a read-only kvdb.
+ */
+void
+ikvdb_compact_history_get(struct ikvdb *handle, struct csched_history *hist);
+
 /**
  * ikvdb_kvdb_handle()    - Convert an ikvdb reference to an ikvdb
  * @self:                 - ikvdb_imple reference
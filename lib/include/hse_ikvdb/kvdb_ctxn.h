@@ -123,6 +123,14 @@ void
 kvdb_ctxn_unlock(
     struct kvdb_ctxn *handle);
 
+/* Make an inactive txn a write batch: its writes acquire no key or prefix
+ * locks, hence there is no write conflict detection, but its writes still
+ * become visible atomically and share one commit seqno.
+ */
+/* MTF_MOCK */
+void
+kvdb_ctxn_nolock_set(struct kvdb_ctxn *handle);
+
 int64_t
 kvdb_ctxn_wal_cookie_get(struct kvdb_ctxn *handle);
 
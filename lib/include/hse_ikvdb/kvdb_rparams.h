@@ -88,6 +88,7 @@ struct kvdb_rparams {
     uint32_t throttle_debug;
     uint32_t throttle_debug_intvl_s;
     uint32_t throttle_c0_hi_th;
+    uint32_t throttle_sleep_p99_us;
     uint64_t throttle_burst;
     uint64_t throttle_rate;
 
@@ -100,6 +101,7 @@ struct kvdb_rparams {
     uint32_t c0_ingest_threads;
     uint16_t cn_maint_threads;
     uint16_t cn_io_threads;
+    bool     numa_mode;
 
     uint32_t keylock_tables;
 
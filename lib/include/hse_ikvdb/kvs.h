@@ -37,10 +37,13 @@ struct cn;
 struct cn_kvdb;
 struct wal;
 struct viewset;
+struct c0kvs_batch_ent;
+struct kc_pred;
 
 struct kc_filter {
-    const void *kcf_maxkey;
-    size_t      kcf_maxklen;
+    const void           *kcf_maxkey;
+    size_t                kcf_maxklen;
+    const struct kc_pred *kcf_pred;
 };
 
 struct hse_kvs_cursor {
@@ -52,6 +55,7 @@ struct hse_kvs_cursor {
     u64                    kc_seq;
     u64                    kc_create_time;
     volatile bool          kc_on_list;
+    bool                   kc_snapshot;
     unsigned int           kc_flags;
     merr_t                 kc_err;
     struct kc_filter       kc_filter;
@@ -176,6 +180,24 @@ kvs_put(
     struct kvs_vtuple       *vt,
     u64                      seqno);
 
+/**
+ * kvs_putdel_batch() - apply a vector of puts and deletes within a txn
+ * @txn:   nolock txn within which to apply the entries
+ * @kvsv:  kvsv[i] is the kvs to which entv[i] applies
+ * @entv:  vector of entries (key hashes and c0s are set by this call)
+ * @entc:  number of entries
+ *
+ * Return: 0 on success, otherwise the first error encountered, in which
+ * case some of the entries may have been applied and the txn must be
+ * aborted.
+ */
+merr_t
+kvs_putdel_batch(
+    struct hse_kvdb_txn     *txn,
+    struct ikvs            **kvsv,
+    struct c0kvs_batch_ent  *entv,
+    uint                     entc);
+
 merr_t
 kvs_get(
     struct ikvs *        ikvs,
@@ -205,7 +227,12 @@ void
 kvs_maint_task(struct ikvs *ikvs, u64 now);
 
 struct hse_kvs_cursor *
-kvs_cursor_alloc(struct ikvs *ikvs, const void *prefix, size_t pfx_len, bool reverse);
+kvs_cursor_alloc(
+    struct ikvs *ikvs,
+    const void  *prefix,
+    size_t       pfx_len,
+    bool         reverse,
+    bool         keys_only);
 
 void
 kvs_cursor_free(struct hse_kvs_cursor *cursor);
@@ -222,6 +249,17 @@ kvs_cursor_destroy(struct hse_kvs_cursor *cursor);
 void
 kvs_cursor_reap(struct ikvs *kvs);
 
+/**
+ * kvs_cursor_filter_set() - install a key predicate on a cursor
+ * @cursor: cursor handle
+ * @pred:   predicate (or NULL to remove), ownership passes to the cursor
+ *
+ * Replaces (and frees) any existing predicate and rewinds the cursor to
+ * the start of its range.
+ */
+void
+kvs_cursor_filter_set(struct hse_kvs_cursor *cursor, struct kc_pred *pred);
+
 merr_t
 kvs_cursor_update(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn, u64 seqno);
 
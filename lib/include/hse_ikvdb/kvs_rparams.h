@@ -41,6 +41,12 @@ struct kvs_rparams {
     bool     read_only;
     uint8_t  perfc_level;
     uint32_t cn_maint_delay;
+    uint8_t  cn_compact_prio;
+    uint32_t cn_compact_jobs_max;
+    uint32_t cn_compact_rd_mbps;
+    uint32_t cn_compact_wr_mbps;
+    uint32_t cn_open_threads;
+    bool     cn_summary;
     uint64_t cn_compaction_debug; /* 1=compact, 2=ingest */
 
     uint64_t cn_compact_kblk_ra;
@@ -21,6 +21,7 @@ struct kvset_builder;
 struct kvs_rparams;
 struct perfc_set;
 struct cn_merge_stats;
+struct cn_qos_budget;
 
 /* MTF_MOCK_DECL(kvset_builder) */
 /* MTF_MOCK */
@@ -106,6 +107,10 @@ kvset_builder_set_agegroup(struct kvset_builder *self, enum hse_mclass_policy_ag
 void
 kvset_builder_set_merge_stats(struct kvset_builder *self, struct cn_merge_stats *stats);
 
+/* MTF_MOCK */
+void
+kvset_builder_set_qos(struct kvset_builder *self, struct cn_qos_budget *qos);
+
 #if HSE_MOCKING
 #include "kvset_builder_ut.h"
 #endif /* HSE_MOCKING */
@@ -86,6 +86,17 @@
 
 #define CN_SMALL_VALUE_THRESHOLD    (8)
 
+/*
+ * Size of the resident arena for bloom filters and wbtree internal
+ * nodes (0 disables the arena).
+ */
+#define HSE_CN_PIN_SZ_DFLT          (0ul)
+#define HSE_CN_PIN_SZ_MAX           (1ul << 40)
+#define HSE_CN_BCACHE_SZ_DFLT       (0ul)
+#define HSE_CN_BCACHE_SZ_MAX        (1ul << 40)
+#define HSE_REQTRACE_PERIOD_DFLT    (0u)
+#define HSE_REQTRACE_PERIOD_MAX     (1u << 30)
+
 /*
  * Low memory limits.
  */
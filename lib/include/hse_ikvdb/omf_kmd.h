@@ -63,10 +63,35 @@
  *            }
  *    }
  *
+ * Delta encoding (WBT_TREE_VERSION7):
+ *
+ *   The wbtree builder picks a restart key every few keys in each leaf
+ *   node.  The first kmd entry of a restart key (the base entry) is encoded
+ *   as above.  Entries of the keys that follow it may encode their seqno
+ *   and/or vblock offset as a delta from the base entry, whichever is
+ *   shorter:
+ *
+ *   Member  Encoding    Notes
+ *   ------  --------    -----
+ *   vtype   u8          KMD_SEQ_DELTA set
+ *   bref    hg16_32k    byte distance back from vtype to the base entry
+ *   seqno   hg32_1024m  zigzag encoded (seqno - base seqno)
+ *
+ *   vboff   u8          KMD_VBOFF_DELTA | byte distance back from this
+ *                       byte to the base entry (at most 127)
+ *           hg32_1024m  (vboff - base vboff)
+ *
+ *   A base entry lies within the kmd region of its own leaf node, and
+ *   is always encoded in full, so each key's kmd can still be decoded
+ *   without reference to any other key.  Absolute vblock offsets are less
+ *   than VBLOCK_MAX_SIZE, hence the high bit of their first byte is never
+ *   set.  The decoders below handle both encodings, so version 6 kmd
+ *   needs no special treatment.
+ *
  * Notes:
- *   - Vblock offfsets are not encoded because the vast majority of offsets in
- *     a large vblock will exceed 16MB and thus require 4-bytes to encode
- *     anyhow.
+ *   - Absolute vblock offsets are not hg-encoded because the vast majority
+ *     of offsets in a large vblock will exceed 16MB and thus require 4-bytes
+ *     to encode anyhow.
  */
 
 #define KMD_MAX_COUNT HG32_1024M_MAX
@@ -74,6 +99,11 @@
 #define KMD_MAX_ENCODED_ENTRY_LEN 23
 #define KMD_MAX_ENCODED_COUNT_LEN 4
 
+#define KMD_VTYPE_MASK      (0x0fu)
+#define KMD_SEQ_DELTA       (0x80u)
+#define KMD_VBOFF_DELTA     (0x80u)
+#define KMD_VBOFF_BREF_MAX  (0x7fu)
+
 enum kmd_vtype {
     vtype_val = 0,   /* normal value            */
     vtype_zval = 1,  /* zero-length value       */
@@ -163,6 +193,72 @@ kmd_add_cval(void *kmd, size_t *off, u64 seq, uint vbidx, uint vboff, uint vlen,
     encode_hg32_1024m(kmd, off, complen);
 }
 
+static inline u64
+kmd_zigzag(u64 delta)
+{
+    return (delta << 1) ^ (u64)((s64)delta >> 63);
+}
+
+static inline u64
+kmd_unzigzag(u64 zz)
+{
+    return (zz >> 1) ^ -(zz & 1);
+}
+
+/**
+ * kmd_add_seq_delta() - add a vtype and seqno relative to a base entry
+ * @bref: distance from kmd + *off back to the base entry
+ */
+static inline void
+kmd_add_seq_delta(void *kmd, size_t *off, enum kmd_vtype vtype, u64 seq, uint bref, u64 base_seq)
+{
+    ((u8 *)kmd)[*off] = vtype | KMD_SEQ_DELTA;
+    *off += 1;
+    encode_hg16_32k(kmd, off, bref);
+    encode_hg32_1024m(kmd, off, kmd_zigzag(seq - base_seq));
+}
+
+/**
+ * kmd_add_vboff_delta() - add a vblock offset relative to a base entry
+ * @bref: distance from kmd + *off back to the base entry
+ */
+static inline void
+kmd_add_vboff_delta(void *kmd, size_t *off, uint vboff, uint bref, uint base_vboff)
+{
+    assert(bref <= KMD_VBOFF_BREF_MAX && vboff >= base_vboff);
+
+    ((u8 *)kmd)[*off] = KMD_VBOFF_DELTA | bref;
+    *off += 1;
+    encode_hg32_1024m(kmd, off, vboff - base_vboff);
+}
+
+/* A base entry is never delta encoded.
+ */
+static inline u64
+kmd_base_seq(const u8 *base)
+{
+    size_t off = 1;
+
+    assert(!(base[0] & ~KMD_VTYPE_MASK));
+
+    return decode_hg64(base, &off);
+}
+
+static inline uint
+kmd_base_vboff(const u8 *base)
+{
+    size_t off = 1;
+    __be32 val32;
+
+    assert(base[0] == vtype_val || base[0] == vtype_cval);
+
+    decode_hg64(base, &off);
+    decode_hg16_32k(base, &off);
+    memcpy(&val32, base + off, sizeof(val32));
+
+    return be32_to_cpu(val32);
+}
+
 static inline uint
 kmd_count(const void *kmd, size_t *off)
 {
@@ -172,32 +268,51 @@ kmd_count(const void *kmd, size_t *off)
 static inline void
 kmd_type_seq(const void *kmd, size_t *off, enum kmd_vtype *vtype, u64 *seq)
 {
-    *vtype = ((const u8 *)kmd)[*off];
+    const u8 *p = (const u8 *)kmd + *off;
+
+    *vtype = p[0] & KMD_VTYPE_MASK;
     *off += 1;
+
+    if (p[0] & KMD_SEQ_DELTA) {
+        uint bref = decode_hg16_32k(kmd, off);
+
+        *seq = kmd_base_seq(p - bref) + kmd_unzigzag(decode_hg32_1024m(kmd, off));
+        return;
+    }
+
     *seq = decode_hg64(kmd, off);
 }
 
+static inline uint
+kmd_vboff(const void *kmd, size_t *off)
+{
+    const u8 *p = (const u8 *)kmd + *off;
+    __be32    val32;
+
+    if (p[0] & KMD_VBOFF_DELTA) {
+        *off += 1;
+        return kmd_base_vboff(p - (p[0] & KMD_VBOFF_BREF_MAX)) + decode_hg32_1024m(kmd, off);
+    }
+
+    memcpy(&val32, p, sizeof(val32));
+    *off += sizeof(val32);
+
+    return be32_to_cpu(val32);
+}
+
 static inline void
 kmd_val(const void *kmd, size_t *off, uint *vbidx, uint *vboff, uint *vlen)
 {
-    __be32 val32;
-
     *vbidx = decode_hg16_32k(kmd, off);
-    memcpy(&val32, kmd + *off, sizeof(val32));
-    *vboff = be32_to_cpu(val32);
-    *off += 4;
+    *vboff = kmd_vboff(kmd, off);
     *vlen = decode_hg32_1024m(kmd, off);
 }
 
 static inline void
 kmd_cval(const void *kmd, size_t *off, uint *vbidx, uint *vboff, uint *vlen, uint *complen)
 {
-    __be32 val32;
-
     *vbidx = decode_hg16_32k(kmd, off);
-    memcpy(&val32, kmd + *off, sizeof(val32));
-    *vboff = be32_to_cpu(val32);
-    *off += 4;
+    *vboff = kmd_vboff(kmd, off);
     *vlen = decode_hg32_1024m(kmd, off);
     *complen = decode_hg32_1024m(kmd, off);
 }
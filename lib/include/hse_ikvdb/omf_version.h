@@ -12,6 +12,7 @@ enum {
     GLOBAL_OMF_VERSION1 = 1,
     GLOBAL_OMF_VERSION2 = 2,
     GLOBAL_OMF_VERSION3 = 3,
+    GLOBAL_OMF_VERSION4 = 4,
 };
 
 enum {
@@ -35,6 +36,7 @@ enum {
 
 enum {
     WBT_TREE_VERSION6 = 6,
+    WBT_TREE_VERSION7 = 7,
 };
 
 enum {
@@ -42,6 +44,10 @@ enum {
     CN_TSTATE_VERSION2 = 2,
 };
 
+enum {
+    CN_SUMMARY_VERSION1 = 1,
+};
+
 enum {
     MBLOCK_METAHDR_VERSION1 = 1,
     MBLOCK_METAHDR_VERSION2 = 2,
@@ -62,7 +68,7 @@ enum {
     KVDB_META_VERSION2 = 2,
 };
 
-#define GLOBAL_OMF_VERSION     GLOBAL_OMF_VERSION3
+#define GLOBAL_OMF_VERSION     GLOBAL_OMF_VERSION4
 
 /* In the event one of the following versions in incremented, increment the
  * global OMF version.
@@ -72,8 +78,9 @@ enum {
 #define KBLOCK_HDR_VERSION     KBLOCK_HDR_VERSION5
 #define VBLOCK_HDR_VERSION     VBLOCK_HDR_VERSION2
 #define BLOOM_OMF_VERSION      BLOOM_OMF_VERSION5
-#define WBT_TREE_VERSION       WBT_TREE_VERSION6
+#define WBT_TREE_VERSION       WBT_TREE_VERSION7
 #define CN_TSTATE_VERSION      CN_TSTATE_VERSION2
+#define CN_SUMMARY_VERSION     CN_SUMMARY_VERSION1
 #define MBLOCK_METAHDR_VERSION MBLOCK_METAHDR_VERSION2
 #define MDC_LOGHDR_VERSION     MDC_LOGHDR_VERSION2
 #define WAL_VERSION            WAL_VERSION2
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_IKVDB_REQTRACE_H
+#define HSE_IKVDB_REQTRACE_H
+
+#include <hse_util/arch.h>
+#include <hse_util/atomic.h>
+#include <hse_util/compiler.h>
+#include <hse_util/hse_err.h>
+#include <hse_util/inttypes.h>
+
+/* Request tracing samples one in every N operations per thread and
+ * records a timeline of the stages the sampled operation passed through.
+ * Completed samples are published to a fixed size ring which can be read
+ * over the REST interface ("trace") at any time.
+ *
+ * Instrumentation points bracket a stage with reqtrace_stage_start() and
+ * reqtrace_stage_end().  When the calling thread is not tracing, both
+ * reduce to a single test of a thread-local pointer.
+ */
+
+enum reqtrace_op {
+    REQTRACE_OP_GET,
+    REQTRACE_OP_PUT,
+    REQTRACE_OP_DEL,
+    REQTRACE_OP_CURSOR_CREATE,
+    REQTRACE_OP_CURSOR_SEEK,
+    REQTRACE_OP_CURSOR_READ,
+    REQTRACE_OP_MAX
+};
+
+/* Stages may nest: a cn level stage includes the bloom, wbtree and
+ * vblock stages of the kvsets searched in that level.
+ */
+enum reqtrace_stage {
+    REQTRACE_STAGE_C0,
+    REQTRACE_STAGE_LC,
+    REQTRACE_STAGE_CN_L0,
+    REQTRACE_STAGE_CN_L1,
+    REQTRACE_STAGE_CN_L2,
+    REQTRACE_STAGE_CN_L3,
+    REQTRACE_STAGE_CN_L4,
+    REQTRACE_STAGE_CN_L5, /* level 5 and below */
+    REQTRACE_STAGE_BLOOM,
+    REQTRACE_STAGE_WBT,
+    REQTRACE_STAGE_VBLOCK,
+    REQTRACE_STAGE_DECOMPRESS,
+    REQTRACE_STAGE_WAL,
+    REQTRACE_STAGE_THROTTLE,
+    REQTRACE_STAGE_MAX
+};
+
+/**
+ * struct reqtrace_rec - one sampled request
+ * @rr_seq:    sample sequence number (from 1)
+ * @rr_start:  start time (ns, CLOCK_MONOTONIC)
+ * @rr_total:  total time (ns)
+ * @rr_tid:    thread id
+ * @rr_op:     enum reqtrace_op
+ * @rr_errno:  errno of the result, 0 on success
+ * @rr_ns:     time spent in each stage (ns)
+ * @rr_cnt:    number of times each stage was entered (saturates)
+ */
+struct reqtrace_rec {
+    u64 rr_seq;
+    u64 rr_start;
+    u64 rr_total;
+    u32 rr_tid;
+    u16 rr_op;
+    u16 rr_errno;
+    u64 rr_ns[REQTRACE_STAGE_MAX];
+    u16 rr_cnt[REQTRACE_STAGE_MAX];
+};
+
+extern atomic_uint reqtrace_period;
+extern thread_local struct reqtrace_rec *reqtrace_tls;
+
+bool
+reqtrace_begin_sampled(enum reqtrace_op op);
+
+void
+reqtrace_stage_add(enum reqtrace_stage stage, u64 ns);
+
+/**
+ * reqtrace_begin() - decide whether to trace the calling operation
+ * @op: operation type
+ *
+ * Return: true if the operation is being traced, in which case the caller
+ * must call reqtrace_end() when it completes.  Nested calls (e.g., a get
+ * issued from within a traced operation) return false.
+ */
+static HSE_ALWAYS_INLINE bool
+reqtrace_begin(enum reqtrace_op op)
+{
+    if (HSE_LIKELY(!atomic_read(&reqtrace_period)))
+        return false;
+
+    return reqtrace_begin_sampled(op);
+}
+
+/**
+ * reqtrace_end() - finish tracing and publish the sample
+ * @err: result of the operation
+ */
+void
+reqtrace_end(merr_t err);
+
+static HSE_ALWAYS_INLINE u64
+reqtrace_stage_start(void)
+{
+    return HSE_UNLIKELY(reqtrace_tls) ? get_time_ns() : 0;
+}
+
+static HSE_ALWAYS_INLINE void
+reqtrace_stage_end(enum reqtrace_stage stage, u64 tstart)
+{
+    if (HSE_UNLIKELY(tstart))
+        reqtrace_stage_add(stage, get_time_ns() - tstart);
+}
+
+/**
+ * reqtrace_period_set() - set the sampling period
+ * @period: trace one in every @period operations per thread, 0 to disable
+ */
+void
+reqtrace_period_set(uint period);
+
+/**
+ * reqtrace_snapshot() - copy out the most recent samples
+ * @recv:   (output) samples, oldest first
+ * @recc:   number of elements in @recv
+ * @min_ns: skip samples that took less than @min_ns in total
+ *
+ * Samples that are overwritten while being copied are skipped.
+ *
+ * Return: number of samples copied to @recv
+ */
+uint
+reqtrace_snapshot(struct reqtrace_rec *recv, uint recc, u64 min_ns);
+
+const char *
+reqtrace_op_name(enum reqtrace_op op);
+
+const char *
+reqtrace_stage_name(enum reqtrace_stage stage);
+
+merr_t
+reqtrace_init(uint period);
+
+void
+reqtrace_fini(void);
+
+#endif
@@ -64,6 +64,14 @@ sts_create(const char *name, uint nq, sts_print_fn *print_fn, struct sts **sts);
 void
 sts_destroy(struct sts *s);
 
+/**
+ * sts_numa_bind() - run a short term scheduler's jobs on a NUMA node
+ * @s:    short term scheduler handle
+ * @node: NUMA node ID, or -1 to run jobs on any CPU
+ */
+merr_t
+sts_numa_bind(struct sts *s, int node);
+
 static inline void
 sts_job_init(struct sts_job *job, sts_job_fn *job_fn, uint id)
 {
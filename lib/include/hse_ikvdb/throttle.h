@@ -39,6 +39,11 @@ enum {
  */
 #define THROTTLE_DELAY_START_AUTO    (THROTTLE_DELAY_MAX)
 
+/* PREDICTIVE replaces the sensor-max controller with a model of cN root
+ * compaction debt (see throttle_predict()).  The start delay is MEDIUM.
+ */
+#define THROTTLE_DELAY_START_PREDICTIVE (THROTTLE_DELAY_MAX - 1)
+
 #define THROTTLE_SMAX_CNT          24
 #define THROTTLE_REDUCE_CYCLES    200
 #define THROTTLE_INJECT_MS        200
@@ -48,6 +53,12 @@ enum {
 #define THROTTLE_SENSOR_SCALE    1000
 #define THROTTLE_MAX_RUN            6
 
+#define THROTTLE_PRED_HORIZON_MIN  1000  /* min debt horizon (ms) */
+#define THROTTLE_PRED_HORIZON_MAX 60000  /* max debt horizon (ms) */
+#define THROTTLE_PRED_HORIZON_DEF 10000  /* initial debt horizon (ms) */
+#define THROTTLE_PRED_WINDOW_MS    1000  /* latency evaluation window (ms) */
+#define THROTTLE_PRED_SAMPLE_MASK    15  /* sample 1 in 16 puts for latency */
+
 /* clang-format on */
 
 /**
@@ -108,6 +119,64 @@ throttle_sensor_get(struct throttle_sensor *ts)
     return atomic_read(&ts->ts_sensor);
 }
 
+/**
+ * struct throttle_debt - cN root compaction debt, as reported by csched
+ * @td_root_kvsets:     max number of kvsets in any root node
+ * @td_root_kvsets_hwm: root kvset count at which ingest must stall
+ * @td_spill_bytes:     total bytes in root nodes waiting to be spilled
+ * @td_drain_bps:       average root spill throughput (bytes/sec)
+ *
+ * Only the predictive throttle policy consumes these values.  Like the
+ * throttle sensors, they are raw observations without any hysteresis.
+ */
+struct throttle_debt {
+    atomic_ulong td_root_kvsets;
+    atomic_ulong td_root_kvsets_hwm;
+    atomic_ulong td_spill_bytes;
+    atomic_ulong td_drain_bps;
+} HSE_L1D_ALIGNED;
+
+static inline void
+throttle_debt_set(struct throttle_debt *td, ulong kvsets, ulong kvsets_hwm, ulong spill_bytes)
+{
+    atomic_set(&td->td_root_kvsets, kvsets);
+    atomic_set(&td->td_root_kvsets_hwm, kvsets_hwm);
+    atomic_set(&td->td_spill_bytes, spill_bytes);
+}
+
+static inline void
+throttle_debt_drain_set(struct throttle_debt *td, ulong bps)
+{
+    atomic_set(&td->td_drain_bps, bps);
+}
+
+/**
+ * struct throttle_pred - predictive throttle model state
+ * @tp_rate:       current paced ingest rate (bytes/sec)
+ * @tp_target:     rate the model is converging toward (bytes/sec)
+ * @tp_horizon_ms: time over which the root headroom may be consumed
+ * @tp_win_cycles: cycles accumulated in the current sleep window
+ * @tp_win_ops:    sampled throttle sleeps in the current window
+ * @tp_win_slow:   sampled sleeps that exceeded the p99 target
+ * @tp_slow_bp:    slow sleeps in the last window (basis points)
+ * @tp_target_ns:  p99 throttle sleep target (nsecs)
+ * @tp_lat_ops:    sampled sleeps since the last update
+ * @tp_lat_slow:   sampled sleeps longer than the target since the last update
+ */
+struct throttle_pred {
+    u64  tp_rate;
+    u64  tp_target;
+    uint tp_horizon_ms;
+    uint tp_win_cycles;
+    u64  tp_win_ops;
+    u64  tp_win_slow;
+    uint tp_slow_bp;
+
+    atomic_ulong tp_target_ns HSE_L1D_ALIGNED;
+    atomic_ulong tp_lat_ops;
+    atomic_ulong tp_lat_slow;
+};
+
 enum throttle_state { THROTTLE_NO_CHANGE, THROTTLE_DECREASE, THROTTLE_INCREASE };
 
 /**
@@ -154,8 +223,11 @@ struct throttle_mavg {
  * @thr_longest_run:    longest run of sensor values seen
  * @thr_num_tries:      number of trials in current reduction cycle
  * @thr_max_tries:      max number of trials
+ * @thr_predictive:     use the predictive (debt model) controller
  * @thr_rp:
  * @thr_perfc:
+ * @thr_pred:           predictive controller state
+ * @thr_debt:           compaction debt reported by csched
  * @thr_sensorv:        vector of throttle sensors
  */
 struct throttle {
@@ -185,10 +257,14 @@ struct throttle {
     uint                 thr_longest_run;
     uint                 thr_num_tries;
     uint                 thr_max_tries;
+    bool                 thr_predictive;
     struct kvdb_rparams *thr_rp;
     struct perfc_set     thr_sensor_perfc;
     struct perfc_set     thr_sleep_perfc;
+    struct perfc_set     thr_pred_perfc;
 
+    struct throttle_pred   thr_pred;
+    struct throttle_debt   thr_debt;
     struct throttle_sensor thr_sensorv[THROTTLE_SENSOR_CNT];
 };
 
@@ -216,6 +292,30 @@ throttle_sensor(struct throttle *self, uint index)
     return (index < THROTTLE_SENSOR_CNT ? self->thr_sensorv + index : 0);
 }
 
+static inline struct throttle_debt *
+throttle_debt(struct throttle *self)
+{
+    return &self->thr_debt;
+}
+
+/**
+ * throttle_lat_record() - record the throttle delay imposed on a sampled put
+ * @self:     throttle handle
+ * @sleep_ns: delay imposed on the put (nsecs)
+ *
+ * Used only by the predictive policy to estimate whether the p99 of the
+ * throttle sleeps imposed on puts exceeds throttle_sleep_p99_us.  Only the
+ * sleep is measured, not the end-to-end latency of the put.
+ */
+static inline void
+throttle_lat_record(struct throttle *self, u64 sleep_ns)
+{
+    atomic_inc(&self->thr_pred.tp_lat_ops);
+
+    if (sleep_ns > atomic_read(&self->thr_pred.tp_target_ns))
+        atomic_inc(&self->thr_pred.tp_lat_slow);
+}
+
 void
 throttle_debug(struct throttle *self);
 
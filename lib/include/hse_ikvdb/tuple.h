@@ -60,10 +60,35 @@ struct kvs_vtuple {
     uint64_t vt_xlen;
 };
 
+/**
+ * struct kvs_vpin - a pinned reference to a value
+ * @vp_data:    address of the value
+ * @vp_obj:     object whose reference keeps @vp_data valid
+ * @vp_release: function that drops the reference on @vp_obj
+ */
+struct kvs_vpin {
+    const void *vp_data;
+    void       *vp_obj;
+    void      (*vp_release)(void *obj);
+};
+
+/**
+ * struct kvs_buf - an output buffer for a key or value
+ * @b_buf:    buffer
+ * @b_buf_sz: size of @b_buf
+ * @b_len:    length of the key or value (may exceed @b_buf_sz)
+ * @b_pin:    if not NULL, a lookup may pin the value in @b_pin rather
+ *            than copy it to @b_buf
+ *
+ * A lookup that pins the value sets @b_pin->vp_data and does not touch
+ * @b_buf.  Values that must be transformed (e.g., decompressed) are always
+ * copied.
+ */
 struct kvs_buf {
-    void    *b_buf;
-    uint32_t b_buf_sz;
-    uint32_t b_len;
+    void            *b_buf;
+    uint32_t         b_buf_sz;
+    uint32_t         b_len;
+    struct kvs_vpin *b_pin;
 };
 
 struct kvs_kvtuple {
@@ -172,6 +197,18 @@ kvs_buf_init(struct kvs_buf *vbuf, void *buf, uint32_t buf_size)
     vbuf->b_buf = buf;
     vbuf->b_buf_sz = buf_size;
     vbuf->b_len = 0;
+    vbuf->b_pin = NULL;
+}
+
+static inline void
+kvs_vpin_release(struct kvs_vpin *pin)
+{
+    if (pin->vp_release)
+        pin->vp_release(pin->vp_obj);
+
+    pin->vp_data = NULL;
+    pin->vp_obj = NULL;
+    pin->vp_release = NULL;
 }
 
 #endif
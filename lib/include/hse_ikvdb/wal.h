@@ -129,6 +129,15 @@ wal_sync(struct wal *wal);
 void
 wal_throttle_sensor(struct wal *wal, struct throttle_sensor *sensor);
 
+/**
+ * wal_buffer_usage() - retrieve WAL buffer fill
+ * @wal:    wal handle
+ * @bufsz:  (output) total capacity of all WAL buffers (bytes)
+ * @buflen: (output) bytes buffered but not yet reclaimed
+ */
+void
+wal_buffer_usage(struct wal *wal, uint64_t *bufsz, uint64_t *buflen);
+
 #if HSE_MOCKING
 #include "wal_ut.h"
 #endif /* HSE_MOCKING */
@@ -24,12 +24,14 @@
 #include <hse_util/xrand.h>
 #include <hse_util/bkv_collection.h>
 #include <hse_util/alloc.h>
+#include <hse_util/keycmp.h>
 
 #include <hse_ikvdb/config.h>
 #include <hse_ikvdb/argv.h>
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/kvdb_health.h>
 #include <hse_ikvdb/kvs.h>
+#include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/c0.h>
 #include <hse_ikvdb/c0sk.h>
 #include <hse_ikvdb/c0sk_perfc.h>
@@ -59,6 +61,7 @@
 #include <hse_ikvdb/kvdb_meta.h>
 #include <hse_ikvdb/omf_version.h>
 #include <hse_ikvdb/kvdb_home.h>
+#include <hse_ikvdb/reqtrace.h>
 
 #include "kvdb_kvs.h"
 #include "viewset.h"
@@ -84,6 +87,9 @@ static_assert((sizeof(uintptr_t) == sizeof(uint64_t)),
 static_assert((sizeof(atomic_ulong) == sizeof(uint64_t)),
               "libhse require atomic_ulong to be exactly 64-bits");
 
+static_assert((HSE_KVS_CURSOR_FILTER_FIELDS_MAX <= KC_PRED_FIELDS_MAX),
+              "cursor filter fields exceed internal predicate fields");
+
 struct perfc_name ctxn_perfc_op[] _dt_section = {
     NE(PERFC_BA_CTXNOP_ACTIVE,    1, "Count of active txns",       "c_ctxn_active"),
     NE(PERFC_RA_CTXNOP_ALLOC,     1, "Rate of ctxn allocs",        "r_ctxn_alloc(/s)"),
@@ -124,6 +130,7 @@ struct kvdb_ctxn_bkt {
 };
 
 static thread_local uint tls_txn_idx;
+static thread_local uint tls_throttle_samp;
 static atomic_uint ikvdb_txn_idx;
 
 /**
@@ -143,6 +150,9 @@ static atomic_uint ikvdb_txn_idx;
  * @ikdb_ctxn_cache:    ctxn cache
  * @ikdb_curcnt:        number of active cursors (lazily updated)
  * @ikdb_curcnt_max:    maximum number of active cursors
+ * @ikdb_snap_lock:     protects ikdb_snap_list and ikdb_snap_cnt
+ * @ikdb_snap_list:     list of active snapshots, oldest first
+ * @ikdb_snap_cnt:      number of active snapshots
  * @ikdb_seqno:         current sequence number for the struct ikvdb
  * @ikdb_maint_work:    used to schedule kvdb maint task
  * @ikdb_rp:            KVDB run time params
@@ -190,6 +200,10 @@ struct ikvdb_impl {
     atomic_int              ikdb_curcnt HSE_ACP_ALIGNED;
     u32                     ikdb_curcnt_max;
 
+    spinlock_t              ikdb_snap_lock HSE_L1X_ALIGNED;
+    struct list_head        ikdb_snap_list;
+    u64                     ikdb_snap_cnt;
+
     atomic_ulong            ikdb_tb_dbg_ops HSE_L1X_ALIGNED;
     atomic_ulong            ikdb_tb_dbg_bytes;
     atomic_ulong            ikdb_tb_dbg_sleep_ns;
@@ -222,6 +236,68 @@ struct ikvdb_impl {
     const char       ikdb_home[]; /* flexible array */
 };
 
+/**
+ * struct hse_kvdb_snapshot - read-only view of a kvdb
+ * @snap_link:        ikdb_snap_list linkage
+ * @snap_kvdb:        kvdb in which the view is pinned
+ * @snap_viewcookie:  cookie from viewset_insert()
+ * @snap_view_seqno:  pinned view seqno
+ * @snap_ctime:       creation time (nsecs)
+ */
+struct hse_kvdb_snapshot {
+    struct list_head   snap_link;
+    struct ikvdb_impl *snap_kvdb;
+    void              *snap_viewcookie;
+    u64                snap_view_seqno;
+    u64                snap_ctime;
+};
+
+/**
+ * struct hse_kvs_batch - write batch
+ * @kb_kvdb:   kvdb to which the batch is applied
+ * @kb_ctxn:   keylock-free txn through which the batch is applied
+ * @kb_buf:    serialized ops (see struct kvs_batch_op)
+ * @kb_bufsz:  size of @kb_buf
+ * @kb_len:    bytes of @kb_buf in use
+ * @kb_opc:    number of ops in @kb_buf
+ * @kb_entmax: number of elements in @kb_kvsv and @kb_entv
+ * @kb_kvsv:   scratch vector of kvs given to kvs_putdel_batch()
+ * @kb_entv:   scratch vector of entries given to kvs_putdel_batch()
+ */
+struct hse_kvs_batch {
+    struct ikvdb_impl      *kb_kvdb;
+    struct kvdb_ctxn       *kb_ctxn;
+    char                   *kb_buf;
+    size_t                  kb_bufsz;
+    size_t                  kb_len;
+    uint                    kb_opc;
+    uint                    kb_entmax;
+    struct ikvs           **kb_kvsv;
+    struct c0kvs_batch_ent *kb_entv;
+};
+
+/**
+ * struct kvs_batch_op - serialized write batch op
+ * @kbo_kvs:   kvs to which the op applies
+ * @kbo_flags: hse_kvs_put() flags (put only)
+ * @kbo_del:   true if the op is a delete
+ * @kbo_klen:  key length
+ * @kbo_xlen:  encoded value length (see struct kvs_vtuple)
+ * @kbo_data:  key followed by value, padded to 8-byte alignment
+ *
+ * Values are compressed (if warranted) as they are added to the batch
+ * rather than when the batch is committed, so as to keep compression
+ * out of the window during which the batch's txn is locked.
+ */
+struct kvs_batch_op {
+    struct kvdb_kvs *kbo_kvs;
+    uint16_t         kbo_flags;
+    uint16_t         kbo_del;
+    uint16_t         kbo_klen;
+    uint64_t         kbo_xlen;
+    char             kbo_data[];
+};
+
 /* clang-format on */
 
 struct ikvdb *
@@ -854,6 +930,27 @@ ikvdb_throttle_task(struct work_struct *work)
     }
 }
 
+/* Publish the number of active snapshots and the age of the oldest one.
+ * Snapshots are appended to ikdb_snap_list in creation order, hence the
+ * oldest snapshot is always at the head of the list.
+ */
+static void
+ikvdb_snapshot_metrics(struct ikvdb_impl *self, u64 now)
+{
+    struct hse_kvdb_snapshot *snap;
+    u64 age = 0, cnt;
+
+    spin_lock(&self->ikdb_snap_lock);
+    snap = list_first_entry_or_null(&self->ikdb_snap_list, typeof(*snap), snap_link);
+    if (snap && now > snap->snap_ctime)
+        age = now - snap->snap_ctime;
+    cnt = self->ikdb_snap_cnt;
+    spin_unlock(&self->ikdb_snap_lock);
+
+    perfc_set(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_SNAPCNT, cnt);
+    perfc_set(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_SNAPAGE, age / (NSEC_PER_SEC / MSEC_PER_SEC));
+}
+
 static void
 ikvdb_maint_task(struct work_struct *work)
 {
@@ -889,6 +986,8 @@ ikvdb_maint_task(struct work_struct *work)
             }
         }
 
+        ikvdb_snapshot_metrics(self, tstart);
+
         /* [HSE_REVISIT] move from big lock to using refcnts for
          * accessing KVSes in the kvs vector. Here and in all admin
          * functions
@@ -938,6 +1037,8 @@ ikvdb_init_throttle_params(struct ikvdb_impl *self)
     csched_throttle_sensor(self->ikdb_csched,
                            throttle_sensor(&self->ikdb_throttle, THROTTLE_SENSOR_CNROOT));
 
+    csched_throttle_debt(self->ikdb_csched, throttle_debt(&self->ikdb_throttle));
+
     c0sk_throttle_sensor(
         self->ikdb_c0sk, throttle_sensor(&self->ikdb_throttle, THROTTLE_SENSOR_C0SK));
 
@@ -957,6 +1058,10 @@ ikvdb_txn_init(struct ikvdb_impl *self)
         spin_lock_init(&bkt->kcb_lock);
         bkt->kcb_ctxnc = 0;
     }
+
+    spin_lock_init(&self->ikdb_snap_lock);
+    INIT_LIST_HEAD(&self->ikdb_snap_list);
+    self->ikdb_snap_cnt = 0;
 }
 
 static void
@@ -972,6 +1077,21 @@ ikvdb_txn_fini(struct ikvdb_impl *self)
 
         bkt->kcb_ctxnc = 0;
     }
+
+    /* Reclaim snapshots the application neglected to destroy.  Their views
+     * need not be removed as the viewsets are about to be destroyed.
+     */
+    if (self->ikdb_snap_cnt > 0) {
+        struct hse_kvdb_snapshot *snap, *next;
+
+        log_warn("%lu snapshots not destroyed prior to close", (ulong)self->ikdb_snap_cnt);
+
+        list_for_each_entry_safe(snap, next, &self->ikdb_snap_list, snap_link)
+            free(snap);
+
+        INIT_LIST_HEAD(&self->ikdb_snap_list);
+        self->ikdb_snap_cnt = 0;
+    }
 }
 
 merr_t
@@ -1700,6 +1820,7 @@ out:
         viewset_destroy(self->ikdb_txn_viewset);
         csched_destroy(self->ikdb_csched);
         throttle_fini(&self->ikdb_throttle);
+        cn_purge(self->ikdb_mp);
         mpool_close(self->ikdb_mp);
 
         ikvdb_txn_fini(self);
@@ -2024,6 +2145,11 @@ ikvdb_kvs_drop(struct ikvdb *handle, const char *kvs_name)
     if (ev(err))
         goto out_unlock;
 
+    /* The kvs is gone once cndb says so, failing to remove any of
+     * its leftovers isn't fatal.
+     */
+    ev(cn_drop(self->ikdb_mp, kvs->kk_cnid));
+
     drop_kvs_index(handle, idx);
 
 out_unlock:
@@ -2436,6 +2562,7 @@ ikvdb_close(struct ikvdb *handle)
 
     throttle_fini(&self->ikdb_throttle);
 
+    cn_purge(self->ikdb_mp);
     mpool_close(self->ikdb_mp);
 
     ikvdb_perfc_free(self);
@@ -2451,6 +2578,10 @@ ikvdb_throttle(struct ikvdb_impl *self, u64 bytes, u64 tstart)
     u64 sleep_ns, now;
 
     sleep_ns = tbkt_request(&self->ikdb_tb, bytes, &now);
+
+    if (self->ikdb_throttle.thr_predictive && (++tls_throttle_samp & THROTTLE_PRED_SAMPLE_MASK) == 0)
+        throttle_lat_record(&self->ikdb_throttle, sleep_ns);
+
     if (sleep_ns > 0) {
         u64 dly = now - tstart;
 
@@ -2485,6 +2616,90 @@ is_read_allowed(struct ikvs *kvs, struct hse_kvdb_txn *const txn)
     return txn && !kvs_txn_is_enabled(kvs) ? false : true;
 }
 
+/* Compress the value (if warranted), in which case vt is updated to
+ * describe the compressed value.  Returns the buffer (if any) that must
+ * be released via ikvdb_kvs_vcomp_free() once the value is consumed,
+ * along with its size and the number of bytes of it used.
+ */
+static void *
+ikvdb_kvs_vcomp(
+    struct kvdb_kvs   *kk,
+    const unsigned int flags,
+    struct kvs_vtuple *vt,
+    size_t            *vbufszp,
+    uint              *usedp)
+{
+    uint   vlen, clen;
+    size_t vbufsz;
+    void  *vbuf;
+    merr_t err;
+
+    vlen = kvs_vtuple_vlen(vt);
+    clen = kvs_vtuple_clen(vt);
+
+    vbufsz = tls_vbufsz;
+    vbuf = NULL;
+
+    if (clen == 0 && vlen > kk->kk_vcompmin && !(flags & HSE_KVS_PUT_VCOMP_OFF)) {
+        if (vlen > kk->kk_vcompbnd) {
+            vbufsz = vlen + PAGE_SIZE * 2;
+            vbuf = vlb_alloc(vbufsz);
+        } else {
+            vbuf = tls_vbuf;
+        }
+
+        if (vbuf) {
+            err = kk->kk_vcompress(vt->vt_data, vlen, vbuf, vbufsz, &clen);
+
+            if (!err && clen < vlen)
+                kvs_vtuple_cinit(vt, vbuf, vlen, clen);
+        }
+    }
+
+    *vbufszp = vbufsz;
+    *usedp = clen;
+
+    return vbuf;
+}
+
+static void
+ikvdb_kvs_vcomp_free(void *vbuf, size_t vbufsz, uint used)
+{
+    if (vbuf && vbuf != tls_vbuf)
+        vlb_free(vbuf, (vbufsz > VLB_ALLOCSZ_MAX) ? vbufsz : used);
+}
+
+/* Compress the value (if warranted) and insert the key-value pair into c0.
+ * Returns the number of value bytes written via *wlenp.
+ */
+static merr_t
+ikvdb_kvs_put_vcomp(
+    struct kvdb_kvs *          kk,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    struct kvs_ktuple *        kt,
+    struct kvs_vtuple *        vt,
+    uint *                     wlenp)
+{
+    uint64_t seqnoref;
+    merr_t   err;
+    size_t   vbufsz;
+    void *   vbuf;
+    uint     used;
+
+    vbuf = ikvdb_kvs_vcomp(kk, flags, vt, &vbufsz, &used);
+
+    seqnoref = txn ? 0 : HSE_SQNREF_SINGLE;
+
+    err = kvs_put(kk->kk_ikvs, txn, kt, vt, seqnoref);
+
+    ikvdb_kvs_vcomp_free(vbuf, vbufsz, used);
+
+    *wlenp = kvs_vtuple_vlen(vt);
+
+    return err;
+}
+
 merr_t
 ikvdb_kvs_put(
     struct hse_kvs *           handle,
@@ -2497,12 +2712,10 @@ ikvdb_kvs_put(
     struct ikvdb_impl *parent;
     struct kvs_ktuple  ktbuf;
     struct kvs_vtuple  vtbuf;
-    uint64_t           seqnoref;
     merr_t             err;
-    uint               vlen, clen;
-    size_t             vbufsz;
-    void *             vbuf;
+    uint               wlen;
     uint64_t           tstart;
+    bool               traced;
 
     INVARIANT(handle && kt && vt);
 
@@ -2519,45 +2732,22 @@ ikvdb_kvs_put(
 
     tstart = (flags & HSE_KVS_PUT_PRIO || parent->ikdb_rp.throttle_disable) ? 0 : get_time_ns();
 
+    traced = reqtrace_begin(REQTRACE_OP_PUT);
+
     ktbuf = *kt;
     vtbuf = *vt;
 
-    kt = &ktbuf;
-    vt = &vtbuf;
-
-    vlen = kvs_vtuple_vlen(vt);
-    clen = kvs_vtuple_clen(vt);
-
-    vbufsz = tls_vbufsz;
-    vbuf = NULL;
-
-    if (clen == 0 && vlen > kk->kk_vcompmin && !(flags & HSE_KVS_PUT_VCOMP_OFF)) {
-        if (vlen > kk->kk_vcompbnd) {
-            vbufsz = vlen + PAGE_SIZE * 2;
-            vbuf = vlb_alloc(vbufsz);
-        } else {
-            vbuf = tls_vbuf;
-        }
+    err = ikvdb_kvs_put_vcomp(kk, flags, txn, &ktbuf, &vtbuf, &wlen);
 
-        if (vbuf) {
-            err = kk->kk_vcompress(vt->vt_data, vlen, vbuf, vbufsz, &clen);
+    if (tstart > 0) {
+        u64 rt_start = reqtrace_stage_start();
 
-            if (!err && clen < vlen) {
-                kvs_vtuple_cinit(vt, vbuf, vlen, clen);
-                vlen = clen;
-            }
-        }
+        ikvdb_throttle(parent, ktbuf.kt_len + wlen, tstart);
+        reqtrace_stage_end(REQTRACE_STAGE_THROTTLE, rt_start);
     }
 
-    seqnoref = txn ? 0 : HSE_SQNREF_SINGLE;
-
-    err = kvs_put(kk->kk_ikvs, txn, kt, vt, seqnoref);
-
-    if (vbuf && vbuf != tls_vbuf)
-        vlb_free(vbuf, (vbufsz > VLB_ALLOCSZ_MAX) ? vbufsz : clen);
-
-    if (tstart > 0)
-        ikvdb_throttle(parent, kt->kt_len + (clen ? clen : vlen), tstart);
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
 
     return err;
 }
@@ -2611,6 +2801,8 @@ ikvdb_kvs_get(
     struct kvdb_kvs *  kk = (struct kvdb_kvs *)handle;
     struct ikvdb_impl *p;
     u64                view_seqno;
+    merr_t             err;
+    bool               traced;
 
     if (ev(!handle))
         return merr(EINVAL);
@@ -2620,6 +2812,8 @@ ikvdb_kvs_get(
 
     p = kk->kk_parent;
 
+    traced = reqtrace_begin(REQTRACE_OP_GET);
+
     if (txn) {
         /*
          * No need to wait for ongoing commits. A transaction waited when its view was
@@ -2632,7 +2826,98 @@ ikvdb_kvs_get(
         kvdb_ctxn_set_wait_commits(p->ikdb_ctxn_set, 0);
     }
 
-    return kvs_get(kk->kk_ikvs, txn, kt, view_seqno, res, vbuf);
+    err = kvs_get(kk->kk_ikvs, txn, kt, view_seqno, res, vbuf);
+
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
+    return err;
+}
+
+merr_t
+ikvdb_snapshot_create(struct ikvdb *handle, struct hse_kvdb_snapshot **snapp)
+{
+    struct ikvdb_impl *       self = ikvdb_h2r(handle);
+    struct hse_kvdb_snapshot *snap;
+    u64                       tseqno;
+    merr_t                    err;
+
+    snap = malloc(sizeof(*snap));
+    if (ev(!snap))
+        return merr(ENOMEM);
+
+    err = viewset_insert(self->ikdb_cur_viewset, &snap->snap_view_seqno, &tseqno,
+                         &snap->snap_viewcookie);
+    if (ev(err)) {
+        free(snap);
+        return err;
+    }
+
+    /* As with txn begin, wait for ongoing commits to finish after acquiring
+     * the view so that the snapshot never sees a partial txn.
+     */
+    kvdb_ctxn_set_wait_commits(self->ikdb_ctxn_set, tseqno);
+
+    snap->snap_kvdb = self;
+
+    spin_lock(&self->ikdb_snap_lock);
+    snap->snap_ctime = get_time_ns();
+    list_add_tail(&snap->snap_link, &self->ikdb_snap_list);
+    self->ikdb_snap_cnt++;
+    spin_unlock(&self->ikdb_snap_lock);
+
+    *snapp = snap;
+
+    return 0;
+}
+
+merr_t
+ikvdb_snapshot_destroy(struct ikvdb *handle, struct hse_kvdb_snapshot *snap)
+{
+    struct ikvdb_impl *self = ikvdb_h2r(handle);
+    u64                minview;
+    u32                minchg;
+
+    if (ev(snap->snap_kvdb != self))
+        return merr(EINVAL);
+
+    spin_lock(&self->ikdb_snap_lock);
+    list_del(&snap->snap_link);
+    self->ikdb_snap_cnt--;
+    spin_unlock(&self->ikdb_snap_lock);
+
+    viewset_remove(self->ikdb_cur_viewset, snap->snap_viewcookie, &minchg, &minview);
+
+    free(snap);
+
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_snapshot_get(
+    struct hse_kvs *          handle,
+    const unsigned int        flags,
+    struct hse_kvdb_snapshot *snap,
+    struct kvs_ktuple *       kt,
+    enum key_lookup_res *     res,
+    struct kvs_buf *          vbuf)
+{
+    struct kvdb_kvs *kk = (struct kvdb_kvs *)handle;
+
+    if (ev(!handle || !snap))
+        return merr(EINVAL);
+
+    if (ev(snap->snap_kvdb != kk->kk_parent))
+        return merr(EINVAL);
+
+    /* A snapshot read is a non-txn read at the snapshot's view. */
+    if (ev(!is_read_allowed(kk->kk_ikvs, NULL)))
+        return merr(EINVAL);
+
+    /* No need to wait for ongoing commits, that was done when the
+     * snapshot's view was established.
+     */
+    return kvs_get(kk->kk_ikvs, NULL, kt, snap->snap_view_seqno, res, vbuf);
 }
 
 merr_t
@@ -2646,6 +2931,7 @@ ikvdb_kvs_del(
     struct ikvdb_impl *parent;
     u64                seqnoref;
     merr_t             err;
+    bool               traced;
 
     if (ev(!handle))
         return merr(EINVAL);
@@ -2663,7 +2949,256 @@ ikvdb_kvs_del(
 
     seqnoref = txn ? 0 : HSE_SQNREF_SINGLE;
 
-    return kvs_del(kk->kk_ikvs, txn, kt, seqnoref);
+    traced = reqtrace_begin(REQTRACE_OP_DEL);
+
+    err = kvs_del(kk->kk_ikvs, txn, kt, seqnoref);
+
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
+    return err;
+}
+
+merr_t
+ikvdb_kvs_batch_create(struct ikvdb *handle, struct hse_kvs_batch **batchp)
+{
+    struct ikvdb_impl    *self = ikvdb_h2r(handle);
+    struct hse_kvs_batch *batch;
+
+    batch = calloc(1, sizeof(*batch));
+    if (ev(!batch))
+        return merr(ENOMEM);
+
+    batch->kb_ctxn = kvdb_ctxn_alloc(
+        self->ikdb_keylock,
+        self->ikdb_pfxlock,
+        &self->ikdb_seqno,
+        self->ikdb_ctxn_set,
+        self->ikdb_txn_viewset,
+        self->ikdb_c0snr_set,
+        self->ikdb_c0sk,
+        self->ikdb_wal);
+    if (ev(!batch->kb_ctxn)) {
+        free(batch);
+        return merr(ENOMEM);
+    }
+
+    kvdb_ctxn_nolock_set(batch->kb_ctxn);
+
+    batch->kb_kvdb = self;
+
+    *batchp = batch;
+
+    return 0;
+}
+
+void
+ikvdb_kvs_batch_destroy(struct hse_kvs_batch *batch)
+{
+    if (!batch)
+        return;
+
+    /* The batch's txn is never cached for reuse as its nolock mode
+     * cannot be reverted.
+     */
+    kvdb_ctxn_free(batch->kb_ctxn);
+    free(batch->kb_entv);
+    free(batch->kb_kvsv);
+    free(batch->kb_buf);
+    free(batch);
+}
+
+void
+ikvdb_kvs_batch_reset(struct hse_kvs_batch *batch)
+{
+    batch->kb_len = 0;
+    batch->kb_opc = 0;
+}
+
+static merr_t
+ikvdb_kvs_batch_add(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs       *handle,
+    uint                  flags,
+    bool                  del,
+    struct kvs_ktuple    *kt,
+    struct kvs_vtuple    *vt)
+{
+    struct kvdb_kvs     *kk = (struct kvdb_kvs *)handle;
+    struct kvs_batch_op *op;
+    struct kvs_vtuple    vtbuf;
+    size_t               vlen, oplen;
+    size_t               vbufsz = 0;
+    void                *vbuf = NULL;
+    uint                 used = 0;
+
+    /* Batch ops are not subject to write conflict detection, so they
+     * must not be applied to kvs in which txns could observe them.
+     */
+    if (ev(kk->kk_parent != batch->kb_kvdb || kvs_txn_is_enabled(kk->kk_ikvs)))
+        return merr(EINVAL);
+
+    kvs_vtuple_init(&vtbuf, NULL, 0);
+    if (vt) {
+        vtbuf = *vt;
+        vbuf = ikvdb_kvs_vcomp(kk, flags, &vtbuf, &vbufsz, &used);
+    }
+
+    vlen = kvs_vtuple_vlen(&vtbuf);
+    oplen = ALIGN(sizeof(*op) + kt->kt_len + vlen, 8);
+
+    if (batch->kb_len + oplen > batch->kb_bufsz) {
+        size_t bufsz = max_t(size_t, batch->kb_bufsz * 2, batch->kb_len + oplen);
+        char  *buf;
+
+        bufsz = ALIGN(bufsz, PAGE_SIZE);
+
+        buf = realloc(batch->kb_buf, bufsz);
+        if (ev(!buf)) {
+            ikvdb_kvs_vcomp_free(vbuf, vbufsz, used);
+            return merr(ENOMEM);
+        }
+
+        batch->kb_buf = buf;
+        batch->kb_bufsz = bufsz;
+    }
+
+    op = (struct kvs_batch_op *)(batch->kb_buf + batch->kb_len);
+    op->kbo_kvs = kk;
+    op->kbo_flags = flags;
+    op->kbo_del = del;
+    op->kbo_klen = kt->kt_len;
+    op->kbo_xlen = vtbuf.vt_xlen;
+
+    memcpy(op->kbo_data, kt->kt_data, kt->kt_len);
+    if (vlen > 0)
+        memcpy(op->kbo_data + kt->kt_len, vtbuf.vt_data, vlen);
+
+    ikvdb_kvs_vcomp_free(vbuf, vbufsz, used);
+
+    batch->kb_len += oplen;
+    batch->kb_opc++;
+
+    return 0;
+}
+
+merr_t
+ikvdb_kvs_batch_put(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs       *kvs,
+    const unsigned int    flags,
+    struct kvs_ktuple    *kt,
+    struct kvs_vtuple    *vt)
+{
+    return ikvdb_kvs_batch_add(batch, kvs, flags, false, kt, vt);
+}
+
+merr_t
+ikvdb_kvs_batch_del(
+    struct hse_kvs_batch *batch,
+    struct hse_kvs       *kvs,
+    const unsigned int    flags,
+    struct kvs_ktuple    *kt)
+{
+    return ikvdb_kvs_batch_add(batch, kvs, 0, true, kt, NULL);
+}
+
+merr_t
+ikvdb_kvs_batch_commit(struct hse_kvs_batch *batch, uint *opcp)
+{
+    struct ikvdb_impl   *self = batch->kb_kvdb;
+    struct hse_kvdb_txn *txn = &batch->kb_ctxn->ctxn_handle;
+    size_t               off;
+    u64                  tstart, bytes;
+    merr_t               err;
+    uint                 i;
+
+    *opcp = 0;
+
+    if (batch->kb_opc == 0)
+        return 0;
+
+    if (ev(self->ikdb_read_only))
+        return merr(EROFS);
+
+    err = kvdb_health_check(&self->ikdb_health, KVDB_HEALTH_FLAG_ALL);
+    if (ev(err))
+        return err;
+
+    if (batch->kb_opc > batch->kb_entmax) {
+        struct c0kvs_batch_ent *entv;
+        struct ikvs           **kvsv;
+        uint                    entmax = roundup_pow_of_two(batch->kb_opc);
+
+        entv = realloc(batch->kb_entv, entmax * sizeof(*entv));
+        if (ev(!entv))
+            return merr(ENOMEM);
+
+        batch->kb_entv = entv;
+
+        kvsv = realloc(batch->kb_kvsv, entmax * sizeof(*kvsv));
+        if (ev(!kvsv))
+            return merr(ENOMEM);
+
+        batch->kb_kvsv = kvsv;
+        batch->kb_entmax = entmax;
+    }
+
+    tstart = self->ikdb_rp.throttle_disable ? 0 : get_time_ns();
+    bytes = 0;
+
+    for (i = 0, off = 0; off < batch->kb_len; ++i) {
+        struct kvs_batch_op    *op = (void *)(batch->kb_buf + off);
+        struct c0kvs_batch_ent *ent = batch->kb_entv + i;
+        uint                    vlen;
+
+        memset(ent, 0, sizeof(*ent));
+        kvs_ktuple_init_nohash(&ent->cbe_kt, op->kbo_data, op->kbo_klen);
+        kvs_vtuple_init(&ent->cbe_vt, op->kbo_data + op->kbo_klen, op->kbo_xlen);
+        ent->cbe_del = op->kbo_del;
+
+        batch->kb_kvsv[i] = op->kbo_kvs->kk_ikvs;
+
+        vlen = op->kbo_del ? 0 : kvs_vtuple_vlen(&ent->cbe_vt);
+        bytes += op->kbo_klen + vlen;
+        off += ALIGN(sizeof(*op) + op->kbo_klen + vlen, 8);
+    }
+
+    assert(i == batch->kb_opc);
+
+    /* The batch is applied as a txn that acquires no key locks: its ops
+     * share one WAL record group and one commit seqno, and hence become
+     * visible (and are recovered) atomically.  Txn mutations take no c0
+     * ingest refs, the c0snr indirection keeps them invisible until the
+     * commit seqno is published.
+     *
+     * kvs_putdel_batch() locks the txn once for the whole batch and
+     * inserts the ops into c0 in runs sorted by c0kvset and key, each
+     * run under a single acquisition of its c0kvset's lock.
+     */
+    err = kvdb_ctxn_begin(batch->kb_ctxn);
+    if (ev(err))
+        return err;
+
+    err = kvs_putdel_batch(txn, batch->kb_kvsv, batch->kb_entv, batch->kb_opc);
+
+    if (err) {
+        kvdb_ctxn_abort(batch->kb_ctxn);
+        return err;
+    }
+
+    err = kvdb_ctxn_commit(batch->kb_ctxn);
+    if (ev(err))
+        return err;
+
+    if (tstart > 0)
+        ikvdb_throttle(self, bytes, tstart);
+
+    *opcp = batch->kb_opc;
+
+    ikvdb_kvs_batch_reset(batch);
+
+    return 0;
 }
 
 merr_t
@@ -2707,6 +3242,66 @@ ikvdb_kvs_prefix_delete(
     return kvs_prefix_del(kk->kk_ikvs, txn, kt, seqnoref);
 }
 
+merr_t
+ikvdb_kvs_range_count(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    struct kvs_ktuple *        start,
+    struct kvs_ktuple *        end,
+    u64 *                      count)
+{
+    struct kvdb_kvs *      kk = (struct kvdb_kvs *)handle;
+    struct hse_kvs_cursor *cur = NULL;
+    merr_t                 err;
+
+    INVARIANT(handle);
+    INVARIANT(start->kt_data && end->kt_data);
+
+    *count = 0;
+
+    if (ev(keycmp(start->kt_data, start->kt_len, end->kt_data, end->kt_len) > 0))
+        return merr(EINVAL);
+
+    /* The estimate comes from kblock metadata alone and so sees neither
+     * c0, lc nor the txn.
+     */
+    if (flags & HSE_KVS_RANGE_COUNT_EST) {
+        *count = cn_range_count_est(kvs_cn(kk->kk_ikvs), start, end);
+        return 0;
+    }
+
+    err = ikvdb_kvs_cursor_create(handle, HSE_CURSOR_CREATE_KEYS_ONLY, txn, NULL, 0, &cur);
+    if (ev(err))
+        return err;
+
+    /* Bound the cn iterators by the end key so that they stop at the
+     * first kblock past the range.  The bound is inclusive, hence the
+     * check for the end key itself.
+     */
+    err = ikvdb_kvs_cursor_seek(cur, 0, start->kt_data, start->kt_len, end->kt_data,
+                                end->kt_len, NULL);
+
+    while (!err) {
+        const void *key, *val;
+        size_t      klen, vlen;
+        bool        eof;
+
+        err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
+        if (ev(err) || eof)
+            break;
+
+        if (keycmp(key, klen, end->kt_data, end->kt_len) >= 0)
+            break;
+
+        ++*count;
+    }
+
+    ikvdb_kvs_cursor_destroy(cur);
+
+    return err;
+}
+
 /*-  IKVDB Cursors --------------------------------------------------*/
 
 /*
@@ -2795,27 +3390,27 @@ cursor_unbind_txn(struct hse_kvs_cursor *cur)
     return 0;
 }
 
-merr_t
-ikvdb_kvs_cursor_create(
-    struct hse_kvs *           handle,
-    const unsigned int         flags,
-    struct hse_kvdb_txn *const txn,
-    const void *               prefix,
-    size_t                     pfx_len,
-    struct hse_kvs_cursor **   cursorp)
+/* Common cursor creation for txn, snapshot and plain cursors.  If vseq is
+ * HSE_SQNREF_UNDEFINED then the cursor acquires its own view, otherwise the
+ * view is inherited from a txn or snapshot which is keeping it pinned.
+ */
+static merr_t
+ikvdb_kvs_cursor_create_impl(
+    struct kvdb_kvs *        kk,
+    const unsigned int       flags,
+    struct kvdb_ctxn *       ctxn,
+    u64                      vseq,
+    const void *             prefix,
+    size_t                   pfx_len,
+    struct hse_kvs_cursor ** cursorp)
 {
-    struct kvdb_kvs *      kk = (struct kvdb_kvs *)handle;
     struct ikvdb_impl *    ikvdb = kk->kk_parent;
-    struct kvdb_ctxn *     ctxn = 0;
     struct hse_kvs_cursor *cur = 0;
     merr_t                 err;
-    u64                    ts, vseq, tstart, tseqno;
+    u64                    ts, tstart, tseqno;
     struct perfc_set *     pkvsl_pc;
-
-    *cursorp = NULL;
-
-    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
-        return merr(EINVAL);
+    bool                   inherited = (vseq != HSE_SQNREF_UNDEFINED);
+    bool                   traced;
 
     if (ev(atomic_read(&ikvdb->ikdb_curcnt) > ikvdb->ikdb_curcnt_max))
         return merr(ECANCELED);
@@ -2823,14 +3418,7 @@ ikvdb_kvs_cursor_create(
     pkvsl_pc = kvs_perfc_pkvsl(kk->kk_ikvs);
     tstart = perfc_lat_start(pkvsl_pc);
 
-    vseq = HSE_SQNREF_UNDEFINED;
-
-    if (txn) {
-        ctxn = kvdb_ctxn_h2h(txn);
-        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
-        if (ev(err))
-            return err;
-    }
+    traced = reqtrace_begin(REQTRACE_OP_CURSOR_CREATE);
 
     /* The initialization sequence is driven by the way the sequence
      * number horizon is tracked, which requires atomically getting a
@@ -2843,15 +3431,19 @@ ikvdb_kvs_cursor_create(
      *  - initialize cursor
      * The failure path must unregister the cursor from kk_cursors.
      */
-    cur = kvs_cursor_alloc(kk->kk_ikvs, prefix, pfx_len, flags & HSE_CURSOR_CREATE_REV);
-    if (ev(!cur))
-        return merr(ENOMEM);
+    cur = kvs_cursor_alloc(kk->kk_ikvs, prefix, pfx_len, flags & HSE_CURSOR_CREATE_REV,
+                           flags & HSE_CURSOR_CREATE_KEYS_ONLY);
+    if (ev(!cur)) {
+        err = merr(ENOMEM);
+        goto out;
+    }
 
     cur->kc_pkvsl_pc = pkvsl_pc;
 
-    /* if we have a transaction at all, use its view seqno... */
+    /* if we have a transaction or snapshot, use its view seqno... */
     cur->kc_seq = vseq;
     cur->kc_flags = flags;
+    cur->kc_snapshot = inherited && !ctxn;
 
     cur->kc_kvs = kk;
     cur->kc_gen = 0;
@@ -2865,7 +3457,7 @@ ikvdb_kvs_cursor_create(
 
     ts = perfc_lat_start(pkvsl_pc);
     err = kvs_cursor_init(cur, ctxn);
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_INIT, ts);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_INIT, ts);
     if (ev(err))
         goto out;
 
@@ -2873,15 +3465,15 @@ ikvdb_kvs_cursor_create(
 
     /* After acquiring a view, non-txn cursors must wait for ongoing commits
      * to finish to ensure they never see partial txns.  This is not necessary
-     * for txn cursors because their view is inherited from the txn.
+     * for txn and snapshot cursors because their view is inherited.
      */
-    if (!txn)
+    if (!inherited)
         kvdb_ctxn_set_wait_commits(ikvdb->ikdb_ctxn_set, tseqno);
 
     perfc_inc(&kvdb_metrics_pc, PERFC_BA_KVDBMETRICS_CURCNT);
     cur->kc_create_time = tstart;
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_CREATE, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_CREATE, tstart);
 
     *cursorp = cur;
 
@@ -2889,9 +3481,69 @@ out:
     if (err)
         ikvdb_kvs_cursor_destroy(cur);
 
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
     return err;
 }
 
+merr_t
+ikvdb_kvs_cursor_create(
+    struct hse_kvs *           handle,
+    const unsigned int         flags,
+    struct hse_kvdb_txn *const txn,
+    const void *               prefix,
+    size_t                     pfx_len,
+    struct hse_kvs_cursor **   cursorp)
+{
+    struct kvdb_kvs * kk = (struct kvdb_kvs *)handle;
+    struct kvdb_ctxn *ctxn = 0;
+    merr_t            err;
+    u64               vseq;
+
+    *cursorp = NULL;
+
+    if (ev(!is_read_allowed(kk->kk_ikvs, txn)))
+        return merr(EINVAL);
+
+    vseq = HSE_SQNREF_UNDEFINED;
+
+    if (txn) {
+        ctxn = kvdb_ctxn_h2h(txn);
+        err = kvdb_ctxn_get_view_seqno(ctxn, &vseq);
+        if (ev(err))
+            return err;
+    }
+
+    return ikvdb_kvs_cursor_create_impl(kk, flags, ctxn, vseq, prefix, pfx_len, cursorp);
+}
+
+merr_t
+ikvdb_kvs_snapshot_cursor_create(
+    struct hse_kvs *          handle,
+    const unsigned int        flags,
+    struct hse_kvdb_snapshot *snap,
+    const void *              prefix,
+    size_t                    pfx_len,
+    struct hse_kvs_cursor **  cursorp)
+{
+    struct kvdb_kvs *kk = (struct kvdb_kvs *)handle;
+
+    *cursorp = NULL;
+
+    if (ev(!handle || !snap))
+        return merr(EINVAL);
+
+    if (ev(snap->snap_kvdb != kk->kk_parent))
+        return merr(EINVAL);
+
+    if (ev(!is_read_allowed(kk->kk_ikvs, NULL)))
+        return merr(EINVAL);
+
+    return ikvdb_kvs_cursor_create_impl(
+        kk, flags, NULL, snap->snap_view_seqno, prefix, pfx_len, cursorp);
+}
+
 merr_t
 ikvdb_kvs_cursor_update_view(struct hse_kvs_cursor *cur, unsigned int flags)
 {
@@ -2904,7 +3556,7 @@ ikvdb_kvs_cursor_update_view(struct hse_kvs_cursor *cur, unsigned int flags)
     if (ev(cur->kc_err))
         return cur->kc_err;
 
-    if (ev(cur->kc_ctxn))
+    if (ev(cur->kc_ctxn || cur->kc_snapshot))
         return merr(EINVAL);
 
     cur->kc_seq = HSE_SQNREF_UNDEFINED;
@@ -2929,7 +3581,7 @@ ikvdb_kvs_cursor_update_view(struct hse_kvs_cursor *cur, unsigned int flags)
 
     cur->kc_flags = flags;
 
-    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_UPDATE, tstart);
+    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_UPDATE, tstart);
 
 out:
     return ev(cur->kc_err);
@@ -2960,6 +3612,78 @@ cursor_refresh(struct hse_kvs_cursor *cur)
     return ev(err);
 }
 
+merr_t
+ikvdb_kvs_cursor_filter_set(
+    struct hse_kvs_cursor *             cur,
+    unsigned int                        flags,
+    const struct hse_kvs_cursor_filter *filter)
+{
+    struct kc_pred *pred = NULL;
+    size_t          sz;
+    u8 *            p;
+    uint            i;
+
+    if (ev(cur->kc_err))
+        return cur->kc_err;
+
+    if (!filter) {
+        kvs_cursor_filter_set(cur, NULL);
+        return 0;
+    }
+
+    /* Copy the caller's byte strings into the tail of the predicate
+     * so that it is self-contained.
+     */
+    sz = sizeof(*pred) + filter->kvcf_sfx_len * 2;
+    for (i = 0; i < filter->kvcf_fieldc; ++i)
+        sz += filter->kvcf_fieldv[i].kvcf_len * 2;
+
+    pred = malloc(sz);
+    if (ev(!pred))
+        return merr(ENOMEM);
+
+    memset(pred, 0, sizeof(*pred));
+    p = pred->kp_buf;
+
+    if (filter->kvcf_sfx_len > 0) {
+        pred->kp_sfx_len = filter->kvcf_sfx_len;
+
+        pred->kp_sfx_match = memcpy(p, filter->kvcf_sfx_match, pred->kp_sfx_len);
+        p += pred->kp_sfx_len;
+
+        if (filter->kvcf_sfx_mask) {
+            pred->kp_sfx_mask = memcpy(p, filter->kvcf_sfx_mask, pred->kp_sfx_len);
+            p += pred->kp_sfx_len;
+        }
+    }
+
+    for (i = 0; i < filter->kvcf_fieldc; ++i) {
+        const struct hse_kvs_cursor_filter_field *src = filter->kvcf_fieldv + i;
+        struct kc_pred_field *                    dst = pred->kp_fieldv + i;
+
+        dst->kpf_off = src->kvcf_off;
+        dst->kpf_len = src->kvcf_len;
+
+        if (src->kvcf_min) {
+            dst->kpf_min = memcpy(p, src->kvcf_min, src->kvcf_len);
+            p += src->kvcf_len;
+        }
+
+        if (src->kvcf_max) {
+            dst->kpf_max = memcpy(p, src->kvcf_max, src->kvcf_len);
+            p += src->kvcf_len;
+        }
+    }
+
+    pred->kp_fieldc = filter->kvcf_fieldc;
+    pred->kp_cb = filter->kvcf_cb;
+    pred->kp_cb_arg = filter->kvcf_cb_arg;
+
+    kvs_cursor_filter_set(cur, pred);
+
+    return 0;
+}
+
 merr_t
 ikvdb_kvs_cursor_seek(
     struct hse_kvs_cursor *cur,
@@ -2972,6 +3696,7 @@ ikvdb_kvs_cursor_seek(
 {
     merr_t err;
     u64    tstart;
+    bool   traced;
 
     tstart = perfc_lat_start(cur->kc_pkvsl_pc);
 
@@ -2987,10 +3712,15 @@ ikvdb_kvs_cursor_seek(
             return cur->kc_err;
     }
 
+    traced = reqtrace_begin(REQTRACE_OP_CURSOR_SEEK);
+
     /* errors on seek are not fatal */
     err = kvs_cursor_seek(cur, key, (u32)len, limit, (u32)limit_len, kt);
 
-    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_SEEK, tstart);
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
+    perfc_lat_record(cur->kc_pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_SEEK, tstart);
 
     return ev(err);
 }
@@ -3007,6 +3737,7 @@ ikvdb_kvs_cursor_read(
 {
     merr_t             err;
     u64                tstart;
+    bool               traced;
 
     tstart = perfc_lat_start(cur->kc_pkvsl_pc);
 
@@ -3019,21 +3750,26 @@ ikvdb_kvs_cursor_read(
             return cur->kc_err;
     }
 
+    traced = reqtrace_begin(REQTRACE_OP_CURSOR_READ);
+
     err = kvs_cursor_read(cur, flags, eof);
+    if (!err && !*eof) {
+        kvs_cursor_key_copy(cur, NULL, 0, key, key_len);
+        err = kvs_cursor_val_copy(cur, NULL, 0, val, val_len);
+    }
+
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
     if (ev(err))
         return err;
     if (*eof)
         return 0;
 
-    kvs_cursor_key_copy(cur, NULL, 0, key, key_len);
-    err = kvs_cursor_val_copy(cur, NULL, 0, val, val_len);
-    if (ev(err))
-        return err;
-
     perfc_lat_record(
         cur->kc_pkvsl_pc,
-        cur->kc_flags & HSE_CURSOR_CREATE_REV ? PERFC_LT_PKVSL_KVS_CURSOR_READREV
-                                                : PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
+        cur->kc_flags & HSE_CURSOR_CREATE_REV ? PERFC_HG_PKVSL_KVS_CURSOR_READREV
+                                                : PERFC_HG_PKVSL_KVS_CURSOR_READFWD,
         tstart);
 
     return 0;
@@ -3053,6 +3789,7 @@ ikvdb_kvs_cursor_read_copy(
 {
     merr_t             err;
     u64                tstart;
+    bool               traced;
 
     tstart = perfc_lat_start(cur->kc_pkvsl_pc);
 
@@ -3065,21 +3802,26 @@ ikvdb_kvs_cursor_read_copy(
             return cur->kc_err;
     }
 
+    traced = reqtrace_begin(REQTRACE_OP_CURSOR_READ);
+
     err = kvs_cursor_read(cur, flags, eof);
+    if (!err && !*eof) {
+        kvs_cursor_key_copy(cur, keybuf, keybuf_sz, NULL, key_len);
+        err = kvs_cursor_val_copy(cur, valbuf, valbuf_sz, NULL, val_len);
+    }
+
+    if (HSE_UNLIKELY(traced))
+        reqtrace_end(err);
+
     if (ev(err))
         return err;
     if (*eof)
         return 0;
 
-    kvs_cursor_key_copy(cur, keybuf, keybuf_sz, NULL, key_len);
-    err = kvs_cursor_val_copy(cur, valbuf, valbuf_sz, NULL, val_len);
-    if (ev(err))
-        return err;
-
     perfc_lat_record(
         cur->kc_pkvsl_pc,
-        cur->kc_flags & HSE_CURSOR_CREATE_REV ? PERFC_LT_PKVSL_KVS_CURSOR_READREV
-                                                : PERFC_LT_PKVSL_KVS_CURSOR_READFWD,
+        cur->kc_flags & HSE_CURSOR_CREATE_REV ? PERFC_HG_PKVSL_KVS_CURSOR_READREV
+                                                : PERFC_HG_PKVSL_KVS_CURSOR_READFWD,
         tstart);
 
     return 0;
@@ -3104,8 +3846,8 @@ ikvdb_kvs_cursor_destroy(struct hse_kvs_cursor *cur)
 
     kvs_cursor_free(cur);
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_DESTROY, tstart);
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_CURSOR_FULL, ctime);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_DESTROY, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_CURSOR_FULL, ctime);
 
     return 0;
 }
@@ -3132,6 +3874,42 @@ ikvdb_compact_status_get(struct ikvdb *handle, struct hse_kvdb_compact_status *s
     csched_compact_status_get(self->ikdb_csched, status);
 }
 
+void
+ikvdb_metrics_get(struct ikvdb *handle, struct ikvdb_metrics *metrics)
+{
+    struct ikvdb_impl             *self = ikvdb_h2r(handle);
+    struct hse_kvdb_compact_status status = { 0 };
+    int                            i;
+
+    memset(metrics, 0, sizeof(*metrics));
+
+    for (i = 0; i < THROTTLE_SENSOR_CNT; i++)
+        metrics->ikm_sensorv[i] = throttle_sensor_get(throttle_sensor(&self->ikdb_throttle, i));
+
+    metrics->ikm_thr_delay = throttle_delay(&self->ikdb_throttle);
+
+    c0sk_usage(self->ikdb_c0sk, &metrics->ikm_c0_kvms, &metrics->ikm_c0_memsz);
+    wal_buffer_usage(self->ikdb_wal, &metrics->ikm_wal_bufsz, &metrics->ikm_wal_buflen);
+
+    if (self->ikdb_read_only)
+        return;
+
+    csched_compact_status_get(self->ikdb_csched, &status);
+    csched_qinfo_get(self->ikdb_csched, metrics->ikm_qjobsv, metrics->ikm_qthreadsv);
+
+    metrics->ikm_samp_curr = status.kvcs_samp_curr;
+    metrics->ikm_samp_lwm = status.kvcs_samp_lwm;
+    metrics->ikm_samp_hwm = status.kvcs_samp_hwm;
+}
+
+void
+ikvdb_compact_history_get(struct ikvdb *handle, struct csched_history *hist)
+{
+    struct ikvdb_impl *self = ikvdb_h2r(handle);
+
+    csched_history_get(self->ikdb_read_only ? NULL : self->ikdb_csched, hist);
+}
+
 merr_t
 ikvdb_sync(struct ikvdb *handle, const unsigned int flags)
 {
@@ -3636,8 +4414,22 @@ ikvdb_init(void)
     if (err)
         goto errout5;
 
+    err = reqtrace_init(hse_gparams.gp_reqtrace_period);
+    if (err)
+        goto errout6;
+
+    err = kvdb_rest_init();
+    if (err)
+        goto errout7;
+
     return 0;
 
+errout7:
+    reqtrace_fini();
+
+errout6:
+    bkv_collection_fini();
+
 errout5:
     cn_fini();
 
@@ -3662,6 +4454,8 @@ errout1:
 void
 ikvdb_fini(void)
 {
+    kvdb_rest_fini();
+    reqtrace_fini();
     bkv_collection_fini();
     cn_fini();
     lc_fini();
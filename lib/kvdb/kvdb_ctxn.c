@@ -302,10 +302,13 @@ kvdb_ctxn_free(struct kvdb_ctxn *handle)
 static merr_t
 kvdb_ctxn_enable_inserts(struct kvdb_ctxn_impl *ctxn)
 {
-    struct kvdb_ctxn_locks *locks;
+    struct kvdb_ctxn_locks *locks = NULL;
     uintptr_t *             priv;
     merr_t                  err;
 
+    if (ctxn->ctxn_nolock)
+        goto get_c0snr;
+
     kvdb_keylock_expire(ctxn->ctxn_kvdb_keylock, viewset_min_view(ctxn->ctxn_viewset), 1);
 
     err = kvdb_ctxn_locks_create(&locks);
@@ -319,11 +322,14 @@ kvdb_ctxn_enable_inserts(struct kvdb_ctxn_impl *ctxn)
         return err;
     }
 
+get_c0snr:
     priv = c0snr_set_get_c0snr(ctxn->ctxn_c0snr_set, &ctxn->ctxn_inner_handle);
     if (ev(!priv)) {
-        kvdb_ctxn_pfxlock_destroy(ctxn->ctxn_pfxlock_handle);
-        ctxn->ctxn_pfxlock_handle = NULL;
-        kvdb_ctxn_locks_destroy(locks);
+        if (locks) {
+            kvdb_ctxn_pfxlock_destroy(ctxn->ctxn_pfxlock_handle);
+            ctxn->ctxn_pfxlock_handle = NULL;
+            kvdb_ctxn_locks_destroy(locks);
+        }
         return merr(ECANCELED);
     }
 
@@ -427,22 +433,25 @@ kvdb_ctxn_abort_inner(struct kvdb_ctxn_impl *ctxn)
         locks = ctxn->ctxn_locks_handle;
         ctxn->ctxn_locks_handle = NULL;
 
-        assert(locks);
+        /* Write batches (see kvdb_ctxn_nolock_set()) hold no locks */
+        assert(locks || ctxn->ctxn_nolock);
 
-        /* Release all the locks that we didn't inherit */
-        kvdb_keylock_prune_own_locks(keylock, locks);
+        if (locks) {
+            /* Release all the locks that we didn't inherit */
+            kvdb_keylock_prune_own_locks(keylock, locks);
 
-        if (kvdb_ctxn_locks_count(locks) > 0) {
-            void *cookie = NULL;
-            u64 end_seq;
+            if (kvdb_ctxn_locks_count(locks) > 0) {
+                void *cookie = NULL;
+                u64 end_seq;
 
-            kvdb_keylock_list_lock(keylock, &cookie);
-            end_seq = atomic_fetch_add(ctxn->ctxn_kvdb_seq_addr, 1);
-            kvdb_keylock_enqueue_locks(locks, end_seq, cookie);
-            kvdb_keylock_list_unlock(cookie);
+                kvdb_keylock_list_lock(keylock, &cookie);
+                end_seq = atomic_fetch_add(ctxn->ctxn_kvdb_seq_addr, 1);
+                kvdb_keylock_enqueue_locks(locks, end_seq, cookie);
+                kvdb_keylock_list_unlock(cookie);
 
-        } else {
-            kvdb_ctxn_locks_destroy(locks);
+            } else {
+                kvdb_ctxn_locks_destroy(locks);
+            }
         }
 
         wal_txn_abort(ctxn->ctxn_wal, ctxn->ctxn_view_seqno, ctxn->ctxn_wal_cookie);
@@ -594,7 +603,7 @@ kvdb_ctxn_commit(struct kvdb_ctxn *handle)
     locks = ctxn->ctxn_locks_handle;
     ctxn->ctxn_locks_handle = NULL;
 
-    if (kvdb_ctxn_locks_count(locks) > 0) {
+    if (locks && kvdb_ctxn_locks_count(locks) > 0) {
         kvdb_keylock_enqueue_locks(locks, commit_sn, cookie);
         locks = NULL;
     }
@@ -611,7 +620,8 @@ kvdb_ctxn_commit(struct kvdb_ctxn *handle)
     err = wal_txn_commit(ctxn->ctxn_wal, ctxn->ctxn_view_seqno, commit_sn, head,
                          ctxn->ctxn_wal_cookie);
 
-    kvdb_ctxn_pfxlock_seqno_pub(ctxn->ctxn_pfxlock_handle, commit_sn);
+    if (ctxn->ctxn_pfxlock_handle)
+        kvdb_ctxn_pfxlock_seqno_pub(ctxn->ctxn_pfxlock_handle, commit_sn);
 
     kvdb_ctxn_deactivate(ctxn);
     kvdb_ctxn_unlock_impl(ctxn);
@@ -865,6 +875,9 @@ kvdb_ctxn_trylock_write(
             goto errout;
     }
 
+    if (ctxn->ctxn_nolock)
+        goto locked;
+
     if (pfxhash) {
         struct kvdb_ctxn_pfxlock *pl = ctxn->ctxn_pfxlock_handle;
 
@@ -882,6 +895,7 @@ kvdb_ctxn_trylock_write(
             goto errout;
     }
 
+locked:
     if (ctxn->ctxn_bind)
         kvdb_ctxn_bind_invalidate(ctxn->ctxn_bind);
 
@@ -896,6 +910,16 @@ kvdb_ctxn_trylock_write(
     return err;
 }
 
+void
+kvdb_ctxn_nolock_set(struct kvdb_ctxn *handle)
+{
+    struct kvdb_ctxn_impl *ctxn = kvdb_ctxn_h2r(handle);
+
+    assert(seqnoref_to_state(ctxn->ctxn_seqref) != KVDB_CTXN_ACTIVE);
+
+    ctxn->ctxn_nolock = true;
+}
+
 void
 kvdb_ctxn_unlock(struct kvdb_ctxn *handle)
 {
@@ -21,6 +21,7 @@
  * @ctxn_inner_handle:
  * @ctxn_lock:                thread-thread API and async abort serialization
  * @ctxn_can_insert:          true when txn can accept puts
+ * @ctxn_nolock:              txn is a write batch and acquires no key/prefix locks
  * @ctxn_seqref:              transaction seqref
  * @ctxn_view_seqno:          seqno at time of transaction begin call
  * @ctxn_kvdb_pfxlock:        address of the KVDB pfxlock
@@ -41,6 +42,7 @@ struct kvdb_ctxn_impl {
     struct kvdb_ctxn        ctxn_inner_handle;
     struct mutex            ctxn_lock;
     bool                    ctxn_can_insert;
+    bool                    ctxn_nolock;
     uintptr_t               ctxn_seqref;
     u64                     ctxn_view_seqno;
 
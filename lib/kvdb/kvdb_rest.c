@@ -12,6 +12,9 @@
 #include <hse_util/event_counter.h>
 
 #include <hse_util/rest_api.h>
+#include <hse_util/mutex.h>
+#include <hse_util/openmetrics.h>
+#include <hse_util/parse_num.h>
 
 #include <hse_ikvdb/ikvdb.h>
 #include <hse_ikvdb/kvs.h>
@@ -20,6 +23,7 @@
 #include <hse_ikvdb/cn_tree_view.h>
 #include <hse_ikvdb/kvset_view.h>
 #include <hse_ikvdb/kvdb_rparams.h>
+#include <hse_ikvdb/csched.h>
 
 #include <cjson/cJSON_Utils.h>
 
@@ -397,6 +401,133 @@ rest_kvdb_compact_request(
     return 0;
 }
 
+/* Render the compaction history as yaml: cumulative write amplification
+ * per kvs and per rule, followed by the most recently finished jobs
+ * (all that are retained, or the last "jobs=N").
+ */
+static merr_t
+rest_kvdb_compact_history_get(struct conn_info *info, struct kv_iter *iter, struct ikvdb *ikvdb)
+{
+    struct csched_history *hist;
+    struct rest_kv        *kv;
+    char                  *buf = info->buf;
+    size_t                 bufsz = info->buf_sz;
+    size_t                 off;
+    uint                   jobs = CSCHED_HIST_JOBS;
+    uint                   i;
+    merr_t                 err = 0;
+
+    while ((kv = rest_kv_next(iter))) {
+        if (strcmp(kv->key, "jobs") || parse_u32(kv->value, &jobs))
+            return merr(EINVAL);
+    }
+
+    hist = malloc(sizeof(*hist));
+    if (ev(!hist))
+        return merr(ENOMEM);
+
+    ikvdb_compact_history_get(ikvdb, hist);
+
+    off = 0;
+    snprintf_append(buf, bufsz, &off, "jobs_finished: %lu\n", hist->ch_jobs);
+    snprintf_append(buf, bufsz, &off, "ingest_bytes: %lu\n", hist->ch_ingest_bytes);
+    snprintf_append(buf, bufsz, &off, "kvs:\n");
+
+    if (rest_write_safe(info->resp_fd, buf, off) != off) {
+        err = merr(EIO);
+        goto out;
+    }
+
+    for (i = 0; i < hist->ch_kvsc; i++) {
+        const struct csched_kvs_stats *ks = hist->ch_kvsv + i;
+
+        off = 0;
+        snprintf_append(buf, bufsz, &off, "  - name: %s\n", ks->cks_kvsname);
+        snprintf_append(buf, bufsz, &off, "    cnid: %lu\n", ks->cks_cnid);
+        snprintf_append(buf, bufsz, &off, "    ingest_bytes: %lu\n", ks->cks_ingest_bytes);
+        snprintf_append(buf, bufsz, &off, "    jobs: %lu\n", ks->cks_jobs);
+        snprintf_append(buf, bufsz, &off, "    read_bytes: %lu\n", ks->cks_rbytes);
+        snprintf_append(buf, bufsz, &off, "    write_bytes: %lu\n", ks->cks_wbytes);
+        if (ks->cks_ingest_bytes > 0)
+            snprintf_append(buf, bufsz, &off, "    write_amp: %.2f\n",
+                            (double)(ks->cks_ingest_bytes + ks->cks_wbytes) /
+                            ks->cks_ingest_bytes);
+
+        if (rest_write_safe(info->resp_fd, buf, off) != off) {
+            err = merr(EIO);
+            goto out;
+        }
+    }
+
+    /* A rule's write amp is its share of the kvdb's write amp, i.e.,
+     * the bytes it wrote per byte ingested.
+     */
+    off = 0;
+    snprintf_append(buf, bufsz, &off, "rules:\n");
+
+    for (i = 0; i < hist->ch_rulec; i++) {
+        const struct csched_rule_stats *rs = hist->ch_rulev + i;
+
+        snprintf_append(buf, bufsz, &off, "  - rule: %s\n", rs->crs_rule);
+        snprintf_append(buf, bufsz, &off, "    jobs: %lu\n", rs->crs_jobs);
+        snprintf_append(buf, bufsz, &off, "    read_bytes: %lu\n", rs->crs_rbytes);
+        snprintf_append(buf, bufsz, &off, "    write_bytes: %lu\n", rs->crs_wbytes);
+        snprintf_append(buf, bufsz, &off, "    cpu_ns: %lu\n", rs->crs_cpu_ns);
+        snprintf_append(buf, bufsz, &off, "    wall_ns: %lu\n", rs->crs_wall_ns);
+        if (hist->ch_ingest_bytes > 0)
+            snprintf_append(buf, bufsz, &off, "    write_amp: %.2f\n",
+                            (double)rs->crs_wbytes / hist->ch_ingest_bytes);
+
+        if (rest_write_safe(info->resp_fd, buf, off) != off) {
+            err = merr(EIO);
+            goto out;
+        }
+        off = 0;
+    }
+
+    snprintf_append(buf, bufsz, &off, "jobs:\n");
+
+    for (i = hist->ch_jobc > jobs ? hist->ch_jobc - jobs : 0; i < hist->ch_jobc; i++) {
+        const struct csched_job_rec *rec = hist->ch_jobv + i;
+
+        snprintf_append(buf, bufsz, &off, "  - seq: %lu\n", rec->cjr_seq);
+        snprintf_append(buf, bufsz, &off, "    id: %lu\n", rec->cjr_id);
+        snprintf_append(buf, bufsz, &off, "    kvs: %s\n", rec->cjr_kvsname);
+        snprintf_append(buf, bufsz, &off, "    cnid: %lu\n", rec->cjr_cnid);
+        snprintf_append(buf, bufsz, &off, "    action: %s\n", rec->cjr_action);
+        snprintf_append(buf, bufsz, &off, "    rule: %s\n", rec->cjr_rule);
+        snprintf_append(buf, bufsz, &off, "    node: [%u, %u]\n", rec->cjr_level,
+                        rec->cjr_offset);
+        snprintf_append(buf, bufsz, &off, "    kvsets_in: %u\n", rec->cjr_kvsets_in);
+        snprintf_append(buf, bufsz, &off, "    kvsets_out: %u\n", rec->cjr_kvsets_out);
+        snprintf_append(buf, bufsz, &off, "    vblocks_reused: %u\n", rec->cjr_vblks_reused);
+        snprintf_append(buf, bufsz, &off, "    keys_in: %lu\n", rec->cjr_keys_in);
+        snprintf_append(buf, bufsz, &off, "    keys_out: %lu\n", rec->cjr_keys_out);
+        snprintf_append(buf, bufsz, &off, "    read_bytes: %lu\n", rec->cjr_rbytes);
+        snprintf_append(buf, bufsz, &off, "    write_bytes: %lu\n", rec->cjr_wbytes);
+        snprintf_append(buf, bufsz, &off, "    cpu_ns: %lu\n", rec->cjr_cpu_ns);
+        snprintf_append(buf, bufsz, &off, "    read_wait_ns: %lu\n", rec->cjr_wait_ns);
+        snprintf_append(buf, bufsz, &off, "    queue_ns: %lu\n", rec->cjr_queue_ns);
+        snprintf_append(buf, bufsz, &off, "    wall_ns: %lu\n", rec->cjr_wall_ns);
+        if (rec->cjr_errno)
+            snprintf_append(buf, bufsz, &off, "    errno: %d\n", rec->cjr_errno);
+
+        if (rest_write_safe(info->resp_fd, buf, off) != off) {
+            err = merr(EIO);
+            goto out;
+        }
+        off = 0;
+    }
+
+    if (off > 0 && rest_write_safe(info->resp_fd, buf, off) != off)
+        err = merr(EIO);
+
+out:
+    free(hist);
+
+    return err;
+}
+
 static merr_t
 rest_kvdb_compact_status_get(
     const char *      path,
@@ -418,6 +549,9 @@ rest_kvdb_compact_status_get(
 
     action = p + 1;
 
+    if (strcmp(action, "history") == 0)
+        return rest_kvdb_compact_history_get(info, iter, ikvdb);
+
     if (ev(strcmp(action, "status")))
         return merr(EINVAL);
 
@@ -437,6 +571,266 @@ rest_kvdb_compact_status_get(
     return 0;
 }
 
+/*---------------------------------------------------------------
+ * rest: OpenMetrics exposition of perfc and kvdb state
+ */
+
+#define KVDB_REST_METRICS_URL   "metrics"
+#define KVDB_REST_METRICS_MAX   (64)
+
+/* Open kvdbs are registered here so that a single scrape of the global
+ * metrics url covers all of them.  A kvdb is removed (under the lock)
+ * before it begins to close, so the handler may safely sample any kvdb
+ * in the list while holding the lock.
+ */
+static struct {
+    struct mutex  km_lock;
+    uint          km_kvdbc;
+    struct ikvdb *km_kvdbv[KVDB_REST_METRICS_MAX];
+} kvdb_rest_metrics;
+
+static const char * const kvdb_rest_sensor_namev[] = {
+    [THROTTLE_SENSOR_CNROOT] = "cnroot",
+    [THROTTLE_SENSOR_C0SK] = "c0sk",
+    [THROTTLE_SENSOR_WAL] = "wal",
+};
+
+static const char * const kvdb_rest_qnum_namev[] = {
+    [SP3_QNUM_ROOT] = "root",
+    [SP3_QNUM_INTERN] = "intern",
+    [SP3_QNUM_NODELEN] = "nodelen",
+    [SP3_QNUM_LGARB] = "lgarb",
+    [SP3_QNUM_LSIZE] = "lsize",
+    [SP3_QNUM_SHARED] = "shared",
+};
+
+_Static_assert(NELEM(kvdb_rest_sensor_namev) == THROTTLE_SENSOR_CNT, "kvdb_rest_sensor_namev");
+_Static_assert(NELEM(kvdb_rest_qnum_namev) == SP3_QNUM_MAX, "kvdb_rest_qnum_namev");
+
+enum kvdb_rest_metric {
+    KRM_SENSOR,
+    KRM_THR_DELAY,
+    KRM_SAMP_CURR,
+    KRM_SAMP_LWM,
+    KRM_SAMP_HWM,
+    KRM_QJOBS,
+    KRM_QTHREADS,
+    KRM_C0_KVMS,
+    KRM_C0_BYTES,
+    KRM_WAL_BUFSZ,
+    KRM_WAL_BUFLEN,
+    KRM_MCLASS_ALLOCATED,
+    KRM_MCLASS_USED,
+    KRM_MAX
+};
+
+static const struct {
+    const char *name;
+    const char *help;
+} kvdb_rest_metricv[] = {
+    [KRM_SENSOR] = { "hse_kvdb_throttle_sensor", "Throttle sensor value (1000 = high water mark)" },
+    [KRM_THR_DELAY] = { "hse_kvdb_throttle_delay", "Raw throttle delay" },
+    [KRM_SAMP_CURR] = { "hse_kvdb_csched_samp_pct", "Current space amplification (percent)" },
+    [KRM_SAMP_LWM] = { "hse_kvdb_csched_samp_lwm_pct", "Space amplification low water mark (percent)" },
+    [KRM_SAMP_HWM] = { "hse_kvdb_csched_samp_hwm_pct", "Space amplification high water mark (percent)" },
+    [KRM_QJOBS] = { "hse_kvdb_csched_queue_jobs", "Active compaction jobs per queue" },
+    [KRM_QTHREADS] = { "hse_kvdb_csched_queue_threads", "Compaction threads per queue" },
+    [KRM_C0_KVMS] = { "hse_kvdb_c0_kvms", "c0 kvmultisets, active and awaiting ingest" },
+    [KRM_C0_BYTES] = { "hse_kvdb_c0_bytes", "Memory consumed by c0" },
+    [KRM_WAL_BUFSZ] = { "hse_kvdb_wal_buffer_bytes", "WAL buffer capacity" },
+    [KRM_WAL_BUFLEN] = { "hse_kvdb_wal_buffered_bytes", "Bytes held in WAL buffers" },
+    [KRM_MCLASS_ALLOCATED] = { "hse_kvdb_mclass_allocated_bytes", "Media class allocated bytes" },
+    [KRM_MCLASS_USED] = { "hse_kvdb_mclass_used_bytes", "Media class used bytes" },
+};
+
+_Static_assert(NELEM(kvdb_rest_metricv) == KRM_MAX, "kvdb_rest_metricv");
+
+static void
+kvdb_rest_metrics_sample(
+    struct om_writer           *w,
+    enum kvdb_rest_metric       metric,
+    const char                 *kvdb,
+    const char                 *lname,
+    const char                 *lvalue,
+    u64                         value)
+{
+    char   labels[OM_LABELS_MAX];
+    size_t off = 0;
+
+    om_label(labels, sizeof(labels), &off, "kvdb", kvdb);
+    if (lname)
+        om_label(labels, sizeof(labels), &off, lname, lvalue);
+
+    om_sample(w, kvdb_rest_metricv[metric].name, labels, value);
+}
+
+static void
+kvdb_rest_metrics_emit(
+    struct om_writer           *w,
+    enum kvdb_rest_metric       metric,
+    struct ikvdb_metrics       *mv)
+{
+    struct hse_mclass_info info;
+    const char            *alias;
+    uint                   i, j;
+
+    om_family(w, kvdb_rest_metricv[metric].name, "gauge", kvdb_rest_metricv[metric].help);
+
+    for (i = 0; i < kvdb_rest_metrics.km_kvdbc; i++) {
+        struct ikvdb_metrics *m = mv + i;
+        struct ikvdb         *kvdb = kvdb_rest_metrics.km_kvdbv[i];
+
+        alias = ikvdb_alias(kvdb);
+
+        switch (metric) {
+        case KRM_SENSOR:
+            for (j = 0; j < THROTTLE_SENSOR_CNT; j++)
+                kvdb_rest_metrics_sample(w, metric, alias, "sensor", kvdb_rest_sensor_namev[j],
+                                         m->ikm_sensorv[j]);
+            break;
+
+        case KRM_THR_DELAY:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_thr_delay);
+            break;
+
+        case KRM_SAMP_CURR:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_samp_curr);
+            break;
+
+        case KRM_SAMP_LWM:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_samp_lwm);
+            break;
+
+        case KRM_SAMP_HWM:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_samp_hwm);
+            break;
+
+        case KRM_QJOBS:
+        case KRM_QTHREADS:
+            for (j = 0; j < SP3_QNUM_MAX; j++)
+                kvdb_rest_metrics_sample(w, metric, alias, "queue", kvdb_rest_qnum_namev[j],
+                    metric == KRM_QJOBS ? m->ikm_qjobsv[j] : m->ikm_qthreadsv[j]);
+            break;
+
+        case KRM_C0_KVMS:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_c0_kvms);
+            break;
+
+        case KRM_C0_BYTES:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_c0_memsz);
+            break;
+
+        case KRM_WAL_BUFSZ:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_wal_bufsz);
+            break;
+
+        case KRM_WAL_BUFLEN:
+            kvdb_rest_metrics_sample(w, metric, alias, NULL, NULL, m->ikm_wal_buflen);
+            break;
+
+        case KRM_MCLASS_ALLOCATED:
+        case KRM_MCLASS_USED:
+            for (j = HSE_MCLASS_BASE; j < HSE_MCLASS_COUNT; j++) {
+                if (!ikvdb_mclass_is_configured(kvdb, j) ||
+                    ikvdb_mclass_info_get(kvdb, j, &info))
+                    continue;
+
+                kvdb_rest_metrics_sample(w, metric, alias, "mclass", hse_mclass_name_get(j),
+                    metric == KRM_MCLASS_USED ? info.mi_used_bytes : info.mi_allocated_bytes);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+static merr_t
+rest_kvdb_metrics_get(
+    const char *      path,
+    struct conn_info *info,
+    const char *      url,
+    struct kv_iter *  iter,
+    void *            context)
+{
+    struct ikvdb_metrics *mv;
+    struct om_writer      w;
+    uint                  i;
+
+    mv = malloc(sizeof(*mv) * KVDB_REST_METRICS_MAX);
+    if (ev(!mv))
+        return merr(ENOMEM);
+
+    om_init(&w, info->resp_fd, info->buf, info->buf_sz);
+
+    perfc_metrics_emit(&w);
+
+    /* Sample each kvdb once so that all families agree with each other.
+     */
+    mutex_lock(&kvdb_rest_metrics.km_lock);
+    for (i = 0; i < kvdb_rest_metrics.km_kvdbc; i++)
+        ikvdb_metrics_get(kvdb_rest_metrics.km_kvdbv[i], mv + i);
+
+    for (i = 0; i < KRM_MAX; i++)
+        kvdb_rest_metrics_emit(&w, i, mv);
+    mutex_unlock(&kvdb_rest_metrics.km_lock);
+
+    free(mv);
+
+    return om_finish(&w);
+}
+
+static void
+kvdb_rest_metrics_add(struct ikvdb *kvdb)
+{
+    mutex_lock(&kvdb_rest_metrics.km_lock);
+    if (kvdb_rest_metrics.km_kvdbc < KVDB_REST_METRICS_MAX)
+        kvdb_rest_metrics.km_kvdbv[kvdb_rest_metrics.km_kvdbc++] = kvdb;
+    else
+        log_warn("%s: too many open kvdbs, metrics unavailable", ikvdb_alias(kvdb));
+    mutex_unlock(&kvdb_rest_metrics.km_lock);
+}
+
+static void
+kvdb_rest_metrics_remove(struct ikvdb *kvdb)
+{
+    uint i;
+
+    mutex_lock(&kvdb_rest_metrics.km_lock);
+    for (i = 0; i < kvdb_rest_metrics.km_kvdbc; i++) {
+        if (kvdb_rest_metrics.km_kvdbv[i] == kvdb) {
+            kvdb_rest_metrics.km_kvdbv[i] =
+                kvdb_rest_metrics.km_kvdbv[--kvdb_rest_metrics.km_kvdbc];
+            break;
+        }
+    }
+    mutex_unlock(&kvdb_rest_metrics.km_lock);
+}
+
+merr_t
+kvdb_rest_init(void)
+{
+    merr_t err;
+
+    mutex_init(&kvdb_rest_metrics.km_lock);
+    kvdb_rest_metrics.km_kvdbc = 0;
+
+    err = rest_url_register(NULL, URL_FLAG_EXACT, rest_kvdb_metrics_get, NULL,
+                            KVDB_REST_METRICS_URL);
+    if (err)
+        log_warnx("unable to register url '%s': @@e", err, KVDB_REST_METRICS_URL);
+
+    return 0;
+}
+
+void
+kvdb_rest_fini(void)
+{
+    rest_url_deregister(KVDB_REST_METRICS_URL);
+    mutex_destroy(&kvdb_rest_metrics.km_lock);
+}
+
 merr_t
 kvdb_rest_register(struct ikvdb *kvdb)
 {
@@ -445,6 +839,8 @@ kvdb_rest_register(struct ikvdb *kvdb)
     if (!kvdb)
         return merr(ev(EINVAL));
 
+    kvdb_rest_metrics_add(kvdb);
+
     status =
         rest_url_register(kvdb, URL_FLAG_EXACT, rest_kvdb_get, 0, "kvdb/%s", ikvdb_alias(kvdb));
     if (ev(status) && !err)
@@ -481,6 +877,8 @@ kvdb_rest_register(struct ikvdb *kvdb)
 merr_t
 kvdb_rest_deregister(struct ikvdb *const kvdb)
 {
+    kvdb_rest_metrics_remove(kvdb);
+
     return rest_url_deregister("kvdb/%s", ikvdb_alias(kvdb));
 }
 
@@ -9,6 +9,12 @@ struct ikvdb;
 struct kvdb_kvs;
 struct yaml_context;
 
+merr_t
+kvdb_rest_init(void);
+
+void
+kvdb_rest_fini(void);
+
 merr_t
 kvdb_rest_register(struct ikvdb *kvdb);
 
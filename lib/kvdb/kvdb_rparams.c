@@ -465,8 +465,11 @@ throttle_init_policy_converter(
         *(uint *)data = THROTTLE_DELAY_START_MEDIUM;
     } else if (!strcmp(value, "heavy") || !strcmp(value, "default")) {
         *(uint *)data = THROTTLE_DELAY_START_HEAVY;
+    } else if (!strcmp(value, "predictive")) {
+        *(uint *)data = THROTTLE_DELAY_START_PREDICTIVE;
     } else {
-        log_err("Invalid value: %s, must be one of light, medium, heavy or auto", value);
+        log_err("Invalid value: %s, must be one of light, medium, heavy, predictive or auto",
+                value);
         return false;
     }
 
@@ -500,6 +503,9 @@ throttle_init_policy_stringify(
         case THROTTLE_DELAY_START_HEAVY:
             param = "\"heavy\"";
             break;
+        case THROTTLE_DELAY_START_PREDICTIVE:
+            param = "\"predictive\"";
+            break;
         default:
             abort();
     }
@@ -527,6 +533,8 @@ throttle_init_policy_jsonify(const struct param_spec *const ps, const void *cons
             return cJSON_CreateString("medium");
         case THROTTLE_DELAY_START_HEAVY:
             return cJSON_CreateString("heavy");
+        case THROTTLE_DELAY_START_PREDICTIVE:
+            return cJSON_CreateString("predictive");
         default:
             abort();
     }
@@ -1211,6 +1219,27 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "throttle_sleep_p99_us",
+        .ps_description = "predictive throttle p99 target for sampled throttle sleeps (usecs)",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE,
+        .ps_type = PARAM_TYPE_U32,
+        .ps_offset = offsetof(struct kvdb_rparams, throttle_sleep_p99_us),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, throttle_sleep_p99_us),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_uscalar = 1000,
+        },
+        .ps_bounds = {
+            .as_uscalar = {
+                .ps_min = 1,
+                .ps_max = UINT32_MAX,
+            },
+        },
+    },
     {
         .ps_name = "throttling.init_policy",
         .ps_description = "throttle initialization policy",
@@ -1415,6 +1444,21 @@ static const struct param_spec pspecs[] = {
             },
         },
     },
+    {
+        .ps_name = "numa_mode",
+        .ps_description = "place c0, wal and compaction threads and memory by NUMA node",
+        .ps_flags = PARAM_FLAG_EXPERIMENTAL,
+        .ps_type = PARAM_TYPE_BOOL,
+        .ps_offset = offsetof(struct kvdb_rparams, numa_mode),
+        .ps_size = PARAM_SZ(struct kvdb_rparams, numa_mode),
+        .ps_convert = param_default_converter,
+        .ps_validate = param_default_validator,
+        .ps_stringify = param_default_stringify,
+        .ps_jsonify = param_default_jsonify,
+        .ps_default_value = {
+            .as_bool = false,
+        },
+    },
     {
         .ps_name = "keylock_tables",
         .ps_description = "number of keylock tables",
@@ -0,0 +1,330 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <sys/syscall.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/alloc.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/logging.h>
+#include <hse_util/parse_num.h>
+#include <hse_util/printbuf.h>
+#include <hse_util/rest_api.h>
+
+#include <hse_ikvdb/reqtrace.h>
+
+/* Number of samples retained, must be a power of two.
+ */
+#define REQTRACE_RING_SZ (1024)
+
+#define REQTRACE_URL "trace"
+
+/**
+ * struct reqtrace_slot - ring entry
+ * @rs_gen: 0 if empty, odd while being written, otherwise even
+ * @rs_rec: the sample
+ *
+ * Writers never wait on each other nor on readers: each claims a slot by
+ * incrementing the ring head and brackets its update with an odd/even
+ * generation, as in a seqlock.  Readers discard any entry whose generation
+ * is not the one they expect or changed while they copied it.
+ */
+struct reqtrace_slot {
+    atomic_ulong        rs_gen;
+    struct reqtrace_rec rs_rec;
+} HSE_L1D_ALIGNED;
+
+static struct {
+    atomic_ulong         rt_head HSE_L1D_ALIGNED;
+    struct reqtrace_slot rt_slotv[REQTRACE_RING_SZ];
+} reqtrace;
+
+atomic_uint reqtrace_period;
+thread_local struct reqtrace_rec *reqtrace_tls;
+
+static thread_local uint                reqtrace_tls_countdown;
+static thread_local struct reqtrace_rec reqtrace_tls_rec;
+static thread_local u32                 reqtrace_tls_tid;
+
+static const char * const reqtrace_op_namev[] = {
+    [REQTRACE_OP_GET] = "get",
+    [REQTRACE_OP_PUT] = "put",
+    [REQTRACE_OP_DEL] = "del",
+    [REQTRACE_OP_CURSOR_CREATE] = "cursor_create",
+    [REQTRACE_OP_CURSOR_SEEK] = "cursor_seek",
+    [REQTRACE_OP_CURSOR_READ] = "cursor_read",
+};
+
+static const char * const reqtrace_stage_namev[] = {
+    [REQTRACE_STAGE_C0] = "c0",
+    [REQTRACE_STAGE_LC] = "lc",
+    [REQTRACE_STAGE_CN_L0] = "cn_l0",
+    [REQTRACE_STAGE_CN_L1] = "cn_l1",
+    [REQTRACE_STAGE_CN_L2] = "cn_l2",
+    [REQTRACE_STAGE_CN_L3] = "cn_l3",
+    [REQTRACE_STAGE_CN_L4] = "cn_l4",
+    [REQTRACE_STAGE_CN_L5] = "cn_l5",
+    [REQTRACE_STAGE_BLOOM] = "bloom",
+    [REQTRACE_STAGE_WBT] = "wbt",
+    [REQTRACE_STAGE_VBLOCK] = "vblock",
+    [REQTRACE_STAGE_DECOMPRESS] = "decompress",
+    [REQTRACE_STAGE_WAL] = "wal",
+    [REQTRACE_STAGE_THROTTLE] = "throttle",
+};
+
+_Static_assert(NELEM(reqtrace_op_namev) == REQTRACE_OP_MAX, "reqtrace_op_namev");
+_Static_assert(NELEM(reqtrace_stage_namev) == REQTRACE_STAGE_MAX, "reqtrace_stage_namev");
+
+const char *
+reqtrace_op_name(enum reqtrace_op op)
+{
+    return op < REQTRACE_OP_MAX ? reqtrace_op_namev[op] : "invalid";
+}
+
+const char *
+reqtrace_stage_name(enum reqtrace_stage stage)
+{
+    return stage < REQTRACE_STAGE_MAX ? reqtrace_stage_namev[stage] : "invalid";
+}
+
+bool
+reqtrace_begin_sampled(enum reqtrace_op op)
+{
+    struct reqtrace_rec *rec = &reqtrace_tls_rec;
+    uint                 period;
+
+    if (reqtrace_tls)
+        return false;
+
+    /* The countdown is clamped to the current period so that lowering
+     * the period takes effect promptly.
+     */
+    period = atomic_read(&reqtrace_period);
+    if (reqtrace_tls_countdown > period)
+        reqtrace_tls_countdown = period;
+
+    if (reqtrace_tls_countdown > 1) {
+        reqtrace_tls_countdown--;
+        return false;
+    }
+
+    reqtrace_tls_countdown = period;
+
+    if (HSE_UNLIKELY(!reqtrace_tls_tid))
+        reqtrace_tls_tid = syscall(SYS_gettid);
+
+    memset(rec, 0, sizeof(*rec));
+    rec->rr_tid = reqtrace_tls_tid;
+    rec->rr_op = op;
+    rec->rr_start = get_time_ns();
+
+    reqtrace_tls = rec;
+
+    return true;
+}
+
+void
+reqtrace_stage_add(enum reqtrace_stage stage, u64 ns)
+{
+    struct reqtrace_rec *rec = reqtrace_tls;
+
+    if (!rec || stage >= REQTRACE_STAGE_MAX)
+        return;
+
+    rec->rr_ns[stage] += ns;
+    if (rec->rr_cnt[stage] < U16_MAX)
+        rec->rr_cnt[stage]++;
+}
+
+void
+reqtrace_end(merr_t err)
+{
+    struct reqtrace_rec  *rec = reqtrace_tls;
+    struct reqtrace_slot *slot;
+    ulong                 seq, gen;
+
+    if (!rec)
+        return;
+
+    reqtrace_tls = NULL;
+
+    rec->rr_total = get_time_ns() - rec->rr_start;
+    rec->rr_errno = merr_errno(err);
+
+    seq = atomic_inc_return(&reqtrace.rt_head);
+    slot = reqtrace.rt_slotv + (seq & (REQTRACE_RING_SZ - 1));
+
+    rec->rr_seq = seq;
+
+    /* If a writer that lapped the ring is still in this slot then
+     * drop the sample rather than wait.
+     */
+    gen = atomic_read(&slot->rs_gen);
+    if ((gen & 1) || !atomic_cas(&slot->rs_gen, gen, seq * 2 - 1))
+        return;
+
+    atomic_thread_fence(memory_order_release);
+
+    slot->rs_rec = *rec;
+
+    atomic_set_rel(&slot->rs_gen, seq * 2);
+}
+
+void
+reqtrace_period_set(uint period)
+{
+    atomic_set(&reqtrace_period, period);
+}
+
+uint
+reqtrace_snapshot(struct reqtrace_rec *recv, uint recc, u64 min_ns)
+{
+    ulong head, seq, first;
+    uint  n = 0;
+
+    head = atomic_read_acq(&reqtrace.rt_head);
+    first = head > REQTRACE_RING_SZ ? head - REQTRACE_RING_SZ + 1 : 1;
+
+    for (seq = first; seq <= head && n < recc; seq++) {
+        struct reqtrace_slot *slot = reqtrace.rt_slotv + (seq & (REQTRACE_RING_SZ - 1));
+        ulong                 gen;
+
+        gen = atomic_read_acq(&slot->rs_gen);
+        if (gen != seq * 2)
+            continue;
+
+        recv[n] = slot->rs_rec;
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_read(&slot->rs_gen) != gen)
+            continue;
+
+        if (recv[n].rr_total >= min_ns)
+            n++;
+    }
+
+    return n;
+}
+
+static merr_t
+reqtrace_rest_get(
+    const char       *path,
+    struct conn_info *info,
+    const char       *url,
+    struct kv_iter   *iter,
+    void             *context)
+{
+    struct reqtrace_rec *recv;
+    struct rest_kv      *kv;
+    u64                  min_ns = 0;
+    char                 buf[1024];
+    size_t               off;
+    uint                 n, i, j;
+    merr_t               err = 0;
+
+    while ((kv = rest_kv_next(iter))) {
+        u64 min_us;
+
+        if (strcmp(kv->key, "min_us") || parse_u64(kv->value, &min_us))
+            return merr(EINVAL);
+
+        min_ns = min_us * 1000;
+    }
+
+    recv = malloc(REQTRACE_RING_SZ * sizeof(*recv));
+    if (ev(!recv))
+        return merr(ENOMEM);
+
+    n = reqtrace_snapshot(recv, REQTRACE_RING_SZ, min_ns);
+
+    off = 0;
+    snprintf_append(buf, sizeof(buf), &off, "period: %u\n", atomic_read(&reqtrace_period));
+    snprintf_append(buf, sizeof(buf), &off, "published: %lu\n", atomic_read(&reqtrace.rt_head));
+    snprintf_append(buf, sizeof(buf), &off, "samples:\n");
+
+    if (rest_write_safe(info->resp_fd, buf, off) != off) {
+        err = merr(EIO);
+        goto out;
+    }
+
+    for (i = 0; i < n; i++) {
+        const struct reqtrace_rec *rec = recv + i;
+
+        off = 0;
+        snprintf_append(buf, sizeof(buf), &off, "  - seq: %lu\n", rec->rr_seq);
+        snprintf_append(buf, sizeof(buf), &off, "    op: %s\n", reqtrace_op_name(rec->rr_op));
+        snprintf_append(buf, sizeof(buf), &off, "    tid: %u\n", rec->rr_tid);
+        snprintf_append(buf, sizeof(buf), &off, "    start_ns: %lu\n", rec->rr_start);
+        snprintf_append(buf, sizeof(buf), &off, "    total_ns: %lu\n", rec->rr_total);
+        if (rec->rr_errno)
+            snprintf_append(buf, sizeof(buf), &off, "    errno: %u\n", rec->rr_errno);
+        snprintf_append(buf, sizeof(buf), &off, "    stages:\n");
+
+        for (j = 0; j < REQTRACE_STAGE_MAX; j++) {
+            if (!rec->rr_cnt[j])
+                continue;
+
+            snprintf_append(buf, sizeof(buf), &off, "      %s: { ns: %lu, count: %u }\n",
+                            reqtrace_stage_name(j), rec->rr_ns[j], rec->rr_cnt[j]);
+        }
+
+        if (rest_write_safe(info->resp_fd, buf, off) != off) {
+            err = merr(EIO);
+            break;
+        }
+    }
+
+out:
+    free(recv);
+
+    return err;
+}
+
+static merr_t
+reqtrace_rest_put(
+    const char       *path,
+    struct conn_info *info,
+    const char       *url,
+    struct kv_iter   *iter,
+    void             *context)
+{
+    struct rest_kv *kv;
+    u32             period;
+
+    kv = rest_kv_next(iter);
+    if (!kv || strcmp(kv->key, "period") || parse_u32(kv->value, &period))
+        return merr(EINVAL);
+
+    reqtrace_period_set(period);
+
+    log_info("request trace period set to %u", period);
+
+    return 0;
+}
+
+merr_t
+reqtrace_init(uint period)
+{
+    merr_t err;
+
+    memset(&reqtrace, 0, sizeof(reqtrace));
+    reqtrace_period_set(period);
+
+    err = rest_url_register(NULL, URL_FLAG_EXACT, reqtrace_rest_get, reqtrace_rest_put,
+                            REQTRACE_URL);
+    if (err)
+        log_warnx("unable to register url '%s': @@e", err, REQTRACE_URL);
+
+    /* Tracing remains usable via the API without the REST interface.
+     */
+    return 0;
+}
+
+void
+reqtrace_fini(void)
+{
+    reqtrace_period_set(0);
+    rest_url_deregister(REQTRACE_URL);
+}
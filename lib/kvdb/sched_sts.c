@@ -183,6 +183,12 @@ sts_create(const char *name, uint nq, sts_print_fn *print_fn, struct sts **handl
     return 0;
 }
 
+merr_t
+sts_numa_bind(struct sts *self, int node)
+{
+    return workqueue_bind_node(self->sts_wq, node);
+}
+
 void
 sts_destroy(struct sts *self)
 {
@@ -36,6 +36,19 @@ static struct perfc_name throttle_sleep_perfc[] _dt_section = {
 
 NE_CHECK(throttle_sleep_perfc, PERFC_EN_THR_MAX, "perfc table/enum mismatch");
 
+static struct perfc_name throttle_pred_perfc[] _dt_section = {
+    NE(PERFC_BA_THRP_KVSETS,     2, "max root kvsets",            "thrp_kvsets"),
+    NE(PERFC_BA_THRP_KVSETS_HWM, 2, "root kvsets stall mark",     "thrp_kvsets_hwm"),
+    NE(PERFC_BA_THRP_DEBT,       2, "root spill debt (bytes)",    "thrp_debt"),
+    NE(PERFC_BA_THRP_DRAIN,      2, "root spill rate (bytes/s)",  "thrp_drain"),
+    NE(PERFC_BA_THRP_TARGET,     2, "model target rate (bytes/s)", "thrp_target"),
+    NE(PERFC_BA_THRP_RATE,       2, "paced rate (bytes/s)",       "thrp_rate"),
+    NE(PERFC_BA_THRP_HORIZON,    2, "debt horizon (ms)",          "thrp_horizon"),
+    NE(PERFC_BA_THRP_SLOW,       2, "sleeps over p99 target (bp)", "thrp_slow"),
+};
+
+NE_CHECK(throttle_pred_perfc, PERFC_EN_THRP, "perfc table/enum mismatch");
+
 /* clang-format on */
 
 void
@@ -57,6 +70,7 @@ throttle_init(struct throttle *self, struct kvdb_rparams *rp, const char *kvdb_a
 
     perfc_alloc(throttle_sen_perfc, group, "set", rp->perfc_level, &self->thr_sensor_perfc);
     perfc_alloc(throttle_sleep_perfc, group, "set", rp->perfc_level, &self->thr_sleep_perfc);
+    perfc_alloc(throttle_pred_perfc, group, "set", rp->perfc_level, &self->thr_pred_perfc);
 }
 
 void
@@ -66,6 +80,15 @@ throttle_init_params(struct throttle *self, struct kvdb_rparams *rp)
 
     self->thr_delay = rp->throttle_init_policy;
 
+    self->thr_predictive = (rp->throttle_init_policy == THROTTLE_DELAY_START_PREDICTIVE);
+    if (self->thr_predictive) {
+        self->thr_delay = THROTTLE_DELAY_START_MEDIUM;
+        self->thr_pred.tp_rate = throttle_raw_to_rate(self->thr_delay);
+        self->thr_pred.tp_target = self->thr_pred.tp_rate;
+        self->thr_pred.tp_horizon_ms = THROTTLE_PRED_HORIZON_DEF;
+        atomic_set(&self->thr_pred.tp_target_ns, rp->throttle_sleep_p99_us * 1000ul);
+    }
+
     if (self->thr_rp->throttle_debug_intvl_s == 0) {
         log_warn("Invalid setting for throttle_debug_intvl_s: %u, using 1",
                  self->thr_rp->throttle_debug_intvl_s);
@@ -101,8 +124,9 @@ throttle_init_params(struct throttle *self, struct kvdb_rparams *rp)
         time_ms / self->thr_update_ms + (time_ms % self->thr_update_ms ? 1 : 0);
 
     log_info(
-        "delay %d u_ms %d rcycles %d icycles %d scycles %d dcycles %d",
+        "delay %d pred %d u_ms %d rcycles %d icycles %d scycles %d dcycles %d",
         self->thr_delay,
+        self->thr_predictive,
         self->thr_update_ms,
         self->thr_reduce_cycles,
         self->thr_inject_cycles,
@@ -113,6 +137,7 @@ throttle_init_params(struct throttle *self, struct kvdb_rparams *rp)
 void
 throttle_fini(struct throttle *self)
 {
+    perfc_free(&self->thr_pred_perfc);
     perfc_free(&self->thr_sleep_perfc);
     perfc_free(&self->thr_sensor_perfc);
 }
@@ -288,11 +313,127 @@ throttle_switch_state(struct throttle *self, enum throttle_state state, uint max
     }
 }
 
+/**
+ * throttle_predict() - predictive, latency-targeted throttle controller
+ * @self:    throttle handle
+ * @mem_val: max of the c0sk and wal sensors
+ *
+ * Rather than reacting to the root sensor after it crosses its high water
+ * mark, model the cN root compaction debt and pace ingest so that the root
+ * never reaches the point where ingest must stall:
+ *
+ *   headroom = (kvsets_hwm - kvsets) * (spill_bytes / kvsets)
+ *   target   = drain + headroom / horizon
+ *
+ * i.e., ingest may exceed the measured root spill throughput only by as
+ * much as the remaining root headroom can absorb within %tp_horizon_ms.
+ * When the root is over its mark the headroom is negative and the target
+ * drops below the drain rate until the debt is repaid.
+ *
+ * The horizon is steered by the sampled throttle sleeps imposed on puts:
+ * if more than 1% of them exceeded throttle_sleep_p99_us then the
+ * horizon is shortened (spend headroom to serve latency), and if fewer than
+ * 0.25% did it is lengthened (bank headroom for the next burst).
+ *
+ * The paced rate approaches the target by at most 1/8 per update cycle,
+ * which avoids the sawtooth of the sensor-max controller.  The c0sk and wal
+ * sensors remain hard limits since they guard memory, not compaction debt.
+ */
+static void
+throttle_predict(struct throttle *self, uint mem_val)
+{
+    struct throttle_pred *tp = &self->thr_pred;
+    struct throttle_debt *td = &self->thr_debt;
+    const u64 rate_min = throttle_raw_to_rate(THROTTLE_DELAY_MAX);
+    const u64 rate_max = throttle_raw_to_rate(THROTTLE_DELAY_MIN);
+    u64 kvsets, hwm, debt, drain, ops, slow;
+    u64 rate, target, step;
+
+    atomic_set(&tp->tp_target_ns, self->thr_rp->throttle_sleep_p99_us * 1000ul);
+
+    ops = atomic_read(&tp->tp_lat_ops);
+    slow = atomic_read(&tp->tp_lat_slow);
+    atomic_sub(&tp->tp_lat_ops, ops);
+    atomic_sub(&tp->tp_lat_slow, slow);
+
+    tp->tp_win_ops += ops;
+    tp->tp_win_slow += slow;
+
+    if (++tp->tp_win_cycles * self->thr_update_ms >= THROTTLE_PRED_WINDOW_MS) {
+        if (tp->tp_win_ops > 0) {
+            tp->tp_slow_bp = min_t(u64, tp->tp_win_slow, tp->tp_win_ops) * 10000 / tp->tp_win_ops;
+
+            if (tp->tp_slow_bp > 100)
+                tp->tp_horizon_ms = max_t(uint, tp->tp_horizon_ms * 3 / 4,
+                                          THROTTLE_PRED_HORIZON_MIN);
+            else if (tp->tp_slow_bp < 25)
+                tp->tp_horizon_ms = min_t(uint, tp->tp_horizon_ms * 5 / 4,
+                                          THROTTLE_PRED_HORIZON_MAX);
+        }
+
+        tp->tp_win_cycles = 0;
+        tp->tp_win_ops = 0;
+        tp->tp_win_slow = 0;
+    }
+
+    kvsets = atomic_read(&td->td_root_kvsets);
+    hwm = atomic_read(&td->td_root_kvsets_hwm);
+    debt = atomic_read(&td->td_spill_bytes);
+    drain = atomic_read(&td->td_drain_bps);
+
+    rate = tp->tp_rate;
+
+    if (drain > 0 && kvsets > 0 && hwm > 0) {
+        s64 headroom = ((s64)hwm - (s64)kvsets) * (s64)(debt / kvsets);
+        s64 t = (s64)drain + headroom * 1000 / (s64)tp->tp_horizon_ms;
+
+        target = t > 0 ? t : 0;
+    } else if (hwm > 0 && kvsets >= hwm) {
+        /* No spill has completed yet, but the root is already full. */
+        target = rate - rate / 8;
+    } else {
+        /* No debt to model, probe for a higher rate. */
+        target = rate + rate / 8;
+    }
+
+    if (mem_val > THROTTLE_SENSOR_SCALE)
+        target = target * THROTTLE_SENSOR_SCALE / mem_val;
+
+    target = clamp_t(u64, target, rate_min, rate_max);
+
+    /* Approach the target smoothly, but back off twice as fast as we
+     * speed up.
+     */
+    if (target > rate) {
+        step = min_t(u64, (target - rate) / 2, rate / 8);
+        rate += max_t(u64, step, 1);
+    } else if (target < rate) {
+        step = min_t(u64, (rate - target) / 2, rate / 4);
+        rate -= max_t(u64, step, 1);
+    }
+
+    tp->tp_rate = clamp_t(u64, rate, rate_min, rate_max);
+    tp->tp_target = target;
+
+    self->thr_delay = (500000ul * THROTTLE_DELAY_MAX) / tp->tp_rate;
+    self->thr_delay = clamp_t(uint, self->thr_delay, THROTTLE_DELAY_MIN, THROTTLE_DELAY_MAX);
+
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_KVSETS, kvsets);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_KVSETS_HWM, hwm);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_DEBT, debt);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_DRAIN, drain);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_TARGET, tp->tp_target);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_RATE, tp->tp_rate);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_HORIZON, tp->tp_horizon_ms);
+    perfc_set(&self->thr_pred_perfc, PERFC_BA_THRP_SLOW, tp->tp_slow_bp);
+}
+
 uint
 throttle_update(struct throttle *self)
 {
     struct throttle_mavg *mavg = &self->thr_mavg;
     u32                   max_val = 0;
+    u32                   mem_val = 0;
     u64                   debug = self->thr_rp->throttle_debug;
 
     for (int i = 0; i < THROTTLE_SENSOR_CNT; i++) {
@@ -317,12 +458,23 @@ throttle_update(struct throttle *self)
         if (tmp > max_val)
             max_val = tmp;
 
+        if (i != THROTTLE_SENSOR_CNROOT && tmp > mem_val)
+            mem_val = tmp;
+
         assert(cidx != UINT_MAX);
         perfc_set(&self->thr_sensor_perfc, cidx, tmp);
     }
 
     perfc_set(&self->thr_sensor_perfc, PERFC_BA_THSR_MAX, max_val);
 
+    if (self->thr_predictive) {
+        if (HSE_UNLIKELY(self->thr_rp->throttle_disable))
+            return 0;
+
+        throttle_predict(self, mem_val);
+        goto out;
+    }
+
     if (self->thr_skip_cnt > 0) {
         /*
          * Skip the read sensor values for thr_skip_cnt cycles.
@@ -443,6 +595,7 @@ throttle_update(struct throttle *self)
         }
     }
 
+out:
     perfc_set(&self->thr_sleep_perfc, PERFC_BA_THR_SVAL, self->thr_delay);
 
     self->thr_cycles++;
@@ -459,6 +612,23 @@ throttle_update(struct throttle *self)
 void
 throttle_debug(struct throttle *self)
 {
+    if (self->thr_predictive) {
+        struct throttle_debt *td = &self->thr_debt;
+
+        log_info(
+            "delay %d rate %lu target %lu horizon %u slow %u kvsets %lu/%lu debt %lu drain %lu",
+            self->thr_delay,
+            self->thr_pred.tp_rate,
+            self->thr_pred.tp_target,
+            self->thr_pred.tp_horizon_ms,
+            self->thr_pred.tp_slow_bp,
+            atomic_read(&td->td_root_kvsets),
+            atomic_read(&td->td_root_kvsets_hwm),
+            atomic_read(&td->td_spill_bytes),
+            atomic_read(&td->td_drain_bps));
+        return;
+    }
+
     log_info(
         "delay %d min %d mavg %d cnt %d state %d sensors %d %d",
         self->thr_delay,
@@ -22,6 +22,7 @@
 #include <hse_util/logging.h>
 
 #include <hse_ikvdb/c0.h>
+#include <hse_ikvdb/c0_kvset.h>
 #include <hse_ikvdb/lc.h>
 #include <hse_ikvdb/cn.h>
 #include <hse_ikvdb/kvs.h>
@@ -32,6 +33,7 @@
 #include <hse_ikvdb/kvdb_health.h>
 #include <hse_ikvdb/cursor.h>
 #include <hse_ikvdb/wal.h>
+#include <hse_ikvdb/reqtrace.h>
 
 /* clang-format off */
 
@@ -41,21 +43,21 @@
  * otherwise it will defeat the optimization in kvs_perfc_pkvsl().
  */
 struct perfc_name kvs_pkvsl_perfc_op[] _dt_section = {
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_CREATE,  3, "cursor create latency",     "kvs_cursor_create_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_UPDATE,  3, "cursor update latency",     "kvs_cursor_update_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_DESTROY, 3, "cursor destroy latency",    "kvs_cursor_destroy_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_FULL,    3, "cursor full lifetime",      "cursor_lifetime_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_INIT,    3, "cursor init latency",       "kvs_cursor_init_lat"),
-
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_SEEK,    4, "kvs_cursor_seek latency",   "kvs_cursor_seek_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_READFWD, 4, "cursor read fwd latency",   "kvs_cursor_readfwd_lat"),
-    NE(PERFC_LT_PKVSL_KVS_CURSOR_READREV, 4, "cursor read rev latency",   "kvs_cursor_readrev_lat"),
-
-    NE(PERFC_LT_PKVSL_KVS_PUT,            5, "kvs_put latency",            "kvs_put_lat", 7),
-    NE(PERFC_LT_PKVSL_KVS_GET,            5, "kvs_get latency",            "kvs_get_lat", 7),
-    NE(PERFC_LT_PKVSL_KVS_DEL,            5, "kvs_delete latency",         "kvs_del_lat", 7),
-    NE(PERFC_LT_PKVSL_KVS_PFX_PROBE,      5, "kvs_prefix_probe latency",   "kvs_pfx_probe_lat", 7),
-    NE(PERFC_LT_PKVSL_KVS_PFX_DEL,        5, "kvs_prefix_delete latency",  "kvs_pfx_del_lat", 7),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_CREATE,  3, "cursor create latency",     "kvs_cursor_create_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_UPDATE,  3, "cursor update latency",     "kvs_cursor_update_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_DESTROY, 3, "cursor destroy latency",    "kvs_cursor_destroy_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_FULL,    3, "cursor full lifetime",      "cursor_lifetime_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_INIT,    3, "cursor init latency",       "kvs_cursor_init_lat"),
+
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_SEEK,    4, "kvs_cursor_seek latency",   "kvs_cursor_seek_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_READFWD, 4, "cursor read fwd latency",   "kvs_cursor_readfwd_lat"),
+    NE(PERFC_HG_PKVSL_KVS_CURSOR_READREV, 4, "cursor read rev latency",   "kvs_cursor_readrev_lat"),
+
+    NE(PERFC_HG_PKVSL_KVS_PUT,            5, "kvs_put latency",            "kvs_put_lat", 7),
+    NE(PERFC_HG_PKVSL_KVS_GET,            5, "kvs_get latency",            "kvs_get_lat", 7),
+    NE(PERFC_HG_PKVSL_KVS_DEL,            5, "kvs_delete latency",         "kvs_del_lat", 7),
+    NE(PERFC_HG_PKVSL_KVS_PFX_PROBE,      5, "kvs_prefix_probe latency",   "kvs_pfx_probe_lat", 7),
+    NE(PERFC_HG_PKVSL_KVS_PFX_DEL,        5, "kvs_prefix_delete latency",  "kvs_pfx_del_lat", 7),
 };
 
 /* clang-format on */
@@ -282,7 +284,7 @@ kvs_put(
     struct wal_record rec;
     size_t            sfx_len;
     size_t            hashlen;
-    u64               tstart;
+    u64               tstart, rt_start;
     u64               seqno;
     merr_t            err;
 
@@ -332,10 +334,14 @@ kvs_put(
             return err;
     }
 
+    rt_start = reqtrace_stage_start();
     err = wal_put(kvs->ikv_wal, kvs, kt, vt, seqno, &rec);
+    reqtrace_stage_end(REQTRACE_STAGE_WAL, rt_start);
 
     if (HSE_LIKELY(!err)) {
+        rt_start = reqtrace_stage_start();
         err = c0_put(kvs->ikv_c0, kt, vt, seqnoref);
+        reqtrace_stage_end(REQTRACE_STAGE_C0, rt_start);
 
         wal_op_finish(kvs->ikv_wal, &rec, kt->kt_seqno, kt->kt_dgen, merr_errno(err));
     }
@@ -343,7 +349,95 @@ kvs_put(
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PUT, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_PUT, tstart);
+
+    return err;
+}
+
+/* Bound the number of batch entries (and hence the amount of WAL buffer
+ * space) reserved but not yet finished by kvs_putdel_batch().
+ */
+#define KVS_BATCH_CHUNK_MAX     (128)
+#define KVS_BATCH_CHUNK_BYTES   (1ul << 20)
+
+merr_t
+kvs_putdel_batch(
+    struct hse_kvdb_txn *const txn,
+    struct ikvs              **kvsv,
+    struct c0kvs_batch_ent    *entv,
+    uint                       entc)
+{
+    struct kvdb_ctxn       *ctxn = kvdb_ctxn_h2h(txn);
+    struct c0kvs_batch_ent *c0entv[KVS_BATCH_CHUNK_MAX];
+    struct wal_record       recv[KVS_BATCH_CHUNK_MAX];
+    uintptr_t               seqnoref;
+    int64_t                 cookie;
+    u64                     seqno;
+    uint                    i, j, n;
+    merr_t                  err;
+
+    seqno = 0;
+    seqnoref = 0;
+    cookie = -1;
+
+    /* The batch txn acquires no key locks (see kvdb_ctxn_nolock_set()),
+     * hence we needn't compute the write collision hashes.  We hold the
+     * txn lock across the entire batch rather than per op.
+     */
+    err = kvdb_ctxn_trylock_write(ctxn, &seqnoref, &seqno, &cookie, false, 0, 0);
+    if (err)
+        return err;
+
+    for (i = 0; i < entc && !err; i += n) {
+        size_t len = 0;
+        merr_t err2;
+
+        for (n = 0; n < KVS_BATCH_CHUNK_MAX && i + n < entc && len < KVS_BATCH_CHUNK_BYTES; ++n) {
+            struct c0kvs_batch_ent *ent = entv + i + n;
+            struct kvs_ktuple      *kt = &ent->cbe_kt;
+            struct ikvs            *kvs = kvsv[i + n];
+            size_t                  sfx_len = kvs->ikv_sfx_len;
+
+            if (HSE_UNLIKELY(sfx_len && kt->kt_len < sfx_len + kvs->ikv_pfx_len)) {
+                err = merr(EINVAL);
+                break;
+            }
+
+            kt->kt_hash = key_hash64(kt->kt_data, kt->kt_len - sfx_len);
+            ent->cbe_c0 = kvs->ikv_c0;
+            recv[n].cookie = cookie;
+
+            if (ent->cbe_del)
+                err = wal_del(kvs->ikv_wal, kvs, kt, seqno, &recv[n]);
+            else
+                err = wal_put(kvs->ikv_wal, kvs, kt, &ent->cbe_vt, seqno, &recv[n]);
+            if (err)
+                break;
+
+            c0entv[n] = ent;
+            len += kt->kt_len + (ent->cbe_del ? 0 : kvs_vtuple_vlen(&ent->cbe_vt));
+        }
+
+        if (n == 0)
+            break;
+
+        /* c0_putdel_batch() reorders c0entv[] but not entv[], so the WAL
+         * records remain in step with the entries from which they came.
+         */
+        err2 = c0_putdel_batch(c0entv, n, seqnoref);
+
+        for (j = 0; j < n; ++j) {
+            struct c0kvs_batch_ent *ent = entv + i + j;
+
+            wal_op_finish(kvsv[i + j]->ikv_wal, &recv[j], ent->cbe_kt.kt_seqno,
+                          ent->cbe_kt.kt_dgen, merr_errno(err2));
+        }
+
+        if (!err)
+            err = err2;
+    }
+
+    kvdb_ctxn_unlock(ctxn);
 
     return err;
 }
@@ -364,7 +458,7 @@ kvs_get(
     struct cn *       cn = kvs->ikv_cn;
     uintptr_t         seqnoref = 0;
     size_t            hashlen;
-    u64               tstart;
+    u64               tstart, rt_start;
     merr_t            err;
 
     tstart = perfc_lat_start(pkvsl_pc);
@@ -381,10 +475,15 @@ kvs_get(
             return err;
     }
 
+    rt_start = reqtrace_stage_start();
     err = c0_get(c0, kt, seqno, seqnoref, res, vbuf);
+    reqtrace_stage_end(REQTRACE_STAGE_C0, rt_start);
 
-    if (!err && *res == NOT_FOUND)
+    if (!err && *res == NOT_FOUND) {
+        rt_start = reqtrace_stage_start();
         err = lc_get(lc, c0_index(c0), kvs->ikv_pfx_len, kt, seqno, seqnoref, res, vbuf);
+        reqtrace_stage_end(REQTRACE_STAGE_LC, rt_start);
+    }
 
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
@@ -392,7 +491,7 @@ kvs_get(
     if (!err && *res == NOT_FOUND)
         err = cn_get(cn, kt, seqno, res, vbuf);
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_GET, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_GET, tstart);
 
     return err;
 }
@@ -405,7 +504,7 @@ kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt,
     struct wal_record rec;
     size_t            sfx_len;
     size_t            hashlen;
-    u64               tstart;
+    u64               tstart, rt_start;
     u64               seqno;
     merr_t            err;
 
@@ -450,9 +549,14 @@ kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt,
             return err;
     }
 
+    rt_start = reqtrace_stage_start();
     err = wal_del(kvs->ikv_wal, kvs, kt, seqno, &rec);
+    reqtrace_stage_end(REQTRACE_STAGE_WAL, rt_start);
+
     if (!err) {
+        rt_start = reqtrace_stage_start();
         err = c0_del(kvs->ikv_c0, kt, seqnoref);
+        reqtrace_stage_end(REQTRACE_STAGE_C0, rt_start);
 
         wal_op_finish(kvs->ikv_wal, &rec, kt->kt_seqno, kt->kt_dgen, merr_errno(err));
     }
@@ -460,7 +564,7 @@ kvs_del(struct ikvs *kvs, struct hse_kvdb_txn *const txn, struct kvs_ktuple *kt,
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_DEL, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_DEL, tstart);
 
     return err;
 }
@@ -510,7 +614,7 @@ kvs_prefix_del(
     if (ctxn)
         kvdb_ctxn_unlock(ctxn);
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PFX_DEL, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_PFX_DEL, tstart);
 
     return ev(err);
 }
@@ -596,7 +700,7 @@ exit:
             *res = FOUND_MULTIPLE;
     }
 
-    perfc_lat_record(pkvsl_pc, PERFC_LT_PKVSL_KVS_PFX_PROBE, tstart);
+    perfc_lat_record(pkvsl_pc, PERFC_HG_PKVSL_KVS_PFX_PROBE, tstart);
 
     return 0;
 }
@@ -23,6 +23,7 @@
 #include <hse_ikvdb/kvdb_perfc.h>
 #include <hse_ikvdb/tuple.h>
 #include <hse_ikvdb/cursor.h>
+#include <hse_ikvdb/reqtrace.h>
 
 #include <c0/c0_cursor.h>
 #include <cn/cn_cursor.h>
@@ -52,13 +53,13 @@ struct perfc_name kvs_cc_perfc_op[] _dt_section = {
 NE_CHECK(kvs_cc_perfc_op, PERFC_EN_CC, "cursor cache perfc ops table/enum mismatch");
 
 struct perfc_name kvs_cd_perfc_op[] _dt_section = {
-    NE(PERFC_LT_CD_SAVE,            4, "cursor cache save latency",     "l_cc_save(ns)",    7),
-    NE(PERFC_LT_CD_RESTORE,         4, "cursor cache restore latency",  "l_cc_restore(ns)", 7),
+    NE(PERFC_HG_CD_SAVE,            4, "cursor cache save latency",     "l_cc_save(ns)",    7),
+    NE(PERFC_HG_CD_RESTORE,         4, "cursor cache restore latency",  "l_cc_restore(ns)", 7),
 
-    NE(PERFC_LT_CD_CREATE_CN,       4, "cn cursor create latency",      "l_cc_create_cn", 7),
-    NE(PERFC_LT_CD_UPDATE_CN,       4, "cn cursor update latency",      "l_cc_update_cn", 7),
-    NE(PERFC_LT_CD_CREATE_C0,       4, "c0 cursor create latency",      "l_cc_create_c0", 7),
-    NE(PERFC_LT_CD_UPDATE_C0,       4, "c0 cursor update latency",      "l_cc_update_c0", 7),
+    NE(PERFC_HG_CD_CREATE_CN,       4, "cn cursor create latency",      "l_cc_create_cn", 7),
+    NE(PERFC_HG_CD_UPDATE_CN,       4, "cn cursor update latency",      "l_cc_update_cn", 7),
+    NE(PERFC_HG_CD_CREATE_C0,       4, "c0 cursor create latency",      "l_cc_create_c0", 7),
+    NE(PERFC_HG_CD_UPDATE_C0,       4, "c0 cursor update latency",      "l_cc_update_c0", 7),
 
     NE(PERFC_DI_CD_READPERSEEK,     5, "Cursor reads per seek",         "d_cc_readperseek", 7),
     NE(PERFC_DI_CD_TOMBSPERPROBE,   5, "Tombs seen per pfx probe",      "d_cc_tombsperprobe", 7),
@@ -169,6 +170,7 @@ struct kvs_cursor_impl {
     u32 kci_need_seek : 1;
     u32 kci_need_prepare : 1;
     u32 kci_reverse : 1;
+    u32 kci_keys_only : 1;
     u32 kci_ptomb_set : 1;
 
     u32    kci_pfxlen;
@@ -391,9 +393,14 @@ ikvs_curcache_timer_cb(ulong arg)
  * we have to touch while walking the tree.
  */
 static HSE_ALWAYS_INLINE uint64_t
-ikvs_curcache_key(const uint64_t gen, const char *prefix, const u64 pfxhash, const bool reverse)
+ikvs_curcache_key(
+    const uint64_t gen,
+    const char    *prefix,
+    const u64      pfxhash,
+    const bool     reverse,
+    const bool     keys_only)
 {
-    return (gen << 24) | (pfxhash & 0xfffffau) | ((!!prefix) << 1) | reverse;
+    return (gen << 24) | (pfxhash & 0xfffffau) | (keys_only << 2) | ((!!prefix) << 1) | reverse;
 }
 
 static HSE_ALWAYS_INLINE int
@@ -573,14 +580,20 @@ ikvs_cursor_reset(struct kvs_cursor_impl *cursor)
 }
 
 static struct kvs_cursor_impl *
-ikvs_cursor_restore(struct ikvs *kvs, const void *prefix, size_t pfx_len, u64 pfxhash, bool reverse)
+ikvs_cursor_restore(
+    struct ikvs *kvs,
+    const void  *prefix,
+    size_t       pfx_len,
+    u64          pfxhash,
+    bool         reverse,
+    bool         keys_only)
 {
     struct kvs_cursor_impl *cur;
     uint64_t                key, tstart;
 
-    tstart = perfc_lat_startl(&kvs->ikv_cd_pc, PERFC_LT_CD_RESTORE);
+    tstart = perfc_lat_startl(&kvs->ikv_cd_pc, PERFC_HG_CD_RESTORE);
 
-    key = ikvs_curcache_key(kvs->ikv_gen, prefix, pfxhash, reverse);
+    key = ikvs_curcache_key(kvs->ikv_gen, prefix, pfxhash, reverse, keys_only);
 
     cur = ikvs_curcache_remove(ikvs_curcache_td2bkt(), key, prefix, pfx_len);
     if (!cur) {
@@ -588,7 +601,7 @@ ikvs_cursor_restore(struct ikvs *kvs, const void *prefix, size_t pfx_len, u64 pf
         return NULL;
     }
 
-    perfc_lat_record(&kvs->ikv_cd_pc, PERFC_LT_CD_RESTORE, tstart);
+    perfc_lat_record(&kvs->ikv_cd_pc, PERFC_HG_CD_RESTORE, tstart);
     PERFC_INC_RU(&kvs->ikv_cc_pc, PERFC_RA_CC_HIT);
 
     return cur;
@@ -622,7 +635,7 @@ ikvs_cursor_save(struct kvs_cursor_impl *cur)
     cur->kci_summary.util = 0;
 #endif
 
-    tstart = perfc_lat_startl(&kvs->ikv_cd_pc, PERFC_LT_CD_SAVE);
+    tstart = perfc_lat_startl(&kvs->ikv_cd_pc, PERFC_HG_CD_SAVE);
 
     if (cur->kci_item.ci_ttl > jclock_ns)
         cur = ikvs_curcache_insert(ikvs_curcache_td2bkt(), cur);
@@ -631,20 +644,20 @@ ikvs_cursor_save(struct kvs_cursor_impl *cur)
         perfc_inc(&kvs->ikv_cc_pc, PERFC_RA_CC_SAVEFAIL);
         kvs_cursor_destroy(&cur->kci_handle);
     } else {
-        perfc_lat_record(&kvs->ikv_cd_pc, PERFC_LT_CD_SAVE, tstart);
+        perfc_lat_record(&kvs->ikv_cd_pc, PERFC_HG_CD_SAVE, tstart);
         PERFC_INC_RU(&kvs->ikv_cc_pc, PERFC_RA_CC_SAVE);
     }
 }
 
 struct hse_kvs_cursor *
-kvs_cursor_alloc(struct ikvs *kvs, const void *prefix, size_t pfx_len, bool reverse)
+kvs_cursor_alloc(struct ikvs *kvs, const void *prefix, size_t pfx_len, bool reverse, bool keys_only)
 {
     struct kvs_cursor_impl *cur;
     u64                     pfxhash;
 
     pfxhash = (prefix && pfx_len > 0) ? key_hash64(prefix, pfx_len) : 0;
 
-    cur = ikvs_cursor_restore(kvs, prefix, pfx_len, pfxhash, reverse);
+    cur = ikvs_cursor_restore(kvs, prefix, pfx_len, pfxhash, reverse, keys_only);
     if (cur) {
 
         /*
@@ -663,7 +676,7 @@ kvs_cursor_alloc(struct ikvs *kvs, const void *prefix, size_t pfx_len, bool reve
 
     memset(cur, 0, sizeof(*cur));
 
-    cur->kci_item.ci_key = ikvs_curcache_key(kvs->ikv_gen, prefix, pfxhash, reverse);
+    cur->kci_item.ci_key = ikvs_curcache_key(kvs->ikv_gen, prefix, pfxhash, reverse, keys_only);
     cur->kci_cc_pc = PERFC_ISON(&kvs->ikv_cc_pc) ? &kvs->ikv_cc_pc : NULL;
     cur->kci_cd_pc = PERFC_ISON(&kvs->ikv_cd_pc) ? &kvs->ikv_cd_pc : NULL;
     cur->kci_kvs = kvs;
@@ -680,8 +693,10 @@ kvs_cursor_alloc(struct ikvs *kvs, const void *prefix, size_t pfx_len, bool reve
 
     cur->kci_limit_len = 0;
     cur->kci_handle.kc_filter.kcf_maxkey = 0;
+    cur->kci_handle.kc_filter.kcf_pred = NULL;
 
     cur->kci_reverse = reverse;
+    cur->kci_keys_only = keys_only;
     ikvs_cursor_reset(cur);
 
     /* Pad with 0xff to make reverse cursor seek-to-pfx simple */
@@ -694,7 +709,11 @@ kvs_cursor_alloc(struct ikvs *kvs, const void *prefix, size_t pfx_len, bool reve
 void
 kvs_cursor_free(struct hse_kvs_cursor *cursor)
 {
-    if (cursor->kc_err)
+    /* The c0, lc and cn cursors of a filtered cursor retain pointers to
+     * its predicate until they are next seeked, which a cached cursor
+     * reused via prepare never is.  So we don't cache them.
+     */
+    if (cursor->kc_err || cursor->kc_filter.kcf_pred)
         kvs_cursor_destroy(cursor);
     else
         ikvs_cursor_save(cursor_h2r(cursor));
@@ -732,7 +751,7 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
     void *                  cn = kvs->ikv_cn;
     u64                     seqno = cursor->kc_seq;
     merr_t                  err = 0;
-    u64                     tstart;
+    u64                     tstart, rt_start;
     struct cursor_summary * summary = &cur->kci_summary;
     bool                    reverse = cur->kci_reverse;
     const void *            prefix = cur->kci_prefix;
@@ -750,6 +769,8 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
     }
 #endif
 
+    rt_start = reqtrace_stage_start();
+
     /* Create/Update c0 cursor */
     if (!cur->kci_c0cur) {
 
@@ -757,9 +778,9 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
 
         /* Create c0 cursor */
         perfc_inc(cur->kci_cc_pc, PERFC_BA_CC_INIT_CREATE_C0);
-        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_LT_CD_CREATE_C0);
+        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_HG_CD_CREATE_C0);
         err = c0_cursor_create(c0, seqno, reverse, prefix, pfxlen, summary, &cur->kci_c0cur);
-        perfc_lat_record(cur->kci_cd_pc, PERFC_LT_CD_CREATE_C0, tstart);
+        perfc_lat_record(cur->kci_cd_pc, PERFC_HG_CD_CREATE_C0, tstart);
     } else {
         u32 flags = 0;
 
@@ -767,22 +788,26 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
 
         /* Update c0 cursor */
         cur->kci_need_seek = 1;
-        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_LT_CD_UPDATE_C0);
+        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_HG_CD_UPDATE_C0);
 
         /* [HSE_REVISIT] mapi breaks initialization of flags.
          */
         err = c0_cursor_update(cur->kci_c0cur, seqno, &flags);
-        perfc_lat_record(cur->kci_cd_pc, PERFC_LT_CD_UPDATE_C0, tstart);
+        perfc_lat_record(cur->kci_cd_pc, PERFC_HG_CD_UPDATE_C0, tstart);
 
         if (flags & CURSOR_FLAG_SEQNO_CHANGE)
             perfc_inc(cur->kci_cc_pc, PERFC_BA_CC_INIT_UPDATE_C0);
     }
 
+    reqtrace_stage_end(REQTRACE_STAGE_C0, rt_start);
+
     if (ev(err))
         goto error;
 
     assert(cur->kci_c0cur);
 
+    rt_start = reqtrace_stage_start();
+
     if (!cur->kci_lccur) {
         u16       skidx = c0_index(c0);
         s32       tree_pfxlen = c0_get_pfx_len(c0);
@@ -804,26 +829,29 @@ kvs_cursor_init(struct hse_kvs_cursor *cursor, struct kvdb_ctxn *ctxn)
         cur->kci_need_seek = 1;
     }
 
+    reqtrace_stage_end(REQTRACE_STAGE_LC, rt_start);
+
     if (ev(err))
         goto error;
 
     if (!cur->kci_cncur) {
         /* Create cn cursor */
         perfc_inc(cur->kci_cc_pc, PERFC_BA_CC_INIT_CREATE_CN);
-        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_LT_CD_CREATE_CN);
-        err = cn_cursor_create(cn, seqno, reverse, prefix, pfxlen, summary, &cur->kci_cncur);
-        perfc_lat_record(cur->kci_cd_pc, PERFC_LT_CD_CREATE_CN, tstart);
+        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_HG_CD_CREATE_CN);
+        err = cn_cursor_create(cn, seqno, reverse, cur->kci_keys_only, prefix, pfxlen, summary,
+                               &cur->kci_cncur);
+        perfc_lat_record(cur->kci_cd_pc, PERFC_HG_CD_CREATE_CN, tstart);
     } else {
         bool updated = false;
 
         /* Update cn cursor */
         cur->kci_need_seek = 1;
-        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_LT_CD_UPDATE_CN);
+        tstart = perfc_lat_startu(cur->kci_cd_pc, PERFC_HG_CD_UPDATE_CN);
 
         /* [HSE_REVISIT] mapi breaks initialization of updated.
          */
         err = cn_cursor_update(cur->kci_cncur, seqno, &updated);
-        perfc_lat_record(cur->kci_cd_pc, PERFC_LT_CD_UPDATE_CN, tstart);
+        perfc_lat_record(cur->kci_cd_pc, PERFC_HG_CD_UPDATE_CN, tstart);
 
         if (updated)
             perfc_inc(cur->kci_cc_pc, PERFC_BA_CC_INIT_UPDATE_CN);
@@ -897,9 +925,32 @@ kvs_cursor_destroy(struct hse_kvs_cursor *handle)
     if (cursor->kci_bh)
         bin_heap2_destroy(cursor->kci_bh);
 
+    free((void *)handle->kc_filter.kcf_pred);
+
     vlb_free(cursor, kvs_cursor_impl_alloc_sz);
 }
 
+void
+kvs_cursor_filter_set(struct hse_kvs_cursor *handle, struct kc_pred *pred)
+{
+    struct kvs_cursor_impl *cursor = (void *)handle;
+
+    free((void *)handle->kc_filter.kcf_pred);
+    handle->kc_filter.kcf_pred = pred;
+
+    /* Rewind to the start of the range.  The next read seeks there,
+     * which pushes the new predicate down to c0, lc and cn.
+     */
+    cursor->kci_last = NULL;
+    cursor->kci_eof = 0;
+    cursor->kci_need_toss = 0;
+    cursor->kci_need_prepare = 0;
+    cursor->kci_need_seek = 1;
+
+    cursor->kci_last_klen = cursor->kci_reverse ? HSE_KVS_KEY_LEN_MAX : cursor->kci_pfxlen;
+    memcpy(cursor->kci_last_kbuf, cursor->kci_prefix, cursor->kci_last_klen);
+}
+
 merr_t
 kvs_cursor_update(struct hse_kvs_cursor *handle, struct kvdb_ctxn *ctxn, u64 seqno)
 {
@@ -938,12 +989,12 @@ kvs_cursor_update(struct hse_kvs_cursor *handle, struct kvdb_ctxn *ctxn, u64 seq
     }
 
     /* Update c0 cursor */
-    tstart = perfc_lat_startu(cursor->kci_cd_pc, PERFC_LT_CD_UPDATE_C0);
+    tstart = perfc_lat_startu(cursor->kci_cd_pc, PERFC_HG_CD_UPDATE_C0);
 
     cursor->kci_err = c0_cursor_update(cursor->kci_c0cur, seqno, &flags);
     if (ev(cursor->kci_err))
         return cursor->kci_err;
-    perfc_lat_record(cursor->kci_cd_pc, PERFC_LT_CD_UPDATE_C0, tstart);
+    perfc_lat_record(cursor->kci_cd_pc, PERFC_HG_CD_UPDATE_C0, tstart);
 
     if (flags & CURSOR_FLAG_SEQNO_CHANGE)
         perfc_inc(cursor->kci_cc_pc, PERFC_BA_CC_UPDATED_C0);
@@ -955,12 +1006,12 @@ kvs_cursor_update(struct hse_kvs_cursor *handle, struct kvdb_ctxn *ctxn, u64 seq
         return cursor->kci_err;
 
     /* Update cn cursor */
-    tstart = perfc_lat_startu(cursor->kci_cd_pc, PERFC_LT_CD_UPDATE_CN);
+    tstart = perfc_lat_startu(cursor->kci_cd_pc, PERFC_HG_CD_UPDATE_CN);
 
     cursor->kci_err = cn_cursor_update(cursor->kci_cncur, seqno, &updated);
     if (ev(cursor->kci_err))
         return cursor->kci_err;
-    perfc_lat_record(cursor->kci_cd_pc, PERFC_LT_CD_UPDATE_CN, tstart);
+    perfc_lat_record(cursor->kci_cd_pc, PERFC_HG_CD_UPDATE_CN, tstart);
 
     if (updated) {
         u32 active = 0, total;
@@ -1083,17 +1134,25 @@ static merr_t
 ikvs_cursor_seek(struct kvs_cursor_impl *cursor, const void *key, size_t klen)
 {
     struct hse_kvs_cursor *handle = &cursor->kci_handle;
-    struct kc_filter *     filt = handle->kc_filter.kcf_maxkey ? &handle->kc_filter : 0;
+    struct kc_filter *     filt = 0;
     merr_t                 err = 0;
+    u64                    rt_start;
     int                    cnt;
 
+    if (handle->kc_filter.kcf_maxkey || handle->kc_filter.kcf_pred)
+        filt = &handle->kc_filter;
+
     cursor->kci_eof = 0;
 
+    rt_start = reqtrace_stage_start();
     err = c0_cursor_seek(cursor->kci_c0cur, key, klen, filt);
+    reqtrace_stage_end(REQTRACE_STAGE_C0, rt_start);
     if (ev(err))
         goto out;
 
+    rt_start = reqtrace_stage_start();
     err = lc_cursor_seek(cursor->kci_lccur, key, klen, filt);
+    reqtrace_stage_end(REQTRACE_STAGE_LC, rt_start);
     if (ev(err))
         goto out;
 
@@ -1159,6 +1218,14 @@ kvs_cursor_val_copy(
     vt = &cur->kci_elem_last.kce_vt;
     clen = cur->kci_elem_last.kce_complen;
 
+    /* A keys-only cursor yields value lengths but never value data.
+     */
+    if (cur->kci_keys_only) {
+        if (val_out)
+            *val_out = NULL;
+        goto out;
+    }
+
     if (!buf && !val_out)
         goto out;
 
@@ -1168,9 +1235,12 @@ kvs_cursor_val_copy(
     }
 
     if (clen) {
+        u64  rt_start;
         uint outlen;
 
+        rt_start = reqtrace_stage_start();
         err = compress_lz4_ops.cop_decompress(vt->vt_data, clen, buf, bufsz, &outlen);
+        reqtrace_stage_end(REQTRACE_STAGE_DECOMPRESS, rt_start);
         if (ev(err))
             return err;
 
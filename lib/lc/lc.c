@@ -786,6 +786,7 @@ struct lc_cursor {
     u16                       lcc_skidx;
     struct kvs_cursor_element lcc_elem;
     struct key_obj            lcc_filter_max;
+    const struct kc_pred *    lcc_pred;
     struct key_obj            lcc_ptomb;
     u64                       lcc_ptomb_seq;
     size_t                    lcc_tree_pfxlen;
@@ -952,6 +953,11 @@ lc_cursor_read(struct lc_cursor *cur, struct kvs_cursor_element *lc_elem, bool *
                 break; /* eof; key is larger than lcc_filter_max */
         }
 
+        if (cur->lcc_pred && !is_ptomb && !kc_pred_match(cur->lcc_pred, &elem->kce_kobj)) {
+            bin_heap2_pop(cur->lcc_bh, (void **)&elem);
+            continue;
+        }
+
         if (cur->lcc_ptomb_set) {
             int rc = key_obj_cmp_prefix(&cur->lcc_ptomb, &elem->kce_kobj);
 
@@ -1047,12 +1053,14 @@ lc_cursor_seek(struct lc_cursor *cur, const void *seek, size_t seeklen, struct k
 
     assert(cur);
 
-    cur->lcc_filter_set = filter ? 1 : 0;
-    if (filter) {
+    cur->lcc_filter_set = (filter && filter->kcf_maxkey) ? 1 : 0;
+    if (cur->lcc_filter_set) {
         assert(!cur->lcc_reverse);
         key2kobj(&cur->lcc_filter_max, filter->kcf_maxkey, filter->kcf_maxklen);
     }
 
+    cur->lcc_pred = filter ? filter->kcf_pred : NULL;
+
     cur->lcc_ptomb_set = 0;
 
     rcu_read_lock();
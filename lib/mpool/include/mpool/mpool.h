@@ -300,6 +300,22 @@ mpool_mdc_read(struct mpool_mdc *mdc, void *data, size_t len, size_t *rdlen);
 /* MTF_MOCK */
 merr_t
 mpool_mdc_append(struct mpool_mdc *mdc, void *data, size_t len, bool sync);
+
+/**
+ * mpool_mdc_appendv() - append a batch of records to MDC
+ *
+ * @mdc:  MDC handle
+ * @iov:  records to write, one record per element
+ * @iovc: number of records
+ * @sync: flag to defer return until IO for the whole batch is complete
+ *
+ * Space for the whole batch is reserved before the first record is written,
+ * and at most one sync is issued per batch.
+ */
+/* MTF_MOCK */
+merr_t
+mpool_mdc_appendv(struct mpool_mdc *mdc, const struct iovec *iov, int iovc, bool sync);
+
 /**
  * mpool_mdc_cstart() - Initiate MDC compaction
  *
@@ -17,6 +17,8 @@
 #define WAL_FILE_PFX           "wal"
 #define WAL_FILE_PFX_LEN       (sizeof(WAL_FILE_PFX) - 1)
 
+#define CN_SUMMARY_FILE_PFX    "cnsum"
+
 /* [HSE_REVISIT]: The fact that this is necessary at all seems like a code
  * smell. Ideally, I think we remove this and properly propogate errors up the
  * stack, assert(), or abort(). This is a holdover from MP_MED_INVALID.
@@ -130,7 +130,7 @@ mclass_files_prefix(const char *path)
     const char *base = basename(path);
 
     return strstr(base, MBLOCK_FILE_PFX) || strstr(base, MDC_FILE_PFX) ||
-        strstr(base, WAL_FILE_PFX);
+        strstr(base, WAL_FILE_PFX) || strstr(base, CN_SUMMARY_FILE_PFX);
 }
 
 static struct workqueue_struct *mpdwq;
@@ -409,6 +409,24 @@ mpool_mdc_append(struct mpool_mdc *mdc, void *data, size_t len, bool sync)
     return err;
 }
 
+merr_t
+mpool_mdc_appendv(struct mpool_mdc *mdc, const struct iovec *iov, int iovc, bool sync)
+{
+    merr_t err;
+
+    if (!mdc || !iov)
+        return merr(EINVAL);
+
+    mutex_lock(&mdc->lock);
+    err = mdc_file_appendv(mdc->mfpa, iov, iovc, sync);
+    mutex_unlock(&mdc->lock);
+    if (err)
+        log_errx("mdc %p appendv failed, mdc file %p, iovc %d sync %d: @@e",
+                 err, mdc, mdc->mfpa, iovc, sync);
+
+    return err;
+}
+
 merr_t
 mpool_mdc_usage(struct mpool_mdc *mdc, uint64_t *allocated, uint64_t *used)
 {
@@ -732,16 +732,16 @@ mdc_file_append_mem(struct mdc_file *mfp, void *data, size_t len)
     return 0;
 }
 
-merr_t
-mdc_file_append(struct mdc_file *mfp, void *data, size_t len, bool sync)
+static size_t
+mdc_file_reclen(struct mdc_file *mfp, size_t len)
 {
-    merr_t err;
-    size_t tlen;
-
-    if (!mfp || !data)
-        return merr(EINVAL);
+    return omf_mdc_rechdr_len(mfp->lh.vers) + ALIGN(len, sizeof(uint64_t));
+}
 
-    tlen = omf_mdc_rechdr_len(mfp->lh.vers) + ALIGN(len, sizeof(uint64_t));
+static merr_t
+mdc_file_reserve(struct mdc_file *mfp, size_t tlen)
+{
+    merr_t err;
 
     /* Extend file if the usage exceeds 75% of current size. */
     if (mfp->woff + tlen > ((3 * mfp->size) / 4)) {
@@ -753,6 +753,14 @@ mdc_file_append(struct mdc_file *mfp, void *data, size_t len, bool sync)
     if ((mfp->woff + tlen) > mfp->size)
         return merr(EFBIG);
 
+    return 0;
+}
+
+static merr_t
+mdc_file_append_one(struct mdc_file *mfp, void *data, size_t len)
+{
+    merr_t err;
+
     assert(IS_ALIGNED(mfp->woff, sizeof(uint64_t)));
 
     if (len >= 2 * PAGE_SIZE)
@@ -763,7 +771,105 @@ mdc_file_append(struct mdc_file *mfp, void *data, size_t len, bool sync)
     if (err)
         return err;
 
+    mfp->woff += mdc_file_reclen(mfp, len);
+
+    return 0;
+}
+
+merr_t
+mdc_file_append(struct mdc_file *mfp, void *data, size_t len, bool sync)
+{
+    merr_t err;
+
+    if (!mfp || !data)
+        return merr(EINVAL);
+
+    err = mdc_file_reserve(mfp, mdc_file_reclen(mfp, len));
+    if (err)
+        return err;
+
+    err = mdc_file_append_one(mfp, data, len);
+    if (err)
+        return err;
+
+    if (sync || (mfp->woff - mfp->syncoff >= (1u << 20))) {
+        err = mdc_file_sync(mfp);
+        if (err)
+            return err;
+    }
+
+    return 0;
+}
+
+merr_t
+mdc_file_appendv(struct mdc_file *mfp, const struct iovec *iov, int iovc, bool sync)
+{
+    static const char      pad[sizeof(uint64_t)];
+    struct mdc_rechdr_omf *rhv;
+    struct iovec          *wiov;
+    size_t                 tlen = 0, rhlen, wlen = 0;
+    merr_t                 err;
+    int                    i, n;
+
+    if (!mfp || !iov || iovc < 1)
+        return merr(EINVAL);
+
+    for (i = 0; i < iovc; i++) {
+        if (!iov[i].iov_base)
+            return merr(EINVAL);
+
+        tlen += mdc_file_reclen(mfp, iov[i].iov_len);
+    }
+
+    /* Reserve space for the whole batch up front so that it is either
+     * appended in its entirety or not at all.
+     */
+    err = mdc_file_reserve(mfp, tlen);
+    if (err)
+        return err;
+
+    /* Gather each record's header, data and alignment padding into one
+     * vector so that the whole batch goes out in a single pwritev().
+     */
+    rhv = malloc(iovc * (sizeof(*rhv) + 3 * sizeof(*wiov)));
+    if (!rhv)
+        return merr(ENOMEM);
+
+    wiov = (struct iovec *)(rhv + iovc);
+    rhlen = omf_mdc_rechdr_len(mfp->lh.vers);
+
+    assert(IS_ALIGNED(mfp->woff, sizeof(uint64_t)));
+
+    for (i = n = 0; i < iovc; i++) {
+        size_t len = iov[i].iov_len;
+
+        omf_mdc_rechdr_pack(iov[i].iov_base, len, &rhv[i]);
+
+        wiov[n].iov_base = &rhv[i];
+        wiov[n++].iov_len = rhlen;
+
+        if (len > 0) {
+            wiov[n].iov_base = iov[i].iov_base;
+            wiov[n++].iov_len = len;
+        }
+
+        if (len != ALIGN(len, sizeof(uint64_t))) {
+            wiov[n].iov_base = (void *)pad;
+            wiov[n++].iov_len = ALIGN(len, sizeof(uint64_t)) - len;
+        }
+    }
+
+    err = mfp->io.write(mfp->fd, mfp->woff, wiov, n, 0, &wlen);
+    free(rhv);
+
+    if (err)
+        return err;
+
+    if (ev(wlen != tlen))
+        return merr(EIO);
+
     mfp->woff += tlen;
+    mfp->need_dsync = true;
 
     if (sync || (mfp->woff - mfp->syncoff >= (1u << 20))) {
         err = mdc_file_sync(mfp);
@@ -238,4 +238,15 @@ mdc_file_read(struct mdc_file *mfp, void *data, size_t len, bool verify, size_t
 merr_t
 mdc_file_append(struct mdc_file *mfp, void *data, size_t len, bool sync);
 
+/**
+ * mdc_file_appendv() - append a batch of records to an MDC file
+ *
+ * @mfp:  mdc file handle
+ * @iov:  one record per element
+ * @iovc: number of records
+ * @sync: sync once after the last record is appended
+ */
+merr_t
+mdc_file_appendv(struct mdc_file *mfp, const struct iovec *iov, int iovc, bool sync);
+
 #endif /* MPOOL_MDC_FILE_H */
@@ -204,7 +204,8 @@ bonsai_sval_vlen(const struct bonsai_sval *bsv)
  *
  * A bonsai_kv includes the key and a list of bonsai_val objects.
  * The bonsai_kv and initial bonsai_val are allocated in one chunk
- * as recorded by %bkv_allocsz.
+ * (the initial value lives at %bkv_voffset), so a key with only one
+ * version costs just one allocation.
  */
 struct bonsai_kv {
     struct key_immediate    bkv_key_imm;
@@ -36,10 +36,11 @@ typedef enum {
     DT_FIELD_ENABLED,
     DT_FIELD_CLEAR,
     DT_FIELD_DATA,
+    DT_FIELD_INTERVAL,
 } dt_field_t;
 
 /* Operations */
-enum { DT_OP_INVALID, DT_OP_EMIT, DT_OP_SET, DT_OP_COUNT, DT_OP_LOG };
+enum { DT_OP_INVALID, DT_OP_EMIT, DT_OP_SET, DT_OP_COUNT, DT_OP_LOG, DT_OP_VISIT };
 
 /* clang-format on */
 
@@ -92,10 +93,25 @@ struct dt_set_parameters {
     dt_field_t field;
 };
 
+/**
+ * struct dt_visit_parameters - arguments for DT_OP_VISIT
+ * @dv_func:  called for each selected element with the tree lock held
+ * @dv_arg:   opaque argument passed to @dv_func
+ *
+ * DT_OP_VISIT lets a caller render elements in a format of its own
+ * choosing without building a yaml document.  @dv_func must not call
+ * back into the data tree.
+ */
+struct dt_visit_parameters {
+    void (*dv_func)(struct dt_element *dte, void *arg);
+    void  *dv_arg;
+};
+
 union dt_iterate_parameters {
-    struct yaml_context *     yc;
-    struct dt_set_parameters *dsp;
-    int                       log_level;
+    struct yaml_context *       yc;
+    struct dt_set_parameters *  dsp;
+    struct dt_visit_parameters *dvp;
+    int                         log_level;
 };
 
 /* The real definition of struct dt_tree is in data_tree.c */
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_NUMA_H
+#define HSE_PLATFORM_NUMA_H
+
+#include <sched.h>
+
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+/* Minimal NUMA topology and placement helpers built directly on sysfs
+ * and the mbind(2) system call, so that we needn't depend upon libnuma.
+ * All placement operations are advisory: failure to bind a thread or a
+ * memory range leaves it where the kernel put it, which is what we had
+ * before NUMA mode existed.
+ */
+
+#define HSE_NUMA_NODES_MAX  (64)
+
+/**
+ * hse_numa_nodes() - get the number of possible NUMA nodes
+ *
+ * Return: the number of NUMA nodes (always at least 1)
+ */
+uint
+hse_numa_nodes(void);
+
+/**
+ * hse_numa_cpuset() - get the set of CPUs local to a NUMA node
+ * @node: NUMA node ID
+ * @set:  (output) set of CPUs on @node
+ */
+merr_t
+hse_numa_cpuset(uint node, cpu_set_t *set);
+
+/**
+ * hse_numa_membind() - prefer a NUMA node for a range of memory
+ * @addr:    start of range (need not be page aligned)
+ * @len:     length of range
+ * @node:    preferred NUMA node
+ * @migrate: if true, also migrate pages already faulted in
+ *
+ * Pages in the range that are faulted in subsequently will be allocated
+ * from @node if possible.
+ */
+merr_t
+hse_numa_membind(void *addr, size_t len, uint node, bool migrate);
+
+/**
+ * hse_numa_path_node() - get the NUMA node of the device backing a path
+ * @path: file or directory
+ *
+ * Return: the NUMA node of the block device on which @path resides,
+ * or -1 if it cannot be determined (e.g., tmpfs or a single node system)
+ */
+int
+hse_numa_path_node(const char *path);
+
+#endif /* HSE_PLATFORM_NUMA_H */
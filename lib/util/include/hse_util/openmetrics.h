@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#ifndef HSE_PLATFORM_OPENMETRICS_H
+#define HSE_PLATFORM_OPENMETRICS_H
+
+#include <hse_util/compiler.h>
+#include <hse_util/inttypes.h>
+#include <hse_util/hse_err.h>
+
+/* An OpenMetrics text exposition writer.  Output is staged in a caller
+ * supplied buffer and written to a file descriptor (typically a REST
+ * response fd) each time the buffer fills, so documents of any size can
+ * be rendered with a small fixed amount of memory.
+ *
+ * A document consists of metric families, each introduced by om_family()
+ * and followed by all of its samples, and is terminated by om_finish().
+ * Label sets are built with om_label() and passed to om_sample() as the
+ * text that goes between the braces.
+ */
+
+#define OM_LABELS_MAX   (512)
+
+/**
+ * struct om_writer - OpenMetrics writer
+ * @ow_fd:    output file descriptor
+ * @ow_buf:   staging buffer
+ * @ow_bufsz: size of @ow_buf
+ * @ow_off:   number of bytes staged in @ow_buf
+ * @ow_err:   first error encountered, subsequent output is discarded
+ */
+struct om_writer {
+    int    ow_fd;
+    char  *ow_buf;
+    size_t ow_bufsz;
+    size_t ow_off;
+    merr_t ow_err;
+};
+
+/**
+ * om_init() - initialize an OpenMetrics writer
+ * @w:     writer
+ * @fd:    output file descriptor
+ * @buf:   staging buffer, must be large enough for the longest sample line
+ * @bufsz: size of @buf
+ */
+void
+om_init(struct om_writer *w, int fd, char *buf, size_t bufsz);
+
+/**
+ * om_family() - start a metric family
+ * @w:    writer
+ * @name: family name
+ * @type: OpenMetrics type ("gauge", "counter", "summary", ...)
+ * @help: one line description
+ */
+void
+om_family(struct om_writer *w, const char *name, const char *type, const char *help);
+
+/**
+ * om_sample() - emit one sample
+ * @w:      writer
+ * @name:   sample name (the family name plus an optional suffix)
+ * @labels: label set without braces (see om_label()), may be nil
+ * @value:  sample value
+ */
+void
+om_sample(struct om_writer *w, const char *name, const char *labels, u64 value);
+
+/**
+ * om_label() - append a label to a label set
+ * @buf:   label set buffer (OM_LABELS_MAX is ample for our label sets)
+ * @bufsz: size of @buf
+ * @off:   (in/out) offset at which to append
+ * @name:  label name
+ * @value: label value, escaped as required
+ *
+ * A label that does not fit is dropped in its entirety.
+ */
+void
+om_label(char *buf, size_t bufsz, size_t *off, const char *name, const char *value);
+
+/**
+ * om_finish() - terminate the document and flush the writer
+ * @w: writer
+ *
+ * Return: the first error encountered while writing the document
+ */
+merr_t
+om_finish(struct om_writer *w);
+
+#endif
@@ -39,6 +39,23 @@
 #define PERFC_PCT_SCALE     (1u << 20)
 #define PERFC_CTRS_MAX      (64)
 
+/* Histogram counters use the HdrHistogram bucket encoding: values are
+ * recorded with PERFC_HG_SUB_SHIFT bits of sub-bucket resolution, which
+ * bounds the relative error of any reported value to 1/64 (~1.6%), and
+ * values larger than PERFC_HG_VAL_MAX are clamped.
+ *
+ * PERFC_HG_SUB_SHIFT       log2 of the number of sub-buckets per bucket
+ * PERFC_HG_MAG_MAX         log2 of the largest trackable value (ns)
+ * PERFC_HG_BKT_MAX         number of counts per cpu group
+ * PERFC_HG_PCTC            number of percentiles reported
+ */
+#define PERFC_HG_SUB_SHIFT  (7)
+#define PERFC_HG_MAG_MAX    (36)
+#define PERFC_HG_VAL_MAX    ((1ul << PERFC_HG_MAG_MAX) - 1)
+#define PERFC_HG_BKT_MAX \
+    ((PERFC_HG_MAG_MAX - PERFC_HG_SUB_SHIFT + 2) << (PERFC_HG_SUB_SHIFT - 1))
+#define PERFC_HG_PCTC       (5)
+
 /* If you perturb perfc_type in any way then be certain to update
  * perfc_ctr_name2type() and perfc_ctr_type2name[] to match.
  */
@@ -49,6 +66,7 @@ enum perfc_type {
     PERFC_TYPE_LT, /* Get the distribution of a latency */
     PERFC_TYPE_DI, /* Get the distribution of a variable */
     PERFC_TYPE_SL, /* Simple latency, cumulative average */
+    PERFC_TYPE_HG, /* Get the percentiles of a latency */
 };
 
 enum perfc_ctr_flags {
@@ -319,6 +337,7 @@ perfc_ivl_destroy(const struct perfc_ivl *ivl);
  * DI_ distribution counter
  * LT_ distribution of a latency counter
  * SL_ simple latency counter
+ * HG_ latency histogram counter (exact percentiles)
  *
  * Followed with <FAMILYNAME>_ that identifies the family of the counter.
  *
@@ -326,6 +345,12 @@ perfc_ivl_destroy(const struct perfc_ivl *ivl);
  *
  * For example: PERFC_LT_MPOOL_MB_READ
  *      family is "MPOOL".
+ *
+ * Prefer HG_ to LT_ for request latencies whose tail matters: LT_ counters
+ * bin samples into at most PERFC_IVL_MAX coarse buckets, whereas HG_
+ * counters can report any percentile to within ~1.6%.  The price is
+ * memory: an HG_ counter allocates roughly 256KiB the first time it
+ * records a sample.
  */
 
 /* The perfc "rollup" macros are similar to their namesakes with
@@ -533,6 +558,56 @@ struct perfc_dis {
     const struct perfc_ivl *pdi_ivl;
 };
 
+/**
+ * struct perfc_hgrp - per-cpu-group histogram data
+ * @phgg_sum:   sum of samples recorded by this group
+ * @phgg_cntv:  sample counts, indexed by HdrHistogram bucket encoding
+ */
+struct perfc_hgrp {
+    atomic_ulong phgg_sum;
+    atomic_ulong phgg_cntv[PERFC_HG_BKT_MAX];
+} HSE_L1D_ALIGNED;
+
+/**
+ * struct perfc_hg - latency histogram counter
+ * @phg_hdr:        base counter object
+ * @phg_pct:        sample record percentage (scaled by PERFC_PCT_SCALE)
+ * @phg_reset_ns:   time at which the histogram was last cleared
+ * @phg_ivl_ns:     reset interval (0 if never reset on read)
+ * @phg_grpv:       vector of PERFC_GRP_MAX per-cpu-group histograms
+ *
+ * %phg_grpv is allocated by the first call to record a sample so that
+ * counters that are never enabled cost nothing.  Histograms are merged
+ * only when read.
+ *
+ * perfc_hg "is-a" perfc_ctr_hdr.
+ */
+struct perfc_hg {
+    struct perfc_ctr_hdr        phg_hdr; /* Must be first field */
+    u32                         phg_pct;
+    u64                         phg_reset_ns;
+    u64                         phg_ivl_ns;
+    struct perfc_hgrp *_Atomic  phg_grpv;
+};
+
+/**
+ * struct perfc_hg_stats - summary of a histogram counter
+ * @phs_hits:   number of samples
+ * @phs_sum:    sum of samples
+ * @phs_min:    smallest sample (within the histogram's resolution)
+ * @phs_max:    largest sample (within the histogram's resolution)
+ * @phs_ivl_ns: time since the histogram was last cleared
+ * @phs_pctv:   the 50th, 90th, 99th, 99.9th and 99.99th percentiles
+ */
+struct perfc_hg_stats {
+    u64 phs_hits;
+    u64 phs_sum;
+    u64 phs_min;
+    u64 phs_max;
+    u64 phs_ivl_ns;
+    u64 phs_pctv[PERFC_HG_PCTC];
+};
+
 /**
  * union perfc_ctru - union of all perf counter types
  */
@@ -541,6 +616,7 @@ union perfc_ctru {
     struct perfc_basic   basic;
     struct perfc_rate    rate;
     struct perfc_dis     dis;
+    struct perfc_hg      hg;
 } HSE_L1D_ALIGNED;
 
 /**
@@ -611,6 +687,46 @@ perfc_lat_record_impl(struct perfc_dis *dis, u64 sample);
 void
 perfc_dis_record_impl(struct perfc_dis *dis, u64 sample);
 
+/**
+ * perfc_hg_lat_record_impl() - Record a latency sample in a histogram
+ *
+ * @hg:       histogram performance counter ptr
+ * @sample:   latency start time obtained by calling perfc_lat_start()
+ */
+void
+perfc_hg_lat_record_impl(struct perfc_hg *hg, u64 sample);
+
+/**
+ * perfc_hg_record_impl() - Record a value (in nanoseconds) in a histogram
+ *
+ * @hg:       histogram performance counter ptr
+ * @val:      value to record
+ */
+void
+perfc_hg_record_impl(struct perfc_hg *hg, u64 val);
+
+/**
+ * perfc_hg_read() - merge the per-cpu histograms of a counter and summarize
+ * @pcs:    perfc counter set handle
+ * @cidx:   counter index
+ * @stats:  (output) histogram summary
+ *
+ * Return: EINVAL if the counter is not a histogram counter, ENOENT if
+ * it is not enabled, ENOMEM if there is insufficient memory to merge
+ * the histograms.
+ */
+merr_t
+perfc_hg_read(struct perfc_set *pcs, const u32 cidx, struct perfc_hg_stats *stats);
+
+/**
+ * perfc_hg_pct_name() - name of the i'th percentile in perfc_hg_stats
+ * @i:  index into phs_pctv[]
+ *
+ * Return: a string such as "p99" or "p999" (for the 99.9th percentile)
+ */
+const char *
+perfc_hg_pct_name(uint i);
+
 /**
  * perfc_read() - return sum totals of all operations made to a counter
  * @pcs:    perfc counter set handle
@@ -625,6 +741,21 @@ perfc_dis_record_impl(struct perfc_dis *dis, u64 sample);
 void
 perfc_read(struct perfc_set *pcs, const u32 cidx, u64 *vadd, u64 *vsub);
 
+struct om_writer;
+
+/**
+ * perfc_metrics_emit() - render all enabled counters in OpenMetrics format
+ * @w:  OpenMetrics writer
+ *
+ * Counters are grouped by type into the hse_perfc_value (basic),
+ * hse_perfc (rate), hse_perfc_latency_ns (latency and histogram) and
+ * hse_perfc_dist (distribution) families.  Each sample is labeled with
+ * the counter set path relative to /data/perfc ("set") and the counter
+ * name ("name").  Disabled counters are omitted.
+ */
+void
+perfc_metrics_emit(struct om_writer *w);
+
 
 #define perfc_rec_sample perfc_dis_record
 
@@ -730,7 +861,12 @@ perfc_lat_record(struct perfc_set *pcs, const u32 cidx, const u64 start)
         return;
 
     pcsi = perfc_ison(pcs, cidx);
-    if (pcsi)
+    if (!pcsi)
+        return;
+
+    if (pcsi->pcs_ctrv[cidx].hdr.pch_type == PERFC_TYPE_HG)
+        perfc_hg_lat_record_impl(&pcsi->pcs_ctrv[cidx].hg, start);
+    else
         perfc_lat_record_impl(&pcsi->pcs_ctrv[cidx].dis, start);
 }
 
@@ -777,6 +913,19 @@ perfc_dis_record(struct perfc_set *pcs, const u32 cidx, const u64 val)
         perfc_dis_record_impl(&pcsi->pcs_ctrv[cidx].dis, val);
 }
 
+/**
+ * perfc_hg_record() - record a value (in nanoseconds) in a histogram counter
+ */
+static HSE_ALWAYS_INLINE void
+perfc_hg_record(struct perfc_set *pcs, const u32 cidx, const u64 val)
+{
+    struct perfc_seti *pcsi;
+
+    pcsi = perfc_ison(pcs, cidx);
+    if (pcsi)
+        perfc_hg_record_impl(&pcsi->pcs_ctrv[cidx].hg, val);
+}
+
 /**
  * perfc_set() - set a counter to the given value
  * @pcs:    counter set ptr
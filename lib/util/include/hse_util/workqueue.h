@@ -17,6 +17,7 @@
 #include <hse_util/list.h>
 #include <hse_util/timer.h>
 #include <hse_util/condvar.h>
+#include <hse_util/hse_err.h>
 
 #define WQ_MAX_ACTIVE (128)
 #define WQ_DFL_ACTIVE (WQ_MAX_ACTIVE / 8)
@@ -81,6 +82,16 @@ flush_workqueue(struct workqueue_struct *wq);
 void
 dump_workqueue(struct workqueue_struct *wq);
 
+/**
+ * workqueue_bind_node() - confine a workqueue's threads to a NUMA node
+ * @wq:   workqueue
+ * @node: NUMA node ID, or -1 to allow threads to run on any CPU
+ *
+ * Applies to both existing worker threads and threads created hereafter.
+ */
+merr_t
+workqueue_bind_node(struct workqueue_struct *wq, int node);
+
 /*
  * Add work to a workqueue.  Return false if work was already on a
  * queue, true otherwise.
@@ -349,11 +349,14 @@ bn_node_alloc(struct bonsai_root *tree, int height, uint skidx)
     return bn_node_alloc_impl(tree, skidx % (NELEM(tree->br_slabinfov) - 2));
 }
 
+/* Keys and values require only pointer alignment, so don't let the cheap
+ * pad them out to its (typically 16-byte) default alignment.
+ */
 static void *
 bn_alloc(struct bonsai_root *tree, size_t sz)
 {
     if (tree->br_cheap)
-        return cheap_malloc(tree->br_cheap, sz);
+        return cheap_memalign(tree->br_cheap, __alignof__(struct bonsai_kv), sz);
 
     return malloc(sz);
 }
@@ -480,6 +480,9 @@ dt_iterate_cmd(
     if (DT_OP_SET == op && (!dip || !dip->dsp))
         return 0;
 
+    if (DT_OP_VISIT == op && (!dip || !dip->dvp || !dip->dvp->dv_func))
+        return 0;
+
     dt_lock(tree);
     dt_add_pending(tree);
 
@@ -526,6 +529,13 @@ dt_iterate_cmd(
             }
             break;
 
+        case DT_OP_VISIT:
+            if ((selector && selector(dte)) || !selector) {
+                dip->dvp->dv_func(dte, dip->dvp->dv_arg);
+                ++count;
+            }
+            break;
+
         default:
             break;
         }
@@ -590,6 +600,7 @@ static struct field_name dt_field_names[] = {
     { "enabled", DT_FIELD_ENABLED },
     { "clear", DT_FIELD_CLEAR },
     { "data", DT_FIELD_DATA },
+    { "interval", DT_FIELD_INTERVAL },
     { NULL, DT_FIELD_INVALID }
 };
 
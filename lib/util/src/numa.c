@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/minmax.h>
+#include <hse_util/page.h>
+#include <hse_util/numa.h>
+
+#define NUMA_SYSFS_NODE     "/sys/devices/system/node"
+
+/* From <numaif.h>, which is part of libnuma-devel.
+ */
+#define NUMA_MPOL_PREFERRED (1)
+#define NUMA_MPOL_MF_MOVE   (1u << 1)
+
+static uint numa_nodes HSE_READ_MOSTLY;
+
+/* Read the first line of a sysfs file into buf.
+ */
+static int
+numa_sysfs_read(const char *path, char *buf, size_t bufsz)
+{
+    FILE *fp;
+    int rc = 0;
+
+    fp = fopen(path, "r");
+    if (!fp)
+        return errno;
+
+    if (fgets(buf, bufsz, fp))
+        buf[strcspn(buf, "\n")] = '\000';
+    else
+        rc = ferror(fp) ? EIO : ENODATA;
+
+    fclose(fp);
+
+    return rc;
+}
+
+/* Parse a sysfs cpu or node list (e.g., "0-3,8-11") and call fn() on each
+ * range therein.  Returns the largest ID in the list, or -1 on error.
+ */
+static int
+numa_list_parse(const char *list, void (*fn)(uint, uint, void *), void *arg)
+{
+    const char *s = list;
+    int max = -1;
+
+    while (*s) {
+        unsigned long lo, hi;
+        char *end;
+
+        lo = strtoul(s, &end, 10);
+        if (end == s)
+            return -1;
+
+        hi = lo;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtoul(s, &end, 10);
+            if (end == s || hi < lo)
+                return -1;
+        }
+
+        if (fn)
+            fn(lo, hi, arg);
+
+        max = max_t(int, max, hi);
+
+        s = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',')
+            return -1;
+    }
+
+    return max;
+}
+
+uint
+hse_numa_nodes(void)
+{
+    char buf[256];
+    int max;
+
+    if (numa_nodes > 0)
+        return numa_nodes;
+
+    max = -1;
+    if (!numa_sysfs_read(NUMA_SYSFS_NODE "/possible", buf, sizeof(buf)))
+        max = numa_list_parse(buf, NULL, NULL);
+
+    numa_nodes = clamp_t(int, max + 1, 1, HSE_NUMA_NODES_MAX);
+
+    return numa_nodes;
+}
+
+static void
+numa_cpuset_add(uint lo, uint hi, void *arg)
+{
+    cpu_set_t *set = arg;
+
+    for (; lo <= hi && lo < CPU_SETSIZE; ++lo)
+        CPU_SET(lo, set);
+}
+
+merr_t
+hse_numa_cpuset(uint node, cpu_set_t *set)
+{
+    char path[128], buf[1024];
+    int rc;
+
+    CPU_ZERO(set);
+
+    if (node >= hse_numa_nodes())
+        return merr(EINVAL);
+
+    snprintf(path, sizeof(path), NUMA_SYSFS_NODE "/node%u/cpulist", node);
+
+    rc = numa_sysfs_read(path, buf, sizeof(buf));
+    if (rc)
+        return merr(rc);
+
+    if (numa_list_parse(buf, numa_cpuset_add, set) < 0)
+        return merr(EINVAL);
+
+    return CPU_COUNT(set) > 0 ? 0 : merr(ENOENT);
+}
+
+merr_t
+hse_numa_membind(void *addr, size_t len, uint node, bool migrate)
+{
+    unsigned long nodemask;
+    uintptr_t start, end;
+    long rc;
+
+    if (node >= hse_numa_nodes() || node >= sizeof(nodemask) * CHAR_BIT)
+        return merr(EINVAL);
+
+    if (hse_numa_nodes() < 2 || len == 0)
+        return 0;
+
+    start = (uintptr_t)addr & PAGE_MASK;
+    end = PAGE_ALIGN((uintptr_t)addr + len);
+    nodemask = 1ul << node;
+
+    /* The kernel ignores the last bit of maxnode (see numa_set_membind()
+     * in libnuma), hence the extra bit.
+     */
+    rc = syscall(SYS_mbind, start, end - start, NUMA_MPOL_PREFERRED, &nodemask,
+                 sizeof(nodemask) * CHAR_BIT + 1, migrate ? NUMA_MPOL_MF_MOVE : 0);
+
+    return rc ? merr(errno) : 0;
+}
+
+int
+hse_numa_path_node(const char *path)
+{
+    static const char *const subdirv[] = {
+        "device", "device/device", "../device", "../device/device",
+    };
+    struct stat st;
+    char buf[PATH_MAX + 64], val[32];
+    int i;
+
+    if (!path || stat(path, &st))
+        return -1;
+
+    if (hse_numa_nodes() < 2)
+        return -1;
+
+    /* A partition's sysfs directory has no device link of its own, and
+     * an NVMe namespace's device link leads to the controller rather than
+     * to the PCI function, hence the search.
+     */
+    for (i = 0; i < NELEM(subdirv); ++i) {
+        long node;
+        char *end;
+
+        snprintf(buf, sizeof(buf), "/sys/dev/block/%u:%u/%s/numa_node",
+                 major(st.st_dev), minor(st.st_dev), subdirv[i]);
+
+        if (numa_sysfs_read(buf, val, sizeof(val)))
+            continue;
+
+        node = strtol(val, &end, 10);
+        if (end == val)
+            continue;
+
+        if (node >= 0 && node < hse_numa_nodes())
+            return node;
+    }
+
+    return -1;
+}
@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/event_counter.h>
+#include <hse_util/rest_api.h>
+#include <hse_util/openmetrics.h>
+
+static void
+om_flush(struct om_writer *w)
+{
+    if (w->ow_off > 0 && !w->ow_err) {
+        if (rest_write_safe(w->ow_fd, w->ow_buf, w->ow_off) != w->ow_off)
+            w->ow_err = merr(EIO);
+    }
+
+    w->ow_off = 0;
+}
+
+static HSE_PRINTF(2, 3) void
+om_printf(struct om_writer *w, const char *fmt, ...)
+{
+    va_list ap;
+    int     cc, i;
+
+    /* Try to format into the space remaining in the buffer, and if that
+     * fails flush the buffer and try once more with the whole buffer.
+     */
+    for (i = 0; i < 2 && !w->ow_err; ++i) {
+        size_t avail = w->ow_bufsz - w->ow_off;
+
+        va_start(ap, fmt);
+        cc = vsnprintf(w->ow_buf + w->ow_off, avail, fmt, ap);
+        va_end(ap);
+
+        if (cc < 0) {
+            w->ow_err = merr(EINVAL);
+            break;
+        }
+
+        if (cc < avail) {
+            w->ow_off += cc;
+            return;
+        }
+
+        if (w->ow_off == 0) {
+            w->ow_err = merr(ev(EMSGSIZE));
+            break;
+        }
+
+        om_flush(w);
+    }
+}
+
+void
+om_init(struct om_writer *w, int fd, char *buf, size_t bufsz)
+{
+    w->ow_fd = fd;
+    w->ow_buf = buf;
+    w->ow_bufsz = bufsz;
+    w->ow_off = 0;
+    w->ow_err = 0;
+}
+
+void
+om_family(struct om_writer *w, const char *name, const char *type, const char *help)
+{
+    om_printf(w, "# TYPE %s %s\n# HELP %s %s\n", name, type, name, help);
+}
+
+void
+om_sample(struct om_writer *w, const char *name, const char *labels, u64 value)
+{
+    if (labels && labels[0])
+        om_printf(w, "%s{%s} %lu\n", name, labels, (ulong)value);
+    else
+        om_printf(w, "%s %lu\n", name, (ulong)value);
+}
+
+void
+om_label(char *buf, size_t bufsz, size_t *off, const char *name, const char *value)
+{
+    size_t n = *off;
+    int    cc;
+
+    cc = snprintf(buf + n, bufsz - n, "%s%s=\"", n > 0 ? "," : "", name);
+    if (cc < 0 || cc >= bufsz - n)
+        goto drop;
+
+    n += cc;
+
+    for (; *value; ++value) {
+        const char *esc = NULL;
+
+        if (*value == '\\')
+            esc = "\\\\";
+        else if (*value == '"')
+            esc = "\\\"";
+        else if (*value == '\n')
+            esc = "\\n";
+
+        if (n + (esc ? 2 : 1) >= bufsz)
+            goto drop;
+
+        if (esc) {
+            buf[n++] = esc[0];
+            buf[n++] = esc[1];
+        } else {
+            buf[n++] = *value;
+        }
+    }
+
+    if (n + 2 > bufsz)
+        goto drop;
+
+    buf[n++] = '"';
+    buf[n] = '\000';
+    *off = n;
+    return;
+
+drop:
+    if (*off < bufsz)
+        buf[*off] = '\000';
+}
+
+merr_t
+om_finish(struct om_writer *w)
+{
+    om_printf(w, "# EOF\n");
+    om_flush(w);
+
+    return w->ow_err;
+}
@@ -18,13 +18,152 @@
 #include <hse_util/xrand.h>
 #include <hse_util/logging.h>
 #include <hse_util/perfc.h>
+#include <hse_util/openmetrics.h>
 
 static const char * const perfc_ctr_type2name[] = {
-    "Invalid", "Basic", "Rate", "Latency", "Distribution", "SimpleLatency",
+    "Invalid", "Basic", "Rate", "Latency", "Distribution", "SimpleLatency", "Histogram",
+};
+
+/* Percentiles reported by histogram counters, in parts per million.
+ */
+static const u32 perfc_hg_pctv[PERFC_HG_PCTC] = {
+    500000, 900000, 990000, 999000, 999900,
+};
+
+static const char * const perfc_hg_pct_namev[PERFC_HG_PCTC] = {
+    "p50", "p90", "p99", "p999", "p9999",
 };
 
 struct perfc_ivl *perfc_di_ivl HSE_READ_MOSTLY;
 
+#define PERFC_HG_SUB_HALF   (1u << (PERFC_HG_SUB_SHIFT - 1))
+
+/* Map a value to its index in phgg_cntv[].  Values less than twice the
+ * sub-bucket half count map to themselves, beyond that each power-of-two
+ * range of values is split into PERFC_HG_SUB_HALF equal width buckets.
+ */
+static HSE_ALWAYS_INLINE uint
+perfc_hg_val2idx(u64 val)
+{
+    uint shift;
+
+    if (val > PERFC_HG_VAL_MAX)
+        val = PERFC_HG_VAL_MAX;
+
+    shift = ilog2(val | ((1u << PERFC_HG_SUB_SHIFT) - 1)) - (PERFC_HG_SUB_SHIFT - 1);
+
+    return (shift << (PERFC_HG_SUB_SHIFT - 1)) + (val >> shift);
+}
+
+/* Return the smallest value that maps to the given index.
+ */
+static u64
+perfc_hg_idx2lo(uint idx)
+{
+    uint shift = 0;
+
+    if (idx >= 2 * PERFC_HG_SUB_HALF)
+        shift = idx / PERFC_HG_SUB_HALF - 1;
+
+    return (u64)(idx - shift * PERFC_HG_SUB_HALF) << shift;
+}
+
+/* Return the largest value that maps to the given index.
+ */
+static u64
+perfc_hg_idx2hi(uint idx)
+{
+    return idx + 1 < PERFC_HG_BKT_MAX ? perfc_hg_idx2lo(idx + 1) - 1 : PERFC_HG_VAL_MAX;
+}
+
+static void
+perfc_hg_clear(struct perfc_hg *hg)
+{
+    struct perfc_hgrp *grpv;
+    u64                vtmp;
+    int                i, j;
+
+    hg->phg_reset_ns = get_time_ns();
+
+    grpv = atomic_read_acq(&hg->phg_grpv);
+    if (!grpv)
+        return;
+
+    for (j = 0; j < PERFC_GRP_MAX; ++j) {
+        struct perfc_hgrp *grp = grpv + j;
+
+        vtmp = atomic_read(&grp->phgg_sum);
+        atomic_sub(&grp->phgg_sum, vtmp);
+
+        for (i = 0; i < PERFC_HG_BKT_MAX; ++i) {
+            vtmp = atomic_read(&grp->phgg_cntv[i]);
+            if (vtmp)
+                atomic_sub(&grp->phgg_cntv[i], vtmp);
+        }
+    }
+}
+
+static merr_t
+perfc_hg_summarize(struct perfc_hg *hg, struct perfc_hg_stats *stats)
+{
+    struct perfc_hgrp *grpv;
+    u64               *cntv;
+    u64                cum;
+    int                i, j, k;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->phs_ivl_ns = get_time_ns() - hg->phg_reset_ns;
+
+    grpv = atomic_read_acq(&hg->phg_grpv);
+    if (!grpv)
+        return 0;
+
+    cntv = calloc(PERFC_HG_BKT_MAX, sizeof(*cntv));
+    if (ev(!cntv))
+        return merr(ENOMEM);
+
+    for (j = 0; j < PERFC_GRP_MAX; ++j) {
+        const struct perfc_hgrp *grp = grpv + j;
+
+        stats->phs_sum += atomic_read(&grp->phgg_sum);
+
+        for (i = 0; i < PERFC_HG_BKT_MAX; ++i)
+            cntv[i] += atomic_read(&grp->phgg_cntv[i]);
+    }
+
+    for (i = 0; i < PERFC_HG_BKT_MAX; ++i) {
+        if (!cntv[i])
+            continue;
+
+        if (!stats->phs_hits)
+            stats->phs_min = perfc_hg_idx2lo(i);
+        stats->phs_max = perfc_hg_idx2hi(i);
+        stats->phs_hits += cntv[i];
+    }
+
+    /* Each percentile is reported as the largest value equivalent to
+     * the sample at its rank, as does HdrHistogram.
+     */
+    for (cum = i = k = 0; i < PERFC_HG_BKT_MAX && k < PERFC_HG_PCTC; ++i) {
+        cum += cntv[i];
+
+        while (k < PERFC_HG_PCTC && cum > 0 &&
+               cum * 1000000 >= stats->phs_hits * perfc_hg_pctv[k]) {
+            stats->phs_pctv[k++] = perfc_hg_idx2hi(i);
+        }
+    }
+
+    free(cntv);
+
+    return 0;
+}
+
+const char *
+perfc_hg_pct_name(uint i)
+{
+    return i < PERFC_HG_PCTC ? perfc_hg_pct_namev[i] : "invalid";
+}
+
 /**
  * perfc_ctrseti_clear() - Clear a counter set instance.
  * @seti:
@@ -96,6 +235,10 @@ perfc_ctrseti_clear(struct perfc_seti *seti)
             }
             break;
 
+        case PERFC_TYPE_HG:
+            perfc_hg_clear(&seti->pcs_ctrv[cidx].hg);
+            break;
+
         case PERFC_TYPE_SL:
         case PERFC_TYPE_BA:
         default:
@@ -122,6 +265,29 @@ perfc_set_handler_ctrset(struct dt_element *dte, struct dt_set_parameters *dsp)
         return seti->pcs_ctrc;
     }
 
+    /* Set the reset interval (in milliseconds) of all histogram counters
+     * in the set.  A histogram whose interval has elapsed is cleared after
+     * it is next read, so each read reports the latest interval only.
+     */
+    if (dsp->field == DT_FIELD_INTERVAL) {
+        u64 ms;
+
+        if (ev_err(!dsp->value || parse_u64(dsp->value, &ms)))
+            return 0;
+
+        for (uint cidx = 0; cidx < seti->pcs_ctrc; ++cidx) {
+            struct perfc_hg *hg = &seti->pcs_ctrv[cidx].hg;
+
+            if (hg->phg_hdr.pch_type != PERFC_TYPE_HG)
+                continue;
+
+            hg->phg_ivl_ns = ms * 1000000;
+            ++nchanged;
+        }
+
+        return nchanged;
+    }
+
     if (dsp->field == DT_FIELD_ENABLED) {
         struct perfc_set *setp = seti->pcs_handle;
         char *endptr = NULL;
@@ -317,6 +483,51 @@ perfc_di_emit(struct perfc_dis *dis, struct yaml_context *yc)
     yaml_element_field(yc, "bkts", bktstr);
 }
 
+static void
+perfc_hg_emit(struct perfc_hg *hg, struct yaml_context *yc)
+{
+    struct perfc_hg_stats stats;
+    char                  value[DT_PATH_MAX];
+    merr_t                err;
+    int                   i;
+
+    err = perfc_hg_summarize(hg, &stats);
+    if (err)
+        return;
+
+    u64_to_string(value, sizeof(value), stats.phs_min);
+    yaml_element_field(yc, "min", value);
+
+    u64_to_string(value, sizeof(value), stats.phs_max);
+    yaml_element_field(yc, "max", value);
+
+    u64_to_string(value, sizeof(value), stats.phs_hits ? stats.phs_sum / stats.phs_hits : 0);
+    yaml_element_field(yc, "average", value);
+
+    /* 'sum' and 'hitcnt' field names must match those of the
+     * distribution and simple latency counters.
+     */
+    u64_to_string(value, sizeof(value), stats.phs_sum);
+    yaml_element_field(yc, "sum", value);
+
+    u64_to_string(value, sizeof(value), stats.phs_hits ?: 1);
+    yaml_element_field(yc, "hitcnt", value);
+
+    for (i = 0; i < PERFC_HG_PCTC; ++i) {
+        u64_to_string(value, sizeof(value), stats.phs_pctv[i]);
+        yaml_element_field(yc, perfc_hg_pct_namev[i], value);
+    }
+
+    u64_to_string(value, sizeof(value), hg->phg_pct * 100 / PERFC_PCT_SCALE);
+    yaml_element_field(yc, "pct", value);
+
+    u64_to_string(value, sizeof(value), stats.phs_ivl_ns);
+    yaml_element_field(yc, "interval_ns", value);
+
+    if (hg->phg_ivl_ns > 0 && stats.phs_ivl_ns >= hg->phg_ivl_ns)
+        perfc_hg_clear(hg);
+}
+
 static void
 perfc_read_hdr(struct perfc_ctr_hdr *hdr, u64 *vadd, u64 *vsub)
 {
@@ -346,6 +557,21 @@ perfc_read(struct perfc_set *pcs, const u32 cidx, u64 *vadd, u64 *vsub)
         perfc_read_hdr(&pcsi->pcs_ctrv[cidx].hdr, vadd, vsub);
 }
 
+merr_t
+perfc_hg_read(struct perfc_set *pcs, const u32 cidx, struct perfc_hg_stats *stats)
+{
+    struct perfc_seti *pcsi;
+
+    pcsi = perfc_ison(pcs, cidx);
+    if (!pcsi)
+        return merr(ENOENT);
+
+    if (pcsi->pcs_ctrv[cidx].hdr.pch_type != PERFC_TYPE_HG)
+        return merr(EINVAL);
+
+    return perfc_hg_summarize(&pcsi->pcs_ctrv[cidx].hg, stats);
+}
+
 static size_t
 perfc_emit_handler_ctrset(struct dt_element *dte, struct yaml_context *yc)
 {
@@ -415,6 +641,10 @@ perfc_emit_handler_ctrset(struct dt_element *dte, struct yaml_context *yc)
             perfc_di_emit(&seti->pcs_ctrv[cidx].dis, yc);
             break;
 
+        case PERFC_TYPE_HG:
+            perfc_hg_emit(&seti->pcs_ctrv[cidx].hg, yc);
+            break;
+
         default:
             break;
         }
@@ -449,6 +679,170 @@ perfc_emit_handler(struct dt_element *dte, struct yaml_context *yc)
     return perfc_emit_handler_ctrset(dte, yc);
 }
 
+struct perfc_om_family {
+    const char *pof_name;
+    const char *pof_type;
+    const char *pof_help;
+    u32         pof_typemask;
+};
+
+static const struct perfc_om_family perfc_om_familyv[] = {
+    { "hse_perfc_value", "gauge", "HSE basic performance counters",
+      1u << PERFC_TYPE_BA },
+    { "hse_perfc", "counter", "HSE rate performance counters",
+      1u << PERFC_TYPE_RA },
+    { "hse_perfc_latency_ns", "summary", "HSE latency performance counters",
+      (1u << PERFC_TYPE_LT) | (1u << PERFC_TYPE_SL) | (1u << PERFC_TYPE_HG) },
+    { "hse_perfc_dist", "summary", "HSE distribution performance counters",
+      1u << PERFC_TYPE_DI },
+};
+
+static const char * const perfc_hg_quantile_namev[PERFC_HG_PCTC] = {
+    "0.5", "0.9", "0.99", "0.999", "0.9999"
+};
+
+struct perfc_om_args {
+    struct om_writer             *poa_writer;
+    const struct perfc_om_family *poa_family;
+};
+
+static void
+perfc_dis_read(struct perfc_dis *dis, u64 *sum, u64 *hits)
+{
+    int i, j;
+
+    *sum = *hits = 0;
+
+    for (i = 0; i < dis->pdi_ivl->ivl_cnt + 1; ++i) {
+        struct perfc_bkt *bkt = dis->pdi_hdr.pch_bktv + i;
+
+        for (j = 0; j < PERFC_GRP_MAX; ++j) {
+            *sum += atomic_read(&bkt->pcb_vadd);
+            *hits += atomic_read(&bkt->pcb_hits);
+            bkt += PERFC_IVL_MAX + 1;
+        }
+    }
+}
+
+static void
+perfc_om_summary(struct om_writer *w, const char *name, const char *labels, u64 sum, u64 hits)
+{
+    char sname[64];
+
+    snprintf(sname, sizeof(sname), "%s_sum", name);
+    om_sample(w, sname, labels, sum);
+
+    snprintf(sname, sizeof(sname), "%s_count", name);
+    om_sample(w, sname, labels, hits);
+}
+
+static void
+perfc_om_visit(struct dt_element *dte, void *arg)
+{
+    const struct perfc_om_args *args = arg;
+    const char                 *name = args->poa_family->pof_name;
+    struct om_writer           *w = args->poa_writer;
+    struct perfc_seti          *seti = dte->dte_data;
+    const char                 *set;
+    char                        sname[64];
+    u64                         bitmap;
+    u32                         cidx;
+
+    if (!seti->pcs_handle || strlen(dte->dte_path) < sizeof(DT_PATH_PERFC))
+        return;
+
+    set = dte->dte_path + sizeof(DT_PATH_PERFC);
+    bitmap = seti->pcs_handle->ps_bitmap;
+
+    for (cidx = 0; cidx < seti->pcs_ctrc; cidx++) {
+        union perfc_ctru     *ctr = seti->pcs_ctrv + cidx;
+        struct perfc_hg_stats stats;
+        char                  labels[OM_LABELS_MAX];
+        size_t                off = 0;
+        u64                   vadd, vsub;
+        int                   i;
+
+        if (!(bitmap & (1ul << cidx)))
+            continue;
+
+        if (!(args->poa_family->pof_typemask & (1u << ctr->hdr.pch_type)))
+            continue;
+
+        om_label(labels, sizeof(labels), &off, "set", set);
+        om_label(labels, sizeof(labels), &off, "name", seti->pcs_ctrnamev[cidx].pcn_name);
+
+        switch (ctr->hdr.pch_type) {
+        case PERFC_TYPE_BA:
+            perfc_read_hdr(&ctr->hdr, &vadd, &vsub);
+            om_sample(w, name, labels, vadd > vsub ? vadd - vsub : 0);
+            break;
+
+        case PERFC_TYPE_RA:
+            perfc_read_hdr(&ctr->hdr, &vadd, &vsub);
+            snprintf(sname, sizeof(sname), "%s_total", name);
+            om_sample(w, sname, labels, vadd > vsub ? vadd - vsub : 0);
+            break;
+
+        case PERFC_TYPE_SL:
+            perfc_read_hdr(&ctr->hdr, &vadd, &vsub);
+            perfc_om_summary(w, name, labels, vadd, vsub);
+            break;
+
+        case PERFC_TYPE_LT:
+        case PERFC_TYPE_DI:
+            perfc_dis_read(&ctr->dis, &vadd, &vsub);
+            perfc_om_summary(w, name, labels, vadd, vsub);
+            break;
+
+        case PERFC_TYPE_HG:
+            if (perfc_hg_summarize(&ctr->hg, &stats))
+                break;
+
+            for (i = 0; i < PERFC_HG_PCTC; ++i) {
+                char   qlabels[OM_LABELS_MAX];
+                size_t qoff = off;
+
+                memcpy(qlabels, labels, off + 1);
+                om_label(qlabels, sizeof(qlabels), &qoff, "quantile", perfc_hg_quantile_namev[i]);
+                om_sample(w, name, qlabels, stats.phs_pctv[i]);
+            }
+
+            perfc_om_summary(w, name, labels, stats.phs_sum, stats.phs_hits);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+static int
+perfc_om_selector(struct dt_element *dte)
+{
+    return dte->dte_type == DT_TYPE_PERFC;
+}
+
+void
+perfc_metrics_emit(struct om_writer *w)
+{
+    struct dt_visit_parameters  dvp = { .dv_func = perfc_om_visit };
+    union dt_iterate_parameters dip = { .dvp = &dvp };
+    int                         i;
+
+    /* All samples of a family must be contiguous, so walk the tree
+     * once per family.
+     */
+    for (i = 0; i < NELEM(perfc_om_familyv); ++i) {
+        const struct perfc_om_family *fam = perfc_om_familyv + i;
+        struct perfc_om_args          args = { .poa_writer = w, .poa_family = fam };
+
+        dvp.dv_arg = &args;
+
+        om_family(w, fam->pof_name, fam->pof_type, fam->pof_help);
+        dt_iterate_cmd(DT_OP_VISIT, DT_PATH_PERFC, &dip, perfc_om_selector, NULL, NULL);
+    }
+}
+
 /**
  * perfc_remove_handler_ctrset()
  * @dte:
@@ -458,6 +852,16 @@ perfc_emit_handler(struct dt_element *dte, struct yaml_context *yc)
 static size_t
 perfc_remove_handler_ctrset(struct dt_element *dte)
 {
+    struct perfc_seti *seti = dte->dte_data;
+    u32                cidx;
+
+    for (cidx = 0; cidx < seti->pcs_ctrc; ++cidx) {
+        struct perfc_hg *hg = &seti->pcs_ctrv[cidx].hg;
+
+        if (hg->phg_hdr.pch_type == PERFC_TYPE_HG)
+            free_aligned(atomic_read(&hg->phg_grpv));
+    }
+
     free_aligned(dte->dte_data);
     free(dte);
 
@@ -620,7 +1024,7 @@ perfc_ivl_destroy(const struct perfc_ivl *ivl)
 static enum perfc_type
 perfc_ctr_name2type(const char *ctrname, char *type, char *family, char *mean)
 {
-    static const char list[] = "BA,RA,LT,DI,SL"; /* must be in perfc_type order */
+    static const char list[] = "BA,RA,LT,DI,SL,HG"; /* must be in perfc_type order */
     const char *pc;
     int n;
 
@@ -655,7 +1059,7 @@ perfc_alloc_impl(
     size_t valdatasz, sz;
     size_t familylen;
     merr_t err = 0;
-    u32 n, i;
+    u32 n, ndis, i;
     int rc;
 
     if (!group || !ctrv || ctrc < 1 || ctrc > PERFC_CTRS_MAX || !setp)
@@ -677,7 +1081,7 @@ perfc_alloc_impl(
      *
      * PERFC_<type>_<family>_<meaning>
      *
-     * <type>     one of "BA", "RA", "LT", "DI", "SI"
+     * <type>     one of "BA", "RA", "LT", "DI", "SL", "HG"
      * <family>   [A-Z0-9]+
      * <meaning>  [_A-Z0-9]+
      *
@@ -752,14 +1156,20 @@ perfc_alloc_impl(
     sz = sizeof(*seti) + sizeof(seti->pcs_ctrv[0]) * ctrc;
     sz = roundup(sz, HSE_ACP_LINESIZE);
 
-    for (n = i = 0; i < ctrc; ++i) {
+    /* Distribution counters each need a full per-cpu value vector,
+     * whereas basic, rate and simple latency counters share them.
+     * Histogram counters allocate their own data on first use.
+     */
+    for (n = ndis = i = 0; i < ctrc; ++i) {
         enum perfc_type type = typev[i];
 
-        if (!(type == PERFC_TYPE_DI || type == PERFC_TYPE_LT))
+        if (type == PERFC_TYPE_DI || type == PERFC_TYPE_LT)
+            ++ndis;
+        else if (type != PERFC_TYPE_HG)
             ++n;
     }
 
-    n = ctrc - n + (roundup(n, 4) / 4) + 1;
+    n = ndis + (roundup(n, 4) / 4) + 1;
 
     valdatasz = sizeof(struct perfc_val) * PERFC_VALPERCNT * PERFC_VALPERCPU * n + 1;
 
@@ -815,6 +1225,11 @@ perfc_alloc_impl(
 
             pch->pch_bktv = valdata;
             valdata += sizeof(struct perfc_val) * PERFC_VALPERCNT * PERFC_VALPERCPU;
+        } else if (type == PERFC_TYPE_HG) {
+            struct perfc_hg *hg = &seti->pcs_ctrv[i].hg;
+
+            hg->phg_pct = entry->pcn_samplepct * PERFC_PCT_SCALE / 100;
+            hg->phg_reset_ns = get_time_ns();
         } else {
             if (!valcur || (n % PERFC_VALPERCPU) == 0) {
                 valcur = valdata;
@@ -930,6 +1345,57 @@ perfc_dis_record_impl(struct perfc_dis *dis, u64 sample)
         perfc_latdis_record(dis, sample);
 }
 
+static struct perfc_hgrp *
+perfc_hg_grpv_alloc(struct perfc_hg *hg)
+{
+    struct perfc_hgrp *grpv, *old = NULL;
+    size_t             sz;
+
+    sz = sizeof(*grpv) * PERFC_GRP_MAX;
+
+    grpv = alloc_aligned(sz, HSE_ACP_LINESIZE);
+    if (ev(!grpv))
+        return NULL;
+
+    memset(grpv, 0, sz);
+
+    /* Another thread may have beaten us to it...
+     */
+    if (!atomic_cmpxchg(&hg->phg_grpv, &old, grpv)) {
+        free_aligned(grpv);
+        grpv = old;
+    }
+
+    return grpv;
+}
+
+void
+perfc_hg_record_impl(struct perfc_hg *hg, u64 val)
+{
+    struct perfc_hgrp *grp;
+
+    assert(hg->phg_hdr.pch_type == PERFC_TYPE_HG);
+
+    grp = atomic_read_acq(&hg->phg_grpv);
+    if (HSE_UNLIKELY(!grp)) {
+        grp = perfc_hg_grpv_alloc(hg);
+        if (!grp)
+            return;
+    }
+
+    grp += hse_getcpu(NULL) % PERFC_GRP_MAX;
+
+    atomic_add(&grp->phgg_sum, val);
+    atomic_inc(&grp->phgg_cntv[perfc_hg_val2idx(val)]);
+}
+
+void
+perfc_hg_lat_record_impl(struct perfc_hg *hg, u64 sample)
+{
+    if (sample % PERFC_PCT_SCALE < hg->phg_pct)
+        perfc_hg_record_impl(hg, cycles_to_nsecs(get_cycles() - sample));
+}
+
 #if HSE_MOCKING
 #include "perfc_ut_impl.i"
 #endif /* HSE_MOCKING */
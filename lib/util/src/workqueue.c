@@ -14,6 +14,7 @@
 #include <hse_util/rest_api.h>
 #include <hse_util/list.h>
 #include <hse_util/atomic.h>
+#include <hse_util/numa.h>
 
 #include <hse_ikvdb/hse_gparams.h>
 
@@ -68,6 +69,7 @@ struct wq_barrier {
  * @wq_tdmin:       minimum number of worker threads
  * @wq_barid:       barrier ID generator
  * @wq_tcdelay:     delay in milliseconds between thread-create operations
+ * @wq_node:        NUMA node to which worker threads are bound (-1 if none)
  * @wq_idle:        condvar where idle worker threads wait
  * @wq_barrier:     condvar where all threads wait for barrier completion
  * @wq_delayed:     list of work to be dispatched in the future
@@ -86,6 +88,7 @@ struct workqueue_struct {
     int               wq_tdmin;
     uint              wq_barid;
     uint              wq_tcdelay;
+    int               wq_node;
     struct cv         wq_idle;
     struct cv         wq_barrier;
     struct list_head  wq_delayed;
@@ -199,6 +202,7 @@ alloc_workqueue(const char *fmt, unsigned int flags, int min_active, int max_act
 
     setup_timer(&wq->wq_grow, grow_workqueue_cb, wq);
     wq->wq_tcdelay = msecs_to_jiffies(1000);
+    wq->wq_node = -1;
 
     /* refcnt, tdcnt, tdmin, and tdmax are initialized to prevent
      * threads entering worker_thread() from exiting until after
@@ -285,6 +289,35 @@ destroy_workqueue(struct workqueue_struct *wq)
     free(wq);
 }
 
+merr_t
+workqueue_bind_node(struct workqueue_struct *wq, int node)
+{
+    struct wq_priv *priv;
+    cpu_set_t cpuset;
+    merr_t err = 0;
+
+    if (node >= 0) {
+        err = hse_numa_cpuset(node, &cpuset);
+        if (err)
+            return err;
+    } else {
+        CPU_ZERO(&cpuset);
+        for (int i = 0; i < get_nprocs_conf() && i < CPU_SETSIZE; ++i)
+            CPU_SET(i, &cpuset);
+    }
+
+    mutex_lock(&hse_wg.wg_lock);
+    wq->wq_node = node;
+
+    list_for_each_entry(priv, &hse_wg.wg_tlist, wp_link) {
+        if (priv->wp_wq == wq && sched_setaffinity(priv->wp_tid, sizeof(cpuset), &cpuset))
+            err = merr(errno);
+    }
+    mutex_unlock(&hse_wg.wg_lock);
+
+    return err;
+}
+
 static HSE_ALWAYS_INLINE bool
 work_pending(const struct work_struct *work)
 {
@@ -375,8 +408,9 @@ worker_thread(void *arg)
 {
     struct workqueue_struct *wq = arg;
     struct wq_priv *priv = &hse_wp_tls;
+    cpu_set_t cpuset;
     sigset_t sigset;
-    int timedout;
+    int timedout, node;
 
     sigfillset(&sigset);
     pthread_sigmask(SIG_BLOCK, &sigset, NULL);
@@ -393,10 +427,17 @@ worker_thread(void *arg)
     priv->wp_calls = 0;
     priv->wp_wmesgp = &hse_wmesg_tls;
 
+    /* Check for a node binding only after we're visible on the global
+     * thread list so that we cannot miss a concurrent workqueue_bind_node().
+     */
     mutex_lock(&hse_wg.wg_lock);
     list_add_tail(&priv->wp_link, &hse_wg.wg_tlist);
+    node = wq->wq_node;
     mutex_unlock(&hse_wg.wg_lock);
 
+    if (node >= 0 && !hse_numa_cpuset(node, &cpuset))
+        pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+
     mutex_lock(&wq->wq_lock);
     timedout = 0;
 
@@ -757,7 +757,7 @@ wal_open(
     wal->wiocb.iocb = wal_ionotify_cb;
     wal->wiocb.cbarg = wal;
     wal->wbs = wal_bufset_open(wal->wfset, wal->dur_bufsz, wal->dur_bytes,
-                               &wal->wal_ingestgen, &wal->wiocb);
+                               &wal->wal_ingestgen, &wal->wiocb, rp->numa_mode);
     if (!wal->wbs) {
         err = merr(ENOMEM);
         goto errout;
@@ -869,6 +869,15 @@ wal_throttle_sensor(struct wal *wal, struct throttle_sensor *sensor)
         wal->wal_thr_sensor = sensor;
 }
 
+void
+wal_buffer_usage(struct wal *wal, uint64_t *bufsz, uint64_t *buflen)
+{
+    *bufsz = *buflen = 0;
+
+    if (wal && wal->wbs)
+        wal_bufset_usage(wal->wbs, bufsz, buflen);
+}
+
 /*
  * get/set interfaces for struct wal fields
  */
@@ -10,6 +10,7 @@
 #include <hse_util/xrand.h>
 #include <hse_util/slab.h>
 #include <hse_util/storage.h>
+#include <hse_util/numa.h>
 
 #include "wal.h"
 #include "wal_omf.h"
@@ -44,8 +45,13 @@ struct wal_buffer {
     atomic_ulong wb_genoffv[32];
 };
 
+/* In NUMA mode each group of WAL_BPN_MAX buffers is flushed by its own
+ * workqueue whose threads are bound to the node on which the buffers'
+ * memory resides, otherwise all buffers share wbs_flushwqv[0].
+ */
 struct wal_bufset {
-    struct workqueue_struct *wbs_flushwq;
+    struct workqueue_struct *wbs_flushwqv[WAL_NODE_MAX];
+    bool                     wbs_numa;
 
     uint32_t    wbs_buf_durbytes;
 
@@ -226,12 +232,13 @@ wal_bufset_open(
     size_t              bufsz,
     uint32_t            dur_bytes,
     atomic_ulong       *ingestgen,
-    struct wal_iocb    *iocb)
+    struct wal_iocb    *iocb,
+    bool                numa)
 {
     struct wal_bufset *wbs;
     uint32_t i, j, k;
     size_t sz;
-    uint32_t threads;
+    uint32_t threads, nodes;
     merr_t err;
 
     sz = sizeof(*wbs) + sizeof(*wbs->wbs_bufv) * WAL_NODE_MAX * WAL_BPN_MAX;
@@ -243,6 +250,9 @@ wal_bufset_open(
     memset(wbs, 0, sz);
     atomic_set(&wbs->wbs_err, 0);
     wbs->wbs_ingestgen = ingestgen;
+    wbs->wbs_numa = numa;
+
+    nodes = hse_numa_nodes();
 
     wbs->wbs_buf_sz = bufsz;
     wbs->wbs_buf_allocsz = ALIGN(bufsz + wal_reclen(WAL_VERSION) + HSE_KVS_KEY_LEN_MAX +
@@ -280,6 +290,12 @@ wal_bufset_open(
             if (!wb->wb_buf)
                 goto errout;
 
+            /* Buffer group i is used only by threads running on node i
+             * (modulo WAL_NODE_MAX), so keep its memory local to them.
+             */
+            if (numa)
+                hse_numa_membind(wb->wb_buf, wbs->wbs_buf_allocsz, i % nodes, true);
+
             wbs->wbs_bufc++;
         }
     }
@@ -302,9 +318,22 @@ wal_bufset_open(
      * application expects WAL to recover all its data before the last timer sync, i.e.,
      * the app. doesn't issue periodic kvdb syncs using hse_kvdb_sync().
      */
-    wbs->wbs_flushwq = alloc_workqueue("hse_wal_flush", 0, threads, threads);
-    if (!wbs->wbs_flushwq)
-        goto errout;
+    if (numa) {
+        for (i = 0; i < WAL_NODE_MAX; ++i) {
+            wbs->wbs_flushwqv[i] = alloc_workqueue("hse_wal_flush%u", 0, WAL_BPN_MAX,
+                                                   WAL_BPN_MAX, i);
+            if (!wbs->wbs_flushwqv[i])
+                goto errout;
+
+            err = workqueue_bind_node(wbs->wbs_flushwqv[i], i % nodes);
+            if (err)
+                log_warnx("unable to bind wal flush threads to node %u: @@e", err, i % nodes);
+        }
+    } else {
+        wbs->wbs_flushwqv[0] = alloc_workqueue("hse_wal_flush", 0, threads, threads);
+        if (!wbs->wbs_flushwqv[0])
+            goto errout;
+    }
 
     err = wal_io_init(threads);
     if (err)
@@ -346,7 +375,10 @@ wal_bufset_close(struct wal_bufset *wbs)
     if (!wbs)
         return;
 
-    destroy_workqueue(wbs->wbs_flushwq);
+    for (int i = 0; i < WAL_NODE_MAX; ++i) {
+        if (wbs->wbs_flushwqv[i])
+            destroy_workqueue(wbs->wbs_flushwqv[i]);
+    }
 
     for (int i = 0; i < wbs->wbs_bufc; ++i) {
         struct wal_buffer *wb = wbs->wbs_bufv + i;
@@ -474,15 +506,12 @@ wal_bufset_reclaim(struct wal_bufset *wbs, uint64_t gen)
 merr_t
 wal_bufset_flush(struct wal_bufset *wbs, struct wal_flush_stats *wbfsp)
 {
-    struct workqueue_struct *wq;
     merr_t err;
     uint32_t i;
 
     if (!wbs)
         return merr(EINVAL);
 
-    wq = wbs->wbs_flushwq;
-
     memset(wbfsp, 0, sizeof(*wbfsp));
 
     for (i = 0; i < wbs->wbs_bufc; ++i) {
@@ -492,11 +521,17 @@ wal_bufset_flush(struct wal_bufset *wbs, struct wal_flush_stats *wbfsp)
 
         if (wb->wb_buf && atomic_read(&wb->wb_offset_head) > PAGE_SIZE &&
             atomic_cas(&wb->wb_flushing, 0, 1)) {
+            uint32_t qidx = wbs->wbs_numa ? i / WAL_BPN_MAX : 0;
+
             atomic_set(&wb->wb_flushb, 0);
-            queue_work(wq, &wb->wb_fwork);
+            queue_work(wbs->wbs_flushwqv[qidx], &wb->wb_fwork);
         }
     }
-    flush_workqueue(wq);
+
+    for (i = 0; i < WAL_NODE_MAX; ++i) {
+        if (wbs->wbs_flushwqv[i])
+            flush_workqueue(wbs->wbs_flushwqv[i]);
+    }
 
     if ((err = atomic_read(&wbs->wbs_err)))
         return err;
@@ -567,6 +602,22 @@ wal_bufset_genoff(struct wal_bufset *wbs, uint64_t gen, uint32_t offc, uint64_t
     return wbs->wbs_bufc;
 }
 
+void
+wal_bufset_usage(struct wal_bufset *wbs, uint64_t *bufsz, uint64_t *buflen)
+{
+    *bufsz = wbs->wbs_buf_sz * wbs->wbs_bufc;
+    *buflen = 0;
+
+    for (int i = 0; i < wbs->wbs_bufc; ++i) {
+        struct wal_buffer *wb = wbs->wbs_bufv + i;
+        uint64_t head, tail;
+
+        tail = atomic_read_acq(&wb->wb_offset_tail);
+        head = atomic_read(&wb->wb_offset_head);
+        *buflen += head - tail;
+    }
+}
+
 uint32_t
 wal_bufset_durcnt(struct wal_bufset *wbs, uint32_t offc, uint64_t *offv)
 {
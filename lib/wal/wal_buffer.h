@@ -18,7 +18,8 @@ wal_bufset_open(
     size_t              bufsz,
     uint32_t            dur_bytes,
     atomic_ulong       *ingestgen,
-    struct wal_iocb    *iocb);
+    struct wal_iocb    *iocb,
+    bool                numa);
 
 void
 wal_bufset_close(struct wal_bufset *wbs);
@@ -57,4 +58,7 @@ wal_bufset_flushoff(struct wal_bufset *wbs, uint32_t offc, uint64_t *offv);
 uint32_t
 wal_bufset_genoff(struct wal_bufset *wbs, uint64_t gen, uint32_t offc, uint64_t *offv);
 
+void
+wal_bufset_usage(struct wal_bufset *wbs, uint64_t *bufsz, uint64_t *buflen);
+
 #endif /* WAL_BUFFER_H */
@@ -15,8 +15,10 @@
 
 #include <hse_ikvdb/kvs.h>
 #include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/cursor.h>
 #include <cn/cn_cursor.h>
 #include <hse_ikvdb/c0.h>
+#include <hse_ikvdb/c0_kvset.h>
 #include <hse_ikvdb/cndb.h>
 #include <hse_ikvdb/wal.h>
 #include <hse_ikvdb/kvdb_health.h>
@@ -97,6 +99,7 @@ struct mock_cn_cursor {
     struct element_source es;
     struct kvs_cursor_element elem;
     struct c0_data *data;
+    const struct kc_pred *pred;
     u64             seqno;
     int             pfx_len;
     int             i;
@@ -377,6 +380,24 @@ _c0_del(struct c0 *handle, struct kvs_ktuple *kt, const uintptr_t seqno)
     return 0;
 }
 
+static merr_t
+_c0_putdel_batch(struct c0kvs_batch_ent **entv, uint entc, uintptr_t seqnoref)
+{
+    merr_t err = 0;
+    uint   i;
+
+    for (i = 0; i < entc && !err; ++i) {
+        struct c0kvs_batch_ent *ent = entv[i];
+
+        if (ent->cbe_del)
+            err = _c0_del(ent->cbe_c0, &ent->cbe_kt, seqnoref);
+        else
+            err = _c0_put(ent->cbe_c0, &ent->cbe_kt, &ent->cbe_vt, seqnoref);
+    }
+
+    return err;
+}
+
 static merr_t
 _c0_prefix_del(struct c0 *handle, struct kvs_ktuple *kt, u64 seqno)
 {
@@ -482,6 +503,7 @@ _cn_cursor_create(
     struct cn *            cn,
     u64                    seqno,
     bool                   reverse,
+    bool                   keys_only,
     const void *           prefix,
     u32                    pfx_len,
     struct cursor_summary *summary,
@@ -515,6 +537,7 @@ _cn_cursor_create(
     cur->seqno = seqno;
     cur->i = 0;
     cur->data = mn->data;
+    cur->pred = NULL;
     cur->cn = mn;
 
     if (mn->data)
@@ -565,6 +588,11 @@ _cn_cursor_read(struct cn_cursor *cursor, struct kvs_cursor_element *elem, bool
                 continue;
 
             key2kobj(&elem->kce_kobj, d->key, d->klen);
+
+            /* Filter like kvset_cursor_next() does for the real cn */
+            if (cur->pred && !kc_pred_match(cur->pred, &elem->kce_kobj))
+                continue;
+
             kvs_vtuple_init(&elem->kce_vt, (void *)d->val, d->xlen);
             *eof = false;
 
@@ -585,6 +613,8 @@ _cn_cursor_seek(
 {
     struct mock_cn_cursor *cur = (void *)cursor;
 
+    cur->pred = filter ? filter->kcf_pred : NULL;
+
     if (!cur->data)
         goto missed;
 
@@ -650,6 +680,7 @@ _cn_cursor_active_kvsets(struct cn_cursor *cursor, u32 *active, u32 *total)
 static struct mapi_injection cn_inject_list[] = {
 
     { mapi_idx_cn_make,              MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cn_drop,              MAPI_RC_SCALAR, 0 },
     { mapi_idx_cn_ingestv,           MAPI_RC_SCALAR, 0 },
     { mapi_idx_cn_get_sfx_len,       MAPI_RC_SCALAR, 0 },
     { mapi_idx_cn_periodic,          MAPI_RC_SCALAR, 0 },
@@ -743,6 +774,7 @@ mock_c0_set()
     MOCK_SET(c0, _c0_put);
     MOCK_SET(c0, _c0_get);
     MOCK_SET(c0, _c0_del);
+    MOCK_SET(c0, _c0_putdel_batch);
     MOCK_SET(c0, _c0_prefix_del);
     MOCK_SET(c0, _c0_cursor_create);
     MOCK_SET(c0, _c0_cursor_read);
@@ -763,6 +795,7 @@ mock_c0_unset()
     MOCK_UNSET(c0, _c0_put);
     MOCK_UNSET(c0, _c0_get);
     MOCK_UNSET(c0, _c0_del);
+    MOCK_UNSET(c0, _c0_putdel_batch);
     MOCK_UNSET(c0, _c0_prefix_del);
     MOCK_UNSET(c0, _c0_cursor_create);
     MOCK_UNSET(c0, _c0_cursor_seek);
@@ -883,8 +916,10 @@ static struct mapi_injection cndb_inject_list[] = {
     { mapi_idx_cndb_replay,       MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_start,    MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_txc,      MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cndb_txn_txcv,     MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_txd,      MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_meta,     MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cndb_txn_metav,    MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_ack_c,    MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_ack_d,    MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_nak,      MAPI_RC_SCALAR, 0 },
@@ -29,6 +29,9 @@
  *                      (which allows iteration and eof detection)
  *              eof is when d[0].val == d[0].keys (current == nkeys)
  *      Tombstones are val of -1.
+ *      Prefix tombstones are val of -2, and their key is the two
+ *      high-order bytes of a big-endian key.
+ *      Every entry's seqno is the dgen of its kvset.
  */
 
 static u64 dgen;
@@ -41,6 +44,12 @@ struct kvdata {
 
 int mock_kvset_verbose = 0;
 
+static size_t
+_kvdata_klen(const struct kvdata *d)
+{
+    return d->val == -2 ? sizeof(d->key) / 2 : sizeof(d->key);
+}
+
 void
 mock_kvset_data_reset()
 {
@@ -62,7 +71,7 @@ _make_data(struct nkv_tab *nkv)
             size_t buflen = 1 + CN_SMALL_VALUE_THRESHOLD;
 
             d[i].key = nkv->be ? htonl(k) : k;
-            if (v == -1) { /* tombstone */
+            if (v == -1 || v == -2) { /* tombstone or ptomb */
                 d[i].val = v;
                 d[i].val_len = 0;
                 continue;
@@ -456,11 +465,12 @@ _kvset_iter_next_key(struct kv_iterator *kvi, struct key_obj *kobj, struct kvset
     vc->nvals = 1;
 
     d += vc->off;
+    vc->is_ptomb = d->val == -2;
 
     kobj->ko_pfx = 0;
     kobj->ko_pfx_len = 0;
     kobj->ko_sfx = &d->key;
-    kobj->ko_sfx_len = sizeof(d->key);
+    kobj->ko_sfx_len = _kvdata_klen(d);
 
     if (mock_kvset_verbose)
         printf(
@@ -470,24 +480,6 @@ _kvset_iter_next_key(struct kv_iterator *kvi, struct key_obj *kobj, struct kvset
     return 0;
 }
 
-static bool
-_kvset_cursor_next(struct element_source *es, void **element)
-{
-    struct kv_iterator *kvi = kvset_cursor_es_h2r(es);
-    struct cn_kv_item * kv = &kvi->kvi_kv;
-
-    *element = 0;
-
-    _kvset_iter_next_key(kvi, &kv->kobj, &kv->vctx);
-    if (kvi->kvi_eof)
-        return false;
-
-    kv->src = es;
-    *element = &kvi->kvi_kv;
-
-    return true;
-}
-
 static int valbuf[1 + CN_SMALL_VALUE_THRESHOLD];
 
 static merr_t
@@ -517,6 +509,9 @@ _kvset_iter_next_val(
     if (entry->val == -1) {
         *vdata = HSE_CORE_TOMB_REG;
         *vlen = 0;
+    } else if (entry->val == -2) {
+        *vdata = HSE_CORE_TOMB_PFX;
+        *vlen = 0;
     } else {
         if (entry->val_len == 0) {
             *vlen = 0;
@@ -565,13 +560,16 @@ _kvset_iter_next_vref(
         return false; /* no more values */
 
     entry += vc->off;
-    *seq = 1;
+    *seq = iter->kvset->dgen;
     *vbidx = iter->src;
     *vboff = 0;
 
     if (entry->val_len == 0 && entry->val == -1) {
         *vdata = HSE_CORE_TOMB_REG;
         *vtype = vtype_tomb;
+    } else if (entry->val_len == 0 && entry->val == -2) {
+        *vdata = HSE_CORE_TOMB_PFX;
+        *vtype = vtype_ptomb;
     } else {
         if (entry->val_len == 0) {
             *vtype = vtype_zval;
@@ -599,7 +597,7 @@ _kvset_iter_next_vref(
 merr_t
 _kvset_iter_set_start(struct kv_iterator *kvi, int start, int pt_start)
 {
-    kvi->kvi_es = es_make(_kvset_cursor_next, 0, 0);
+    kvi->kvi_es = es_make(kvset_cursor_next, 0, 0);
     return 0;
 }
 
@@ -608,23 +606,22 @@ _kvset_iter_seek(struct kv_iterator *kvi, const void *key, int len, bool *eof)
 {
     struct mock_kv_iterator *iter = kvi->kvi_context;
     struct kvdata *          d = iter->kvset->iter_data;
-    size_t                   sz = sizeof(d[0].key);
     int                      i, rc, nkeys;
 
     /* find the first key larger than us */
     nkeys = (len == 0) ? 0 : d[0].key;
     for (i = 1; i <= nkeys; ++i) {
         if (len < 0)
-            rc = keycmp_prefix(key, -len, &d[i].key, sz);
+            rc = keycmp_prefix(key, -len, &d[i].key, _kvdata_klen(&d[i]));
         else
-            rc = keycmp(key, len, &d[i].key, sz);
+            rc = keycmp(key, len, &d[i].key, _kvdata_klen(&d[i]));
         if (rc <= 0)
             break;
     }
 
     iter->nextkey = i - 1;
     *eof = kvi->kvi_eof = iter->nextkey == d[0].key;
-    kvi->kvi_es = es_make(_kvset_cursor_next, 0, 0);
+    kvi->kvi_es = es_make(kvset_cursor_next, 0, 0);
     return 0;
 }
 
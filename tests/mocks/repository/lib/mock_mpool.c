@@ -543,6 +543,27 @@ _mpool_mdc_append(struct mpool_mdc *mdc, void *data, size_t len, bool sync)
     return 0;
 }
 
+merr_t
+_mpool_mdc_appendv(struct mpool_mdc *mdc, const struct iovec *iov, int iovc, bool sync)
+{
+    struct mocked_mdc *m = (void *)mdc;
+    size_t             len = 0;
+    int                i;
+
+    for (i = 0; i < iovc; i++)
+        len += iov[i].iov_len;
+
+    if (m->wcur + len > (size_t)m->cap)
+        return merr(ev(EFBIG));
+
+    for (i = 0; i < iovc; i++) {
+        memcpy(m->array + m->wcur, iov[i].iov_base, iov[i].iov_len);
+        m->wcur += iov[i].iov_len;
+    }
+
+    return 0;
+}
+
 merr_t
 _mpool_mdc_rewind(struct mpool_mdc *mdc)
 {
@@ -832,6 +853,7 @@ mock_mpool_set(void)
     MOCK_SET(mpool, _mpool_mcache_madvise);
 
     MOCK_SET(mpool, _mpool_mdc_append);
+    MOCK_SET(mpool, _mpool_mdc_appendv);
     MOCK_SET(mpool, _mpool_mdc_cend);
     MOCK_SET(mpool, _mpool_mdc_close);
     MOCK_SET(mpool, _mpool_mdc_cstart);
@@ -865,6 +887,7 @@ mock_mpool_unset(void)
     MOCK_UNSET(mpool, _mpool_mcache_madvise);
 
     MOCK_UNSET(mpool, _mpool_mdc_append);
+    MOCK_UNSET(mpool, _mpool_mdc_appendv);
     MOCK_UNSET(mpool, _mpool_mdc_cend);
     MOCK_UNSET(mpool, _mpool_mdc_close);
     MOCK_UNSET(mpool, _mpool_mdc_cstart);
@@ -388,6 +388,104 @@ MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, basic_repeated_put, no_fail_pre, no_fail
     c0kvs_destroy(kvs);
 }
 
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, putdel_batch, no_fail_pre, no_fail_post)
+{
+    struct c0kvs_batch_ent  entv[4], *entpv[4];
+    struct c0_kvset        *kvs;
+    merr_t                  err;
+    char                    kbuf[4], vbuf[4], obuf[1];
+    struct kvs_ktuple       kt;
+    struct kvs_buf          vb;
+    enum key_lookup_res     res;
+    uintptr_t               oseqnoref;
+    uint                    done;
+    int                     i;
+
+    err = c0kvs_create(NULL, NULL, &kvs);
+    ASSERT_EQ(0, err);
+
+    /* Keys 0, 1, 0, 2: the second update of key 0 is a delete.
+     */
+    for (i = 0; i < 4; ++i) {
+        kbuf[i] = (i == 2) ? 0 : i;
+        vbuf[i] = 10 + i;
+
+        memset(&entv[i], 0, sizeof(entv[i]));
+        kvs_ktuple_init(&entv[i].cbe_kt, kbuf + i, 1);
+        kvs_vtuple_init(&entv[i].cbe_vt, vbuf + i, 1);
+        entv[i].cbe_del = (i == 2);
+        entpv[i] = &entv[i];
+    }
+
+    err = c0kvs_putdel_batch(kvs, entpv, 4, HSE_ORDNL_TO_SQNREF(5), &done);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, done);
+
+    for (i = 0; i < 4; ++i)
+        ASSERT_EQ(5, entv[i].cbe_kt.kt_seqno);
+
+    kvs_buf_init(&vb, obuf, sizeof(obuf));
+
+    kbuf[0] = 0;
+    kvs_ktuple_init(&kt, kbuf, 1);
+    err = c0kvs_get_excl(kvs, 0, &kt, 5, 0, &res, &vb, &oseqnoref);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, res);
+
+    kvs_ktuple_init(&kt, kbuf + 3, 1);
+    err = c0kvs_get_excl(kvs, 0, &kt, 5, 0, &res, &vb, &oseqnoref);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_EQ(13, obuf[0]);
+
+    c0kvs_destroy(kvs);
+}
+
+MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, get_pinned, no_fail_pre, no_fail_post)
+{
+    struct c0_kvset *   kvs;
+    merr_t              err = 0;
+    char                kbuf[1], vbuf[8], obuf[8];
+    struct kvs_ktuple   kt;
+    struct kvs_vtuple   vt;
+    struct kvs_buf      vb;
+    struct kvs_vpin     pin = { 0 };
+    enum key_lookup_res res;
+    uintptr_t           oseqnoref;
+
+    err = c0kvs_create(NULL, NULL, &kvs);
+    ASSERT_NE((struct c0_kvset *)0, kvs);
+
+    kbuf[0] = 7;
+    memset(vbuf, 7, sizeof(vbuf));
+    kvs_ktuple_init(&kt, kbuf, 1);
+    kvs_vtuple_init(&vt, vbuf, sizeof(vbuf));
+
+    err = c0kvs_put(kvs, 0, &kt, &vt, HSE_ORDNL_TO_SQNREF(0));
+    ASSERT_EQ(0, err);
+
+    /* An uncompressed value is returned by reference, not copied */
+    memset(obuf, 0, sizeof(obuf));
+    kvs_buf_init(&vb, obuf, sizeof(obuf));
+    vb.b_pin = &pin;
+
+    err = c0kvs_get_excl(kvs, 0, &kt, 0, 0, &res, &vb, &oseqnoref);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, res);
+    ASSERT_EQ(sizeof(vbuf), vb.b_len);
+    ASSERT_NE(NULL, pin.vp_data);
+    ASSERT_NE(vbuf, pin.vp_data);
+    ASSERT_EQ(0, memcmp(pin.vp_data, vbuf, sizeof(vbuf)));
+    ASSERT_EQ(0, obuf[0]);
+
+    /* The kvms, not the c0_kvset, owns the pin's reference */
+    ASSERT_EQ(NULL, pin.vp_release);
+    kvs_vpin_release(&pin);
+    ASSERT_EQ(NULL, pin.vp_data);
+
+    c0kvs_destroy(kvs);
+}
+
 MTF_DEFINE_UTEST_PREPOST(c0_kvset_test, ctxn_put, no_fail_pre, no_fail_post)
 {
     struct c0_kvset *   kvs;
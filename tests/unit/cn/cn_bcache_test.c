@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/page.h>
+
+#include <cn/cn_bcache.h>
+
+#include <mocks/mock_mpool.h>
+
+#define SHARDS  (16)
+#define MBPAGES (64)
+#define MBSZ    (MBPAGES * PAGE_SIZE)
+
+static char mbdata[MBSZ];
+static char buf[MBSZ];
+static u64  mbid;
+
+int
+test_collection_setup(struct mtf_test_info *info)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(mbdata); i++)
+        mbdata[i] = (i * 131) ^ (i >> 12);
+
+    return 0;
+}
+
+int
+test_collection_teardown(struct mtf_test_info *info)
+{
+    mock_mpool_unset();
+    return 0;
+}
+
+int
+pre(struct mtf_test_info *info)
+{
+    merr_t err;
+
+    mock_mpool_set();
+
+    err = mpm_mblock_alloc(MBSZ, &mbid);
+    if (!err)
+        err = mpm_mblock_write(mbid, mbdata, 0, MBSZ);
+
+    return merr_errno(err);
+}
+
+MTF_BEGIN_UTEST_COLLECTION_PREPOST(cn_bcache_test, test_collection_setup, test_collection_teardown);
+
+MTF_DEFINE_UTEST_PRE(cn_bcache_test, disabled, pre)
+{
+    struct cn_bcache_stats stats;
+    merr_t                 err;
+
+    err = cn_bcache_init(0);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(cn_bcache_enabled());
+
+    err = cn_bcache_read(NULL, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(ENOTSUP, merr_errno(err));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(0, stats.cbs_cap);
+
+    cn_bcache_fini();
+
+    /* Less than one page per shard disables the cache. */
+    err = cn_bcache_init(SHARDS * PAGE_SIZE - 1);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(cn_bcache_enabled());
+    cn_bcache_fini();
+}
+
+MTF_DEFINE_UTEST_PRE(cn_bcache_test, hit_miss, pre)
+{
+    struct cn_bcache_stats stats;
+    size_t                 off, len;
+    merr_t                 err;
+
+    err = cn_bcache_init(SHARDS * MBPAGES * PAGE_SIZE);
+    ASSERT_EQ(0, err);
+    ASSERT_TRUE(cn_bcache_enabled());
+
+    /* An unaligned range spanning four pages is filled by one read. */
+    off = PAGE_SIZE + 123;
+    len = 3 * PAGE_SIZE;
+
+    err = cn_bcache_read(NULL, mbid, off, len, buf + 1);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, memcmp(buf + 1, mbdata + off, len));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(SHARDS * MBPAGES * PAGE_SIZE, stats.cbs_cap);
+    ASSERT_EQ(4 * PAGE_SIZE, stats.cbs_bytes);
+    ASSERT_EQ(0, stats.cbs_hits);
+    ASSERT_EQ(1, stats.cbs_misses);
+    ASSERT_EQ(1, stats.cbs_reads);
+
+    /* A subrange is served entirely from the cache. */
+    memset(buf, 0, sizeof(buf));
+
+    off = 2 * PAGE_SIZE - 7;
+    len = 100;
+
+    err = cn_bcache_read(NULL, mbid, off, len, buf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, memcmp(buf, mbdata + off, len));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(2, stats.cbs_hits);
+    ASSERT_EQ(1, stats.cbs_reads);
+
+    /* A miss reads the rest of the range with a single I/O. */
+    err = cn_bcache_read(NULL, mbid, 0, MBSZ, buf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, memcmp(buf, mbdata, MBSZ));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(MBSZ, stats.cbs_bytes);
+    ASSERT_EQ(2, stats.cbs_reads);
+    ASSERT_EQ(0, stats.cbs_evicts);
+
+    err = cn_bcache_read(NULL, mbid, 0, 0, buf);
+    ASSERT_EQ(0, err);
+
+    cn_bcache_fini();
+}
+
+MTF_DEFINE_UTEST_PRE(cn_bcache_test, evict, pre)
+{
+    struct cn_bcache_stats stats;
+    merr_t                 err;
+    int                    i;
+
+    /* Two pages per shard. */
+    err = cn_bcache_init(2 * SHARDS * PAGE_SIZE);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; i < 4; i++) {
+        memset(buf, 0, sizeof(buf));
+
+        err = cn_bcache_read(NULL, mbid, 0, MBSZ, buf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(0, memcmp(buf, mbdata, MBSZ));
+    }
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_LE(stats.cbs_bytes, stats.cbs_cap);
+    ASSERT_GT(stats.cbs_evicts, 0);
+
+    cn_bcache_fini();
+}
+
+MTF_DEFINE_UTEST_PRE(cn_bcache_test, read_error, pre)
+{
+    struct cn_bcache_stats stats;
+    merr_t                 err;
+
+    err = cn_bcache_init(SHARDS * MBPAGES * PAGE_SIZE);
+    ASSERT_EQ(0, err);
+
+    mapi_inject_once(mapi_idx_mpool_mblock_read, 1, EIO);
+
+    err = cn_bcache_read(NULL, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(EIO, merr_errno(err));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(0, stats.cbs_bytes);
+    ASSERT_EQ(0, stats.cbs_reads);
+
+    mapi_inject_unset(mapi_idx_mpool_mblock_read);
+
+    cn_bcache_fini();
+}
+
+MTF_DEFINE_UTEST_PRE(cn_bcache_test, mpool_key, pre)
+{
+    struct cn_bcache_stats stats;
+    struct mpool *         ds1 = (void *)0x1000, *ds2 = (void *)0x2000;
+    merr_t                 err;
+
+    err = cn_bcache_init(SHARDS * MBPAGES * PAGE_SIZE);
+    ASSERT_EQ(0, err);
+
+    /* The same mblock id in two mpools names two different mblocks. */
+    err = cn_bcache_read(ds1, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(0, err);
+
+    err = cn_bcache_read(ds2, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, memcmp(buf, mbdata, PAGE_SIZE));
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(2 * PAGE_SIZE, stats.cbs_bytes);
+    ASSERT_EQ(0, stats.cbs_hits);
+    ASSERT_EQ(2, stats.cbs_reads);
+
+    err = cn_bcache_read(ds1, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(0, err);
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(1, stats.cbs_hits);
+
+    /* Purging one mpool leaves the other's pages cached. */
+    cn_bcache_purge(ds1);
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(PAGE_SIZE, stats.cbs_bytes);
+
+    err = cn_bcache_read(ds2, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(0, err);
+
+    err = cn_bcache_read(ds1, mbid, 0, PAGE_SIZE, buf);
+    ASSERT_EQ(0, err);
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(2, stats.cbs_hits);
+    ASSERT_EQ(3, stats.cbs_reads);
+
+    cn_bcache_purge(ds1);
+    cn_bcache_purge(ds2);
+
+    cn_bcache_stats_get(&stats);
+    ASSERT_EQ(0, stats.cbs_bytes);
+
+    cn_bcache_fini();
+}
+
+MTF_END_UTEST_COLLECTION(cn_bcache_test);
@@ -230,7 +230,7 @@ verify_cursor(
     merr_t                err;
 
     /* make seqno so large there is never any filtering */
-    err = cn_cursor_create(cn, seqno, false, pfx, pfx_len, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, pfx, pfx_len, &sum, &cur);
     ASSERT_EQ(err, 0);
     ASSERT_NE(cur, NULL);
 
@@ -254,7 +254,7 @@ verify_seek(
     struct cn_cursor *    cur;
     merr_t                err;
 
-    err = cn_cursor_create(cn, seqno, false, pfx, pfx_len, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, pfx, pfx_len, &sum, &cur);
     ASSERT_EQ(err, 0);
     ASSERT_NE(cur, NULL);
 
@@ -280,7 +280,7 @@ verify_seek_eof(
     struct cn_cursor *    cur;
     merr_t err;
 
-    err = cn_cursor_create(cn, seqno, false, pfx, pfx_len, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, pfx, pfx_len, &sum, &cur);
     ASSERT_EQ(err, 0);
     ASSERT_NE(cur, NULL);
 
@@ -424,7 +424,7 @@ MTF_DEFINE_UTEST_PREPOST(cn_cursor, repeat_update, pre, post)
     err = cn_tree_insert_kvset(tree, ITV_KVSET(itv[0]), 0, 0);
     ASSERT_EQ(err, 0);
 
-    err = cn_cursor_create(cn, seqno, false, NULL, 0, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, NULL, 0, &sum, &cur);
     ASSERT_EQ(err, 0);
     ASSERT_NE(cur, NULL);
 
@@ -1036,7 +1036,7 @@ MTF_DEFINE_UTEST_PREPOST(cn_cursor, capped_update, pre, post)
     }
 
     /* Test 1: capped cursor update test */
-    err = cn_cursor_create(cn, seqno, false, NULL, 0, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, NULL, 0, &sum, &cur);
     ASSERT_EQ(err, 0);
 
     for (; i < NELEM(make); ++i) {
@@ -1185,7 +1185,7 @@ MTF_DEFINE_UTEST_PREPOST(cn_cursor, capped_update_errors, pre, post)
         ASSERT_EQ(err, 0);
     }
 
-    err = cn_cursor_create(cn, seqno, false, NULL, 0, &sum, &cur);
+    err = cn_cursor_create(cn, seqno, false, false, NULL, 0, &sum, &cur);
     ASSERT_EQ(err, 0);
 
     for (; i < NELEM(make); ++i) {
@@ -1228,4 +1228,167 @@ MTF_DEFINE_UTEST_PREPOST(cn_cursor, capped_update_errors, pre, post)
     MOCK_UNSET(kvset, _kvset_minkey);
 }
 
+MTF_DEFINE_UTEST_PREPOST(cn_cursor, filter_pred, pre, post)
+{
+    struct cn *           cn;
+    struct cn_tree *      tree;
+    struct cn_cursor *    cur;
+    struct cursor_summary sum;
+    struct mock_kvset *   mk;
+    struct mpool *        ds = (void *)-1;
+    struct kv_iterator *  itv[5];
+    merr_t                err;
+    int                   i, vi, nk, ntombs;
+    bool                  eof;
+    u32                   seek = 0;
+    u8                    mask = 0x01, match = 0x00;
+    struct kc_pred        pred = { 0 };
+    struct kc_filter      filter = { 0 };
+    struct cndb           cndb;
+    struct cndb_cn        cndbcn = cndb_cn_initializer(8, 2, 0);
+    struct kvs_cparams    cp = {};
+
+    struct kvdb_kvs kk = { 0 };
+
+    /*
+     * Filter a prefixed tree down to even keys.  The ptomb's key
+     * (00 01) is odd, but it must still pass through the filter and
+     * hide the older keys under its prefix.  Tombstones are filtered
+     * like the keys they delete, so an even tomb hides its key just
+     * as a tomb from c0 hides the cn key it matches.
+     */
+    struct nkv_tab make[] = {
+        { 0x20, 0x10000, 0x1000, VMX_S32, KVDATA_BE_KEY, 1 }, /* under ptomb */
+        { 0x20, 0x20000, 0x2000, VMX_S32, KVDATA_BE_KEY, 2 },
+        { 0x01, 0x10000, -2, VMX_S32, KVDATA_BE_KEY, 3 },     /* ptomb 00 01 */
+        { 0x10, 0x10010, 0x3000, VMX_S32, KVDATA_BE_KEY, 4 }, /* newer than ptomb */
+        { 0x08, 0x20008, -1, VMX_S32, KVDATA_BE_KEY, 5 },     /* tombs */
+    };
+
+    struct {
+        int key1;
+        int nkeys;
+        int val1;
+    } vtab[] = {
+        { 0x10010, 8, 0x3000 }, /* dgen 4 */
+        { 0x20000, 4, 0x2000 }, /* dgen 2 */
+        { 0x20010, 8, 0x2010 }, /* dgen 2 */
+    };
+
+    for (i = 0; i < NELEM(make); ++i)
+        ITV_INIT(itv, i, make);
+
+    mk = ITV_KVSET_MOCK(itv[NELEM(make) - 1]);
+    mapi_inject(mapi_idx_cn_tree_initial_dgen, mk->dgen);
+    mapi_inject_ptr(mapi_idx_ikvdb_get_csched, NULL);
+
+    err = cndb_init(&cndb, ds, true, 0, CNDB_ENTRIES, 0, 0, &health, 0);
+    ASSERT_EQ(err, 0);
+
+    cndb.cndb_cnc = 1;
+    cndb.cndb_cnv[0] = &cndbcn;
+    ASSERT_NE(cndb.cndb_workv, NULL);
+    ASSERT_NE(cndb.cndb_keepv, NULL);
+    ASSERT_NE(cndb.cndb_tagv, NULL);
+
+    kk.kk_parent = dummy_ikvdb_create();
+    kk.kk_cparams = &cp;
+    kk.kk_cparams->fanout = 1 << 3;
+    kk.kk_cparams->pfx_len = 2;
+
+    err = cn_open(cn_kvdb, ds, &kk, &cndb, 0, &rp, "mp", "kvs", &health, 0, &cn);
+    ASSERT_EQ(err, 0);
+
+    tree = cn_get_tree(cn);
+    ASSERT_NE(tree, NULL);
+
+    for (i = 0; i < NELEM(make); ++i) {
+        err = cn_tree_insert_kvset(tree, ITV_KVSET(itv[i]), 0, 0);
+        ASSERT_EQ(err, 0);
+    }
+
+    pred.kp_sfx_mask = &mask;
+    pred.kp_sfx_match = &match;
+    pred.kp_sfx_len = 1;
+    filter.kcf_pred = &pred;
+
+    err = cn_cursor_create(cn, seqno, false, false, 0, 0, &sum, &cur);
+    ASSERT_EQ(err, 0);
+    ASSERT_NE(cur, NULL);
+
+    err = cn_cursor_seek(cur, &seek, sizeof(seek), &filter);
+    ASSERT_EQ(err, 0);
+
+    vi = nk = ntombs = 0;
+
+    while (1) {
+        struct kvs_kvtuple kvt = {0};
+        const int *        ip;
+        int                key;
+
+        cn_cursor_read_internal(lcl_ti, cur, &kvt, &eof);
+        if (eof)
+            break;
+
+        ip = kvt.kvt_key.kt_data;
+        key = ntohl(*ip);
+        ASSERT_EQ(0, key & 1);
+
+        if (HSE_CORE_IS_TOMB(kvt.kvt_value.vt_data)) {
+            ASSERT_GE(key, 0x20008);
+            ASSERT_LT(key, 0x20010);
+            ++ntombs;
+            continue;
+        }
+
+        ASSERT_LT(vi, NELEM(vtab));
+        ASSERT_EQ(key, vtab[vi].key1 + 2 * nk);
+        ip = kvt.kvt_value.vt_data;
+        ASSERT_EQ(*ip, vtab[vi].val1 + 2 * nk);
+
+        if (++nk == vtab[vi].nkeys) {
+            nk = 0;
+            ++vi;
+        }
+    }
+    ASSERT_EQ(vi, NELEM(vtab));
+    ASSERT_EQ(ntombs, 4);
+
+    /* Without the filter, every key comes back */
+    err = cn_cursor_seek(cur, &seek, sizeof(seek), 0);
+    ASSERT_EQ(err, 0);
+
+    nk = 0;
+    while (1) {
+        struct kvs_kvtuple kvt = {0};
+
+        cn_cursor_read_internal(lcl_ti, cur, &kvt, &eof);
+        if (eof)
+            break;
+
+        if (!HSE_CORE_IS_TOMB(kvt.kvt_value.vt_data))
+            ++nk;
+    }
+    ASSERT_EQ(nk, 0x10 + 0x20 - 0x08);
+
+    cn_cursor_destroy(cur);
+
+    err = cn_close(cn);
+    ASSERT_EQ(err, 0);
+
+    for (i = 0; i < NELEM(make); ++i) {
+        struct mock_kv_iterator *iter = itv[i]->kvi_context;
+        struct kvdata *          d = iter->kvset->iter_data;
+
+        free(d);
+        kvset_iter_release(itv[i]);
+    }
+
+    dummy_ikvdb_destroy(kk.kk_parent);
+    free(cndb.cndb_workv);
+    free(cndb.cndb_keepv);
+    free(cndb.cndb_tagv);
+    free(cndb.cndb_cbuf);
+}
+
 MTF_END_UTEST_COLLECTION(cn_cursor)
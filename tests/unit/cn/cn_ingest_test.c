@@ -52,8 +52,10 @@ struct injections injections[] = {
     { 0, mapi_idx_cndb_seqno },
     { 0, mapi_idx_cndb_txn_start },
     { 0, mapi_idx_cndb_txn_txc },
+    { 0, mapi_idx_cndb_txn_txcv },
     { 0, mapi_idx_cndb_txn_txd },
     { 0, mapi_idx_cndb_txn_meta },
+    { 0, mapi_idx_cndb_txn_metav },
     { 0, mapi_idx_cndb_txn_ack_c },
     { 0, mapi_idx_cndb_txn_ack_d },
     { 0, mapi_idx_cndb_txn_nak },
@@ -191,7 +193,7 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, commit_delete, test_pre)
     u64    context;
 
     /*
-     * Test cn_mblocks_commit w/ cndb_txn_txc set to succeed
+     * Test cn_mblocks_commit w/ cndb_txn_txcv set to succeed
      */
     n = 0;
     init_mblks(m, n_kvsets, &k, &v);
@@ -210,9 +212,9 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, commit_delete, test_pre)
     free_mblks(m, n_kvsets);
 
     /*
-     * Test cn_mblocks_commit w/ cndb_txn_txc set to fail
+     * Test cn_mblocks_commit w/ cndb_txn_txcv set to fail
      */
-    mapi_inject(mapi_idx_cndb_txn_txc, -1);
+    mapi_inject(mapi_idx_cndb_txn_txcv, -1);
 
     n = 0;
     init_mblks(m, n_kvsets, &k, &v);
@@ -230,8 +232,8 @@ MTF_DEFINE_UTEST_PRE(cn_ingest_test, commit_delete, test_pre)
     ASSERT_EQ(n, 0);
     free_mblks(m, n_kvsets);
 
-    /* unset cndb_txn_txc injection */
-    mapi_inject(mapi_idx_cndb_txn_txc, 0);
+    /* unset cndb_txn_txcv injection */
+    mapi_inject(mapi_idx_cndb_txn_txcv, 0);
 
     /* Test cn_mblocks_destroy with kcompact == false.
      * Should delete kblocks and vblocks.
@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/page.h>
+
+#include <cn/cn_pin.h>
+
+#define CHUNKSZ (2ul << 20)
+
+MTF_BEGIN_UTEST_COLLECTION(cn_pin_test);
+
+MTF_DEFINE_UTEST(cn_pin_test, disabled)
+{
+    struct cn_pin_stats stats;
+    struct cn_pin *     pin;
+    void *              ptr = NULL;
+    merr_t              err;
+
+    err = cn_pin_init(0);
+    ASSERT_EQ(0, err);
+
+    ASSERT_EQ(NULL, cn_pin_alloc(PAGE_SIZE, &ptr, &pin));
+    ASSERT_EQ(NULL, pin);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(0, stats.cps_cap);
+    ASSERT_EQ(0, stats.cps_resident);
+
+    cn_pin_fini();
+}
+
+MTF_DEFINE_UTEST(cn_pin_test, alloc_free)
+{
+    struct cn_pin *     c1, *c2, *c3, *c4;
+    struct cn_pin_stats stats;
+    void *              v1 = NULL, *v2 = NULL, *v3 = NULL, *v4 = NULL;
+    char *              p1, *p2, *p3;
+    merr_t              err;
+
+    err = cn_pin_init(2 * CHUNKSZ);
+    ASSERT_EQ(0, err);
+
+    /* Small allocations share a chunk and are page aligned.  They are
+     * not visible to readers until published.
+     */
+    p1 = cn_pin_alloc(100, &v1, &c1);
+    ASSERT_NE(NULL, p1);
+    ASSERT_TRUE(IS_ALIGNED((uintptr_t)p1, PAGE_SIZE));
+    memset(p1, 0xaa, 100);
+    ASSERT_EQ(NULL, v1);
+    cn_pin_publish(c1);
+    ASSERT_EQ(p1, v1);
+
+    p2 = cn_pin_alloc(3 * PAGE_SIZE, &v2, &c2);
+    ASSERT_NE(NULL, p2);
+    ASSERT_EQ(c1->cpn_chunk, c2->cpn_chunk);
+    ASSERT_EQ(p1 + PAGE_SIZE, p2);
+    memset(p2, 0x55, 3 * PAGE_SIZE);
+    cn_pin_publish(c2);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(2 * CHUNKSZ, stats.cps_cap);
+    ASSERT_EQ(CHUNKSZ, stats.cps_resident);
+    ASSERT_EQ(4 * PAGE_SIZE, stats.cps_live);
+    ASSERT_EQ(1, stats.cps_chunks);
+
+    /* An allocation larger than a chunk gets a chunk of its own,
+     * and is refused if it would exceed the cap.
+     */
+    p3 = cn_pin_alloc(CHUNKSZ + PAGE_SIZE, &v3, &c3);
+    ASSERT_EQ(NULL, p3);
+    ASSERT_EQ(NULL, c3);
+
+    p3 = cn_pin_alloc(CHUNKSZ, &v3, &c3);
+    ASSERT_NE(NULL, p3);
+    ASSERT_NE(c1->cpn_chunk, c3->cpn_chunk);
+    memset(p3, 0x11, CHUNKSZ);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(2 * CHUNKSZ, stats.cps_resident);
+    ASSERT_EQ(2, stats.cps_chunks);
+    ASSERT_EQ(1, stats.cps_fails);
+
+    /* The arena is full, and the only candidate for eviction
+     * has not been published.
+     */
+    ASSERT_EQ(NULL, cn_pin_alloc(CHUNKSZ, &v4, &c4));
+    ASSERT_EQ(NULL, c4);
+    ASSERT_EQ(NULL, v4);
+    ASSERT_NE(NULL, v2);
+
+    /* Freeing every allocation in a chunk releases the chunk. */
+    cn_pin_free(c3);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(CHUNKSZ, stats.cps_resident);
+    ASSERT_EQ(1, stats.cps_chunks);
+    ASSERT_EQ(0, stats.cps_evicts);
+
+    cn_pin_free(c1);
+    cn_pin_free(c2);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(0, stats.cps_live);
+    ASSERT_EQ(3, stats.cps_allocs);
+    ASSERT_EQ(2, stats.cps_fails);
+
+    cn_pin_fini();
+}
+
+MTF_DEFINE_UTEST(cn_pin_test, evict)
+{
+    struct cn_pin *     a, *b, *c, *d, *e;
+    struct cn_pin_stats stats;
+    void *              va = NULL, *vb = NULL, *vc = NULL, *vd = NULL, *ve = NULL;
+    merr_t              err;
+
+    err = cn_pin_init(3 * CHUNKSZ);
+    ASSERT_EQ(0, err);
+
+    /* a is in the current chunk, b and c have chunks of their own. */
+    ASSERT_NE(NULL, cn_pin_alloc(PAGE_SIZE, &va, &a));
+    cn_pin_publish(a);
+    ASSERT_NE(NULL, cn_pin_alloc(CHUNKSZ, &vb, &b));
+    cn_pin_publish(b);
+    ASSERT_NE(NULL, cn_pin_alloc(CHUNKSZ, &vc, &c));
+    cn_pin_publish(c);
+
+    /* New allocations get a second chance, so the first sweep clears
+     * the reference bits of b and c and the second evicts b.  The
+     * current chunk is never evicted.
+     */
+    ASSERT_NE(NULL, cn_pin_alloc(CHUNKSZ, &vd, &d));
+    cn_pin_publish(d);
+
+    ASSERT_EQ(NULL, vb);
+    ASSERT_EQ(NULL, b->cpn_chunk);
+    ASSERT_NE(NULL, va);
+    ASSERT_NE(NULL, vc);
+    ASSERT_NE(NULL, vd);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(3 * CHUNKSZ, stats.cps_resident);
+    ASSERT_EQ(3, stats.cps_chunks);
+    ASSERT_EQ(1, stats.cps_evicts);
+    ASSERT_EQ(0, stats.cps_fails);
+
+    /* A referenced chunk survives the sweep in favor of one that
+     * hasn't been referenced since the last sweep.
+     */
+    d->cpn_ref = false;
+    cn_pin_touch(c);
+
+    ASSERT_NE(NULL, cn_pin_alloc(CHUNKSZ, &ve, &e));
+    cn_pin_publish(e);
+
+    ASSERT_EQ(NULL, vd);
+    ASSERT_NE(NULL, vc);
+    ASSERT_NE(NULL, ve);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(2, stats.cps_evicts);
+    ASSERT_EQ(PAGE_SIZE + 2 * CHUNKSZ, stats.cps_live);
+
+    /* Evicted allocations must still be freed by their owners. */
+    cn_pin_free(a);
+    cn_pin_free(b);
+    cn_pin_free(c);
+    cn_pin_free(d);
+    cn_pin_free(e);
+
+    cn_pin_stats_get(&stats);
+    ASSERT_EQ(0, stats.cps_live);
+
+    cn_pin_fini();
+}
+
+MTF_END_UTEST_COLLECTION(cn_pin_test)
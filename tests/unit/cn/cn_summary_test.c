@@ -0,0 +1,452 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <mtf/framework.h>
+#include <mock/api.h>
+
+#include <hse_util/hse_err.h>
+
+#include <hse_ikvdb/kvdb_health.h>
+#include <hse_ikvdb/kvs_cparams.h>
+#include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/omf_version.h>
+
+#include <mpool/mpool.h>
+
+#include <cn/cn_summary.h>
+#include <cn/cn_tree.h>
+#include <cn/cn_tree_create.h>
+#include <cn/kvset.h>
+#include <cn/kvset_internal.h>
+#include <cn/omf.h>
+
+#include "../mpool/common.h"
+
+#define CNID 0x2a
+
+static struct kvdb_health health;
+static struct kvs_cparams cp;
+static struct kvs_rparams rp;
+static struct mpool *mp;
+static struct cn_tree *tree;
+
+static const char *keyv[] = { "apple", "banana", "cherry", "damson", "elder", "fig" };
+
+/* Kvsets are fabricated directly rather than read from media: the summary
+ * only needs their dgen and the kblock fields kvset_summary_pack() saves.
+ */
+static struct kvset *
+fake_kvset_create(u64 dgen, uint kblkc, u64 blkid)
+{
+    struct kvset *ks;
+    uint i;
+
+    ks = mapi_safe_calloc(1, sizeof(*ks) + kblkc * sizeof(ks->ks_kblks[0]));
+    if (!ks)
+        return NULL;
+
+    ks->ks_entry.le_kvset = ks;
+    atomic_set(&ks->ks_ref, 1);
+    ks->ks_dgen = dgen;
+    ks->ks_st.kst_kvsets = 1;
+    ks->ks_st.kst_kblks = kblkc;
+
+    for (i = 0; i < kblkc; i++) {
+        struct kvset_kblk *kb = ks->ks_kblks + i;
+
+        kb->kb_kblk.bk_blkid = blkid + i;
+        kb->kb_seqno_min = dgen * 100;
+        kb->kb_seqno_max = dgen * 100 + i;
+        kb->kb_metrics.num_keys = 1000 + i;
+        kb->kb_koff_min = keyv[i % NELEM(keyv)];
+        kb->kb_klen_min = strlen(kb->kb_koff_min);
+        kb->kb_koff_max = keyv[(i + 1) % NELEM(keyv)];
+        kb->kb_klen_max = strlen(kb->kb_koff_max);
+    }
+
+    return ks;
+}
+
+static void
+_kvset_put_ref(struct kvset *ks)
+{
+    if (atomic_dec_return(&ks->ks_ref) > 0)
+        return;
+
+    mapi_safe_free(ks);
+}
+
+/* Build a tree with a two kblock kvset in the root and a one kblock
+ * kvset in each of two leaves.
+ */
+static int
+tree_create(void)
+{
+    struct {
+        u64  dgen;
+        uint kblkc;
+        uint level;
+        uint offset;
+    } tv[] = {
+        { 3, 2, 0, 0 },
+        { 2, 1, 1, 0 },
+        { 1, 1, 1, 1 },
+    };
+    merr_t err;
+    uint i;
+
+    err = cn_tree_create(&tree, NULL, "kvs", 0, &cp, &health, &rp);
+    if (err)
+        return merr_errno(err);
+
+    for (i = 0; i < NELEM(tv); i++) {
+        struct kvset *ks = fake_kvset_create(tv[i].dgen, tv[i].kblkc, tv[i].dgen << 8);
+
+        if (!ks)
+            return ENOMEM;
+
+        err = cn_tree_insert_kvset(tree, ks, tv[i].level, tv[i].offset);
+        if (err)
+            return merr_errno(err);
+    }
+
+    return 0;
+}
+
+static int
+collection_pre(struct mtf_test_info *ti)
+{
+    int rc;
+
+    rc = mpool_collection_pre(ti);
+    if (rc)
+        return rc;
+
+    cp = kvs_cparams_defaults();
+    cp.fanout = 2;
+    rp = kvs_rparams_defaults();
+
+    MOCK_SET(kvset, _kvset_put_ref);
+
+    return 0;
+}
+
+static int
+test_pre(struct mtf_test_info *ti)
+{
+    merr_t err;
+    int rc;
+
+    rc = mpool_test_pre(ti);
+    if (rc)
+        return rc;
+
+    err = mpool_create(home, &tcparams);
+    if (!err)
+        err = mpool_open(home, &trparams, O_RDWR, &mp);
+    if (err)
+        return merr_errno(err);
+
+    return tree_create();
+}
+
+static int
+test_post(struct mtf_test_info *ti)
+{
+    cn_tree_destroy(tree);
+    tree = NULL;
+
+    mpool_close(mp);
+    mpool_destroy(home, &tdparams);
+    mp = NULL;
+
+    return mpool_test_post(ti);
+}
+
+static void
+summary_path(char *buf, size_t bufsz)
+{
+    snprintf(buf, bufsz, "%s/%s-%lx", capacity_path, CN_SUMMARY_FILE_PFX, (ulong)CNID);
+}
+
+static merr_t
+hdr_read(struct cn_summary_hdr_omf *hdr)
+{
+    struct mpool_file *mpf;
+    char name[32];
+    size_t rdlen;
+    merr_t err;
+
+    snprintf(name, sizeof(name), "%s-%lx", CN_SUMMARY_FILE_PFX, (ulong)CNID);
+
+    err = mpool_file_open(mp, HSE_MCLASS_CAPACITY, name, O_RDONLY, 0, true, &mpf);
+    if (err)
+        return err;
+
+    err = mpool_file_read(mpf, 0, (char *)hdr, sizeof(*hdr), &rdlen);
+    mpool_file_close(mpf);
+
+    return err;
+}
+
+static merr_t
+file_write(off_t off, const void *buf, size_t len)
+{
+    struct mpool_file *mpf;
+    char name[32];
+    merr_t err;
+
+    snprintf(name, sizeof(name), "%s-%lx", CN_SUMMARY_FILE_PFX, (ulong)CNID);
+
+    err = mpool_file_open(mp, HSE_MCLASS_CAPACITY, name, O_RDWR, 0, true, &mpf);
+    if (err)
+        return err;
+
+    err = mpool_file_write(mpf, off, buf, len, NULL);
+    if (!err)
+        err = mpool_file_sync(mpf);
+    mpool_file_close(mpf);
+
+    return err;
+}
+
+/* Check that there is no usable summary, and that this isn't an error.
+ */
+#define ASSERT_SUMMARY_IGNORED()                  \
+    do {                                          \
+        struct cn_summary *_sum;                  \
+        merr_t             _err;                  \
+                                                  \
+        _err = cn_summary_load(mp, CNID, &_sum);  \
+        ASSERT_EQ(0, _err);                       \
+        ASSERT_EQ(NULL, _sum);                    \
+    } while (0)
+
+MTF_BEGIN_UTEST_COLLECTION_PRE(cn_summary_test, collection_pre)
+
+MTF_DEFINE_UTEST_PREPOST(cn_summary_test, round_trip, test_pre, test_post)
+{
+    const struct cn_summary_kblk_omf *rec;
+    struct cn_summary *sum;
+    ulong hits, misses;
+    const char *key;
+    merr_t err;
+
+    /* No summary yet.
+     */
+    ASSERT_SUMMARY_IGNORED();
+
+    err = cn_summary_save(mp, CNID, tree);
+    ASSERT_EQ(0, err);
+
+    err = cn_summary_load(mp, CNID, &sum);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, sum);
+
+    /* Second kblock of the root kvset.
+     */
+    rec = cn_summary_lookup(sum, 3, (3 << 8) + 1);
+    ASSERT_NE(NULL, rec);
+    ASSERT_TRUE(cn_summary_contains(sum, rec));
+    ASSERT_EQ(3, omf_csk_dgen(rec));
+    ASSERT_EQ((3 << 8) + 1, omf_csk_blkid(rec));
+    ASSERT_EQ(300, omf_csk_seqno_min(rec));
+    ASSERT_EQ(301, omf_csk_seqno_max(rec));
+    ASSERT_EQ(1001, omf_csk_keys(rec));
+    ASSERT_EQ(strlen(keyv[2]), omf_csk_klen_max(rec));
+    ASSERT_EQ(strlen(keyv[1]), omf_csk_klen_min(rec));
+
+    /* The max key follows the record, then the min key.
+     */
+    key = (const char *)(rec + 1);
+    ASSERT_EQ(0, memcmp(key, keyv[2], omf_csk_klen_max(rec)));
+    key += omf_csk_klen_max(rec);
+    ASSERT_EQ(0, memcmp(key, keyv[1], omf_csk_klen_min(rec)));
+
+    /* The leaf kvsets.
+     */
+    rec = cn_summary_lookup(sum, 2, 2 << 8);
+    ASSERT_NE(NULL, rec);
+    ASSERT_EQ(1000, omf_csk_keys(rec));
+
+    rec = cn_summary_lookup(sum, 1, 1 << 8);
+    ASSERT_NE(NULL, rec);
+    ASSERT_EQ(1 << 8, omf_csk_blkid(rec));
+
+    /* Right blkid but wrong dgen, and vice versa.
+     */
+    ASSERT_EQ(NULL, cn_summary_lookup(sum, 2, 1 << 8));
+    ASSERT_EQ(NULL, cn_summary_lookup(sum, 3, (3 << 8) + 2));
+
+    cn_summary_stats(sum, &hits, &misses);
+    ASSERT_EQ(3, hits);
+    ASSERT_EQ(2, misses);
+
+    ASSERT_FALSE(cn_summary_contains(sum, &hits));
+
+    cn_summary_free(sum);
+
+    /* Summaries are per cn.
+     */
+    err = cn_summary_load(mp, CNID + 1, &sum);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NULL, sum);
+
+    err = cn_summary_drop(mp, CNID);
+    ASSERT_EQ(0, err);
+
+    ASSERT_SUMMARY_IGNORED();
+
+    err = cn_summary_drop(mp, CNID);
+    ASSERT_EQ(0, err);
+
+    /* NULL summaries are tolerated.
+     */
+    ASSERT_EQ(NULL, cn_summary_lookup(NULL, 3, 3 << 8));
+    ASSERT_FALSE(cn_summary_contains(NULL, &hits));
+    cn_summary_free(NULL);
+}
+
+MTF_DEFINE_UTEST_PREPOST(cn_summary_test, bad_header, test_pre, test_post)
+{
+    struct cn_summary_hdr_omf good, hdr;
+    struct cn_summary *sum;
+    merr_t err;
+
+    err = cn_summary_save(mp, CNID, tree);
+    ASSERT_EQ(0, err);
+
+    err = hdr_read(&good);
+    ASSERT_EQ(0, err);
+
+    hdr = good;
+    omf_set_csh_magic(&hdr, CN_SUMMARY_MAGIC + 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    hdr = good;
+    omf_set_csh_version(&hdr, CN_SUMMARY_VERSION + 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    /* A summary written for another cn under this cn's name.
+     */
+    hdr = good;
+    omf_set_csh_cnid(&hdr, CNID + 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    hdr = good;
+    omf_set_csh_crc(&hdr, omf_csh_crc(&good) ^ 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    /* Restoring the header makes the summary usable again.
+     */
+    err = file_write(0, &good, sizeof(good));
+    ASSERT_EQ(0, err);
+
+    err = cn_summary_load(mp, CNID, &sum);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, sum);
+    cn_summary_free(sum);
+
+    /* A flipped bit in a record fails the crc check.
+     */
+    err = file_write(sizeof(good), "\xff", 1);
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+}
+
+MTF_DEFINE_UTEST_PREPOST(cn_summary_test, truncated, test_pre, test_post)
+{
+    struct cn_summary_hdr_omf good, hdr;
+    char path[PATH_MAX];
+    merr_t err;
+    int rc;
+
+    err = cn_summary_save(mp, CNID, tree);
+    ASSERT_EQ(0, err);
+
+    err = hdr_read(&good);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, omf_csh_kblkc(&good));
+
+    /* A length too short to hold the claimed number of records.
+     */
+    hdr = good;
+    omf_set_csh_len(&hdr, 4 * sizeof(struct cn_summary_kblk_omf) - 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    /* More records claimed than the records and keys fit in.
+     */
+    hdr = good;
+    omf_set_csh_kblkc(&hdr, omf_csh_kblkc(&good) + 1);
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    /* A valid header on a file cut short.
+     */
+    err = file_write(0, &good, sizeof(good));
+    ASSERT_EQ(0, err);
+
+    summary_path(path, sizeof(path));
+
+    rc = truncate(path, sizeof(good) + omf_csh_len(&good) - 1);
+    ASSERT_EQ(0, rc);
+    ASSERT_SUMMARY_IGNORED();
+
+    rc = truncate(path, sizeof(good) / 2);
+    ASSERT_EQ(0, rc);
+    ASSERT_SUMMARY_IGNORED();
+}
+
+MTF_DEFINE_UTEST_PREPOST(cn_summary_test, crash_during_save, test_pre, test_post)
+{
+    struct cn_summary_hdr_omf hdr;
+    struct cn_summary *sum;
+    char junk[64];
+    merr_t err;
+
+    err = cn_summary_save(mp, CNID, tree);
+    ASSERT_EQ(0, err);
+
+    /* Replay what cn_summary_save() does up to the point where it would
+     * write the final header: invalidate the header, then overwrite part
+     * of the records.
+     */
+    memset(&hdr, 0, sizeof(hdr));
+    err = file_write(0, &hdr, sizeof(hdr));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    memset(junk, 0xa5, sizeof(junk));
+    err = file_write(sizeof(hdr), junk, sizeof(junk));
+    ASSERT_EQ(0, err);
+    ASSERT_SUMMARY_IGNORED();
+
+    /* The next save starts over.
+     */
+    err = cn_summary_save(mp, CNID, tree);
+    ASSERT_EQ(0, err);
+
+    err = cn_summary_load(mp, CNID, &sum);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, sum);
+    ASSERT_NE(NULL, cn_summary_lookup(sum, 3, 3 << 8));
+    cn_summary_free(sum);
+}
+
+MTF_END_UTEST_COLLECTION(cn_summary_test)
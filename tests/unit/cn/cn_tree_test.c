@@ -292,8 +292,10 @@ struct mapi_injection inject_list[] = {
     /* cndb  */
     { mapi_idx_cndb_txn_start, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_txc, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cndb_txn_txcv, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_txd, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_meta, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_cndb_txn_metav, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_ack_c, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_ack_d, MAPI_RC_SCALAR, 0 },
     { mapi_idx_cndb_txn_nak, MAPI_RC_SCALAR, 0 },
@@ -320,6 +322,7 @@ struct mapi_injection inject_list[] = {
      * need the guts of an iterator b/c we mock
      * the actual compact/spill functions. */
     { mapi_idx_kvset_iter_set_stats, MAPI_RC_SCALAR, 0 },
+    { mapi_idx_kvset_iter_set_qos, MAPI_RC_SCALAR, 0 },
     { mapi_idx_kvset_iter_seek, MAPI_RC_SCALAR, -1 },
     { mapi_idx_kvset_iter_next_key, MAPI_RC_SCALAR, -1 },
     { mapi_idx_kvset_iter_next_val, MAPI_RC_SCALAR, -1 },
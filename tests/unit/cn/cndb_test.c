@@ -1111,6 +1111,83 @@ MTF_DEFINE_UTEST(cndb_test, cndb_compaction_test)
     mapi_inject_unset(mapi_idx_mpool_mdc_append);
 }
 
+MTF_DEFINE_UTEST(cndb_test, cndb_txn_batch_test)
+{
+    merr_t               err;
+    struct cndb *        cndb;
+    u64                  tag, txid;
+    u64                  tagv[3];
+    struct kvset_meta    km[3] = {};
+    struct kvset_meta *  kmv[3] = { &km[0], &km[1], &km[2] };
+    struct kvdb_health   health;
+    struct kvset_mblocks mbv[3] = {};
+    struct kvs_block     vb = {}, kb = {};
+    struct mpool *       ds = (void *)-1;
+    int                  workc, i;
+
+    mapi_inject(mapi_idx_mpool_mdc_read, 1);
+    mapi_inject(mapi_idx_mpool_mdc_open, 0);
+    mapi_inject(mapi_idx_mpool_mdc_append, 0);
+    mapi_inject(mapi_idx_mpool_mdc_appendv, 0);
+    mapi_inject(mapi_idx_mpool_mdc_usage, 0);
+
+    err = cndb_open(ds, false, 0, 100, 11, 101, &health, NULL, &cndb);
+    ASSERT_EQ(0, err);
+
+    cndb->cndb_high_water = 1000;
+    atomic_set(&cndb->cndb_txid, 10);
+
+    kb.bk_blkid = 11;
+    vb.bk_blkid = 12;
+
+    for (i = 0; i < NELEM(mbv); i++) {
+        mbv[i].kblks.blks = &kb;
+        mbv[i].kblks.n_blks = 1;
+        mbv[i].vblks.blks = &vb;
+        mbv[i].vblks.n_blks = 1;
+    }
+
+    err = cndb_txn_start(cndb, &txid, NELEM(mbv), 0, 0, 0, 0);
+    ASSERT_EQ(0, err);
+
+    mapi_calls_clear(mapi_idx_mpool_mdc_appendv);
+    workc = cndb->cndb_workc;
+
+    /* All TXC records go out in one append, with the same tags
+     * that NELEM(mbv) calls to cndb_txn_txc() would have minted.
+     */
+    tag = 0;
+    err = cndb_txn_txcv(cndb, txid, 0, &tag, NELEM(mbv), mbv, true, tagv);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, mapi_calls(mapi_idx_mpool_mdc_appendv));
+    ASSERT_EQ(workc + NELEM(mbv), cndb->cndb_workc);
+    ASSERT_EQ(txid + NELEM(mbv) - 1, tag);
+
+    for (i = 0; i < NELEM(mbv); i++)
+        ASSERT_EQ(txid + i, tagv[i]);
+
+    err = cndb_txn_metav(cndb, txid, 0, NELEM(kmv), tagv, kmv);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, mapi_calls(mapi_idx_mpool_mdc_appendv));
+    ASSERT_EQ(workc + 2 * NELEM(mbv), cndb->cndb_workc);
+
+    /* An empty batch is a no-op. */
+    err = cndb_txn_metav(cndb, txid, 0, 0, tagv, kmv);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, mapi_calls(mapi_idx_mpool_mdc_appendv));
+
+    err = cndb_txn_ack_c(cndb, txid);
+    ASSERT_EQ(0, err);
+
+    err = cndb_close(cndb);
+    ASSERT_EQ(0, err);
+
+    mapi_inject_unset(mapi_idx_mpool_mdc_usage);
+    mapi_inject_unset(mapi_idx_mpool_mdc_read);
+    mapi_inject_unset(mapi_idx_mpool_mdc_append);
+    mapi_inject_unset(mapi_idx_mpool_mdc_appendv);
+}
+
 MTF_DEFINE_UTEST(cndb_test, cndb_get_ingestid_test)
 {
     struct cndb                cndb;
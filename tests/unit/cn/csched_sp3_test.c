@@ -14,6 +14,7 @@
 #include <hse_ikvdb/blk_list.h>
 #include <hse_ikvdb/kvdb_health.h>
 #include <hse_ikvdb/cn_kvdb.h>
+#include <hse_ikvdb/csched.h>
 #include <hse_ikvdb/csched_rp.h>
 #include <hse_ikvdb/cn.h>
 
@@ -647,4 +648,61 @@ MTF_DEFINE_UTEST_PRE(test, t_sp3_one_big_tree_with_work, pre_test)
     sp3_destroy(cs);
 }
 
+MTF_DEFINE_UTEST_PRE(test, t_sp3_history, pre_test)
+{
+    struct csched_history *hist;
+    merr_t                 err;
+    struct test_tree *     tt;
+    struct csched     *    cs;
+    uint                   i;
+
+    hist = malloc(sizeof(*hist));
+    ASSERT_NE(hist, NULL);
+
+    err = sp3_create(NULL, kvdb_rp, mp, &health, &cs);
+    ASSERT_EQ(err, 0);
+
+    sp3_history_get(cs, hist);
+    ASSERT_EQ(0, hist->ch_jobs);
+    ASSERT_EQ(0, hist->ch_jobc);
+    ASSERT_EQ(0, hist->ch_rulec);
+    ASSERT_EQ(0, hist->ch_kvsc);
+
+    tt = new_tree(4);
+    ASSERT_NE(tt, NULL);
+
+    err = new_kvsets(tt, SP3_NODE_LEN_THRESH + 1, 0, 0);
+    ASSERT_EQ(err, 0);
+
+    for (i = 0; i < ttc; i++)
+        add_tree(ttv[i].tree, cs);
+
+    usleep(DELAY_MS * 1000);
+
+    sp3_history_get(cs, hist);
+    ASSERT_EQ(ttc, hist->ch_kvsc);
+    ASSERT_EQ(min_t(u64, hist->ch_jobs, CSCHED_HIST_JOBS), hist->ch_jobc);
+
+    for (i = 0; i < hist->ch_jobc; i++) {
+        ASSERT_EQ(hist->ch_jobs - hist->ch_jobc + i + 1, hist->ch_jobv[i].cjr_seq);
+        ASSERT_EQ(tt->tree->cnid, hist->ch_jobv[i].cjr_cnid);
+        ASSERT_NE(NULL, hist->ch_jobv[i].cjr_rule);
+    }
+
+    for (i = 0; i < ttc; i++)
+        remove_tree(ttv[i].tree, cs);
+
+    destroy_trees();
+
+    sp3_destroy(cs);
+
+    /* A nil handle (e.g., read-only kvdb) yields an empty history.
+     */
+    sp3_history_get(NULL, hist);
+    ASSERT_EQ(0, hist->ch_jobc);
+    ASSERT_EQ(0, hist->ch_kvsc);
+
+    free(hist);
+}
+
 MTF_END_UTEST_COLLECTION(test);
@@ -617,6 +617,7 @@ pre(struct mtf_test_info *info)
     mapi_inject(mapi_idx_cn_tree_get_cn, 0);
     mapi_inject(mapi_idx_kvset_builder_set_agegroup, 0);
     mapi_inject(mapi_idx_kvset_builder_set_merge_stats, 0);
+    mapi_inject(mapi_idx_kvset_builder_set_qos, 0);
 
     return 0;
 }
@@ -690,4 +690,108 @@ MTF_DEFINE_UTEST_PREPOST(wbt_test, skip_keys, pre_test, post_test)
     free(ql.buf);
 }
 
+MTF_DEFINE_UTEST_PREPOST(wbt_test, kmd_delta, pre_test, post_test)
+{
+    struct kvs_mblk_desc  kbd = { 0 };
+    struct wbt_desc       wbd = { 0 };
+    struct wbt_hdr_omf    hdr;
+    struct iovec          iov[4096];
+    struct kvs_ktuple     kt;
+    struct kvs_vtuple_ref vref;
+    enum key_lookup_res   res;
+    struct wbti *         wbti;
+    const void *          kdata, *kmdp;
+    char                  buf[32];
+    uint                  iov_cnt, klen;
+    size_t                v6len = 0;
+    const u64             seqbase = 1ul << 32;
+    const int             nkeys = 50 * 1000;
+    void *                tree;
+    merr_t                err;
+    int                   i;
+
+    for (i = 0; i < nkeys; i++) {
+        struct key_obj ko;
+        bool           added = false;
+        char           cnt[4];
+        size_t         cntlen = 0;
+
+        snprintf(buf, sizeof(buf), "key-%020d", i);
+        key2kobj(&ko, buf, strlen(buf));
+
+        kmd_used = 0;
+        kmd_add_val(kmd, &kmd_used, seqbase + 2 * i + 1, i / 10000, (i % 10000) * 100, 100);
+        kmd_add_tomb(kmd, &kmd_used, seqbase + 2 * i);
+
+        kmd_set_count(cnt, &cntlen, 2);
+        v6len += cntlen + kmd_used;
+
+        wbb_add_entry(wbb, &ko, 2, kmd, kmd_used, max_pgc, &wbt_pgc, &added);
+        ASSERT_TRUE(added);
+    }
+
+    err = wbb_freeze(wbb, &hdr, max_pgc, &wbt_pgc, iov, NELEM(iov), &iov_cnt);
+    ASSERT_EQ(0, err);
+
+    tree = wbtree_write(iov, iov_cnt);
+    ASSERT_NE(NULL, tree);
+
+    /* Sequential seqnos and vblock offsets must shrink the kmd region.
+     */
+    ASSERT_LT(omf_wbt_kmd_pgc(&hdr) * PAGE_SIZE, v6len * 3 / 4);
+
+    kbd.map_base = tree;
+    wbd.wbd_n_pages = wbt_pgc;
+    wbd.wbd_version = WBT_TREE_VERSION;
+    wbd.wbd_root = omf_wbt_root(&hdr);
+    wbd.wbd_leaf = omf_wbt_leaf(&hdr);
+    wbd.wbd_leaf_cnt = omf_wbt_leaf_cnt(&hdr);
+    wbd.wbd_kmd_pgc = omf_wbt_kmd_pgc(&hdr);
+
+    /* Point gets decode each key's kmd in isolation.
+     */
+    for (i = 0; i < nkeys; i++) {
+        snprintf(buf, sizeof(buf), "key-%020d", i);
+        kvs_ktuple_init_nohash(&kt, buf, strlen(buf));
+
+        err = wbtr_read_vref(&kbd, &wbd, &kt, 0, U64_MAX, &res, &vref);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(FOUND_VAL, res);
+        ASSERT_EQ(seqbase + 2 * i + 1, vref.vr_seq);
+        ASSERT_EQ(i / 10000, vref.vb.vr_index);
+        ASSERT_EQ((i % 10000) * 100, vref.vb.vr_off);
+        ASSERT_EQ(100, vref.vb.vr_len);
+
+        err = wbtr_read_vref(&kbd, &wbd, &kt, 0, seqbase + 2 * i, &res, &vref);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(FOUND_TMB, res);
+        ASSERT_EQ(seqbase + 2 * i, vref.vr_seq);
+    }
+
+    /* As does a full scan via wbti_next().
+     */
+    err = wbti_create(&wbti, &kbd, &wbd, NULL, false, false);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; wbti_next(wbti, &kdata, &klen, &kmdp); i++) {
+        size_t off = 0;
+        u64    seq;
+
+        ASSERT_EQ(2, kmd_count(kmdp, &off));
+
+        wbt_read_kmd_vref(kmdp, &off, &seq, &vref);
+        ASSERT_EQ(vtype_val, vref.vr_type);
+        ASSERT_EQ(seqbase + 2 * i + 1, seq);
+        ASSERT_EQ((i % 10000) * 100, vref.vb.vr_off);
+
+        wbt_read_kmd_vref(kmdp, &off, &seq, &vref);
+        ASSERT_EQ(vtype_tomb, vref.vr_type);
+        ASSERT_EQ(seqbase + 2 * i, seq);
+    }
+    ASSERT_EQ(nkeys, i);
+
+    wbti_destroy(wbti);
+    free(tree);
+}
+
 MTF_END_UTEST_COLLECTION(wbt_test)
@@ -7,6 +7,7 @@
 #include <dirent.h>
 
 #include <hse/flags.h>
+#include <hse/experimental.h>
 
 #include <mtf/framework.h>
 #include <mock/api.h>
@@ -559,9 +560,7 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, txn_del_test, test_pre, test_post)
     ikvdb_txn_free(h, txn);
     txn = 0;
 
-    vbuf.b_buf = buf;
-    vbuf.b_buf_sz = sizeof(buf);
-    vbuf.b_len = 0;
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
     err = ikvdb_kvs_get(kvs_h, 0, txn, &kt, &found, &vbuf);
     ASSERT_EQ(0, err);
     ASSERT_EQ(found, FOUND_TMB);
@@ -573,6 +572,224 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, txn_del_test, test_pre, test_post)
     ASSERT_EQ(0, err);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, snapshot_get_test, test_pre, test_post)
+{
+    struct ikvdb *            h = NULL;
+    struct hse_kvs *          kvs_h = NULL;
+    const char *              mpool = __func__;
+    const char *              kvs = "kvs";
+    const char *const         kvdb_open_paramv[] = { "c0_diag_mode=true" };
+    const char *const         kvs_open_paramv[] = { "mclass.policy=\"capacity_only\"" };
+    merr_t                    err;
+    struct hse_kvdb_snapshot *snap1, *snap2;
+    struct kvs_ktuple         kt;
+    struct kvs_vtuple         vt;
+    struct kvs_buf            vbuf;
+    char                      buf[100];
+    enum key_lookup_res       found;
+    struct kvdb_rparams       kvdb_rp = kvdb_rparams_defaults();
+    struct kvs_rparams        kvs_rp = kvs_rparams_defaults();
+    struct kvs_cparams        kvs_cp = kvs_cparams_defaults();
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    err = argv_deserialize_to_kvdb_rparams(NELEM(kvdb_open_paramv), kvdb_open_paramv, &kvdb_rp);
+    ASSERT_EQ(0, err);
+
+    err = argv_deserialize_to_kvs_rparams(NELEM(kvs_open_paramv), kvs_open_paramv, &kvs_rp);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_open(mpool, &kvdb_rp, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_create(h, kvs, &kvs_cp);
+    ASSERT_EQ(0, err);
+
+    mapi_inject(mapi_idx_mpool_mclass_props_get, 0);
+    err = ikvdb_kvs_open(h, kvs, &kvs_rp, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs_h);
+
+    err = ikvdb_snapshot_create(h, &snap1);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "key", 3);
+    kvs_vtuple_init(&vt, "data", 4);
+
+    err = ikvdb_kvs_put(kvs_h, 0, NULL, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_snapshot_create(h, &snap2);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_del(kvs_h, 0, NULL, &kt);
+    ASSERT_EQ(0, err);
+
+    /* snap1 predates the put, snap2 sees the put but not the delete */
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_snapshot_get(kvs_h, 0, snap1, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NOT_FOUND, found);
+
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_snapshot_get(kvs_h, 0, snap2, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_VAL, found);
+    ASSERT_EQ(4, vbuf.b_len);
+    ASSERT_EQ(0, memcmp(buf, "data", 4));
+
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_get(kvs_h, 0, NULL, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, found);
+
+    err = ikvdb_snapshot_destroy(h, snap1);
+    ASSERT_EQ(0, err);
+
+    /* snap2 is deliberately leaked to exercise cleanup at close */
+    err = ikvdb_kvs_close(kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, batch_test, test_pre, test_post)
+{
+    struct ikvdb *        h = NULL;
+    struct hse_kvs *      kvs_h = NULL, *txkvs_h = NULL;
+    const char *          mpool = __func__;
+    const char *const     kvdb_open_paramv[] = { "c0_diag_mode=true" };
+    const char *const     kvs_open_paramv[] = { "mclass.policy=\"capacity_only\"" };
+    const char *const     txkvs_open_paramv[] =
+    { "transactions.enabled=true", "mclass.policy=\"capacity_only\"" };
+    merr_t                err;
+    struct hse_kvs_batch *batch;
+    struct kvs_ktuple     kt;
+    struct kvs_vtuple     vt;
+    struct kvs_buf        vbuf;
+    char                  key[16], buf[100];
+    enum key_lookup_res   found;
+    uint                  opc;
+    int                   i;
+    struct kvdb_rparams   kvdb_rp = kvdb_rparams_defaults();
+    struct kvs_rparams    kvs_rp = kvs_rparams_defaults();
+    struct kvs_rparams    txkvs_rp = kvs_rparams_defaults();
+    struct kvs_cparams    kvs_cp = kvs_cparams_defaults();
+
+    /* we want a valid c0/c0sk here */
+    mock_c0_unset();
+
+    err = argv_deserialize_to_kvdb_rparams(NELEM(kvdb_open_paramv), kvdb_open_paramv, &kvdb_rp);
+    ASSERT_EQ(0, err);
+
+    err = argv_deserialize_to_kvs_rparams(NELEM(kvs_open_paramv), kvs_open_paramv, &kvs_rp);
+    ASSERT_EQ(0, err);
+
+    err = argv_deserialize_to_kvs_rparams(
+        NELEM(txkvs_open_paramv), txkvs_open_paramv, &txkvs_rp);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_open(mpool, &kvdb_rp, &h);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, h);
+
+    err = ikvdb_kvs_create(h, "kvs", &kvs_cp);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_create(h, "txkvs", &kvs_cp);
+    ASSERT_EQ(0, err);
+
+    mapi_inject(mapi_idx_mpool_mclass_props_get, 0);
+    err = ikvdb_kvs_open(h, "kvs", &kvs_rp, 0, &kvs_h);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_open(h, "txkvs", &txkvs_rp, 0, &txkvs_h);
+    ASSERT_EQ(0, err);
+
+    kvs_ktuple_init(&kt, "key0", 4);
+    kvs_vtuple_init(&vt, "data", 4);
+    err = ikvdb_kvs_put(kvs_h, 0, NULL, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_batch_create(h, &batch);
+    ASSERT_EQ(0, err);
+
+    /* Committing an empty batch is a no-op */
+    err = ikvdb_kvs_batch_commit(batch, &opc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, opc);
+
+    /* Batches cannot be applied to transactional kvs */
+    err = ikvdb_kvs_batch_put(batch, txkvs_h, 0, &kt, &vt);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    for (i = 1; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        kvs_ktuple_init(&kt, key, strlen(key));
+        kvs_vtuple_init(&vt, key, strlen(key));
+
+        err = ikvdb_kvs_batch_put(batch, kvs_h, 0, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_ktuple_init(&kt, "key0", 4);
+    err = ikvdb_kvs_batch_del(batch, kvs_h, 0, &kt);
+    ASSERT_EQ(0, err);
+
+    /* Nothing is visible until the batch is committed */
+    kvs_ktuple_init(&kt, "key1", 4);
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_get(kvs_h, 0, NULL, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NOT_FOUND, found);
+
+    err = ikvdb_kvs_batch_commit(batch, &opc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(100, opc);
+
+    for (i = 1; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        kvs_ktuple_init(&kt, key, strlen(key));
+        kvs_buf_init(&vbuf, buf, sizeof(buf));
+
+        err = ikvdb_kvs_get(kvs_h, 0, NULL, &kt, &found, &vbuf);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(FOUND_VAL, found);
+        ASSERT_EQ(strlen(key), vbuf.b_len);
+        ASSERT_EQ(0, memcmp(buf, key, vbuf.b_len));
+    }
+
+    kvs_ktuple_init(&kt, "key0", 4);
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_get(kvs_h, 0, NULL, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, found);
+
+    /* The batch is reusable after commit, and reset discards its ops */
+    kvs_vtuple_init(&vt, "data", 4);
+    err = ikvdb_kvs_batch_put(batch, kvs_h, 0, &kt, &vt);
+    ASSERT_EQ(0, err);
+
+    ikvdb_kvs_batch_reset(batch);
+
+    err = ikvdb_kvs_batch_commit(batch, &opc);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, opc);
+
+    kvs_buf_init(&vbuf, buf, sizeof(buf));
+    err = ikvdb_kvs_get(kvs_h, 0, NULL, &kt, &found, &vbuf);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(FOUND_TMB, found);
+
+    ikvdb_kvs_batch_destroy(batch);
+
+    err = ikvdb_close(h);
+    ASSERT_EQ(0, err);
+}
+
 struct tx_info {
     struct ikvdb *  kvdb;
     struct hse_kvs *kvs;
@@ -612,9 +829,7 @@ parallel_transactions(void *info)
 
     ikvdb_txn_free(ti->kvdb, txn);
 
-    val.b_buf = vbuf;
-    val.b_buf_sz = sizeof(vbuf);
-    val.b_len = 0;
+    kvs_buf_init(&val, vbuf, sizeof(vbuf));
     txn = 0;
     err = ikvdb_kvs_get(ti->kvs, 0, txn, &kt, &found, &val);
     VERIFY_EQ_RET(0, err, 0);
@@ -1869,6 +2084,253 @@ MTF_DEFINE_UTEST_PREPOST(ikvdb_test, prefix_delete_test, test_pre, test_post)
     ASSERT_EQ(err, 0);
 }
 
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, range_count_test, test_pre, test_post)
+{
+    merr_t                 err;
+    const char *const      kvdb_open_paramv[] = { "c0_diag_mode=true" };
+    const char *const      kvs_open_paramv[] = { "mclass.policy=\"capacity_only\"" };
+    const char *const      keys[] = { "aa1", "aa2", "ab1", "ab2", "ac1", "ad1" };
+    struct kvs_ktuple      kt, skt, ekt;
+    struct kvs_vtuple      vt;
+    struct ikvdb *         kvdb = NULL;
+    struct hse_kvs *       kvs = NULL;
+    struct hse_kvs_cursor *cur;
+    struct kvdb_rparams    kvdb_rp = kvdb_rparams_defaults();
+    struct kvs_rparams     kvs_rp = kvs_rparams_defaults();
+    const void *           key, *val;
+    size_t                 klen, vlen;
+    bool                   eof;
+    u64                    count;
+    int                    i;
+
+    err = argv_deserialize_to_kvdb_rparams(NELEM(kvdb_open_paramv), kvdb_open_paramv, &kvdb_rp);
+    ASSERT_EQ(0, err);
+
+    err = argv_deserialize_to_kvs_rparams(NELEM(kvs_open_paramv), kvs_open_paramv, &kvs_rp);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_open(__func__, &kvdb_rp, &kvdb);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvdb);
+
+    err = ikvdb_kvs_create(kvdb, "kvs", &g_kvs_cp);
+    ASSERT_EQ(0, err);
+
+    mapi_inject(mapi_idx_mpool_mclass_props_get, 0);
+    err = ikvdb_kvs_open(kvdb, "kvs", &kvs_rp, 0, &kvs);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs);
+
+    for (i = 0; i < NELEM(keys); ++i) {
+        kvs_ktuple_init(&kt, keys[i], strlen(keys[i]));
+        kvs_vtuple_init(&vt, "data", 4);
+
+        err = ikvdb_kvs_put(kvs, 0, NULL, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_ktuple_init(&kt, keys[3], strlen(keys[3]));
+    err = ikvdb_kvs_del(kvs, 0, NULL, &kt);
+    ASSERT_EQ(0, err);
+
+    /* start must not sort after end */
+    kvs_ktuple_init_nohash(&skt, "b", 1);
+    kvs_ktuple_init_nohash(&ekt, "a", 1);
+    err = ikvdb_kvs_range_count(kvs, 0, NULL, &skt, &ekt, &count);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* "aa2", "ab1" and "ac1", but neither the deleted "ab2" nor the end key */
+    kvs_ktuple_init_nohash(&skt, "aa2", 3);
+    kvs_ktuple_init_nohash(&ekt, "ad1", 3);
+    err = ikvdb_kvs_range_count(kvs, 0, NULL, &skt, &ekt, &count);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(3, count);
+
+    kvs_ktuple_init_nohash(&skt, "b", 1);
+    kvs_ktuple_init_nohash(&ekt, "c", 1);
+    err = ikvdb_kvs_range_count(kvs, 0, NULL, &skt, &ekt, &count);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, count);
+
+    /* A keys-only cursor yields value lengths without value data */
+    err = ikvdb_kvs_cursor_create(kvs, HSE_CURSOR_CREATE_KEYS_ONLY, NULL, NULL, 0, &cur);
+    ASSERT_EQ(0, err);
+
+    for (i = 0; ; ++i) {
+        err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
+        ASSERT_EQ(0, err);
+        if (eof)
+            break;
+
+        ASSERT_EQ(NULL, val);
+        ASSERT_EQ(4, vlen);
+    }
+    ASSERT_EQ(NELEM(keys) - 1, i);
+
+    err = ikvdb_kvs_cursor_destroy(cur);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_close(kvs);
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_close(kvdb);
+    ASSERT_EQ(err, 0);
+}
+
+static bool
+cursor_filter_cb(void *arg, const void *key, size_t klen)
+{
+    ++*(int *)arg;
+
+    return !(klen == 3 && !memcmp(key, "ac1", 3));
+}
+
+static int
+cursor_filter_count(struct hse_kvs_cursor *cur, const char *first)
+{
+    const void *key, *val;
+    size_t      klen, vlen;
+    bool        eof;
+    merr_t      err;
+    int         n;
+
+    for (n = 0; ; ++n) {
+        err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
+        if (err)
+            return -1;
+        if (eof)
+            break;
+
+        if (n == 0 && first && (klen != strlen(first) || memcmp(key, first, klen)))
+            return -1;
+    }
+
+    return n;
+}
+
+MTF_DEFINE_UTEST_PREPOST(ikvdb_test, cursor_filter_test, test_pre, test_post)
+{
+    merr_t                       err;
+    const char *const            kvdb_open_paramv[] = { "c0_diag_mode=true" };
+    const char *const            kvs_open_paramv[] = { "mclass.policy=\"capacity_only\"" };
+    const char *const            keys[] = { "aa1", "aa2", "ab1", "ab2", "ac1", "ad1", "ad12" };
+    struct kvs_ktuple            kt;
+    struct kvs_vtuple            vt;
+    struct ikvdb *               kvdb = NULL;
+    struct hse_kvs *             kvs = NULL;
+    struct hse_kvs_cursor *      cur;
+    struct hse_kvs_cursor_filter filter;
+    struct kvdb_rparams          kvdb_rp = kvdb_rparams_defaults();
+    struct kvs_rparams           kvs_rp = kvs_rparams_defaults();
+    const void *                 key, *val;
+    size_t                       klen, vlen;
+    bool                         eof;
+    int                          i, calls = 0;
+
+    err = argv_deserialize_to_kvdb_rparams(NELEM(kvdb_open_paramv), kvdb_open_paramv, &kvdb_rp);
+    ASSERT_EQ(0, err);
+
+    err = argv_deserialize_to_kvs_rparams(NELEM(kvs_open_paramv), kvs_open_paramv, &kvs_rp);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_open(__func__, &kvdb_rp, &kvdb);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvdb);
+
+    err = ikvdb_kvs_create(kvdb, "kvs", &g_kvs_cp);
+    ASSERT_EQ(0, err);
+
+    mapi_inject(mapi_idx_mpool_mclass_props_get, 0);
+    err = ikvdb_kvs_open(kvdb, "kvs", &kvs_rp, 0, &kvs);
+    ASSERT_EQ(0, err);
+    ASSERT_NE(NULL, kvs);
+
+    for (i = 0; i < NELEM(keys); ++i) {
+        kvs_ktuple_init(&kt, keys[i], strlen(keys[i]));
+        kvs_vtuple_init(&vt, "data", 4);
+
+        err = ikvdb_kvs_put(kvs, 0, NULL, &kt, &vt);
+        ASSERT_EQ(0, err);
+    }
+
+    kvs_ktuple_init(&kt, keys[3], strlen(keys[3]));
+    err = ikvdb_kvs_del(kvs, 0, NULL, &kt);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_cursor_create(kvs, 0, NULL, NULL, 0, &cur);
+    ASSERT_EQ(0, err);
+
+    /* Installing a filter rewinds the cursor */
+    err = ikvdb_kvs_cursor_read(cur, 0, &key, &klen, &val, &vlen, &eof);
+    ASSERT_EQ(0, err);
+    ASSERT_FALSE(eof);
+
+    /* Second byte within ["b", "c"]: "ab1" and "ac1", but not the deleted "ab2" */
+    memset(&filter, 0, sizeof(filter));
+    filter.kvcf_fieldc = 1;
+    filter.kvcf_fieldv[0].kvcf_off = 1;
+    filter.kvcf_fieldv[0].kvcf_len = 1;
+    filter.kvcf_fieldv[0].kvcf_min = "b";
+    filter.kvcf_fieldv[0].kvcf_max = "c";
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, &filter);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, cursor_filter_count(cur, "ab1"));
+
+    /* Masked suffix: keys ending in '1' (0x31), '3', '5', ... */
+    memset(&filter, 0, sizeof(filter));
+    filter.kvcf_sfx_mask = "\xf1";
+    filter.kvcf_sfx_match = "1";
+    filter.kvcf_sfx_len = 1;
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, &filter);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, cursor_filter_count(cur, "aa1"));
+
+    /* The callback runs only on keys that pass the other tests */
+    filter.kvcf_cb = cursor_filter_cb;
+    filter.kvcf_cb_arg = &calls;
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, &filter);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(3, cursor_filter_count(cur, "aa1"));
+    ASSERT_LE(4, calls);
+
+    /* Fields beyond the end of a key never match */
+    memset(&filter, 0, sizeof(filter));
+    filter.kvcf_fieldc = 1;
+    filter.kvcf_fieldv[0].kvcf_off = 3;
+    filter.kvcf_fieldv[0].kvcf_len = 1;
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, &filter);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(1, cursor_filter_count(cur, "ad12"));
+
+    /* A filter composes with a seek limit */
+    filter.kvcf_fieldv[0].kvcf_off = 0;
+    filter.kvcf_fieldv[0].kvcf_min = "a";
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, &filter);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_cursor_seek(cur, 0, "ab", 2, "ac9", 3, NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(2, cursor_filter_count(cur, "ab1"));
+
+    err = ikvdb_kvs_cursor_filter_set(cur, 0, NULL);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(NELEM(keys) - 1, cursor_filter_count(cur, "aa1"));
+
+    err = ikvdb_kvs_cursor_destroy(cur);
+    ASSERT_EQ(0, err);
+
+    err = ikvdb_kvs_close(kvs);
+    ASSERT_EQ(err, 0);
+
+    err = ikvdb_close(kvdb);
+    ASSERT_EQ(err, 0);
+}
+
 MTF_DEFINE_UTEST_PREPOST(ikvdb_test, ikvdb_test_various, test_pre, test_post)
 {
     char   invalid[HSE_KVS_NAME_LEN_MAX * 2];
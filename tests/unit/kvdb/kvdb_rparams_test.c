@@ -676,6 +676,25 @@ MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, throttle_c0_hi_th, test_pre)
     ASSERT_EQ(UINT32_MAX, ps->ps_bounds.as_uscalar.ps_max);
 }
 
+MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, throttle_sleep_p99_us, test_pre)
+{
+    const struct param_spec *ps = ps_get("throttle_sleep_p99_us");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL | PARAM_FLAG_WRITABLE, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_U32, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvdb_rparams, throttle_sleep_p99_us), ps->ps_offset);
+    ASSERT_EQ(sizeof(uint32_t), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(1000, params.throttle_sleep_p99_us);
+    ASSERT_EQ(1, ps->ps_bounds.as_uscalar.ps_min);
+    ASSERT_EQ(UINT32_MAX, ps->ps_bounds.as_uscalar.ps_max);
+}
+
 MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, thorttling_init_policy, test_pre)
 {
     char                     buf[128];
@@ -699,6 +718,11 @@ MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, thorttling_init_policy, test_pre)
     ps->ps_stringify(ps, &params.throttle_init_policy, buf, sizeof(buf), &needed_sz);
     ASSERT_STREQ("\"auto\"", buf);
     ASSERT_EQ(6, needed_sz);
+
+    params.throttle_init_policy = THROTTLE_DELAY_START_PREDICTIVE;
+    ps->ps_stringify(ps, &params.throttle_init_policy, buf, sizeof(buf), &needed_sz);
+    ASSERT_STREQ("\"predictive\"", buf);
+    ASSERT_EQ(12, needed_sz);
 }
 
 MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, throttle_burst, test_pre)
@@ -870,6 +894,23 @@ MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, cn_io_threads, test_pre)
     ASSERT_EQ(256, ps->ps_bounds.as_uscalar.ps_max);
 }
 
+MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, numa_mode, test_pre)
+{
+    const struct param_spec *ps = ps_get("numa_mode");
+
+    ASSERT_NE(NULL, ps);
+    ASSERT_NE(NULL, ps->ps_description);
+    ASSERT_EQ(PARAM_FLAG_EXPERIMENTAL, ps->ps_flags);
+    ASSERT_EQ(PARAM_TYPE_BOOL, ps->ps_type);
+    ASSERT_EQ(offsetof(struct kvdb_rparams, numa_mode), ps->ps_offset);
+    ASSERT_EQ(sizeof(bool), ps->ps_size);
+    ASSERT_EQ((uintptr_t)ps->ps_convert, (uintptr_t)param_default_converter);
+    ASSERT_EQ((uintptr_t)ps->ps_validate, (uintptr_t)param_default_validator);
+    ASSERT_EQ((uintptr_t)ps->ps_stringify, (uintptr_t)param_default_stringify);
+    ASSERT_EQ((uintptr_t)ps->ps_jsonify, (uintptr_t)param_default_jsonify);
+    ASSERT_EQ(false, params.numa_mode);
+}
+
 MTF_DEFINE_UTEST_PRE(kvdb_rparams_test, keylock_tables, test_pre)
 {
     const struct param_spec *ps = ps_get("keylock_tables");
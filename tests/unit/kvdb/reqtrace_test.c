@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse_util/platform.h>
+
+#include <hse_ikvdb/reqtrace.h>
+
+#define RING_SZ (1024)
+
+static struct reqtrace_rec recv[RING_SZ];
+
+int
+pre(struct mtf_test_info *info)
+{
+    /* Clears the ring.  The REST server isn't running, so the url
+     * registration fails, which reqtrace_init() tolerates.
+     */
+    return merr_errno(reqtrace_init(0));
+}
+
+int
+post(struct mtf_test_info *info)
+{
+    reqtrace_fini();
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION(reqtrace_test);
+
+MTF_DEFINE_UTEST_PREPOST(reqtrace_test, disabled, pre, post)
+{
+    u64  tstart;
+    bool traced;
+
+    traced = reqtrace_begin(REQTRACE_OP_GET);
+    ASSERT_FALSE(traced);
+
+    tstart = reqtrace_stage_start();
+    ASSERT_EQ(0, tstart);
+    reqtrace_stage_end(REQTRACE_STAGE_C0, tstart);
+
+    reqtrace_end(0);
+
+    ASSERT_EQ(0, reqtrace_snapshot(recv, RING_SZ, 0));
+}
+
+MTF_DEFINE_UTEST_PREPOST(reqtrace_test, sample, pre, post)
+{
+    u64  tstart;
+    bool traced;
+    uint n;
+
+    reqtrace_period_set(1);
+
+    traced = reqtrace_begin(REQTRACE_OP_PUT);
+    ASSERT_TRUE(traced);
+
+    /* Nested operations are not traced separately.
+     */
+    ASSERT_FALSE(reqtrace_begin(REQTRACE_OP_GET));
+
+    tstart = reqtrace_stage_start();
+    ASSERT_NE(0, tstart);
+    reqtrace_stage_end(REQTRACE_STAGE_WAL, tstart);
+
+    tstart = reqtrace_stage_start();
+    reqtrace_stage_end(REQTRACE_STAGE_C0, tstart);
+    tstart = reqtrace_stage_start();
+    reqtrace_stage_end(REQTRACE_STAGE_C0, tstart);
+
+    reqtrace_stage_add(REQTRACE_STAGE_THROTTLE, 5000);
+
+    reqtrace_end(merr(ENOSPC));
+
+    /* Stages entered outside a traced operation are ignored.
+     */
+    ASSERT_EQ(0, reqtrace_stage_start());
+    reqtrace_stage_add(REQTRACE_STAGE_LC, 1000);
+
+    n = reqtrace_snapshot(recv, RING_SZ, 0);
+    ASSERT_EQ(1, n);
+
+    ASSERT_EQ(1, recv[0].rr_seq);
+    ASSERT_EQ(REQTRACE_OP_PUT, recv[0].rr_op);
+    ASSERT_EQ(ENOSPC, recv[0].rr_errno);
+    ASSERT_NE(0, recv[0].rr_tid);
+    ASSERT_GE(recv[0].rr_total, 5000);
+    ASSERT_EQ(1, recv[0].rr_cnt[REQTRACE_STAGE_WAL]);
+    ASSERT_EQ(2, recv[0].rr_cnt[REQTRACE_STAGE_C0]);
+    ASSERT_EQ(1, recv[0].rr_cnt[REQTRACE_STAGE_THROTTLE]);
+    ASSERT_EQ(5000, recv[0].rr_ns[REQTRACE_STAGE_THROTTLE]);
+    ASSERT_EQ(0, recv[0].rr_cnt[REQTRACE_STAGE_LC]);
+    ASSERT_EQ(0, recv[0].rr_ns[REQTRACE_STAGE_LC]);
+
+    ASSERT_STREQ("put", reqtrace_op_name(recv[0].rr_op));
+    ASSERT_STREQ("throttle", reqtrace_stage_name(REQTRACE_STAGE_THROTTLE));
+    ASSERT_STREQ("invalid", reqtrace_stage_name(REQTRACE_STAGE_MAX));
+}
+
+MTF_DEFINE_UTEST_PREPOST(reqtrace_test, period, pre, post)
+{
+    const uint period = 4;
+    uint       i, n;
+
+    reqtrace_period_set(period);
+
+    for (i = 0; i < period * 8; i++) {
+        if (reqtrace_begin(REQTRACE_OP_GET))
+            reqtrace_end(0);
+    }
+
+    n = reqtrace_snapshot(recv, RING_SZ, 0);
+    ASSERT_EQ(8, n);
+
+    for (i = 0; i < n; i++)
+        ASSERT_EQ(i + 1, recv[i].rr_seq);
+
+    /* Disabling tracing takes effect immediately.
+     */
+    reqtrace_period_set(0);
+
+    for (i = 0; i < period * 8; i++)
+        ASSERT_FALSE(reqtrace_begin(REQTRACE_OP_GET));
+}
+
+MTF_DEFINE_UTEST_PREPOST(reqtrace_test, min_ns, pre, post)
+{
+    uint i, n;
+
+    reqtrace_period_set(1);
+
+    for (i = 0; i < 10; i++) {
+        ASSERT_TRUE(reqtrace_begin(REQTRACE_OP_DEL));
+        if (i % 2)
+            usleep(2000);
+        reqtrace_end(0);
+    }
+
+    n = reqtrace_snapshot(recv, RING_SZ, 0);
+    ASSERT_EQ(10, n);
+
+    n = reqtrace_snapshot(recv, RING_SZ, 2000 * 1000);
+    ASSERT_EQ(5, n);
+
+    for (i = 0; i < n; i++) {
+        ASSERT_EQ(0, recv[i].rr_seq % 2);
+        ASSERT_GE(recv[i].rr_total, 2000 * 1000);
+    }
+
+    /* A short output vector gets the oldest samples.
+     */
+    n = reqtrace_snapshot(recv, 3, 0);
+    ASSERT_EQ(3, n);
+    ASSERT_EQ(1, recv[0].rr_seq);
+}
+
+MTF_DEFINE_UTEST_PREPOST(reqtrace_test, wrap, pre, post)
+{
+    uint i, n;
+
+    reqtrace_period_set(1);
+
+    for (i = 0; i < RING_SZ * 2 + 17; i++) {
+        ASSERT_TRUE(reqtrace_begin(REQTRACE_OP_CURSOR_READ));
+        reqtrace_end(0);
+    }
+
+    n = reqtrace_snapshot(recv, RING_SZ, 0);
+    ASSERT_EQ(RING_SZ, n);
+
+    for (i = 0; i < n; i++)
+        ASSERT_EQ(RING_SZ + 17 + 1 + i, recv[i].rr_seq);
+}
+
+MTF_END_UTEST_COLLECTION(reqtrace_test);
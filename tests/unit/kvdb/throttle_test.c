@@ -255,4 +255,74 @@ MTF_DEFINE_UTEST_PRE(test, t_range, pre_test)
     }
 }
 
+MTF_DEFINE_UTEST_PRE(test, t_predictive, pre_test)
+{
+    struct throttle_debt *td;
+    const u64             drain = 100ul << 20;
+    u64                   rate;
+    uint                  horizon;
+    int                   i;
+
+    kvdb_rp = kvdb_rparams_defaults();
+    kvdb_rp.throttle_init_policy = THROTTLE_DELAY_START_PREDICTIVE;
+
+    t = &throttlebuf;
+    throttle_init(t, &kvdb_rp, __func__);
+    for (i = 0; i < sc; i++)
+        sv[i] = throttle_sensor(t, i);
+    throttle_init_params(t, &kvdb_rp);
+
+    ASSERT_TRUE(t->thr_predictive);
+    ASSERT_EQ(THROTTLE_DELAY_START_MEDIUM, throttle_delay(t));
+
+    td = throttle_debt(t);
+    throttle_debt_drain_set(td, drain);
+
+    /* Root at its stall mark: pace at the drain rate. */
+    throttle_debt_set(td, 19, 19, 19ul << 30);
+    for (i = 0; i < 1000; i++)
+        throttle_update(t);
+
+    rate = throttle_raw_to_rate(throttle_delay(t));
+    ASSERT_GE(rate, drain - drain / 100);
+    ASSERT_LE(rate, drain + drain / 100);
+
+    /* Root half full: headroom allows ingest above the drain rate. */
+    throttle_debt_set(td, 9, 19, 9ul << 30);
+    for (i = 0; i < 1000; i++)
+        throttle_update(t);
+
+    rate = throttle_raw_to_rate(throttle_delay(t));
+    ASSERT_GT(rate, 2 * drain);
+
+    /* Root over its stall mark: pace below the drain rate. */
+    throttle_debt_set(td, 29, 19, 29ul << 30);
+    for (i = 0; i < 1000; i++)
+        throttle_update(t);
+
+    rate = throttle_raw_to_rate(throttle_delay(t));
+    ASSERT_LT(rate, drain);
+
+    /* Sleeps longer than the p99 target shorten the debt horizon. */
+    horizon = t->thr_pred.tp_horizon_ms;
+    for (i = 0; i < 1000; i++) {
+        throttle_lat_record(t, kvdb_rp.throttle_sleep_p99_us * 2000ul);
+        throttle_update(t);
+    }
+
+    ASSERT_LT(t->thr_pred.tp_horizon_ms, horizon);
+    ASSERT_GE(t->thr_pred.tp_horizon_ms, THROTTLE_PRED_HORIZON_MIN);
+
+    /* A saturated c0sk sensor overrides the debt model. */
+    throttle_debt_set(td, 9, 19, 9ul << 30);
+    throttle_sensor_set(sv[THROTTLE_SENSOR_C0SK], 2 * THROTTLE_SENSOR_SCALE);
+    for (i = 0; i < 1000; i++)
+        throttle_update(t);
+
+    ASSERT_LE(t->thr_pred.tp_target, t->thr_pred.tp_rate + t->thr_pred.tp_rate / 100);
+    throttle_debug(t);
+
+    throttle_fini(t);
+}
+
 MTF_END_UTEST_COLLECTION(test);
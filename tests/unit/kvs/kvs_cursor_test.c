@@ -125,7 +125,7 @@ void verify_range(struct mtf_test_info *lcl_ti, const char *pfx, int start, int
     struct hse_kvs_cursor *cur;
     struct kvs_ktuple kt;
 
-    cur = kvs_cursor_alloc(kvs, pfx, strlen(pfx), false);
+    cur = kvs_cursor_alloc(kvs, pfx, strlen(pfx), false, false);
     ASSERT_NE(NULL, cur);
 
     err = kvs_cursor_init(cur, NULL);
@@ -205,7 +205,7 @@ MTF_DEFINE_UTEST_PREPOST(kvs_cursor_test, val_copy_null_val_out, test_pre, test_
 
     insert_key(lcl_ti, data);
 
-    cur = kvs_cursor_alloc(kvs, NULL, 0, false);
+    cur = kvs_cursor_alloc(kvs, NULL, 0, false, false);
     ASSERT_NE(NULL, cur);
 
     err = kvs_cursor_init(cur, NULL);
@@ -311,6 +311,98 @@ MTF_DEFINE_UTEST_PREPOST(mdc_test, mdc_io_basic, mpool_test_pre, mpool_test_post
     free(rdbuf);
 }
 
+MTF_DEFINE_UTEST_PREPOST(mdc_test, mdc_io_appendv, mpool_test_pre, mpool_test_post)
+{
+    struct mpool     *mp;
+    struct mpool_mdc *mdc;
+    struct iovec      iov[8];
+
+    uint64_t logid1, logid2;
+    merr_t   err;
+    char    *buf, *rdbuf;
+    size_t   bufsz = 16 << 10, rdlen;
+    int      i;
+
+    err = mpool_create(home, &tcparams);
+    ASSERT_EQ(0, err);
+
+    err = mpool_open(home, &trparams, O_RDWR, &mp);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_alloc(mp, MDC_TEST_MAGIC, MDC_TEST_CAP, HSE_MCLASS_CAPACITY, &logid1, &logid2);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_commit(mp, logid1, logid2);
+    ASSERT_EQ(0, err);
+
+    buf = malloc(bufsz);
+    ASSERT_NE(NULL, buf);
+    randomize_buffer(buf, bufsz, 17);
+
+    rdbuf = calloc(1, bufsz);
+    ASSERT_NE(NULL, rdbuf);
+
+    err = mpool_mdc_open(mp, logid1, logid2, false, &mdc);
+    ASSERT_EQ(0, err);
+
+    /* Odd lengths exercise the alignment padding between records,
+     * and the last record is large enough to have used the pwrite path.
+     */
+    for (i = 0; i < NELEM(iov); i++) {
+        iov[i].iov_base = buf + i * 13;
+        iov[i].iov_len = (i == NELEM(iov) - 1) ? 3 * 4096 + 5 : 7 * i + 1;
+    }
+
+    err = mpool_mdc_append(mdc, "head", 4, false);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_appendv(mdc, iov, NELEM(iov), true);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_append(mdc, "tail", 4, true);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_close(mdc);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_open(mp, logid1, logid2, false, &mdc);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_read(mdc, rdbuf, bufsz, &rdlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, rdlen);
+    ASSERT_EQ(0, memcmp(rdbuf, "head", 4));
+
+    for (i = 0; i < NELEM(iov); i++) {
+        err = mpool_mdc_read(mdc, rdbuf, bufsz, &rdlen);
+        ASSERT_EQ(0, err);
+        ASSERT_EQ(iov[i].iov_len, rdlen);
+        ASSERT_EQ(0, memcmp(rdbuf, iov[i].iov_base, rdlen));
+    }
+
+    err = mpool_mdc_read(mdc, rdbuf, bufsz, &rdlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(4, rdlen);
+    ASSERT_EQ(0, memcmp(rdbuf, "tail", 4));
+
+    err = mpool_mdc_read(mdc, rdbuf, bufsz, &rdlen);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, rdlen);
+
+    err = mpool_mdc_close(mdc);
+    ASSERT_EQ(0, err);
+
+    err = mpool_mdc_delete(mp, logid1, logid2);
+    ASSERT_EQ(0, err);
+
+    err = mpool_close(mp);
+    ASSERT_EQ(0, err);
+    mpool_destroy(home, &tdparams);
+
+    free(buf);
+    free(rdbuf);
+}
+
 static void
 mdc_rw_test(
     struct mtf_test_info *lcl_ti,
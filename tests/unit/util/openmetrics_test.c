@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+#include <mtf/framework.h>
+
+#include <hse_util/platform.h>
+#include <hse_util/perfc.h>
+#include <hse_util/openmetrics.h>
+
+static int  pipefd[2];
+static char outbuf[64 * 1024];
+
+/* Drain the read side of the pipe into outbuf.
+ */
+static size_t
+drain(void)
+{
+    ssize_t cc;
+    size_t  n = 0;
+
+    while (n < sizeof(outbuf) - 1) {
+        cc = read(pipefd[0], outbuf + n, sizeof(outbuf) - 1 - n);
+        if (cc <= 0)
+            break;
+        n += cc;
+    }
+
+    outbuf[n] = '\000';
+
+    return n;
+}
+
+int
+pre(struct mtf_test_info *info)
+{
+    int rc;
+
+    rc = pipe2(pipefd, O_NONBLOCK);
+    if (rc)
+        return errno;
+
+    memset(outbuf, 0, sizeof(outbuf));
+
+    return 0;
+}
+
+int
+post(struct mtf_test_info *info)
+{
+    close(pipefd[0]);
+    close(pipefd[1]);
+
+    return 0;
+}
+
+MTF_BEGIN_UTEST_COLLECTION(openmetrics_test);
+
+MTF_DEFINE_UTEST_PREPOST(openmetrics_test, writer, pre, post)
+{
+    struct om_writer w;
+    char             buf[64];
+    char             labels[OM_LABELS_MAX];
+    size_t           off = 0;
+    merr_t           err;
+    int              i;
+
+    om_label(labels, sizeof(labels), &off, "kvdb", "a\"b\\c\nd");
+    om_label(labels, sizeof(labels), &off, "queue", "root");
+    ASSERT_STREQ("kvdb=\"a\\\"b\\\\c\\nd\",queue=\"root\"", labels);
+
+    /* A label that doesn't fit is dropped, leaving the set intact.
+     */
+    om_label(labels, off + 8, &off, "mclass", "capacity");
+    ASSERT_STREQ("kvdb=\"a\\\"b\\\\c\\nd\",queue=\"root\"", labels);
+
+    /* A buffer much smaller than the document forces repeated flushes.
+     */
+    om_init(&w, pipefd[1], buf, sizeof(buf));
+
+    om_family(&w, "hse_test", "gauge", "test gauge");
+    for (i = 0; i < 100; i++)
+        om_sample(&w, "hse_test", "id=\"x\"", i);
+    om_sample(&w, "hse_test", NULL, 12345);
+
+    err = om_finish(&w);
+    ASSERT_EQ(0, err);
+
+    drain();
+
+    ASSERT_EQ(outbuf, strstr(outbuf, "# TYPE hse_test gauge\n# HELP hse_test test gauge\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "hse_test{id=\"x\"} 0\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "hse_test{id=\"x\"} 99\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "\nhse_test 12345\n# EOF\n"));
+
+    /* A line longer than the buffer is an error.
+     */
+    om_init(&w, pipefd[1], buf, 16);
+    om_sample(&w, "hse_test_with_a_long_name", NULL, 1);
+
+    err = om_finish(&w);
+    ASSERT_EQ(EMSGSIZE, merr_errno(err));
+}
+
+MTF_DEFINE_UTEST_PREPOST(openmetrics_test, perfc, pre, post)
+{
+    enum omtest_cidx {
+        PERFC_BA_OMTEST_VAL,
+        PERFC_RA_OMTEST_OPS,
+        PERFC_HG_OMTEST_LAT,
+        PERFC_BA_OMTEST_OFF,
+        PERFC_EN_OMTEST
+    };
+    struct perfc_name ctrnames[] = {
+        NE(PERFC_BA_OMTEST_VAL, 1, "omtest_val", "omtest_val"),
+        NE(PERFC_RA_OMTEST_OPS, 1, "omtest_ops", "omtest_ops"),
+        NE(PERFC_HG_OMTEST_LAT, 1, "omtest_lat", "omtest_lat"),
+        NE(PERFC_BA_OMTEST_OFF, 9, "omtest_off", "omtest_off"),
+    };
+    struct perfc_set set = { 0 };
+    struct om_writer w;
+    char             buf[1024];
+    merr_t           err;
+    int              i;
+
+    err = perfc_alloc_impl(2, "omtest", ctrnames, PERFC_EN_OMTEST, "set", __FILE__, __LINE__, &set);
+    ASSERT_EQ(0, err);
+
+    perfc_set(&set, PERFC_BA_OMTEST_VAL, 42);
+    perfc_add(&set, PERFC_RA_OMTEST_OPS, 7);
+    for (i = 1; i <= 100; i++)
+        perfc_hg_record(&set, PERFC_HG_OMTEST_LAT, i);
+
+    om_init(&w, pipefd[1], buf, sizeof(buf));
+    perfc_metrics_emit(&w);
+
+    err = om_finish(&w);
+    ASSERT_EQ(0, err);
+
+    drain();
+
+    ASSERT_NE(NULL, strstr(outbuf, "# TYPE hse_perfc_value gauge\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "# TYPE hse_perfc counter\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "# TYPE hse_perfc_latency_ns summary\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "# TYPE hse_perfc_dist summary\n"));
+
+    ASSERT_NE(NULL, strstr(outbuf,
+        "hse_perfc_value{set=\"omtest/OMTEST/set\",name=\"PERFC_BA_OMTEST_VAL\"} 42\n"));
+    ASSERT_NE(NULL, strstr(outbuf,
+        "hse_perfc_total{set=\"omtest/OMTEST/set\",name=\"PERFC_RA_OMTEST_OPS\"} 7\n"));
+    ASSERT_NE(NULL, strstr(outbuf,
+        "hse_perfc_latency_ns_count{set=\"omtest/OMTEST/set\",name=\"PERFC_HG_OMTEST_LAT\"} 100\n"));
+    ASSERT_NE(NULL, strstr(outbuf,
+        "hse_perfc_latency_ns_sum{set=\"omtest/OMTEST/set\",name=\"PERFC_HG_OMTEST_LAT\"} 5050\n"));
+    ASSERT_NE(NULL, strstr(outbuf, "name=\"PERFC_HG_OMTEST_LAT\",quantile=\"0.99\"} "));
+
+    /* Counters above the engagement level are not rendered.
+     */
+    ASSERT_EQ(NULL, strstr(outbuf, "PERFC_BA_OMTEST_OFF"));
+
+    perfc_free(&set);
+}
+
+MTF_END_UTEST_COLLECTION(openmetrics_test);
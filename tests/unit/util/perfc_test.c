@@ -7,6 +7,7 @@
 
 #include <mtf/framework.h>
 
+#include <hse_util/platform.h>
 #include <hse_util/inttypes.h>
 #include <hse_util/hse_err.h>
 #include <hse_util/logging.h>
@@ -166,7 +167,7 @@ MTF_DEFINE_UTEST(perfc, clear_counters)
     struct dt_set_parameters    dsp;
     union dt_iterate_parameters dip;
     char *                      name;
-    int                         i, ctrc = 4;
+    int                         i, ctrc = 5;
     int                         count;
 
     ctrnames = calloc(ctrc, sizeof(*ctrnames) + 32);
@@ -186,6 +187,7 @@ MTF_DEFINE_UTEST(perfc, clear_counters)
     ctrnames[1].pcn_name = "PERFC_RA_FAM_TEST";
     ctrnames[2].pcn_name = "PERFC_LT_FAM_TEST";
     ctrnames[3].pcn_name = "PERFC_SL_FAM_TEST";
+    ctrnames[4].pcn_name = "PERFC_HG_FAM_TEST";
 
     err = perfc_alloc_impl(1, "myset", ctrnames, ctrc, "alltypes", __FILE__, __LINE__, &set);
     ASSERT_EQ(0, err);
@@ -261,6 +263,116 @@ MTF_DEFINE_UTEST(perfc, enable_counters)
     perfc_free(&set);
 }
 
+MTF_DEFINE_UTEST(perfc, histogram)
+{
+    enum perfc_hg_sidx {
+        PERFC_HG_HGTEST_LAT,
+        PERFC_BA_HGTEST_VAL,
+        PERFC_EN_HGTEST
+    };
+    struct perfc_name ctrnames[] = {
+        NE(PERFC_HG_HGTEST_LAT, 1, "hgtest_lat", "hgtest_lat"),
+        NE(PERFC_BA_HGTEST_VAL, 1, "hgtest_val", "hgtest_val"),
+    };
+    struct yaml_context yc = {
+        .yaml_indent = 0, .yaml_offset = 0,
+    };
+    union dt_iterate_parameters dip = { .yc = &yc };
+    struct dt_set_parameters    dsp;
+    struct perfc_hg_stats       stats;
+    struct perfc_set            set = { 0 };
+    u64                         sum, i, start;
+    size_t                      count;
+    merr_t                      err;
+
+    err = perfc_alloc_impl(1, "hgtest", ctrnames, PERFC_EN_HGTEST, "set", __FILE__, __LINE__, &set);
+    ASSERT_EQ(0, err);
+
+    err = perfc_hg_read(&set, PERFC_BA_HGTEST_VAL, &stats);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* Nothing recorded yet...
+     */
+    err = perfc_hg_read(&set, PERFC_HG_HGTEST_LAT, &stats);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, stats.phs_hits);
+
+    for (i = 1, sum = 0; i <= 100000; ++i) {
+        perfc_hg_record(&set, PERFC_HG_HGTEST_LAT, i);
+        sum += i;
+    }
+
+    err = perfc_hg_read(&set, PERFC_HG_HGTEST_LAT, &stats);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(100000, stats.phs_hits);
+    ASSERT_EQ(sum, stats.phs_sum);
+    ASSERT_EQ(1, stats.phs_min);
+
+    /* Reported values may exceed the true value by at most 1/64.
+     */
+    ASSERT_GE(stats.phs_max, 100000);
+    ASSERT_LE(stats.phs_max, 100000 + 100000 / 64);
+    ASSERT_GE(stats.phs_pctv[0], 50000);
+    ASSERT_LE(stats.phs_pctv[0], 50000 + 50000 / 64);
+    ASSERT_GE(stats.phs_pctv[2], 99000);
+    ASSERT_LE(stats.phs_pctv[2], 99000 + 99000 / 64);
+    ASSERT_GE(stats.phs_pctv[3], 99900);
+    ASSERT_LE(stats.phs_pctv[3], stats.phs_max);
+    ASSERT_STREQ("p999", perfc_hg_pct_name(3));
+
+    /* Values too large to track are clamped.
+     */
+    perfc_hg_record(&set, PERFC_HG_HGTEST_LAT, U64_MAX);
+
+    err = perfc_hg_read(&set, PERFC_HG_HGTEST_LAT, &stats);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(100001, stats.phs_hits);
+    ASSERT_EQ(PERFC_HG_VAL_MAX, stats.phs_max);
+
+    start = perfc_lat_start(&set);
+    ASSERT_NE(0, start);
+    perfc_lat_record(&set, PERFC_HG_HGTEST_LAT, start);
+
+    yc.yaml_buf = yamlbuf;
+    yc.yaml_buf_sz = sizeof(yamlbuf);
+    yc.yaml_emit = NULL;
+
+    count = dt_iterate_cmd(DT_OP_EMIT, perfc_ctrseti_path(&set), &dip, NULL, NULL, NULL);
+    ASSERT_GE(count, 1);
+    ASSERT_NE(NULL, strstr(yamlbuf, "type: Histogram"));
+    ASSERT_NE(NULL, strstr(yamlbuf, "hitcnt: 100002"));
+    ASSERT_NE(NULL, strstr(yamlbuf, "p9999: "));
+
+    /* With a reset interval set, a read after the interval elapses
+     * clears the histogram.
+     */
+    dsp.path = perfc_ctrseti_path(&set);
+    dsp.field = DT_FIELD_INTERVAL;
+    dsp.value = "1";
+    dsp.value_len = strlen(dsp.value);
+    dip.dsp = &dsp;
+
+    count = dt_iterate_cmd(DT_OP_SET, dsp.path, &dip, NULL, NULL, NULL);
+    ASSERT_EQ(1, count);
+
+    usleep(2000);
+
+    memset(&yc, 0, sizeof(yc));
+    yc.yaml_buf = yamlbuf;
+    yc.yaml_buf_sz = sizeof(yamlbuf);
+    dip.yc = &yc;
+
+    count = dt_iterate_cmd(DT_OP_EMIT, perfc_ctrseti_path(&set), &dip, NULL, NULL, NULL);
+    ASSERT_GE(count, 1);
+
+    err = perfc_hg_read(&set, PERFC_HG_HGTEST_LAT, &stats);
+    ASSERT_EQ(0, err);
+    ASSERT_EQ(0, stats.phs_hits);
+    ASSERT_LT(stats.phs_ivl_ns, 1000 * 1000 * 1000);
+
+    perfc_free(&set);
+}
+
 MTF_DEFINE_UTEST(perfc, perfc_ctr_name2type_fail)
 {
     const char *namev[] = {
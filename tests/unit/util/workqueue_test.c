@@ -8,6 +8,7 @@
 #include <hse_util/platform.h>
 #include <hse_util/workqueue.h>
 #include <hse_util/logging.h>
+#include <hse_util/numa.h>
 
 int verbose = 0;
 
@@ -917,4 +918,57 @@ MTF_DEFINE_UTEST(workqueue_test, requeue)
     free(workv);
 }
 
+struct bind_work {
+    struct work_struct wstruct;
+    cpu_set_t          cpuset;
+};
+
+static void
+bind_cb(struct work_struct *work)
+{
+    struct bind_work *bw = container_of(work, struct bind_work, wstruct);
+
+    sched_getaffinity(0, sizeof(bw->cpuset), &bw->cpuset);
+}
+
+MTF_DEFINE_UTEST(workqueue_test, bind_node)
+{
+    struct workqueue_struct *wq;
+    struct bind_work bw;
+    cpu_set_t nodeset, both;
+    merr_t err;
+    int i;
+
+    wq = alloc_workqueue(__func__, 0, 2, 2);
+    ASSERT_TRUE(wq);
+
+    err = workqueue_bind_node(wq, HSE_NUMA_NODES_MAX);
+    ASSERT_EQ(EINVAL, merr_errno(err));
+
+    /* Node 0 is absent on kernels built without NUMA support.
+     */
+    err = hse_numa_cpuset(0, &nodeset);
+    if (!err) {
+        err = workqueue_bind_node(wq, 0);
+        ASSERT_EQ(0, err);
+
+        /* Both existing threads must now run only on node 0 (their
+         * affinity may be narrower still if we're in a cpuset cgroup).
+         */
+        for (i = 0; i < 4; ++i) {
+            INIT_WORK(&bw.wstruct, bind_cb);
+            queue_work(wq, &bw.wstruct);
+            flush_workqueue(wq);
+
+            CPU_AND(&both, &nodeset, &bw.cpuset);
+            ASSERT_TRUE(CPU_EQUAL(&both, &bw.cpuset));
+        }
+    }
+
+    err = workqueue_bind_node(wq, -1);
+    ASSERT_EQ(0, err);
+
+    destroy_workqueue(wq);
+}
+
 MTF_END_UTEST_COLLECTION(workqueue_test)
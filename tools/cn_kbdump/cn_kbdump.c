@@ -682,7 +682,8 @@ void
 print_wbt(void *wbt_hdr, void *kblk, bool ptomb)
 {
     switch (wbt_hdr_version(wbt_hdr)) {
-        case WBT_TREE_VERSION:
+        case WBT_TREE_VERSION6:
+        case WBT_TREE_VERSION7:
             print_wbt_impl(wbt_hdr, kblk, ptomb);
             break;
         default:
@@ -0,0 +1,1730 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ */
+
+/*
+ * cn_sim - offline cn tree compaction and write amplification simulator
+ *
+ * cn_sim replays an ingest trace against real cn trees (cn_tree_create())
+ * scheduled by the real sp3 scheduler (sp3_create_offline()), driving both
+ * in simulated time.  Every spill and compaction sp3 decides on is handed
+ * to the simulator through the scheduler's submit hook, carried out on
+ * model kvsets and applied to the tree with cn_comp_apply(), so node stats,
+ * samp and the scheduler's rules, queues, priorities and per-kvs job limits
+ * are exactly those of the library.  sp3 sees only simulated time, so runs
+ * with the same parameters and seed are reproducible.  It
+ * reports write amp, space amp and tree shape as simulated time advances,
+ * so that parameter changes can be evaluated in minutes rather than by
+ * running hours-long loads.
+ *
+ * Trees start out empty, or the first one is seeded from the cn tree of an
+ * existing kvs (read via cndb exactly as cn_metrics does).
+ *
+ * The model:
+ *
+ *   - Keys are tracked in groups of -g keys that are always written
+ *     together.  A group has a random 64-bit id whose high order bits
+ *     route it through the tree, so spills distribute keys uniformly.
+ *   - A model kvset is a real struct kvset (stats, hlog, dgen, compc,
+ *     vgroups, scatter) plus the sorted list of groups it contains.
+ *     Block counts and lengths follow kbb/vbb_estimate_alen().
+ *   - Merges keep the newest version of each group.  k-compaction
+ *     rewrites keys only and keeps all input vblocks, kv-compaction and
+ *     spill rewrite both.
+ *   - A job runs for (bytes read + bytes written) / job bandwidth, but no
+ *     faster than its kvs' cn_compact_rd_mbps and cn_compact_wr_mbps
+ *     budgets allow given the other jobs of that kvs.  Ingest into a kvs
+ *     stalls while its root has ten or more idle kvsets past
+ *     rspill_kvsets_max.
+ *
+ * Not modeled: prefix spills, tombstones and mblock reuse.
+ */
+
+#include <stdio.h>
+#include <sysexits.h>
+
+#include <bsd/string.h>
+
+#include <hse/hse.h>
+#include <hse/limits.h>
+
+#include <hse_util/hlog.h>
+#include <hse_util/list.h>
+#include <hse_util/minmax.h>
+#include <hse_util/parse_num.h>
+#include <hse_util/xrand.h>
+
+#include <hse_ikvdb/argv.h>
+#include <hse_ikvdb/cn.h>
+#include <hse_ikvdb/cn_node_loc.h>
+#include <hse_ikvdb/csched.h>
+#include <hse_ikvdb/ikvdb.h>
+#include <hse_ikvdb/kvdb_health.h>
+#include <hse_ikvdb/kvdb_rparams.h>
+#include <hse_ikvdb/kvs_cparams.h>
+#include <hse_ikvdb/kvs_rparams.h>
+#include <hse_ikvdb/limits.h>
+
+#include <cn/cn_metrics.h>
+#include <cn/cn_tree.h>
+#include <cn/cn_tree_compact.h>
+#include <cn/cn_tree_create.h>
+#include <cn/cn_tree_internal.h>
+#include <cn/cn_tree_iter.h>
+#include <cn/csched_sp3.h>
+#include <cn/kblock_builder.h>
+#include <cn/kvset.h>
+#include <cn/kvset_internal.h>
+#include <cn/vblock_builder.h>
+
+#include <tools/common.h>
+#include <tools/parm_groups.h>
+
+#define MiB             (1ul << 20)
+#define GiB             (1ul << 30)
+
+/* Approximate per-key kblock overhead (key metadata, wbtree, bloom).
+ */
+#define SIM_KMD_BYTES   (12)
+
+/* The sp3 monitor loop runs at least this often, see sp3_monitor().
+ */
+#define SIM_TICK_NS     (NSEC_PER_SEC / 3)
+
+/* Stop once there has been nothing to do for this long.
+ */
+#define SIM_QUIET_NS    (NSEC_PER_SEC * 30)
+
+/* A group of keys that are always written together.
+ */
+struct sim_ent {
+    uint64_t se_id;
+    uint32_t se_vlen;
+    uint16_t se_klen;
+    uint16_t se_rank; /* merge order, newest first */
+};
+
+/* A model kvset.  The embedded kvset is what the tree and sp3 see,
+ * it must be last as it ends with a flexible array.
+ *
+ * The simulator holds a reference on every model kvset so that the tree
+ * never releases the last one (kvset_put_ref() would then try to destroy
+ * it as a real kvset).  Once the simulator's is the only reference left
+ * the kvset is reaped by sim_kvsets_reap().
+ */
+struct sim_kvset {
+    struct list_head sk_link;
+    struct sim_ent * sk_entv; /* sorted by id */
+    uint             sk_entc;
+    struct hlog *    sk_hlog;
+    struct kvset     sk_kvset;
+};
+
+#define kvset2sk(_ks) container_of(_ks, struct sim_kvset, sk_kvset)
+
+struct sim_job {
+    struct cn_compaction_work *sj_work;
+    struct sim_tree *          sj_tree;
+    struct kvset *             sj_outv[CN_FANOUT_MAX];
+    uint64_t                   sj_rbytes;
+    uint64_t                   sj_wbytes;
+    uint64_t                   sj_done;
+    bool                       sj_finished;
+};
+
+enum sim_phase_type {
+    PHASE_LOAD,
+    PHASE_UPDATE,
+    PHASE_IDLE,
+};
+
+struct sim_phase {
+    enum sim_phase_type ph_type;
+    uint64_t            ph_keys;
+    uint                ph_klen;
+    uint                ph_vlen;
+    uint64_t            ph_secs;
+};
+
+struct sim_tree {
+    struct cn_tree *   st_tree;
+    struct kvs_rparams st_rp;
+    char               st_name[HSE_KVS_NAME_LEN_MAX];
+
+    struct sim_phase *st_phasev;
+    uint              st_phasec;
+    uint              st_phx;       /* index of the current phase */
+    uint64_t          st_remaining; /* keys left in the current phase */
+    uint64_t          st_ingest_next;
+
+    /* Simulated time at which the kvs' compaction read and write
+     * budgets will have been consumed by the jobs submitted so far.
+     */
+    uint64_t st_rd_next;
+    uint64_t st_wr_next;
+
+    struct sim_ent *st_livev; /* every group ever written */
+    size_t          st_livec;
+    size_t          st_livemax;
+    uint64_t        st_live_bytes;
+
+    uint64_t st_user_bytes;
+    uint64_t st_cn_rbytes;
+    uint64_t st_cn_wbytes;
+    uint64_t st_stall_ns;
+};
+
+struct sim {
+    struct csched *     sched;
+    struct kvdb_health  health;
+    struct kvs_cparams  cp;
+    struct kvs_rparams  rp;
+    struct kvdb_rparams dbrp;
+
+    struct sim_tree *treev[HSE_KVS_COUNT_MAX];
+    uint             treec;
+
+    struct sim_job **jobv;
+    uint             jobc;
+    uint             jobmax;
+    uint64_t         txid;
+
+    struct list_head kvsets;
+
+    struct xrand xr;
+    uint         fbits;
+    uint         throttle_len;
+    uint64_t     dgen;
+    uint64_t     now;
+};
+
+struct options {
+    const char *config;
+    const char *kvdb_home;
+    const char *kvs;
+    const char *trace;
+
+    uint64_t c0_bytes;
+    uint64_t ingest_bw;
+    uint64_t job_bw;
+    uint64_t duration;
+    uint64_t interval;
+    uint64_t seed;
+    uint     group;
+    uint     klen;
+    uint     vlen;
+};
+
+static const char *progname;
+static struct options opt;
+static struct sim sim;
+
+static struct sim_phase *phasev;
+static uint phasec;
+
+static void
+usage(void)
+{
+    printf("usage: %s [options] [param=value ...]\n", progname);
+
+    printf("-b MiBps   per-job compaction bandwidth (default %lu)\n"
+           "-c MiB     c0 ingest (root kvset) size (default %lu)\n"
+           "-d secs    stop after simulating this much time\n"
+           "-g keys    keys per key group (default %u)\n"
+           "-h         show this help list\n"
+           "-i MiBps   ingest rate per kvs (default %lu)\n"
+           "-k bytes   key length (default %u)\n"
+           "-l keys    load this many new keys\n"
+           "-p secs    report interval in simulated seconds (default %lu)\n"
+           "-r seed    random number generator seed (default %lu)\n"
+           "-s db:kvs  start from the cn tree of kvs in kvdb_home db\n"
+           "-T file    replay ingest phases from file\n"
+           "-u keys    update this many uniformly chosen existing keys\n"
+           "-v bytes   value length (default %u)\n"
+           "-Z config  path to global config file\n",
+           opt.job_bw, opt.c0_bytes >> 20, opt.group, opt.ingest_bw, opt.klen,
+           opt.interval, opt.seed, opt.vlen);
+
+    printf("\nA trace file contains one phase per line, '#' starts a comment:\n"
+           "  kvs     NAME [param=value ...]\n"
+           "  load    KEYS [KLEN [VLEN]]\n"
+           "  update  KEYS [KLEN [VLEN]]\n"
+           "  idle    SECS\n"
+           "Each kvs line adds a kvs that ingests concurrently with the others,\n"
+           "its parameters override %s parameters for that kvs only, and the\n"
+           "phases that follow it are its own.\n",
+           PG_KVS_OPEN);
+
+    printf("\nScheduler parameters are taken from %s (e.g., csched_rspill_params),\n"
+           "node sizes and compaction budgets from %s (e.g., cn_compact_rd_mbps)\n"
+           "and fanout from %s.  Without -s the simulation starts from empty trees.\n",
+           PG_KVDB_OPEN, PG_KVS_OPEN, PG_KVS_CREATE);
+}
+
+static void
+syntax(const char *fmt, ...)
+{
+    char    msg[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    fprintf(stderr, "%s: %s, use -h for help\n", progname, msg);
+    exit(EX_USAGE);
+}
+
+static void
+phase_add(
+    struct sim_phase **phasevp,
+    uint *             phasecp,
+    enum sim_phase_type type,
+    uint64_t           keys,
+    uint               klen,
+    uint               vlen,
+    uint64_t           secs)
+{
+    struct sim_phase *ph;
+
+    ph = realloc(*phasevp, (*phasecp + 1) * sizeof(*ph));
+    if (!ph)
+        fatal(ENOMEM, "phase_add");
+
+    *phasevp = ph;
+    ph += (*phasecp)++;
+
+    ph->ph_type = type;
+    ph->ph_keys = keys;
+    ph->ph_klen = clamp_t(uint, klen, 1, HSE_KVS_KEY_LEN_MAX);
+    ph->ph_vlen = vlen;
+    ph->ph_secs = secs;
+}
+
+static struct sim_tree *
+sim_tree_add(const char *name, int argc, char **argv)
+{
+    struct sim_tree *st;
+    merr_t err;
+
+    if (sim.treec >= NELEM(sim.treev))
+        fatal(EINVAL, "too many kvs, at most %zu are supported", NELEM(sim.treev));
+
+    st = calloc(1, sizeof(*st));
+    if (!st)
+        fatal(ENOMEM, "sim_tree_add");
+
+    strlcpy(st->st_name, name, sizeof(st->st_name));
+
+    st->st_rp = sim.rp;
+
+    err = argv_deserialize_to_kvs_rparams(argc, (const char *const *)argv, &st->st_rp);
+    if (err)
+        fatal(err, "invalid parameters for kvs %s", name);
+
+    sim.treev[sim.treec++] = st;
+
+    return st;
+}
+
+static void
+trace_load(const char *path)
+{
+    struct sim_tree *st = sim.treec ? sim.treev[sim.treec - 1] : NULL;
+    char  line[1024];
+    uint  lineno = 0;
+    FILE *fp;
+
+    fp = fopen(path, "r");
+    if (!fp)
+        fatal(errno, "unable to open %s", path);
+
+    while (fgets(line, sizeof(line), fp)) {
+        char     op[32], arg[HSE_KVS_NAME_LEN_MAX];
+        uint     klen = opt.klen, vlen = opt.vlen;
+        uint64_t n;
+        char    *cp;
+        int      cc;
+
+        ++lineno;
+
+        cp = strchr(line, '#');
+        if (cp)
+            *cp = '\000';
+
+        cc = sscanf(line, "%31s %31s %u %u", op, arg, &klen, &vlen);
+        if (cc < 1)
+            continue;
+
+        if (cc < 2)
+            fatal(EINVAL, "%s:%u: invalid phase", path, lineno);
+
+        if (!strcmp(op, "kvs")) {
+            char *argv[32], *tok;
+            int   argc = 0;
+
+            strtok(line, " \t\n");
+            strtok(NULL, " \t\n");
+
+            while ((tok = strtok(NULL, " \t\n")) && argc < NELEM(argv))
+                argv[argc++] = tok;
+
+            st = sim_tree_add(arg, argc, argv);
+            continue;
+        }
+
+        if (parse_size(arg, &n))
+            fatal(EINVAL, "%s:%u: invalid phase", path, lineno);
+
+        if (!st)
+            st = sim_tree_add("kvs", 0, NULL);
+
+        if (!strcmp(op, "load"))
+            phase_add(&st->st_phasev, &st->st_phasec, PHASE_LOAD, n, klen, vlen, 0);
+        else if (!strcmp(op, "update"))
+            phase_add(&st->st_phasev, &st->st_phasec, PHASE_UPDATE, n, klen, vlen, 0);
+        else if (!strcmp(op, "idle"))
+            phase_add(&st->st_phasev, &st->st_phasec, PHASE_IDLE, 0, 0, 0, n);
+        else
+            fatal(EINVAL, "%s:%u: unknown phase type %s", path, lineno, op);
+    }
+
+    fclose(fp);
+}
+
+/*----------------------------------------------------------------
+ * Model kvsets
+ */
+
+static uint64_t
+sim_hash(uint64_t id, uint i)
+{
+    uint64_t h = id + (i + 1) * 0x9e3779b97f4a7c15ul;
+
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ul;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebul;
+
+    return h ^ (h >> 31);
+}
+
+/* Index of the child of a level @level node that key group @id spills to.
+ */
+static uint
+sim_child(uint64_t id, uint level)
+{
+    uint shift = 64 - sim.fbits * (level + 1);
+
+    return (id >> shift) & (sim.cp.fanout - 1);
+}
+
+/* Create a kvset from @entc sorted key groups, which it takes ownership
+ * of.  Key and value stats are derived from the groups as if every key
+ * and value were written anew, callers adjust them for vblock reuse.
+ */
+static struct kvset *
+sim_kvset_create(
+    struct sim_tree *st,
+    struct sim_ent * entv,
+    uint             entc,
+    uint64_t         dgen,
+    uint             compc)
+{
+    struct kvset_stats *kst;
+    struct sim_kvset *  sk;
+    struct kvset *      ks;
+    uint64_t            kwlen = 0, vwlen = 0;
+    uint                i, j;
+    merr_t              err;
+
+    assert(entc > 0);
+
+    sk = calloc(1, sizeof(*sk));
+    if (!sk)
+        fatal(ENOMEM, "sim_kvset_create");
+
+    err = hlog_create(&sk->sk_hlog, HLOG_PRECISION);
+    if (err)
+        fatal(err, "hlog_create");
+
+    for (i = 0; i < entc; ++i) {
+        kwlen += (uint64_t)opt.group * (entv[i].se_klen + SIM_KMD_BYTES);
+        vwlen += (uint64_t)opt.group * entv[i].se_vlen;
+
+        for (j = 0; j < opt.group; ++j)
+            hlog_add(sk->sk_hlog, sim_hash(entv[i].se_id, j));
+    }
+
+    sk->sk_entv = entv;
+    sk->sk_entc = entc;
+
+    ks = &sk->sk_kvset;
+    ks->ks_entry.le_kvset = ks;
+    ks->ks_dgen = dgen;
+    ks->ks_compc = compc;
+    ks->ks_rp = &st->st_rp;
+    ks->ks_tree = st->st_tree;
+    ks->ks_hlog = hlog_data(sk->sk_hlog);
+    ks->ks_vgroups = vwlen ? 1 : 0;
+    ks->ks_scatter = vwlen ? 1 : 0;
+    atomic_set(&ks->ks_ref, 2); /* tree and simulator */
+
+    kst = &ks->ks_st;
+    kst->kst_kvsets = 1;
+    kst->kst_keys = (uint64_t)entc * opt.group;
+    kst->kst_kwlen = kwlen;
+    kst->kst_kalen = kbb_estimate_alen(NULL, kwlen, HSE_MCLASS_CAPACITY);
+    kst->kst_kblks = (kwlen + KBLOCK_MAX_SIZE - 1) / KBLOCK_MAX_SIZE;
+    kst->kst_vwlen = vwlen;
+    kst->kst_vulen = vwlen;
+    kst->kst_valen = vbb_estimate_alen(NULL, vwlen, HSE_MCLASS_CAPACITY);
+    kst->kst_vblks = (vwlen + VBLOCK_MAX_SIZE - 1) / VBLOCK_MAX_SIZE;
+
+    list_add_tail(&sk->sk_link, &sim.kvsets);
+
+    return ks;
+}
+
+/* Free the model kvsets the tree has released.  Model kvsets have no
+ * mblocks, so there is nothing else to clean up.
+ */
+static void
+sim_kvsets_reap(void)
+{
+    struct sim_kvset *sk, *next;
+
+    list_for_each_entry_safe (sk, next, &sim.kvsets, sk_link) {
+        if (atomic_read(&sk->sk_kvset.ks_ref) > 1)
+            continue;
+
+        list_del(&sk->sk_link);
+        hlog_destroy(sk->sk_hlog);
+        free(sk->sk_entv);
+        free(sk);
+    }
+}
+
+static int
+ent_cmp(const void *lhs, const void *rhs)
+{
+    const struct sim_ent *l = lhs, *r = rhs;
+
+    if (l->se_id != r->se_id)
+        return l->se_id < r->se_id ? -1 : 1;
+
+    return (int)l->se_rank - (int)r->se_rank;
+}
+
+static struct sim_ent *
+ent_dup(const struct sim_ent *entv, uint entc)
+{
+    struct sim_ent *dup;
+
+    dup = malloc(entc * sizeof(*dup));
+    if (!dup)
+        fatal(ENOMEM, "ent_dup");
+
+    return memcpy(dup, entv, entc * sizeof(*dup));
+}
+
+/*----------------------------------------------------------------
+ * Compaction jobs
+ */
+
+static struct sim_tree *
+sim_tree_find(const struct cn_tree *tree)
+{
+    uint i;
+
+    for (i = 0; i < sim.treec; ++i) {
+        if (sim.treev[i]->st_tree == tree)
+            return sim.treev[i];
+    }
+
+    abort();
+}
+
+static struct sim_job *
+sim_job_find(const struct cn_compaction_work *w)
+{
+    uint i;
+
+    for (i = 0; i < sim.jobc; ++i) {
+        if (sim.jobv[i]->sj_work == w)
+            return sim.jobv[i];
+    }
+
+    return NULL;
+}
+
+/* Carry out the merge sp3 asked for, leaving its output in @sj->sj_outv
+ * until the job completes.  The input kvsets are marked and cannot change
+ * while the job is running, so doing it at submit time is equivalent.
+ */
+static void
+sim_job_build(struct sim_job *sj)
+{
+    struct cn_compaction_work *w = sj->sj_work;
+    struct cn_merge_stats *    ms = &w->cw_stats;
+    struct sim_tree *          st = sj->sj_tree;
+    struct kvset_list_entry *  le;
+    struct sim_ent *           mergev;
+    struct kvset_stats         in = { 0 };
+    uint                       vgroups = 0, scatter = 0;
+    uint                       level, compc, rank;
+    size_t                     n, m, i;
+    bool                       spill, keepv;
+
+    spill = w->cw_action == CN_ACTION_SPILL;
+    keepv = w->cw_action == CN_ACTION_COMPACT_K;
+    level = w->cw_node->tn_loc.node_level;
+
+    /* Gather the input key groups, oldest kvset first.
+     */
+    n = 0;
+    le = w->cw_mark;
+    for (i = 0; i < w->cw_kvset_cnt; ++i) {
+        n += kvset2sk(le->le_kvset)->sk_entc;
+        le = list_prev_entry(le, le_link);
+    }
+
+    mergev = malloc(n * sizeof(*mergev));
+    if (!mergev)
+        fatal(ENOMEM, "sim_job_build");
+
+    n = 0;
+    rank = w->cw_kvset_cnt;
+    le = w->cw_mark;
+    for (i = 0; i < w->cw_kvset_cnt; ++i) {
+        struct kvset *    ks = le->le_kvset;
+        struct sim_kvset *sk = kvset2sk(ks);
+        uint              j;
+
+        --rank;
+        for (j = 0; j < sk->sk_entc; ++j) {
+            mergev[n] = sk->sk_entv[j];
+            mergev[n++].se_rank = rank;
+        }
+
+        kvset_stats_add(&ks->ks_st, &in);
+        vgroups += ks->ks_vgroups;
+        scatter += ks->ks_scatter;
+
+        le = list_prev_entry(le, le_link);
+    }
+
+    /* Keep only the newest version of each key group.
+     */
+    qsort(mergev, n, sizeof(*mergev), ent_cmp);
+
+    for (i = m = 0; i < n; ++i) {
+        if (m > 0 && mergev[m - 1].se_id == mergev[i].se_id)
+            continue;
+        mergev[m++] = mergev[i];
+    }
+
+    /* Output compc follows cn_comp_commit().
+     */
+    compc = 0;
+    if (!spill) {
+        le = list_next_entry_or_null(w->cw_mark, le_link, &w->cw_node->tn_kvset_list);
+        compc = w->cw_compc;
+        if (!le || w->cw_compc < kvset_get_compc(le->le_kvset))
+            compc++;
+    }
+
+    w->cw_outc = spill ? sim.cp.fanout : 1;
+    w->cw_outk = 0;
+
+    for (i = 0; i < m;) {
+        struct kvset_stats *kst;
+        struct kvset *      ks;
+        uint                cx = spill ? sim_child(mergev[i].se_id, level) : 0;
+        size_t              j = i + 1;
+
+        while (j < m && (!spill || sim_child(mergev[j].se_id, level) == cx))
+            ++j;
+
+        ks = sim_kvset_create(st, ent_dup(mergev + i, j - i), j - i, w->cw_dgen_hi, compc);
+        kst = &ks->ks_st;
+
+        ms->ms_keys_out += kst->kst_keys;
+        ms->ms_key_bytes_out += kst->kst_kwlen;
+        ms->ms_val_bytes_out += kst->kst_vulen;
+        ms->ms_kblk_write.op_size += kst->kst_kwlen;
+
+        if (keepv) {
+            kst->kst_vwlen = in.kst_vwlen;
+            kst->kst_valen = in.kst_valen;
+            kst->kst_vblks = in.kst_vblks;
+            ks->ks_vgroups = vgroups;
+            ks->ks_scatter = scatter;
+        } else {
+            ms->ms_vblk_read1.op_size += kst->kst_vwlen;
+            ms->ms_vblk_write.op_size += kst->kst_vwlen;
+        }
+
+        sj->sj_outv[cx] = ks;
+        w->cw_outk++;
+        i = j;
+    }
+
+    free(mergev);
+
+    w->cw_keep_vblks = keepv;
+    w->cw_vbmap.vbm_blkc = keepv ? in.kst_vblks : 0;
+
+    ms->ms_srcs = w->cw_kvset_cnt;
+    ms->ms_keys_in = in.kst_keys;
+    ms->ms_key_bytes_in = in.kst_kwlen;
+    ms->ms_kblk_read.op_size = in.kst_kwlen;
+
+    sj->sj_rbytes = ms->ms_kblk_read.op_size + ms->ms_vblk_read1.op_size;
+    sj->sj_wbytes = ms->ms_kblk_write.op_size + ms->ms_vblk_write.op_size;
+}
+
+/* A job takes (bytes read + bytes written) / job bandwidth, but cannot
+ * finish before the kvs' read and write budgets have paid for its i/o
+ * on top of that of the jobs submitted before it.
+ */
+static uint64_t
+sim_job_duration(struct sim_job *sj)
+{
+    const struct kvs_rparams *rp = &sj->sj_tree->st_rp;
+    struct sim_tree *st = sj->sj_tree;
+    uint64_t done;
+
+    done = sim.now + (double)(sj->sj_rbytes + sj->sj_wbytes) * NSEC_PER_SEC / opt.job_bw;
+
+    if (rp->cn_compact_rd_mbps > 0) {
+        st->st_rd_next = max(st->st_rd_next, sim.now);
+        st->st_rd_next += (double)sj->sj_rbytes * NSEC_PER_SEC / (rp->cn_compact_rd_mbps * MiB);
+        done = max(done, st->st_rd_next);
+    }
+
+    if (rp->cn_compact_wr_mbps > 0) {
+        st->st_wr_next = max(st->st_wr_next, sim.now);
+        st->st_wr_next += (double)sj->sj_wbytes * NSEC_PER_SEC / (rp->cn_compact_wr_mbps * MiB);
+        done = max(done, st->st_wr_next);
+    }
+
+    return done;
+}
+
+/* sp3's submit hook: instead of running the job on an sts thread, build
+ * its output and schedule its completion in simulated time.
+ */
+static void
+sim_job_submit(struct cn_compaction_work *w)
+{
+    struct sim_job *sj;
+
+    if (sim.jobc == sim.jobmax) {
+        struct sim_job **jobv;
+
+        jobv = realloc(sim.jobv, (sim.jobmax + 16) * sizeof(*jobv));
+        if (!jobv)
+            fatal(ENOMEM, "sim_job_submit");
+
+        sim.jobv = jobv;
+        sim.jobmax += 16;
+    }
+
+    sj = calloc(1, sizeof(*sj));
+    if (!sj)
+        fatal(ENOMEM, "sim_job_submit");
+
+    sj->sj_work = w;
+    sj->sj_tree = sim_tree_find(w->cw_tree);
+
+    sim_job_build(sj);
+
+    sj->sj_done = sim_job_duration(sj);
+
+    /* cn_comp_apply() retires the input kvsets under the job's cndb
+     * transaction id, which offline is ours to assign.
+     */
+    w->cw_work_txid = ++sim.txid;
+
+    w->cw_t0_enqueue = sim.now;
+    w->cw_t1_qtime = sim.now;
+    w->cw_t2_prep = sim.now;
+    w->cw_t3_build = sj->sj_done;
+    w->cw_t4_commit = sj->sj_done;
+
+    sim.jobv[sim.jobc++] = sj;
+}
+
+static void
+sim_job_apply(struct sim_job *sj)
+{
+    struct sim_tree *st = sj->sj_tree;
+    uint i;
+
+    st->st_cn_rbytes += sj->sj_rbytes;
+    st->st_cn_wbytes += sj->sj_wbytes;
+
+    for (i = 0; i < sim.jobc; ++i) {
+        if (sim.jobv[i] == sj) {
+            sim.jobv[i] = sim.jobv[--sim.jobc];
+            break;
+        }
+    }
+
+    /* The work is handed back to sp3, which frees it. */
+    cn_comp_apply(sj->sj_work, sj->sj_outv);
+    free(sj);
+}
+
+/* Concurrent root spills must be applied in the order they were started,
+ * so a finished spill waits for those ahead of it on the node's list.
+ */
+static void
+sim_job_finish(struct sim_job *sj)
+{
+    struct cn_compaction_work *w = sj->sj_work;
+    struct cn_tree_node *tn = w->cw_node;
+
+    if (!w->cw_rspill_conc) {
+        sim_job_apply(sj);
+        return;
+    }
+
+    sj->sj_finished = true;
+
+    while (1) {
+        struct cn_compaction_work *head;
+
+        head = list_first_entry_or_null(&tn->tn_rspills, typeof(*head), cw_rspill_link);
+        if (!head)
+            break;
+
+        sj = sim_job_find(head);
+        if (!sj || !sj->sj_finished)
+            break;
+
+        sim_job_apply(sj);
+    }
+}
+
+/* Finish every job that is done by now, earliest first.
+ */
+static void
+sim_jobs_finish(void)
+{
+    while (1) {
+        struct sim_job *sj = NULL;
+        uint i;
+
+        for (i = 0; i < sim.jobc; ++i) {
+            struct sim_job *p = sim.jobv[i];
+
+            if (p->sj_finished || p->sj_done > sim.now)
+                continue;
+
+            if (!sj || p->sj_done < sj->sj_done)
+                sj = p;
+        }
+
+        if (!sj)
+            break;
+
+        sim_job_finish(sj);
+    }
+}
+
+/*----------------------------------------------------------------
+ * Ingest
+ */
+
+static void
+sim_live_add(struct sim_tree *st, const struct sim_ent *ent)
+{
+    if (st->st_livec == st->st_livemax) {
+        size_t max = st->st_livemax ? st->st_livemax * 2 : 1024;
+        struct sim_ent *livev;
+
+        livev = realloc(st->st_livev, max * sizeof(*livev));
+        if (!livev)
+            fatal(ENOMEM, "sim_live_add");
+
+        st->st_livev = livev;
+        st->st_livemax = max;
+    }
+
+    st->st_livev[st->st_livec++] = *ent;
+    st->st_live_bytes += (uint64_t)opt.group * (ent->se_klen + ent->se_vlen);
+}
+
+static bool
+sim_stalled(const struct sim_tree *st)
+{
+    struct kvset_list_entry *le;
+    uint idle = 0;
+
+    if (sim.jobc == 0)
+        return false;
+
+    list_for_each_entry (le, &st->st_tree->ct_root->tn_kvset_list, le_link) {
+        if (kvset_get_workid(le->le_kvset) == 0)
+            idle++;
+    }
+
+    return idle >= sim.throttle_len;
+}
+
+/* Advance a kvs to its next load or update phase.  Idle phases simply
+ * defer the next ingest.
+ */
+static void
+sim_phase_next(struct sim_tree *st)
+{
+    while (st->st_phx < st->st_phasec) {
+        const struct sim_phase *ph = st->st_phasev + st->st_phx;
+
+        if (ph->ph_type != PHASE_IDLE && st->st_remaining == 0) {
+            st->st_remaining = ph->ph_keys;
+            if (st->st_remaining > 0)
+                return;
+        }
+
+        if (ph->ph_type == PHASE_IDLE)
+            st->st_ingest_next = max(st->st_ingest_next, sim.now) + ph->ph_secs * NSEC_PER_SEC;
+
+        st->st_phx++;
+        st->st_remaining = 0;
+    }
+}
+
+static bool
+sim_ingesting(const struct sim_tree *st)
+{
+    return st->st_phx < st->st_phasec;
+}
+
+static void
+sim_ingest(struct sim_tree *st)
+{
+    const struct sim_phase *ph = st->st_phasev + st->st_phx;
+    struct cn_samp_stats pre, post;
+    struct sim_ent *entv;
+    struct kvset *ks;
+    uint64_t bytes, keys;
+    uint i, m, n;
+
+    keys = opt.c0_bytes / (ph->ph_klen + ph->ph_vlen);
+    keys = clamp_t(uint64_t, keys, 1, st->st_remaining);
+
+    n = (keys + opt.group - 1) / opt.group;
+    keys = min_t(uint64_t, (uint64_t)n * opt.group, st->st_remaining);
+
+    entv = malloc(n * sizeof(*entv));
+    if (!entv)
+        fatal(ENOMEM, "sim_ingest");
+
+    for (i = 0; i < n; ++i) {
+        struct sim_ent *ent = entv + i;
+
+        if (ph->ph_type == PHASE_LOAD || st->st_livec == 0) {
+            ent->se_id = xrand64(&sim.xr);
+            ent->se_klen = ph->ph_klen;
+            ent->se_vlen = ph->ph_vlen;
+            sim_live_add(st, ent);
+        } else {
+            struct sim_ent *live = st->st_livev + xrand64(&sim.xr) % st->st_livec;
+
+            st->st_live_bytes -= (uint64_t)opt.group * (live->se_klen + live->se_vlen);
+            live->se_klen = ph->ph_klen;
+            live->se_vlen = ph->ph_vlen;
+            st->st_live_bytes += (uint64_t)opt.group * (live->se_klen + live->se_vlen);
+            *ent = *live;
+        }
+
+        ent->se_rank = 0;
+    }
+
+    qsort(entv, n, sizeof(*entv), ent_cmp);
+
+    for (i = m = 0; i < n; ++i) {
+        if (m > 0 && entv[m - 1].se_id == entv[i].se_id)
+            continue;
+        entv[m++] = entv[i];
+    }
+
+    ks = sim_kvset_create(st, entv, m, ++sim.dgen, 0);
+
+    /* A tree without a cn has no scheduler to notify, so do it here
+     * with the root's samp delta, as cn_tree_ingest_update() would.
+     */
+    pre = st->st_tree->ct_samp;
+    cn_tree_ingest_update(st->st_tree, ks, NULL, 0, 0);
+    post = st->st_tree->ct_samp;
+
+    sp3_notify_ingest(sim.sched, st->st_tree, post.r_alen - pre.r_alen, post.r_wlen - pre.r_wlen);
+
+    bytes = keys * (ph->ph_klen + ph->ph_vlen);
+
+    st->st_user_bytes += bytes;
+    st->st_cn_wbytes += ks->ks_st.kst_kwlen + ks->ks_st.kst_vwlen;
+    st->st_ingest_next = sim.now + (double)bytes * NSEC_PER_SEC / opt.ingest_bw;
+
+    st->st_remaining -= keys;
+    if (st->st_remaining == 0) {
+        st->st_phx++;
+        sim_phase_next(st);
+    }
+}
+
+/*----------------------------------------------------------------
+ * Reporting
+ */
+
+struct shape {
+    uint     inodes;
+    uint     lnodes;
+    uint     ikvsets;
+    uint     lkvsets;
+    uint     lkvsets_max;
+    uint     rkvsets;
+    uint     depth;
+    uint64_t alen;
+    uint64_t lalen;
+};
+
+static void
+shape_get(struct cn_tree *tree, struct shape *s)
+{
+    struct cn_tree_node *tn;
+    struct tree_iter iter;
+
+    tree_iter_init(tree, &iter, TRAVERSE_TOPDOWN);
+
+    while (NULL != (tn = tree_iter_next(tree, &iter))) {
+        uint kvsets = cn_ns_kvsets(&tn->tn_ns);
+
+        s->alen += cn_ns_alen(&tn->tn_ns);
+        s->depth = max_t(uint, s->depth, tn->tn_loc.node_level);
+
+        if (!tn->tn_parent) {
+            s->rkvsets = max(s->rkvsets, kvsets);
+        } else if (cn_node_isleaf(tn)) {
+            s->lnodes++;
+            s->lkvsets += kvsets;
+            s->lkvsets_max = max(s->lkvsets_max, kvsets);
+            s->lalen += cn_ns_alen(&tn->tn_ns);
+        } else {
+            s->inodes++;
+            s->ikvsets += kvsets;
+        }
+    }
+}
+
+static void
+report(bool hdr)
+{
+    struct shape s = { 0 };
+    uint64_t user = 0, wbytes = 0, live = 0, stall = 0;
+    double secs = (double)sim.now / NSEC_PER_SEC;
+    uint i;
+
+    if (hdr)
+        printf("%8s %9s %6s %6s %6s %5s %5s %6s %6s %6s %5s %5s %4s %6s\n",
+               "secs", "ingestGB", "wamp", "samp", "leaf%", "depth", "rlen",
+               "inodes", "ilen", "lnodes", "llen", "lmax", "jobs", "stall%");
+
+    for (i = 0; i < sim.treec; ++i) {
+        struct sim_tree *st = sim.treev[i];
+
+        shape_get(st->st_tree, &s);
+
+        user += st->st_user_bytes;
+        wbytes += st->st_cn_wbytes;
+        live += st->st_live_bytes;
+        stall += st->st_stall_ns;
+    }
+
+    printf("%8.0f %9.1f %6.2f %6.2f %6.1f %5u %5u %6u %6.1f %6u %5.1f %5u %4u %6.1f\n",
+           secs,
+           (double)user / GiB,
+           user ? (double)wbytes / user : 0,
+           live ? (double)s.alen / live : 0,
+           s.alen ? 100.0 * s.lalen / s.alen : 0,
+           s.depth,
+           s.rkvsets,
+           s.inodes,
+           s.inodes ? (double)s.ikvsets / s.inodes : 0,
+           s.lnodes,
+           s.lnodes ? (double)s.lkvsets / s.lnodes : 0,
+           s.lkvsets_max,
+           sim.jobc,
+           sim.now ? 100.0 * stall / ((double)sim.now * sim.treec) : 0);
+
+    fflush(stdout);
+}
+
+/* Per-rule and per-kvs totals, as recorded by sp3's compaction history.
+ */
+static void
+report_history(void)
+{
+    struct csched_history *hist;
+    uint64_t user = 0, rbytes = 0, wbytes = 0, jobs = 0;
+    uint i;
+
+    hist = malloc(sizeof(*hist));
+    if (!hist)
+        fatal(ENOMEM, "report_history");
+
+    sp3_history_get(sim.sched, hist);
+
+    for (i = 0; i < sim.treec; ++i)
+        user += sim.treev[i]->st_user_bytes;
+    user = user ?: 1;
+
+    printf("\n%-12s %8s %10s %10s %7s\n", "rule", "jobs", "readGB", "writeGB", "wamp");
+
+    for (i = 0; i < hist->ch_rulec; ++i) {
+        const struct csched_rule_stats *rs = hist->ch_rulev + i;
+
+        jobs += rs->crs_jobs;
+        rbytes += rs->crs_rbytes;
+        wbytes += rs->crs_wbytes;
+
+        printf("%-12s %8lu %10.1f %10.1f %7.2f\n",
+               rs->crs_rule, (ulong)rs->crs_jobs,
+               (double)rs->crs_rbytes / GiB, (double)rs->crs_wbytes / GiB,
+               (double)rs->crs_wbytes / user);
+    }
+
+    printf("%-12s %8lu %10.1f %10.1f %7.2f\n", "total", (ulong)jobs,
+           (double)rbytes / GiB, (double)wbytes / GiB, (double)wbytes / user);
+
+    printf("\n%-16s %4s %8s %9s %6s %6s %6s\n",
+           "kvs", "prio", "jobs", "ingestGB", "wamp", "samp", "stall%");
+
+    for (i = 0; i < hist->ch_kvsc; ++i) {
+        const struct csched_kvs_stats *ks = hist->ch_kvsv + i;
+        struct sim_tree *st = NULL;
+        struct shape s = { 0 };
+        uint j;
+
+        for (j = 0; j < sim.treec && !st; ++j) {
+            if (sim.treev[j]->st_tree->cnid == ks->cks_cnid)
+                st = sim.treev[j];
+        }
+
+        if (!st)
+            continue;
+
+        shape_get(st->st_tree, &s);
+
+        printf("%-16s %4u %8lu %9.1f %6.2f %6.2f %6.1f\n",
+               ks->cks_kvsname,
+               st->st_rp.cn_compact_prio,
+               (ulong)ks->cks_jobs,
+               (double)st->st_user_bytes / GiB,
+               st->st_user_bytes ? (double)st->st_cn_wbytes / st->st_user_bytes : 0,
+               st->st_live_bytes ? (double)s.alen / st->st_live_bytes : 0,
+               sim.now ? 100.0 * st->st_stall_ns / sim.now : 0);
+    }
+
+    free(hist);
+}
+
+/*----------------------------------------------------------------
+ * Event loop
+ */
+
+static void
+simulate(void)
+{
+    uint64_t report_next = opt.interval * NSEC_PER_SEC;
+    uint64_t tick = 0, quiet = 0;
+    uint i;
+
+    for (i = 0; i < sim.treec; ++i)
+        sim_phase_next(sim.treev[i]);
+
+    report(true);
+
+    while (!opt.duration || sim.now < opt.duration * NSEC_PER_SEC) {
+        bool stalled[HSE_KVS_COUNT_MAX];
+        uint64_t next = tick, prev = sim.now;
+        bool busy = sim.jobc > 0;
+
+        for (i = 0; i < sim.treec; ++i) {
+            struct sim_tree *st = sim.treev[i];
+
+            stalled[i] = sim_ingesting(st) && sim_stalled(st);
+
+            if (sim_ingesting(st)) {
+                busy = true;
+                if (!stalled[i])
+                    next = min(next, max(st->st_ingest_next, sim.now));
+            }
+        }
+
+        for (i = 0; i < sim.jobc; ++i) {
+            if (!sim.jobv[i]->sj_finished)
+                next = min(next, sim.jobv[i]->sj_done);
+        }
+
+        if (busy)
+            quiet = next;
+        else if (next - quiet > SIM_QUIET_NS)
+            break;
+
+        if (opt.duration)
+            next = min(next, opt.duration * NSEC_PER_SEC);
+
+        while (next >= report_next) {
+            sim.now = report_next;
+            report(false);
+            report_next += opt.interval * NSEC_PER_SEC;
+        }
+
+        sim.now = next;
+
+        for (i = 0; i < sim.treec; ++i) {
+            struct sim_tree *st = sim.treev[i];
+
+            if (stalled[i] && st->st_ingest_next < sim.now)
+                st->st_stall_ns += sim.now - max(prev, st->st_ingest_next);
+        }
+
+        if (sim.now >= tick)
+            tick = sim.now + SIM_TICK_NS;
+
+        sim_jobs_finish();
+
+        for (i = 0; i < sim.treec; ++i) {
+            struct sim_tree *st = sim.treev[i];
+
+            if (sim_ingesting(st) && st->st_ingest_next <= sim.now && !sim_stalled(st))
+                sim_ingest(st);
+        }
+
+        sp3_step(sim.sched, sim.now);
+        sim_kvsets_reap();
+    }
+
+    report(false);
+    report_history();
+}
+
+/* Let the running jobs finish without starting new ones, then hand the
+ * trees back.
+ */
+static void
+drain(void)
+{
+    uint i;
+
+    for (i = 0; i < sim.treec; ++i)
+        sp3_tree_remove(sim.sched, sim.treev[i]->st_tree, false);
+
+    while (sim.jobc > 0) {
+        uint64_t next = UINT64_MAX;
+
+        for (i = 0; i < sim.jobc; ++i) {
+            if (!sim.jobv[i]->sj_finished)
+                next = min(next, sim.jobv[i]->sj_done);
+        }
+
+        sim.now = max(sim.now, next);
+
+        sim_jobs_finish();
+        sp3_step(sim.sched, sim.now);
+    }
+
+    sp3_step(sim.sched, sim.now);
+
+    for (i = 0; i < sim.treec; ++i) {
+        struct sim_tree *st = sim.treev[i];
+
+        cn_tree_destroy(st->st_tree);
+        free(st->st_phasev);
+        free(st->st_livev);
+        free(st);
+    }
+
+    sim_kvsets_reap();
+    assert(list_empty(&sim.kvsets));
+
+    free(sim.jobv);
+}
+
+/*----------------------------------------------------------------
+ * Seeding from an existing kvs
+ */
+
+struct seed_kvset {
+    uint64_t           dgen;
+    uint               compc;
+    uint               vgroups;
+    uint               scatter;
+    struct kvset_stats st;
+};
+
+struct seed_node {
+    struct cn_node_loc loc;
+    uint64_t           uniq;
+    struct seed_kvset *kvv;
+    uint               kvc;
+};
+
+static struct seed_node *seedv;
+static uint seedc;
+
+static int
+seed_callback(
+    void *               rock,
+    struct cn_tree *     tree,
+    struct cn_tree_node *node,
+    struct cn_node_loc * loc,
+    struct kvset *       kvset)
+{
+    struct seed_node *sn = seedc ? seedv + seedc - 1 : NULL;
+    struct seed_kvset *kv;
+
+    if (!node || !kvset)
+        return 0;
+
+    if (!sn || sn->loc.node_level != loc->node_level || sn->loc.node_offset != loc->node_offset) {
+        struct cn_node_stats ns;
+
+        sn = realloc(seedv, (seedc + 1) * sizeof(*sn));
+        if (!sn)
+            fatal(ENOMEM, "seed_callback");
+
+        seedv = sn;
+        sn += seedc++;
+        memset(sn, 0, sizeof(*sn));
+
+        cn_node_stats_get(node, &ns);
+        sn->loc = *loc;
+        sn->uniq = ns.ns_keys_uniq;
+    }
+
+    kv = realloc(sn->kvv, (sn->kvc + 1) * sizeof(*kv));
+    if (!kv)
+        fatal(ENOMEM, "seed_callback");
+
+    sn->kvv = kv;
+    kv += sn->kvc++;
+
+    kvset_stats(kvset, &kv->st);
+    kv->dgen = kvset_get_dgen(kvset);
+    kv->compc = kvset_get_compc(kvset);
+    kv->vgroups = kvset_get_vgroups(kvset);
+    kv->scatter = kvset_get_scatter_score(kvset);
+
+    return 0;
+}
+
+/* Read the shape of the cn tree of an existing kvs.
+ */
+static void
+seed_read(struct parm_groups *pg, struct kvs_cparams *cp)
+{
+    struct svec      db_oparm = { 0 };
+    struct svec      kv_oparm = { 0 };
+    struct hse_kvdb *kd = NULL;
+    struct hse_kvs * kvs = NULL;
+    struct cn *      cn;
+    hse_err_t        rc;
+
+    rc = svec_append_pg(&db_oparm, pg, PG_KVDB_OPEN, "read_only=true", NULL);
+    rc = rc ?: svec_append_pg(&kv_oparm, pg, PG_KVS_OPEN,
+                              "cn_diag_mode=true", "cn_maint_disable=true", NULL);
+    if (rc)
+        fatal(rc, "svec_append_pg failed");
+
+    rc = hse_kvdb_open(opt.kvdb_home, db_oparm.strc, db_oparm.strv, &kd);
+    if (rc)
+        fatal(rc, "hse_kvdb_open %s", opt.kvdb_home);
+
+    rc = hse_kvdb_kvs_open(kd, opt.kvs, kv_oparm.strc, kv_oparm.strv, &kvs);
+    if (rc)
+        fatal(rc, "hse_kvdb_kvs_open %s", opt.kvs);
+
+    cn = ikvdb_kvs_get_cn(kvs);
+    if (!cn)
+        fatal(EBUG, "unable to get cn for kvs %s", opt.kvs);
+
+    cp->fanout = cn_get_cparams(cn)->fanout;
+
+    cn_tree_preorder_walk(cn_get_tree(cn), KVSET_ORDER_OLDEST_FIRST, seed_callback, NULL);
+
+    hse_kvdb_kvs_close(kvs);
+    hse_kvdb_close(kd);
+
+    svec_reset(&db_oparm);
+    svec_reset(&kv_oparm);
+}
+
+/* A random key group id that routes to the node at @loc.
+ */
+static uint64_t
+seed_id(const struct cn_node_loc *loc)
+{
+    uint64_t id = xrand64(&sim.xr);
+    uint bits = sim.fbits * loc->node_level;
+
+    if (bits > 0)
+        id = ((uint64_t)loc->node_offset << (64 - bits)) | (id >> bits);
+
+    return id;
+}
+
+static int
+seed_level_cmp(const void *lhs, const void *rhs)
+{
+    const struct seed_node *l = lhs, *r = rhs;
+
+    return (int)r->loc.node_level - (int)l->loc.node_level;
+}
+
+/* Rebuild the seeded tree from model kvsets.  Nodes are populated bottom
+ * up: each node's key groups are drawn from those already placed beneath
+ * it (i.e., older versions of the same keys), topped up with new ones,
+ * so that the tree's garbage and unique key estimates are preserved.
+ */
+static void
+seed_tree(struct sim_tree *st)
+{
+    struct sim_ent *poolv = NULL;
+    size_t          livec = 0;
+    uint            i, j;
+
+    qsort(seedv, seedc, sizeof(*seedv), seed_level_cmp);
+
+    for (i = 0; i < seedc; ++i) {
+        struct seed_node *sn = seedv + i;
+        uint64_t lo, hi;
+        size_t   first, last, poolc, k;
+        uint     bits = sim.fbits * sn->loc.node_level;
+
+        /* The live groups placed by deeper levels are sorted by id, so
+         * those under this node are a contiguous range.
+         */
+        if (i > 0 && sn->loc.node_level != seedv[i - 1].loc.node_level) {
+            qsort(st->st_livev, st->st_livec, sizeof(*st->st_livev), ent_cmp);
+            livec = st->st_livec;
+        }
+
+        lo = bits ? (uint64_t)sn->loc.node_offset << (64 - bits) : 0;
+        hi = bits ? lo + ((UINT64_MAX >> bits)) : UINT64_MAX;
+
+        for (first = 0; first < livec && st->st_livev[first].se_id < lo; ++first)
+            ; /* do nothing */
+        for (last = first; last < livec && st->st_livev[last].se_id <= hi; ++last)
+            ; /* do nothing */
+
+        poolc = max_t(uint64_t, sn->uniq / opt.group, 1);
+
+        free(poolv);
+        poolv = malloc(max(poolc, last - first) * sizeof(*poolv));
+        if (!poolv)
+            fatal(ENOMEM, "seed_tree");
+
+        memcpy(poolv, st->st_livev + first, (last - first) * sizeof(*poolv));
+
+        for (k = last - first; k < poolc; ++k) {
+            const struct seed_kvset *kv = sn->kvv;
+            uint64_t keys = max_t(uint64_t, kv->st.kst_keys, 1);
+
+            poolv[k].se_id = seed_id(&sn->loc);
+            poolv[k].se_klen = clamp_t(uint64_t, kv->st.kst_kwlen / keys,
+                                       SIM_KMD_BYTES + 1, HSE_KVS_KEY_LEN_MAX) - SIM_KMD_BYTES;
+            poolv[k].se_vlen = kv->st.kst_vulen / keys;
+            poolv[k].se_rank = 0;
+
+            sim_live_add(st, poolv + k);
+        }
+
+        poolc = max(poolc, last - first);
+
+        for (j = 0; j < sn->kvc; ++j) {
+            const struct seed_kvset *kv = sn->kvv + j;
+            struct sim_ent *entv;
+            struct kvset *ks;
+            size_t entc, x;
+            merr_t err;
+
+            entc = clamp_t(uint64_t, kv->st.kst_keys / opt.group, 1, poolc);
+
+            /* Partial Fisher-Yates shuffle to pick entc distinct groups.
+             */
+            for (x = 0; x < entc; ++x) {
+                size_t y = x + xrand64(&sim.xr) % (poolc - x);
+                struct sim_ent tmp = poolv[x];
+
+                poolv[x] = poolv[y];
+                poolv[y] = tmp;
+            }
+
+            entv = ent_dup(poolv, entc);
+            qsort(entv, entc, sizeof(*entv), ent_cmp);
+
+            ks = sim_kvset_create(st, entv, entc, kv->dgen, kv->compc);
+            ks->ks_st.kst_vwlen = kv->st.kst_vwlen;
+            ks->ks_st.kst_valen = kv->st.kst_valen;
+            ks->ks_st.kst_vblks = kv->st.kst_vblks;
+            ks->ks_vgroups = kv->vgroups;
+            ks->ks_scatter = kv->scatter;
+
+            err = cn_tree_insert_kvset(st->st_tree, ks, sn->loc.node_level, sn->loc.node_offset);
+            if (err)
+                fatal(err, "cn_tree_insert_kvset");
+
+            sim.dgen = max(sim.dgen, kv->dgen);
+        }
+
+        free(sn->kvv);
+    }
+
+    free(poolv);
+    free(seedv);
+
+    printf("seeded %s from %s/%s: %u nodes, %.1f GB live data\n",
+           st->st_name, opt.kvdb_home, opt.kvs, seedc, (double)st->st_live_bytes / GiB);
+}
+
+/*----------------------------------------------------------------
+ * Setup
+ */
+
+static void
+process_options(int argc, char **argv)
+{
+    uint64_t keys;
+    char *cp;
+    int c;
+
+    while ((c = getopt(argc, argv, ":b:c:d:g:hi:k:l:p:r:s:T:u:v:Z:")) != -1) {
+        merr_t err = 0;
+
+        switch (c) {
+        case 'b':
+            err = parse_u64(optarg, &opt.job_bw);
+            break;
+        case 'c':
+            err = parse_u64(optarg, &opt.c0_bytes);
+            opt.c0_bytes *= MiB;
+            break;
+        case 'd':
+            err = parse_u64(optarg, &opt.duration);
+            break;
+        case 'g':
+            err = parse_u32(optarg, &opt.group);
+            break;
+        case 'h':
+            usage();
+            exit(0);
+        case 'i':
+            err = parse_u64(optarg, &opt.ingest_bw);
+            break;
+        case 'k':
+            err = parse_u32(optarg, &opt.klen);
+            break;
+        case 'l':
+            err = parse_size(optarg, &keys);
+            if (!err)
+                phase_add(&phasev, &phasec, PHASE_LOAD, keys, opt.klen, opt.vlen, 0);
+            break;
+        case 'p':
+            err = parse_u64(optarg, &opt.interval);
+            break;
+        case 'r':
+            err = parse_u64(optarg, &opt.seed);
+            break;
+        case 's':
+            cp = strrchr(optarg, ':');
+            if (!cp || cp == optarg || !cp[1])
+                syntax("invalid argument for option -s: %s", optarg);
+            *cp++ = '\000';
+            opt.kvdb_home = optarg;
+            opt.kvs = cp;
+            break;
+        case 'T':
+            opt.trace = optarg;
+            break;
+        case 'u':
+            err = parse_size(optarg, &keys);
+            if (!err)
+                phase_add(&phasev, &phasec, PHASE_UPDATE, keys, opt.klen, opt.vlen, 0);
+            break;
+        case 'v':
+            err = parse_u32(optarg, &opt.vlen);
+            break;
+        case 'Z':
+            opt.config = optarg;
+            break;
+        case '?':
+            syntax("invalid option -%c", optopt);
+            break;
+        case ':':
+            syntax("option -%c requires a parameter", optopt);
+            break;
+        default:
+            break;
+        }
+
+        if (err)
+            syntax("invalid argument for option -%c: %s", c, optarg);
+    }
+
+    if (!opt.job_bw || !opt.ingest_bw || !opt.c0_bytes || !opt.interval || !opt.group)
+        syntax("bandwidths, c0 size, group size and report interval must be non-zero");
+
+    if (!phasec && !opt.trace && !opt.kvs)
+        syntax("nothing to simulate, specify a trace, -l, -u or a kvs");
+}
+
+int
+main(int argc, char **argv)
+{
+    struct parm_groups *pg = NULL;
+    struct svec         hse_gparm = { 0 };
+    struct svec         db_oparm = { 0 };
+    struct svec         kv_oparm = { 0 };
+    struct svec         kv_cparm = { 0 };
+    hse_err_t           rc;
+    uint64_t            v;
+    uint                i;
+
+    progname = strrchr(argv[0], '/');
+    progname = progname ? progname + 1 : argv[0];
+
+    opt.c0_bytes = 1024 * MiB;
+    opt.ingest_bw = 512;
+    opt.job_bw = 256;
+    opt.interval = 60;
+    opt.group = 16;
+    opt.klen = 16;
+    opt.vlen = 1000;
+    opt.seed = 1;
+
+    INIT_LIST_HEAD(&sim.kvsets);
+
+    rc = pg_create(&pg, PG_HSE_GLOBAL, PG_KVDB_OPEN, PG_KVS_OPEN, PG_KVS_CREATE, NULL);
+    if (rc)
+        fatal(rc, "pg_create");
+
+    process_options(argc, argv);
+
+    opt.ingest_bw *= MiB;
+    opt.job_bw *= MiB;
+
+    rc = pg_parse_argv(pg, argc, argv, &optind);
+    switch (rc) {
+    case 0:
+        if (optind < argc)
+            fatal(0, "unknown parameter: %s", argv[optind]);
+        break;
+    case EINVAL:
+        fatal(0, "missing group name (e.g. %s) before parameter %s\n",
+              PG_KVDB_OPEN, argv[optind]);
+        break;
+    default:
+        fatal(rc, "error processing parameter %s\n", argv[optind]);
+        break;
+    }
+
+    rc = rc ?: svec_append_pg(&hse_gparm, pg, PG_HSE_GLOBAL, NULL);
+    rc = rc ?: svec_append_pg(&db_oparm, pg, PG_KVDB_OPEN, NULL);
+    rc = rc ?: svec_append_pg(&kv_oparm, pg, PG_KVS_OPEN, NULL);
+    rc = rc ?: svec_append_pg(&kv_cparm, pg, PG_KVS_CREATE, NULL);
+    if (rc)
+        fatal(rc, "svec_append_pg failed");
+
+    rc = hse_init(opt.config, hse_gparm.strc, hse_gparm.strv);
+    if (rc)
+        fatal(rc, "hse_init");
+
+    sim.dbrp = kvdb_rparams_defaults();
+    sim.rp = kvs_rparams_defaults();
+    sim.cp = kvs_cparams_defaults();
+
+    rc = argv_deserialize_to_kvdb_rparams(db_oparm.strc, db_oparm.strv, &sim.dbrp);
+    if (rc)
+        fatal(rc, "invalid %s parameters", PG_KVDB_OPEN);
+
+    rc = argv_deserialize_to_kvs_rparams(kv_oparm.strc, kv_oparm.strv, &sim.rp);
+    if (rc)
+        fatal(rc, "invalid %s parameters", PG_KVS_OPEN);
+
+    rc = argv_deserialize_to_kvs_cparams(kv_cparm.strc, kv_cparm.strv, &sim.cp);
+    if (rc)
+        fatal(rc, "invalid %s parameters", PG_KVS_CREATE);
+
+    if (opt.kvs)
+        seed_read(pg, &sim.cp);
+
+    /* Prefix spills are not modeled. */
+    sim.cp.pfx_len = 0;
+
+    if (sim.cp.fanout & (sim.cp.fanout - 1))
+        fatal(EINVAL, "fanout %u is not a power of two", sim.cp.fanout);
+
+    sim.fbits = cn_tree_fanout2bits(sim.cp.fanout);
+
+    /* Ingest stalls once the root is ten kvsets past rspill_kvsets_max,
+     * where the root throttle sensor saturates (see sp3_qos_check()).
+     */
+    v = sim.dbrp.csched_rspill_params;
+    sim.throttle_len = (v == UINT64_MAX ? 0 : v ? (v & 0xff) : 9) + 10;
+
+    xrand_init(&sim.xr, opt.seed);
+
+    if (phasec || opt.kvs) {
+        struct sim_tree *st = sim_tree_add("kvs", 0, NULL);
+
+        st->st_phasev = phasev;
+        st->st_phasec = phasec;
+    }
+
+    if (opt.trace)
+        trace_load(opt.trace);
+
+    rc = sp3_create_offline(&sim.dbrp, progname, &sim.health, sim_job_submit, &sim.sched);
+    if (rc)
+        fatal(rc, "sp3_create_offline");
+
+    for (i = 0; i < sim.treec; ++i) {
+        struct sim_tree *st = sim.treev[i];
+
+        rc = cn_tree_create(&st->st_tree, NULL, st->st_name, 0, &sim.cp, &sim.health, &st->st_rp);
+        if (rc)
+            fatal(rc, "cn_tree_create");
+
+        cn_tree_setup(st->st_tree, NULL, NULL, &st->st_rp, NULL, i + 1, NULL);
+
+        if (i == 0 && opt.kvs)
+            seed_tree(st);
+
+        cn_tree_samp_init(st->st_tree);
+        sp3_tree_add(sim.sched, st->st_tree);
+    }
+
+    printf("%u kvs, fanout %u, node size %lu-%lu MiB, c0 %lu MiB, ingest %lu MiB/s, "
+           "job %lu MiB/s, %u keys per group\n",
+           sim.treec, sim.cp.fanout, (ulong)sim.rp.cn_node_size_lo, (ulong)sim.rp.cn_node_size_hi,
+           (ulong)(opt.c0_bytes >> 20), (ulong)(opt.ingest_bw >> 20), (ulong)(opt.job_bw >> 20),
+           opt.group);
+
+    simulate();
+    drain();
+
+    sp3_destroy(sim.sched);
+
+    hse_fini();
+    pg_destroy(pg);
+    svec_reset(&hse_gparm);
+    svec_reset(&db_oparm);
+    svec_reset(&kv_oparm);
+    svec_reset(&kv_cparm);
+
+    return 0;
+}
@@ -0,0 +1,1203 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright (C) 2022 Micron Technology, Inc.  All rights reserved.
+ *
+ * kvbench replays YCSB core workloads A-F, or a custom operation mix, with
+ * configurable key popularity (uniform, zipfian, latest, hotspot, and
+ * prefix-clustered), scan length and value size distributions.  A fraction
+ * of the operations may be executed within transactions, in which case they
+ * are directed to a second, transactional kvs.
+ *
+ * Records are identified by a record number, and the key of record r is
+ * the 16-byte big-endian tuple (r % npfx, r / npfx), so that each prefix
+ * holds a contiguous range of suffixes.  The load phase inserts records
+ * [0, nrecs) and the exec phase appends new records from nrecs onward.
+ *
+ * All random streams are derived from a single seed (-r), so a run can be
+ * reproduced exactly, modulo thread scheduling.
+ */
+
+#include <hse_util/platform.h>
+#include <hse_util/atomic.h>
+#include <hse_util/compiler.h>
+#include <hse_util/inttypes.h>
+#include <hse_util/minmax.h>
+#include <hse_util/perfc.h>
+#include <hse_util/openmetrics.h>
+
+#include <xoroshiro.h>
+
+#include <endian.h>
+#include <getopt.h>
+#include <libgen.h>
+#include <math.h>
+#include <sysexits.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include <hse/hse.h>
+#include <hse/limits.h>
+
+#include "kvs_helper.h"
+
+#if HDR_HISTOGRAM_C_FROM_SUBPROJECT == 1
+#include <hdr_histogram.h>
+#else
+#include <hdr/hdr_histogram.h>
+#endif
+
+#define KEY_LEN     (2 * sizeof(uint64_t))
+#define PFX_LEN     (sizeof(uint64_t))
+
+const char *progname;
+
+enum op_type {
+    OP_READ,
+    OP_UPDATE,
+    OP_INSERT,
+    OP_SCAN,
+    OP_RMW,
+    OP_CNT
+};
+
+static const char *op_namev[] = {
+    [OP_READ] = "read",
+    [OP_UPDATE] = "update",
+    [OP_INSERT] = "insert",
+    [OP_SCAN] = "scan",
+    [OP_RMW] = "rmw",
+};
+
+_Static_assert(NELEM(op_namev) == OP_CNT, "op_namev");
+
+enum dist_type {
+    DIST_CONSTANT,
+    DIST_UNIFORM,
+    DIST_ZIPFIAN,
+    DIST_LATEST,
+    DIST_HOTSPOT,
+    DIST_PREFIX,
+};
+
+static const char *dist_namev[] = {
+    [DIST_CONSTANT] = "constant",
+    [DIST_UNIFORM] = "uniform",
+    [DIST_ZIPFIAN] = "zipfian",
+    [DIST_LATEST] = "latest",
+    [DIST_HOTSPOT] = "hotspot",
+    [DIST_PREFIX] = "prefix",
+};
+
+/* Zipfian generator over [0, n) after Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases", as used by YCSB.
+ */
+struct zipf {
+    uint64_t n;
+    double   theta;
+    double   alpha;
+    double   zetan;
+    double   eta;
+    double   half_pow_theta;
+};
+
+/* A distribution of lengths (scan lengths, value sizes) over [min, max].
+ */
+struct lendist {
+    enum dist_type type;
+    uint64_t       min;
+    uint64_t       max;
+    struct zipf    zipf;
+};
+
+struct workload {
+    const char    *name;
+    uint           pct[OP_CNT];
+    enum dist_type keydist;
+};
+
+static const struct workload workloadv[] = {
+    { "a", { [OP_READ] = 50, [OP_UPDATE] = 50 }, DIST_ZIPFIAN },
+    { "b", { [OP_READ] = 95, [OP_UPDATE] = 5 }, DIST_ZIPFIAN },
+    { "c", { [OP_READ] = 100 }, DIST_ZIPFIAN },
+    { "d", { [OP_READ] = 95, [OP_INSERT] = 5 }, DIST_LATEST },
+    { "e", { [OP_SCAN] = 95, [OP_INSERT] = 5 }, DIST_ZIPFIAN },
+    { "f", { [OP_READ] = 50, [OP_RMW] = 50 }, DIST_ZIPFIAN },
+};
+
+struct opts {
+    const char    *workload;
+    char          *mix;
+    enum dist_type keydist;
+    bool           keydist_set;
+    double         theta;
+    uint           hot_data_pct;
+    uint           hot_ops_pct;
+    uint64_t       nrecs;
+    uint64_t       nops;
+    uint           npfx;
+    uint           threads;
+    uint           duration;
+    uint           txn_pct;
+    uint64_t       seed;
+    const char    *vlen;
+    const char    *scanlen;
+    bool           load;
+    bool           exec;
+    bool           perfc;
+} opts = {
+    .workload = "a",
+    .theta = 0.99,
+    .hot_data_pct = 20,
+    .hot_ops_pct = 80,
+    .nrecs = 1000 * 1000,
+    .npfx = 64,
+    .threads = 16,
+    .duration = 60,
+    .vlen = "1000",
+    .scanlen = "uniform:1-100",
+};
+
+/* Exec phase configuration derived from opts.
+ */
+static uint           op_cumpct[OP_CNT];
+static struct zipf    key_zipf;
+static struct zipf    pfx_zipf;
+static struct lendist vlen_dist;
+static struct lendist scan_dist;
+
+static volatile bool stopthreads HSE_ACP_ALIGNED;
+
+atomic_ulong n_records HSE_ACP_ALIGNED;
+atomic_ulong n_ops HSE_ACP_ALIGNED;
+atomic_ulong n_miss;
+atomic_ulong n_txn_abort;
+
+static struct hse_kvdb *kvdb;
+static struct hse_kvs  *txkvs;
+
+/* Latencies are recorded separately for plain and txn ops.
+ */
+#define LAT_CNT     (OP_CNT * 2)
+
+struct worker {
+    uint                  idx;
+    uint64_t              rstart;
+    uint64_t              rend;
+    uint64_t              rstate[2];
+    struct hse_kvdb_txn  *txn;
+    char                 *vbuf;
+    size_t                vbufsz;
+    uint64_t              cnt[LAT_CNT];
+    struct hdr_histogram *lat[LAT_CNT];
+} HSE_ACP_ALIGNED;
+
+static uint64_t
+xrand64(struct worker *w)
+{
+    return xoroshiro128plus(w->rstate);
+}
+
+static double
+xrand01(struct worker *w)
+{
+    return (xrand64(w) >> 11) * 0x1.0p-53;
+}
+
+static uint64_t
+fnv64(uint64_t v)
+{
+    uint64_t h = 0xcbf29ce484222325ul;
+    int      i;
+
+    for (i = 0; i < 8; i++, v >>= 8)
+        h = (h ^ (v & 0xff)) * 0x100000001b3ul;
+
+    return h;
+}
+
+static double
+zeta(uint64_t n, double theta)
+{
+    double   sum = 0;
+    uint64_t i;
+
+    for (i = 1; i <= n; i++)
+        sum += 1 / pow(i, theta);
+
+    return sum;
+}
+
+static void
+zipf_init(struct zipf *z, uint64_t n, double theta)
+{
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1 / (1 - theta);
+    z->zetan = zeta(n, theta);
+    z->eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta(2, theta) / z->zetan);
+    z->half_pow_theta = 1 + pow(0.5, theta);
+}
+
+static uint64_t
+zipf_next(struct worker *w, const struct zipf *z)
+{
+    double   u = xrand01(w);
+    double   uz = u * z->zetan;
+    uint64_t v;
+
+    if (uz < 1)
+        return 0;
+
+    if (uz < z->half_pow_theta)
+        return 1;
+
+    v = z->n * pow(z->eta * u - z->eta + 1, z->alpha);
+
+    return v < z->n ? v : z->n - 1;
+}
+
+static int
+lendist_parse(const char *spec, struct lendist *d)
+{
+    const char *p = spec;
+    char       *end;
+
+    d->type = DIST_CONSTANT;
+
+    if (!strncmp(p, "uniform:", 8)) {
+        d->type = DIST_UNIFORM;
+        p += 8;
+    } else if (!strncmp(p, "zipfian:", 8)) {
+        d->type = DIST_ZIPFIAN;
+        p += 8;
+    }
+
+    errno = 0;
+    d->min = d->max = strtoull(p, &end, 0);
+    if (errno || end == p)
+        return EINVAL;
+
+    if (*end == '-') {
+        p = end + 1;
+        d->max = strtoull(p, &end, 0);
+        if (errno || end == p)
+            return EINVAL;
+    }
+
+    if (*end || d->min > d->max || (d->type != DIST_CONSTANT && d->min == d->max))
+        return EINVAL;
+
+    if (d->type == DIST_CONSTANT && d->min != d->max)
+        d->type = DIST_UNIFORM;
+
+    if (d->type == DIST_ZIPFIAN)
+        zipf_init(&d->zipf, d->max - d->min + 1, opts.theta);
+
+    return 0;
+}
+
+static uint64_t
+lendist_next(struct worker *w, const struct lendist *d)
+{
+    switch (d->type) {
+    case DIST_UNIFORM:
+        return d->min + xrand64(w) % (d->max - d->min + 1);
+
+    case DIST_ZIPFIAN:
+        return d->min + zipf_next(w, &d->zipf);
+
+    default:
+        return d->min;
+    }
+}
+
+/* Choose an existing record per the key distribution.
+ */
+static uint64_t
+key_next(struct worker *w)
+{
+    uint64_t nrecs = atomic_read(&n_records);
+    uint64_t r, hot;
+
+    switch (opts.keydist) {
+    case DIST_ZIPFIAN:
+        /* Scrambled so that the popular records are spread out. */
+        r = fnv64(zipf_next(w, &key_zipf)) % key_zipf.n;
+        break;
+
+    case DIST_LATEST:
+        r = nrecs - 1 - zipf_next(w, &key_zipf) % nrecs;
+        break;
+
+    case DIST_HOTSPOT:
+        hot = max_t(uint64_t, 1, nrecs * opts.hot_data_pct / 100);
+
+        if (xrand64(w) % 100 < opts.hot_ops_pct || hot == nrecs)
+            r = xrand64(w) % hot;
+        else
+            r = hot + xrand64(w) % (nrecs - hot);
+        break;
+
+    case DIST_PREFIX:
+        r = zipf_next(w, &pfx_zipf);
+        r += (xrand64(w) % (nrecs / opts.npfx + 1)) * opts.npfx;
+        if (r >= nrecs)
+            r %= opts.npfx;
+        break;
+
+    default:
+        r = xrand64(w) % nrecs;
+        break;
+    }
+
+    return r;
+}
+
+static void
+key_make(void *key, uint64_t r)
+{
+    uint64_t *kp = key;
+
+    kp[0] = htobe64(r % opts.npfx);
+    kp[1] = htobe64(r / opts.npfx);
+}
+
+static size_t
+val_make(struct worker *w)
+{
+    return lendist_next(w, &vlen_dist);
+}
+
+static void
+lat_record(struct worker *w, int lat, uint64_t tstart)
+{
+    hdr_record_value(w->lat[lat], get_time_ns() - tstart);
+    w->cnt[lat]++;
+}
+
+static hse_err_t
+op_get(struct hse_kvs *kvs, struct hse_kvdb_txn *txn, const void *key, struct worker *w)
+{
+    hse_err_t err;
+    size_t    vlen;
+    bool      found;
+
+    err = hse_kvs_get(kvs, 0, txn, key, KEY_LEN, &found, w->vbuf, w->vbufsz, &vlen);
+    if (!err && !found)
+        atomic_inc(&n_miss);
+
+    return err;
+}
+
+static hse_err_t
+op_put(struct hse_kvs *kvs, struct hse_kvdb_txn *txn, const void *key, struct worker *w)
+{
+    return hse_kvs_put(kvs, 0, txn, key, KEY_LEN, w->vbuf, val_make(w));
+}
+
+static hse_err_t
+op_scan(struct hse_kvs *kvs, struct hse_kvdb_txn *txn, const void *key, struct worker *w)
+{
+    struct hse_kvs_cursor *cur;
+    const void            *k, *v;
+    size_t                 klen, vlen;
+    uint64_t               len, i;
+    hse_err_t              err;
+    bool                   eof = false;
+
+    len = lendist_next(w, &scan_dist);
+
+    err = hse_kvs_cursor_create(kvs, 0, txn, key, PFX_LEN, &cur);
+    if (err)
+        return err;
+
+    err = hse_kvs_cursor_seek(cur, 0, key, KEY_LEN, NULL, NULL);
+
+    for (i = 0; i < len && !err && !eof; i++)
+        err = hse_kvs_cursor_read(cur, 0, &k, &klen, &v, &vlen, &eof);
+
+    hse_kvs_cursor_destroy(cur);
+
+    return err;
+}
+
+static void
+op_exec(struct worker *w, struct hse_kvs *kvs, enum op_type op, bool istxn)
+{
+    struct hse_kvdb_txn *txn = NULL;
+    char                 key[KEY_LEN];
+    uint64_t             tstart;
+    hse_err_t            err;
+
+    if (op == OP_INSERT)
+        key_make(key, atomic_inc_return(&n_records) - 1);
+    else
+        key_make(key, key_next(w));
+
+    tstart = get_time_ns();
+
+    if (istxn) {
+        txn = w->txn;
+
+        err = hse_kvdb_txn_begin(kvdb, txn);
+        if (err)
+            fatal(err, "hse_kvdb_txn_begin failed");
+    }
+
+    switch (op) {
+    case OP_READ:
+        err = op_get(kvs, txn, key, w);
+        break;
+
+    case OP_UPDATE:
+    case OP_INSERT:
+        err = op_put(kvs, txn, key, w);
+        break;
+
+    case OP_SCAN:
+        err = op_scan(kvs, txn, key, w);
+        break;
+
+    case OP_RMW:
+        err = op_get(kvs, txn, key, w);
+        if (!err)
+            err = op_put(kvs, txn, key, w);
+        break;
+
+    default:
+        abort();
+    }
+
+    if (istxn) {
+        /* Write conflicts are expected under skew. */
+        if (hse_err_to_errno(err) == ECANCELED) {
+            hse_kvdb_txn_abort(kvdb, txn);
+            atomic_inc(&n_txn_abort);
+            return;
+        }
+
+        if (!err)
+            err = hse_kvdb_txn_commit(kvdb, txn);
+    }
+
+    if (err)
+        fatal(err, "%s%s failed", istxn ? "txn-" : "", op_namev[op]);
+
+    lat_record(w, istxn ? op + OP_CNT : op, tstart);
+}
+
+static void
+worker_init(struct worker *w, uint phase)
+{
+    size_t i;
+
+    xoroshiro128plus_init(w->rstate, opts.seed + w->idx * 2 + phase);
+
+    w->vbufsz = max_t(size_t, vlen_dist.max, 1);
+    w->vbuf = malloc(w->vbufsz);
+    if (!w->vbuf)
+        fatal(ENOMEM, "cannot allocate value buffer");
+
+    /* Random value data so as not to flatter compression. */
+    for (i = 0; i < w->vbufsz; i++)
+        w->vbuf[i] = xrand64(w);
+
+    if (txkvs && !w->txn) {
+        w->txn = hse_kvdb_txn_alloc(kvdb);
+        if (!w->txn)
+            fatal(ENOMEM, "hse_kvdb_txn_alloc failed");
+    }
+}
+
+static void
+worker_fini(struct worker *w)
+{
+    if (w->txn)
+        hse_kvdb_txn_free(kvdb, w->txn);
+    w->txn = NULL;
+
+    free(w->vbuf);
+    w->vbuf = NULL;
+}
+
+void
+loader(void *arg)
+{
+    struct thread_arg *targ = arg;
+    struct worker     *w = targ->arg;
+    char               key[KEY_LEN];
+    uint64_t           r;
+    hse_err_t          err;
+    uint               ntxn = 0;
+
+    pthread_setname_np(pthread_self(), __func__);
+
+    worker_init(w, 0);
+
+    for (r = w->rstart; r < w->rend && !stopthreads; r++) {
+        key_make(key, r);
+
+        err = hse_kvs_put(targ->kvs, 0, NULL, key, KEY_LEN, w->vbuf, val_make(w));
+        if (err)
+            fatal(err, "load put failed");
+
+        /* Load the txn kvs in groups of puts per txn. */
+        if (txkvs) {
+            if (ntxn == 0) {
+                err = hse_kvdb_txn_begin(kvdb, w->txn);
+                if (err)
+                    fatal(err, "hse_kvdb_txn_begin failed");
+            }
+
+            err = hse_kvs_put(txkvs, 0, w->txn, key, KEY_LEN, w->vbuf, val_make(w));
+            if (err)
+                fatal(err, "load txn put failed");
+
+            if (++ntxn == 64 || r + 1 == w->rend) {
+                err = hse_kvdb_txn_commit(kvdb, w->txn);
+                if (err)
+                    fatal(err, "hse_kvdb_txn_commit failed");
+                ntxn = 0;
+            }
+        }
+
+        atomic_inc(&n_ops);
+    }
+
+    worker_fini(w);
+}
+
+void
+runner(void *arg)
+{
+    struct thread_arg *targ = arg;
+    struct worker     *w = targ->arg;
+    uint64_t           nops = 0;
+
+    pthread_setname_np(pthread_self(), __func__);
+
+    worker_init(w, 1);
+
+    while (!stopthreads && (!opts.nops || nops < opts.nops)) {
+        uint pct = xrand64(w) % 100;
+        bool istxn = txkvs && xrand64(w) % 100 < opts.txn_pct;
+        int  op;
+
+        for (op = 0; op < OP_CNT - 1; op++)
+            if (pct < op_cumpct[op])
+                break;
+
+        op_exec(w, istxn ? txkvs : targ->kvs, op, istxn);
+
+        ++nops;
+        atomic_inc(&n_ops);
+    }
+
+    worker_fini(w);
+}
+
+void
+print_stats(void *arg)
+{
+    uint64_t last = 0, cur;
+    uint32_t second = 0;
+
+    while (!stopthreads) {
+        sleep(1);
+
+        cur = atomic_read(&n_ops);
+
+        if (second % 20 == 0)
+            printf("\n%8s %14s %10s %12s %10s %10s\n",
+                   "elapsed", "ops", "ops/s", "records", "misses", "aborts");
+
+        printf("%8u %14lu %10lu %12lu %10lu %10lu\n",
+               ++second, cur, cur - last, atomic_read(&n_records),
+               atomic_read(&n_miss), atomic_read(&n_txn_abort));
+
+        last = cur;
+    }
+}
+
+/* Render all enabled perf counters in OpenMetrics format into a string.
+ */
+static char *
+perfc_snapshot(void)
+{
+    struct om_writer w;
+    char             buf[8192];
+    char            *snap;
+    off_t            len;
+    merr_t           err;
+    int              fd;
+
+    fd = memfd_create(progname, 0);
+    if (fd == -1)
+        fatal(errno, "memfd_create failed");
+
+    om_init(&w, fd, buf, sizeof(buf));
+    perfc_metrics_emit(&w);
+
+    err = om_finish(&w);
+    if (err)
+        fatal(err, "perfc snapshot failed");
+
+    len = lseek(fd, 0, SEEK_END);
+
+    snap = calloc(1, len + 1);
+    if (!snap)
+        fatal(ENOMEM, "cannot allocate perfc snapshot");
+
+    if (pread(fd, snap, len, 0) != len)
+        fatal(errno, "perfc snapshot read failed");
+
+    close(fd);
+
+    return snap;
+}
+
+struct pcval {
+    const char *name;
+    size_t      namelen;
+    uint64_t    val;
+};
+
+static int
+pcval_cmp(const void *lhs, const void *rhs)
+{
+    const struct pcval *l = lhs, *r = rhs;
+    int                 rc;
+
+    rc = memcmp(l->name, r->name, min_t(size_t, l->namelen, r->namelen));
+
+    return rc ?: (int)l->namelen - (int)r->namelen;
+}
+
+/* Extract the rate counter samples (hse_perfc_total{...} value) from an
+ * OpenMetrics snapshot.
+ */
+static struct pcval *
+perfc_parse(char *snap, size_t *cntp)
+{
+    const char   *tag = "hse_perfc_total{";
+    struct pcval *v = NULL;
+    size_t        cnt = 0, max = 0;
+    char         *line, *sp;
+
+    while ((line = strtok_r(snap, "\n", &sp))) {
+        char *val;
+
+        snap = NULL;
+
+        if (strncmp(line, tag, strlen(tag)))
+            continue;
+
+        val = strrchr(line, ' ');
+        if (!val)
+            continue;
+
+        if (cnt == max) {
+            max = max ? max * 2 : 1024;
+            v = realloc(v, max * sizeof(*v));
+            if (!v)
+                fatal(ENOMEM, "cannot allocate perfc samples");
+        }
+
+        v[cnt].name = line + strlen("hse_perfc_total");
+        v[cnt].namelen = val - v[cnt].name;
+        v[cnt].val = strtoull(val + 1, NULL, 10);
+        cnt++;
+    }
+
+    qsort(v, cnt, sizeof(*v), pcval_cmp);
+
+    *cntp = cnt;
+
+    return v;
+}
+
+static void
+perfc_print_delta(char *before, char *after)
+{
+    struct pcval *bv, *av;
+    size_t        bc, ac, i;
+
+    bv = perfc_parse(before, &bc);
+    av = perfc_parse(after, &ac);
+
+    printf("\nPerf counter deltas:\n");
+
+    for (i = 0; i < ac; i++) {
+        struct pcval *b;
+        uint64_t      delta = av[i].val;
+
+        b = bsearch(av + i, bv, bc, sizeof(*bv), pcval_cmp);
+        if (b)
+            delta -= b->val;
+
+        if (delta > 0)
+            printf("  %.*s %lu\n", (int)av[i].namelen, av[i].name, delta);
+    }
+
+    free(bv);
+    free(av);
+}
+
+static void
+print_hist(struct worker *workers, uint64_t dt)
+{
+    const char *hdr_fmt = "%12s %12s %10s %8s %8s %8s %8s %8s %8s %10s %12s\n";
+    const char *lat_fmt = "%12s %12lu %10lu %8lu %8lu %8lu %8lu %8lu %8lu %10lu %12lu\n";
+    struct worker *w0 = workers;
+    int            i, l;
+
+    for (i = 1; i < opts.threads; i++) {
+        for (l = 0; l < LAT_CNT; l++) {
+            hdr_add(w0->lat[l], workers[i].lat[l]);
+            w0->cnt[l] += workers[i].cnt[l];
+        }
+    }
+
+    printf("\nLatency summary (ns):\n");
+    printf(hdr_fmt, "operation", "samples", "ops/s", "min", "mean", "50.0", "95.0", "99.0",
+           "99.9", "99.99", "max");
+
+    for (l = 0; l < LAT_CNT; l++) {
+        struct hdr_histogram *h = w0->lat[l];
+        char                  name[32];
+
+        if (!w0->cnt[l])
+            continue;
+
+        snprintf(name, sizeof(name), "%s%s", l < OP_CNT ? "" : "txn-", op_namev[l % OP_CNT]);
+
+        printf(lat_fmt, name, w0->cnt[l], w0->cnt[l] * 1000000000ul / (dt ?: 1),
+               (ulong)hdr_min(h), (ulong)hdr_mean(h),
+               (ulong)hdr_value_at_percentile(h, 50.0),
+               (ulong)hdr_value_at_percentile(h, 95.0),
+               (ulong)hdr_value_at_percentile(h, 99.0),
+               (ulong)hdr_value_at_percentile(h, 99.9),
+               (ulong)hdr_value_at_percentile(h, 99.99),
+               (ulong)hdr_max(h));
+    }
+}
+
+static int
+mix_parse(char *mix, uint *pct)
+{
+    char *tok;
+
+    memset(pct, 0, sizeof(*pct) * OP_CNT);
+
+    while ((tok = strsep(&mix, ",")) && *tok) {
+        char *val = strchr(tok, '=');
+        int   op;
+
+        if (!val)
+            return EINVAL;
+        *val++ = '\000';
+
+        for (op = 0; op < OP_CNT; op++)
+            if (!strcmp(tok, op_namev[op]))
+                break;
+
+        if (op == OP_CNT)
+            return EINVAL;
+
+        pct[op] = strtoul(val, NULL, 0);
+    }
+
+    return 0;
+}
+
+/* Driver */
+void
+syntax(const char *fmt, ...)
+{
+    char    msg[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    fprintf(stderr, "%s: %s, use -h for help\n", progname, msg);
+}
+
+void
+usage(void)
+{
+    printf(
+        "usage: %s [options] kvdb_home kvs [param=value ...]\n"
+        "-D dist    Key distribution: uniform, zipfian, latest, hotspot or prefix\n"
+        "           (default: per workload)\n"
+        "-d dur     Duration of exec in seconds (default: %u)\n"
+        "-e         Exec\n"
+        "-H d:o     Hotspot: d%% of the records receive o%% of the ops (default: %u:%u)\n"
+        "-h         Print this help menu\n"
+        "-j jobs    Number of threads (default: %u)\n"
+        "-l         Load\n"
+        "-m mix     Op mix, overrides -w (e.g. read=50,update=30,scan=15,insert=5)\n"
+        "           ops: read, update, insert, scan, rmw\n"
+        "-n nrecs   Number of records loaded (default: %lu)\n"
+        "-o nops    Max ops per thread during exec (default: unlimited)\n"
+        "-P         Print perf counter deltas for the exec phase\n"
+        "-p npfx    Number of key prefixes (default: %u)\n"
+        "-r seed    Random seed (default: time of day, printed)\n"
+        "-S spec    Scan length distribution (default: %s)\n"
+        "-t theta   Zipfian constant (default: %.2f)\n"
+        "-v spec    Value length distribution (default: %s)\n"
+        "-w wkld    YCSB workload: a, b, c, d, e or f (default: %s)\n"
+        "-X pct     Percent of ops executed in txns against kvs \"<kvs>-txn\" (default: %u)\n"
+        "-Z config  path to global config file\n"
+        "\n"
+        "Length distribution specs are N (constant), uniform:MIN-MAX or zipfian:MIN-MAX.\n"
+        "Perf counters must be enabled to be reported (e.g., gp perfc.level=2).\n"
+        "\n",
+        progname, opts.duration, opts.hot_data_pct, opts.hot_ops_pct, opts.threads,
+        opts.nrecs, opts.npfx, opts.scanlen, opts.theta, opts.vlen, opts.workload,
+        opts.txn_pct);
+
+    printf(
+        "Examples:\n\n"
+        "  1. Load:\n"
+        "    %s /mnt/kvdb kvs1 -j32 -n100000000 -l\n\n"
+        "  2. Exec YCSB E with 10%% txns and zipfian value sizes:\n"
+        "    %s /mnt/kvdb kvs1 -j32 -n100000000 -e -we -X10 -v zipfian:100-4000 -d600 -P\n"
+        "\n", progname, progname);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct parm_groups *pg = NULL;
+    struct svec         hse_gparms = { 0 };
+    struct svec         kvdb_oparms = { 0 };
+    struct svec         kvs_cparms = { 0 };
+    struct svec         kvs_oparms = { 0 };
+    struct svec         txkvs_oparms = { 0 };
+    struct worker      *workers;
+    const char         *home, *kvs, *config = NULL;
+    char                txkvs_name[HSE_KVS_NAME_LEN_MAX];
+    uint                pct[OP_CNT], sum;
+    int                 rc, c, i, l;
+
+    progname = basename(argv[0]);
+
+    rc = pg_create(&pg, PG_HSE_GLOBAL, PG_KVDB_OPEN, PG_KVS_OPEN, PG_KVS_CREATE, NULL);
+    if (rc)
+        fatal(rc, "pg_create");
+
+    while ((c = getopt(argc, argv, ":D:d:eH:hj:lm:n:o:Pp:r:S:t:v:w:X:Z:")) != -1) {
+        char *errmsg, *end;
+
+        errmsg = end = NULL;
+        errno = 0;
+
+        switch (c) {
+        case 'D':
+            for (i = DIST_UNIFORM; i < NELEM(dist_namev); i++)
+                if (!strcmp(optarg, dist_namev[i]))
+                    break;
+
+            if (i == NELEM(dist_namev)) {
+                syntax("invalid key distribution '%s'", optarg);
+                exit(EX_USAGE);
+            }
+
+            opts.keydist = i;
+            opts.keydist_set = true;
+            break;
+        case 'd':
+            opts.duration = strtoul(optarg, &end, 0);
+            errmsg = "invalid duration";
+            break;
+        case 'e':
+            opts.exec = true;
+            break;
+        case 'H':
+            if (sscanf(optarg, "%u:%u", &opts.hot_data_pct, &opts.hot_ops_pct) != 2 ||
+                opts.hot_data_pct > 100 || opts.hot_ops_pct > 100) {
+                syntax("invalid hotspot '%s'", optarg);
+                exit(EX_USAGE);
+            }
+            break;
+        case 'h':
+            usage();
+            exit(0);
+        case 'j':
+            opts.threads = strtoul(optarg, &end, 0);
+            errmsg = "invalid thread count";
+            break;
+        case 'l':
+            opts.load = true;
+            break;
+        case 'm':
+            opts.mix = optarg;
+            break;
+        case 'n':
+            opts.nrecs = strtoull(optarg, &end, 0);
+            errmsg = "invalid record count";
+            break;
+        case 'o':
+            opts.nops = strtoull(optarg, &end, 0);
+            errmsg = "invalid op count";
+            break;
+        case 'P':
+            opts.perfc = true;
+            break;
+        case 'p':
+            opts.npfx = strtoul(optarg, &end, 0);
+            errmsg = "invalid number of prefixes";
+            break;
+        case 'r':
+            opts.seed = strtoull(optarg, &end, 0);
+            errmsg = "invalid seed";
+            break;
+        case 'S':
+            opts.scanlen = optarg;
+            break;
+        case 't':
+            opts.theta = strtod(optarg, &end);
+            errmsg = "invalid zipfian constant";
+            break;
+        case 'v':
+            opts.vlen = optarg;
+            break;
+        case 'w':
+            opts.workload = optarg;
+            break;
+        case 'X':
+            opts.txn_pct = strtoul(optarg, &end, 0);
+            errmsg = "invalid txn percent";
+            break;
+        case 'Z':
+            config = optarg;
+            break;
+        case '?':
+            syntax("invalid option -%c", optopt);
+            exit(EX_USAGE);
+        case ':':
+            syntax("option -%c requires a parameter", optopt);
+            exit(EX_USAGE);
+        default:
+            fprintf(stderr, "option -%c ignored\n", c);
+            break;
+        }
+
+        if (errno && errmsg) {
+            syntax("%s", errmsg);
+            exit(EX_USAGE);
+        } else if (end && *end) {
+            syntax("%s '%s'", errmsg, optarg);
+            exit(EX_USAGE);
+        }
+    }
+
+    if (argc - optind < 2) {
+        syntax("missing required parameters");
+        exit(EX_USAGE);
+    }
+
+    home = argv[optind++];
+    kvs = argv[optind++];
+
+    if (!opts.load && !opts.exec) {
+        syntax("choose a phase to run (-l and/or -e)");
+        exit(EX_USAGE);
+    }
+
+    if (opts.threads == 0 || opts.npfx == 0 || opts.nrecs < opts.npfx) {
+        syntax("jobs and prefixes must be non-zero and records at least the prefix count");
+        exit(EX_USAGE);
+    }
+
+    if (opts.theta <= 0 || opts.theta >= 1 || opts.txn_pct > 100) {
+        syntax("theta must be in (0, 1) and txn percent at most 100");
+        exit(EX_USAGE);
+    }
+
+    for (i = 0; i < NELEM(workloadv); i++)
+        if (!strcasecmp(opts.workload, workloadv[i].name))
+            break;
+
+    if (i == NELEM(workloadv)) {
+        syntax("invalid workload '%s'", opts.workload);
+        exit(EX_USAGE);
+    }
+
+    memcpy(pct, workloadv[i].pct, sizeof(pct));
+    if (!opts.keydist_set)
+        opts.keydist = workloadv[i].keydist;
+
+    if (opts.mix && mix_parse(opts.mix, pct)) {
+        syntax("invalid op mix");
+        exit(EX_USAGE);
+    }
+
+    for (sum = 0, i = 0; i < OP_CNT; i++) {
+        sum += pct[i];
+        op_cumpct[i] = sum;
+    }
+
+    if (sum != 100) {
+        syntax("op mix must total 100%%");
+        exit(EX_USAGE);
+    }
+
+    if (lendist_parse(opts.vlen, &vlen_dist) || vlen_dist.max > HSE_KVS_VALUE_LEN_MAX) {
+        syntax("invalid value length distribution '%s'", opts.vlen);
+        exit(EX_USAGE);
+    }
+
+    if (lendist_parse(opts.scanlen, &scan_dist)) {
+        syntax("invalid scan length distribution '%s'", opts.scanlen);
+        exit(EX_USAGE);
+    }
+
+    if (!opts.seed)
+        opts.seed = get_time_ns();
+
+    rc = pg_parse_argv(pg, argc, argv, &optind);
+    switch (rc) {
+        case 0:
+            if (optind < argc)
+                fatal(0, "unknown parameter: %s", argv[optind]);
+            break;
+        case EINVAL:
+            fatal(0, "missing group name (e.g. %s) before parameter %s\n",
+                PG_KVDB_OPEN, argv[optind]);
+            break;
+        default:
+            fatal(rc, "error processing parameter %s\n", argv[optind]);
+            break;
+    }
+
+    rc = rc ?: svec_append_pg(&hse_gparms, pg, PG_HSE_GLOBAL, NULL);
+    rc = rc ?: svec_append_pg(&kvdb_oparms, pg, PG_KVDB_OPEN, NULL);
+    rc = rc ?: svec_append_pg(&kvs_cparms, pg, PG_KVS_CREATE, NULL);
+    rc = rc ?: svec_append_pg(&kvs_oparms, pg, PG_KVS_OPEN, NULL);
+    rc = rc ?: svec_append_pg(&txkvs_oparms, pg, PG_KVS_OPEN, "transactions.enabled=true", NULL);
+    if (rc)
+        fatal(rc, "failed to parse params\n");
+
+    kvdb = kh_init(config, home, &hse_gparms, &kvdb_oparms);
+
+    if (opts.txn_pct > 0) {
+        snprintf(txkvs_name, sizeof(txkvs_name), "%s-txn", kvs);
+        txkvs = kh_get_kvs(txkvs_name, &kvs_cparms, &txkvs_oparms);
+    }
+
+    workers = aligned_alloc(HSE_ACP_LINESIZE, sizeof(*workers) * opts.threads);
+    if (!workers)
+        fatal(ENOMEM, "cannot allocate memory for thread data");
+
+    memset(workers, 0, sizeof(*workers) * opts.threads);
+
+    for (i = 0; i < opts.threads; i++) {
+        workers[i].idx = i;
+
+        for (l = 0; l < LAT_CNT; l++)
+            hdr_init(1, 10UL * 1000 * 1000 * 1000, 3, &workers[i].lat[l]);
+    }
+
+    printf("%s: seed %lu records %lu prefixes %u threads %u\n",
+           progname, opts.seed, opts.nrecs, opts.npfx, opts.threads);
+
+    if (opts.load) {
+        uint64_t share = opts.nrecs / opts.threads;
+
+        printf("load: value length %s\n", opts.vlen);
+
+        stopthreads = false;
+        atomic_set(&n_ops, 0);
+        atomic_set(&n_records, opts.nrecs);
+
+        kh_register(KH_FLAG_DETACH, &print_stats, NULL);
+
+        for (i = 0; i < opts.threads; i++) {
+            workers[i].rstart = share * i;
+            workers[i].rend = (i == opts.threads - 1) ? opts.nrecs : share * (i + 1);
+
+            kh_register_kvs(kvs, 0, &kvs_cparms, &kvs_oparms, &loader, &workers[i]);
+        }
+
+        kh_wait();
+        stopthreads = true;
+        kh_wait_all();
+    }
+
+    if (opts.exec) {
+        char    *before = NULL;
+        uint64_t tstart, dt;
+        uint     duration;
+
+        printf("exec: workload %s mix", opts.mix ? "custom" : opts.workload);
+        for (i = 0; i < OP_CNT; i++)
+            if (pct[i])
+                printf(" %s=%u", op_namev[i], pct[i]);
+        printf(" keys %s values %s scans %s txn %u%%\n",
+               dist_namev[opts.keydist], opts.vlen, opts.scanlen, opts.txn_pct);
+
+        zipf_init(&key_zipf, opts.nrecs, opts.theta);
+        zipf_init(&pfx_zipf, opts.npfx, opts.theta);
+
+        if (opts.perfc)
+            before = perfc_snapshot();
+
+        stopthreads = false;
+        atomic_set(&n_ops, 0);
+        atomic_set(&n_records, opts.nrecs);
+
+        kh_register(KH_FLAG_DETACH, &print_stats, NULL);
+
+        tstart = get_time_ns();
+
+        for (i = 0; i < opts.threads; i++)
+            kh_register_kvs(kvs, 0, &kvs_cparms, &kvs_oparms, &runner, &workers[i]);
+
+        /* Runners exit early if they reach the op limit. */
+        duration = opts.duration;
+        while (!stopthreads && duration--) {
+            sleep(1);
+
+            if (opts.nops && atomic_read(&n_ops) >= opts.nops * opts.threads)
+                break;
+        }
+
+        stopthreads = true;
+        kh_wait_all();
+
+        dt = get_time_ns() - tstart;
+
+        print_hist(workers, dt);
+
+        printf("\nmisses %lu txn aborts %lu\n", atomic_read(&n_miss), atomic_read(&n_txn_abort));
+
+        if (opts.perfc) {
+            char *after = perfc_snapshot();
+
+            perfc_print_delta(before, after);
+            free(after);
+            free(before);
+        }
+    }
+
+    for (i = 0; i < opts.threads; i++) {
+        for (l = 0; l < LAT_CNT; l++)
+            hdr_close(workers[i].lat[l]);
+    }
+
+    free(workers);
+
+    kh_fini();
+
+    pg_destroy(pg);
+    svec_reset(&hse_gparms);
+    svec_reset(&kvdb_oparms);
+    svec_reset(&kvs_cparms);
+    svec_reset(&kvs_oparms);
+    svec_reset(&txkvs_oparms);
+
+    return 0;
+}
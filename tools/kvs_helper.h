@@ -42,6 +42,13 @@ kh_wait(void);
 void
 kh_wait_all(void);
 
+/* open (creating if necessary) a kvs shared by all threads */
+struct hse_kvs *
+kh_get_kvs(
+	const char           *name,
+	struct svec          *cparms,
+	struct svec          *oparms);
+
 int
 kh_register_kvs(
 	const char           *kvs,